@@ -0,0 +1,242 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "verse.h"
+#include "verse_types.h"
+
+#include "b_bench.h"
+
+/**
+ * Benchmark, that could be selected with option -b
+ */
+typedef struct BenchEntry {
+	const char	*name;
+	void		(*func)(const struct BenchOptions *opts);
+} BenchEntry;
+
+static const struct BenchEntry b_benches[] = {
+		{"hash_array",	b_hash_array_bench},
+		{"mem",			b_mem_bench},
+		{"layer",		b_layer_bench},
+		{"pool",		b_pool_bench},
+		{"fanout",		b_fanout_bench},
+		{"codec",		b_codec_bench},
+		{"recv",		b_recv_bench},
+		{"queue",		b_queue_bench},
+		{"history",		b_history_bench},
+		{"send",		b_send_bench},
+		{"dgram",		b_dgram_bench},
+		{"ack_nak",	b_ack_nak_bench},
+		{"cc",			b_cc_bench},
+		{NULL,			NULL}
+};
+
+/* Format of printed results */
+static uint8 b_format = BENCH_FORMAT_TEXT;
+
+/**
+ * \brief This function returns current value of monotonic clock in
+ * nanoseconds
+ */
+uint64 b_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+}
+
+/**
+ * \brief This function prints result of one benchmark
+ * \param[in]	*name	The name of benchmark
+ * \param[in]	items	The number of items used by benchmark
+ * \param[in]	ops		The number of measured operations
+ * \param[in]	time_ns	The time of all operations in nanoseconds
+ */
+void b_report(const char *name, uint32 items, uint64 ops, uint64 time_ns)
+{
+	b_report_value(name, items,
+			(ops > 0) ? (double)time_ns / (double)ops : 0.0, "ns/op");
+}
+
+/**
+ * \brief This function prints number of allocations done by one benchmark
+ * \param[in]	*name	The name of benchmark
+ * \param[in]	items	The number of items used by benchmark
+ * \param[in]	ops		The number of measured operations
+ * \param[in]	allocs	The number of allocations done by all operations
+ */
+void b_report_allocs(const char *name, uint32 items, uint64 ops, uint64 allocs)
+{
+	b_report_value(name, items,
+			(ops > 0) ? (double)allocs / (double)ops : 0.0, "allocs/op");
+}
+
+/**
+ * \brief This function prints one value measured by benchmark. Results are
+ * printed as aligned table or as comma separated values, that could be
+ * compared between builds.
+ * \param[in]	*name	The name of benchmark
+ * \param[in]	items	The number of items used by benchmark
+ * \param[in]	value	The measured value
+ * \param[in]	*unit	The unit of value
+ */
+void b_report_value(const char *name, uint32 items, double value, const char *unit)
+{
+	if(b_format == BENCH_FORMAT_CSV) {
+		printf("%s,%u,%.2f,%s\n", name, items, value, unit);
+	} else if(strcmp(unit, "ns/op") == 0) {
+		printf("%-32s %10u %12.1f %s\n", name, items, value, unit);
+	} else {
+		printf("%-32s %10u %12.2f %s\n", name, items, value, unit);
+	}
+	fflush(stdout);
+}
+
+/**
+ * \brief This function print help of benchmark command (options and
+ * parameters )
+ */
+static void print_help(char *prog_name)
+{
+	printf("\n Usage: %s [OPTION...]\n\n", prog_name);
+	printf("  This program runs benchmarks of verse library\n\n");
+	printf("  Options:\n");
+	printf("   -h               display this help and exit\n");
+	printf("   -m max_items     maximal number of items (default: %d)\n", BENCH_DEFAULT_MAX_ITEMS);
+	printf("   -b benchmark     run only this benchmark (default: all)\n");
+	printf("   -f format        format of results [text|csv] (default: text)\n");
+	printf("   -l               list benchmarks and exit\n");
+	printf("   -d debug_level   use debug level [none|info|error|warning|debug]\n\n");
+}
+
+/**
+ * \brief This function set debug level of verse library
+ */
+static int set_debug_level(char *debug_level)
+{
+	if( strcmp(debug_level, "debug") == 0) {
+		return vrs_set_debug_level(VRS_PRINT_DEBUG_MSG);
+	} else if( strcmp(debug_level, "warning") == 0 ) {
+		return vrs_set_debug_level(VRS_PRINT_WARNING);
+	} else if( strcmp(debug_level, "error") == 0 ) {
+		return vrs_set_debug_level(VRS_PRINT_ERROR);
+	} else if( strcmp(debug_level, "info") == 0 ) {
+		return vrs_set_debug_level(VRS_PRINT_INFO);
+	} else if( strcmp(debug_level, "none") == 0 ) {
+		return vrs_set_debug_level(VRS_PRINT_NONE);
+	} else {
+		printf("Unsupported debug level: %s\n", debug_level);
+		return VRS_FAILURE;
+	}
+}
+
+/**
+ * \brief Main function of benchmarks
+ */
+int main(int argc, char *argv[])
+{
+	struct BenchOptions opts;
+	const char *bench_name = NULL;
+	int opt, i, found = 0;
+
+	opts.max_items = BENCH_DEFAULT_MAX_ITEMS;
+
+	/* Parse all options */
+	while( (opt = getopt(argc, argv, "hlm:d:b:f:")) != -1) {
+		switch(opt) {
+			case 'm':
+				opts.max_items = (uint32)strtoul(optarg, NULL, 10);
+				break;
+			case 'b':
+				bench_name = optarg;
+				break;
+			case 'f':
+				if(strcmp(optarg, "csv") == 0) {
+					b_format = BENCH_FORMAT_CSV;
+				} else if(strcmp(optarg, "text") == 0) {
+					b_format = BENCH_FORMAT_TEXT;
+				} else {
+					printf("Unsupported format: %s\n", optarg);
+					print_help(argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'l':
+				for(i = 0; b_benches[i].name != NULL; i++) {
+					printf("%s\n", b_benches[i].name);
+				}
+				exit(EXIT_SUCCESS);
+			case 'd':
+				if(set_debug_level(optarg) != VRS_SUCCESS) {
+					print_help(argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'h':
+				print_help(argv[0]);
+				exit(EXIT_SUCCESS);
+			default:
+				print_help(argv[0]);
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if(b_format == BENCH_FORMAT_CSV) {
+		printf("benchmark,items,value,unit\n");
+	}
+
+	for(i = 0; b_benches[i].name != NULL; i++) {
+		if(bench_name == NULL || strcmp(bench_name, b_benches[i].name) == 0) {
+			b_benches[i].func(&opts);
+			found = 1;
+		}
+	}
+
+	if(found == 0) {
+		printf("Unknown benchmark: %s\n", bench_name);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_sys_commands.h"
+#include "v_history.h"
+
+#include "b_bench.h"
+
+/* Number of received packets acknowledged by one ACK packet */
+#define ACK_NAK_BENCH_ACK_EVERY		4
+/* Number of ACK packets sent before ANK ID of the first one is received */
+#define ACK_NAK_BENCH_DELAY			16
+/* Maximal number of received packets */
+#define ACK_NAK_BENCH_MAX_OPS		4000000
+
+/**
+ * Pattern of lost packets
+ */
+typedef struct AckNakLoss {
+	const char	*name;
+	uint32		loss;		/* Probability of loss of one packet in 1/10000 */
+	uint32		burst;		/* Count of packets lost at once */
+} AckNakLoss;
+
+static const struct AckNakLoss b_ack_nak_losses[] = {
+		{"ack_nak_no_loss",		0,		1},
+		{"ack_nak_loss_1pct",	100,	1},
+		{"ack_nak_loss_10pct",	1000,	1},
+		{"ack_nak_burst_1pct",	20,		5},
+		{NULL,					0,		0}
+};
+
+/**
+ * \brief Simple deterministic generator of pseudo random numbers, that
+ * makes results comparable between runs.
+ */
+static uint32 b_ack_nak_rand(uint32 *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+
+	return (*seed >> 16) & 0x7FFF;
+}
+
+/**
+ * \brief This function receives packets with given pattern of losses, it
+ * sends ACK and NAK commands in every ACK_NAK_BENCH_ACK_EVERY received packet
+ * and it removes commands confirmed by ANK ID delayed by
+ * ACK_NAK_BENCH_DELAY ACK packets.
+ */
+static void b_ack_nak_run(const struct AckNakLoss *loss, uint32 packets)
+{
+	struct AckNakHistory history;
+	VSystemCommands sys_cmds[MAX_SYSTEM_COMMAND_COUNT + 1];
+	uint32 ank_ids[ACK_NAK_BENCH_DELAY];
+	uint32 pay_id, received = 0, acks = 0, seed = 1, lost = 0;
+	uint64 start, time_ns, cmds = 0;
+	int count;
+
+	memset(&history, 0, sizeof(history));
+	v_ack_nak_history_init(&history);
+
+	start = b_time_ns();
+	for(pay_id = 1; pay_id <= packets; pay_id++) {
+		/* Is this packet lost? */
+		if(lost > 0) {
+			lost--;
+			continue;
+		}
+		if(loss->loss > 0 && (b_ack_nak_rand(&seed) % 10000) < loss->loss) {
+			lost = loss->burst - 1;
+			continue;
+		}
+
+		v_ack_nak_history_add_id(&history, pay_id);
+		received++;
+
+		if(received % ACK_NAK_BENCH_ACK_EVERY != 0) {
+			continue;
+		}
+
+		/* Send ACK packet */
+		count = v_ack_nak_history_pack_cmds(&history, sys_cmds,
+				MAX_SYSTEM_COMMAND_COUNT - 1);
+		cmds += count;
+
+		/* Receive ANK ID of older ACK packet */
+		if(acks >= ACK_NAK_BENCH_DELAY) {
+			v_ack_nak_history_remove_cmds(&history, ank_ids[acks % ACK_NAK_BENCH_DELAY]);
+		}
+		ank_ids[acks % ACK_NAK_BENCH_DELAY] = sys_cmds[count - 1].ack_cmd.pay_id;
+		acks++;
+	}
+	time_ns = b_time_ns() - start;
+
+	b_report(loss->name, ACK_NAK_BENCH_DELAY, received, time_ns);
+	b_report_value(loss->name, ACK_NAK_BENCH_DELAY,
+			(acks > 0) ? (double)cmds / (double)acks : 0.0, "cmd/ack");
+
+	v_ack_nak_history_clear(&history);
+}
+
+/**
+ * \brief This function measures updating of history of ACK and NAK commands
+ * and packing of ACK and NAK commands for several patterns of lost packets.
+ */
+void b_ack_nak_bench(const struct BenchOptions *opts)
+{
+	uint32 packets, i;
+
+	packets = (opts->max_items < ACK_NAK_BENCH_MAX_OPS) ?
+			opts->max_items : ACK_NAK_BENCH_MAX_OPS;
+
+	for(i = 0; b_ack_nak_losses[i].name != NULL; i++) {
+		b_ack_nak_run(&b_ack_nak_losses[i], packets);
+	}
+}
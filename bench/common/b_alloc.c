@@ -0,0 +1,101 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include "verse_types.h"
+
+#include "v_pool.h"
+
+#include "b_bench.h"
+
+/* Number of calls of malloc(), calloc() and realloc() */
+static volatile uint64 b_alloc_counter = 0;
+
+#ifdef __GLIBC__
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+/**
+ * \brief This function replaces malloc() of C library. It counts allocations
+ * of benchmark and verse library and it calls original malloc().
+ */
+void *malloc(size_t size)
+{
+	__sync_fetch_and_add(&b_alloc_counter, 1);
+	return __libc_malloc(size);
+}
+
+/**
+ * \brief This function replaces calloc() of C library
+ */
+void *calloc(size_t nmemb, size_t size)
+{
+	__sync_fetch_and_add(&b_alloc_counter, 1);
+	return __libc_calloc(nmemb, size);
+}
+
+/**
+ * \brief This function replaces realloc() of C library
+ */
+void *realloc(void *ptr, size_t size)
+{
+	__sync_fetch_and_add(&b_alloc_counter, 1);
+	return __libc_realloc(ptr, size);
+}
+
+#endif
+
+/**
+ * \brief This function returns number of heap allocations done since start
+ * of benchmark. It returns 0 all the time, when allocations can not be
+ * counted on current platform.
+ */
+uint64 b_alloc_count(void)
+{
+	return b_alloc_counter;
+}
+
+/**
+ * \brief This function returns number of heap allocations and blocks
+ * allocated from pool by current thread since start of benchmark.
+ */
+uint64 b_alloc_total(void)
+{
+	return b_alloc_counter + v_pool_thread_alloc_count();
+}
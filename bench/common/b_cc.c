@@ -0,0 +1,313 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_sys_commands.h"
+#include "v_history.h"
+#include "v_connection.h"
+#include "v_congestion.h"
+
+#include "b_bench.h"
+
+/* Size of sent packets */
+#define CC_BENCH_MSS			1400
+/* Rate of bottleneck link [B/s] (10 Mbit/s) */
+#define CC_BENCH_BTL_BW			1250000
+/* Rate of access link of sender [B/s] (100 Mbit/s) */
+#define CC_BENCH_ACCESS_BW		12500000
+/* Round trip propagation time [us] */
+#define CC_BENCH_RTT			50000
+/* Size of buffer of bottleneck link (one BDP) */
+#define CC_BENCH_BUFFER			(CC_BENCH_BTL_BW/1000000.0*CC_BENCH_RTT)
+/* Simulated time [us] */
+#define CC_BENCH_TIME			30000000
+/* Count of frames per second, when application sends data */
+#define CC_BENCH_FPS			60
+/* Count of slots in ring of sent packets (power of two) */
+#define CC_BENCH_RING			65536
+
+/**
+ * Simulated path
+ */
+typedef struct CCPath {
+	const char	*name;
+	uint8		cc_meth;
+	uint32		loss;		/* Probability of random loss of packet in 1/10000 */
+	uint32		app_rate;	/* Data queued by application once per frame [B/s], zero for bulk transfer */
+	uint32		buffer;		/* Size of buffer of bottleneck link [packets], zero for one BDP */
+	uint8		pacing;		/* Sent packets are paced */
+} CCPath;
+
+static const struct CCPath b_cc_paths[] = {
+		{"cc_none_loss_1pct",		CC_NONE,	100,	0,			0,	0},
+		{"cc_cubic_no_loss",		CC_CUBIC,	0,		0,			0,	0},
+		{"cc_cubic_loss_1pct",		CC_CUBIC,	100,	0,			0,	0},
+		{"cc_bbr_no_loss",			CC_BBR,		0,		0,			0,	0},
+		{"cc_bbr_loss_1pct",		CC_BBR,		100,	0,			0,	0},
+		/* Frames of 8 Mbit/s stream over shallow buffer (netem limit) */
+		{"cc_cubic_fps_tick",		CC_CUBIC,	0,		1000000,	8,	0},
+		{"cc_cubic_paced",			CC_CUBIC,	0,		1000000,	8,	1},
+		{"cc_bbr_fps_tick",			CC_BBR,		0,		1000000,	8,	0},
+		{"cc_bbr_paced",			CC_BBR,		0,		1000000,	8,	1},
+		{NULL,						0,			0,		0,			0,	0}
+};
+
+/**
+ * Simulated packet
+ */
+typedef struct CCPacket {
+	struct VSent_Packet	sent;		/* Sent packet as it is stored in history */
+	uint64				ack_time;	/* Time of receiving ACK by sender, zero for lost packet */
+	uint8				in_flight;	/* Packet was not acknowledged or lost yet */
+} CCPacket;
+
+static struct VDgramConn b_cc_conn;
+static struct CCPacket b_cc_packets[CC_BENCH_RING];
+
+/**
+ * \brief Simple deterministic generator of pseudo random numbers, that
+ * makes results comparable between runs.
+ */
+static uint32 b_cc_rand(uint32 *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+
+	return (*seed >> 16) & 0x7FFF;
+}
+
+static void b_cc_timeval(struct timeval *tv, uint64 us)
+{
+	tv->tv_sec = us / 1000000;
+	tv->tv_usec = us % 1000000;
+}
+
+/**
+ * \brief This function simulates transfer of data over path with one
+ * bottleneck link and drop-tail buffer. Application queues either unlimited
+ * bulk data or data of one frame at each tick of FPS timer. Random loss of
+ * packets is applied to packets entering bottleneck link. Receiver acknowledges every packet
+ * and sender detects loss of packets from gaps between ACKs like NAK
+ * commands of Verse.
+ */
+static void b_cc_run(const struct CCPath *path, uint32 max_packets)
+{
+	struct VDgramConn *vconn = &b_cc_conn;
+	struct CCPacket *packet;
+	struct timeval tv;
+	uint64 now = 0, access_free = 0, btl_free = 0, last_ack = 0;
+	uint64 delivered = 0, queue_delay = 0, rtt, frame = 0, app_queue = 0;
+	uint32 seed = 1, sent = 0, lost = 0, first_id, next_id, ack_id;
+	uint32 rttvar = 0, rto, pacing_delay = 0;
+	double btl_queue, buffer;
+
+	memset(vconn, 0, sizeof(struct VDgramConn));
+	memset(b_cc_packets, 0, sizeof(b_cc_packets));
+	vconn->cc_meth = path->cc_meth;
+	vconn->io_ctx.mtu = CC_BENCH_MSS;
+	vconn->host_id = 1;
+	v_cc_init(vconn);
+	vconn->cc.pacing = path->pacing;
+
+	buffer = (path->buffer > 0) ? (double)path->buffer*CC_BENCH_MSS : CC_BENCH_BUFFER;
+
+	first_id = next_id = ack_id = vconn->host_id;
+
+	while(now < CC_BENCH_TIME && sent < max_packets) {
+		uint64 next_event = CC_BENCH_TIME;
+
+		/* Receive ACKs in order of sending */
+		while(ack_id != next_id) {
+			packet = &b_cc_packets[ack_id & (CC_BENCH_RING - 1)];
+			if(packet->ack_time == 0) {
+				ack_id++;
+				continue;
+			}
+			if(packet->ack_time > now) {
+				if(packet->ack_time < next_event) {
+					next_event = packet->ack_time;
+				}
+				break;
+			}
+			b_cc_timeval(&tv, now);
+
+			/* Packets sent before acknowledged packet were lost (NAK) */
+			for(; first_id != ack_id; first_id++) {
+				struct CCPacket *lost_packet = &b_cc_packets[first_id & (CC_BENCH_RING - 1)];
+				if(lost_packet->in_flight == 1) {
+					v_cc_packet_lost(vconn, &lost_packet->sent, &tv);
+					vconn->cc.in_flight -= lost_packet->sent.size;
+					lost_packet->in_flight = 0;
+				}
+			}
+
+			if(packet->in_flight == 1) {
+				/* SRTT as it is computed by resend mechanism */
+				rtt = now - ((uint64)packet->sent.tv.tv_sec*1000000 + packet->sent.tv.tv_usec);
+				if(vconn->srtt == 0) {
+					vconn->srtt = (uint32)rtt;
+					rttvar = (uint32)rtt/2;
+				} else {
+					rttvar = (3*rttvar + ((vconn->srtt > rtt) ? vconn->srtt - rtt : rtt - vconn->srtt))/4;
+					vconn->srtt = (uint32)((7*(uint64)vconn->srtt + rtt)/8);
+				}
+				v_cc_rtt_sample(vconn, (uint32)rtt, &tv);
+				v_cc_packet_acked(vconn, &packet->sent, &tv);
+				vconn->cc.in_flight -= packet->sent.size;
+				packet->in_flight = 0;
+				delivered += packet->sent.size;
+			}
+			first_id = ++ack_id;
+			last_ack = now;
+		}
+
+		/* Expiration of retransmission timer: all packets in flight are
+		 * lost, when the probe is acknowledged */
+		rto = vconn->srtt + 4*rttvar;
+		if(rto < RTO_MIN) {
+			rto = RTO_MIN;
+		}
+		if(vconn->cc.in_flight > 0 && ack_id == next_id && now >= last_ack + rto) {
+			b_cc_timeval(&tv, now);
+			v_cc_timeout(vconn, &tv);
+			for(; first_id != next_id; first_id++) {
+				packet = &b_cc_packets[first_id & (CC_BENCH_RING - 1)];
+				if(packet->in_flight == 1) {
+					vconn->cc.in_flight -= packet->sent.size;
+					packet->in_flight = 0;
+				}
+			}
+			ack_id = first_id;
+			last_ack = now;
+		}
+
+		/* Application queues data of new frame */
+		if(path->app_rate > 0) {
+			if(now >= frame) {
+				app_queue += path->app_rate/CC_BENCH_FPS;
+				frame += 1000000/CC_BENCH_FPS;
+			}
+			if(frame < next_event) {
+				next_event = frame;
+			}
+		}
+
+		/* Send packet, when access link is free, window is not full and
+		 * pacer allows it */
+		b_cc_timeval(&tv, now);
+		pacing_delay = v_cc_pacing_delay(vconn, &tv);
+		if(now >= access_free && v_cc_can_send(vconn) == 1 &&
+				pacing_delay == 0 &&
+				(path->app_rate == 0 || app_queue >= CC_BENCH_MSS) &&
+				next_id - first_id < CC_BENCH_RING)
+		{
+			packet = &b_cc_packets[next_id & (CC_BENCH_RING - 1)];
+			b_cc_timeval(&tv, now);
+			memset(packet, 0, sizeof(struct CCPacket));
+			packet->sent.id = next_id;
+			packet->sent.tv = tv;
+			v_cc_packet_sent(vconn, &packet->sent, CC_BENCH_MSS, &tv);
+			packet->in_flight = 1;
+			vconn->count_s_pay++;
+			next_id++;
+			sent++;
+			if(path->app_rate > 0) {
+				app_queue -= CC_BENCH_MSS;
+			}
+
+			access_free = now + (uint64)CC_BENCH_MSS*1000000/CC_BENCH_ACCESS_BW;
+
+			/* Packet enters bottleneck link */
+			btl_queue = (btl_free > access_free) ?
+					(double)(btl_free - access_free)*CC_BENCH_BTL_BW/1000000.0 : 0.0;
+			if(btl_queue + CC_BENCH_MSS > buffer ||
+					(path->loss > 0 && (b_cc_rand(&seed) % 10000) < path->loss))
+			{
+				lost++;
+			} else {
+				if(btl_free < access_free) {
+					btl_free = access_free;
+				}
+				queue_delay += btl_free - access_free;
+				btl_free += (uint64)CC_BENCH_MSS*1000000/CC_BENCH_BTL_BW;
+				packet->ack_time = btl_free + CC_BENCH_RTT;
+			}
+		}
+
+		if(v_cc_can_send(vconn) == 1 && access_free > now && access_free < next_event) {
+			next_event = access_free;
+		}
+		if(v_cc_can_send(vconn) == 1 && pacing_delay > 0 && now + pacing_delay < next_event) {
+			next_event = now + pacing_delay;
+		}
+		if(vconn->cc.in_flight > 0 && last_ack + rto > now && last_ack + rto < next_event) {
+			next_event = last_ack + rto;
+		}
+		if(next_event > now) {
+			now = next_event;
+		}
+	}
+
+	b_report_value(path->name, CC_BENCH_TIME/1000000,
+			(now > 0) ? 100.0*delivered/((double)CC_BENCH_BTL_BW*now/1000000.0) : 0.0,
+			"% of link");
+	b_report_value(path->name, CC_BENCH_TIME/1000000,
+			(delivered > 0) ? (double)queue_delay/(delivered/CC_BENCH_MSS)/1000.0 : 0.0,
+			"ms queue");
+	b_report_value(path->name, CC_BENCH_TIME/1000000,
+			(sent > 0) ? 100.0*lost/sent : 0.0, "% lost");
+}
+
+/**
+ * \brief This function simulates transfer of data with each method of
+ * Congestion Control over path with 10 Mbit/s bottleneck, 50 ms RTT and
+ * random loss. Frames of data sent at FPS tick are compared with paced
+ * packets over shallow buffer. It reports utilization of bottleneck link, average time
+ * spent by packets in queue of bottleneck link and ratio of lost packets.
+ */
+void b_cc_bench(const struct BenchOptions *opts)
+{
+	uint32 i;
+
+	for(i = 0; b_cc_paths[i].name != NULL; i++) {
+		b_cc_run(&b_cc_paths[i], opts->max_items);
+	}
+}
@@ -0,0 +1,132 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_commands.h"
+#include "v_cmd_codec.h"
+
+#include "b_bench.h"
+
+/* Maximal number of packed and unpacked commands */
+#define CODEC_BENCH_MAX_OPS		1000000
+
+/* Commands used by benchmark */
+static const uint8 codec_bench_cmds[] = {
+		CMD_NODE_CREATE,
+		CMD_TAG_SET_VEC4_UINT64,
+		CMD_LAYER_SET_VEC3_REAL32,
+		CMD_LAYER_SET_VEC4_REAL64
+};
+
+/**
+ * \brief This function measures packing and unpacking of one command with
+ * interpreted and generated functions.
+ */
+static void b_codec_cmd(const uint8 id, const uint32 ops)
+{
+	struct Generic_Cmd *cmd = v_cmd_alloc(id), *unpacked = v_cmd_alloc(id);
+	char buffer[DEFAULT_MTU], name[64];
+	uint64 start;
+	uint32 i;
+	int len;
+
+	/* Fill command with some pattern */
+	len = v_cmd_struct_size(cmd) - 1;
+	for(i = 0; i < (uint32)len; i++) {
+		cmd->data[i] = (uint8)(i * 13);
+	}
+
+	start = b_time_ns();
+	for(i = 0; i < ops; i++) {
+		v_cmd_pack_items(buffer, cmd, 0);
+	}
+	sprintf(name, "codec_pack_interp_%d", id);
+	b_report(name, 1, ops, b_time_ns() - start);
+
+	start = b_time_ns();
+	for(i = 0; i < ops; i++) {
+		v_cmd_codec_pack(buffer, cmd, 0);
+	}
+	sprintf(name, "codec_pack_gen_%d", id);
+	b_report(name, 1, ops, b_time_ns() - start);
+
+	start = b_time_ns();
+	for(i = 0; i < ops; i++) {
+		v_cmd_unpack_items(buffer, DEFAULT_MTU, unpacked, 0);
+	}
+	sprintf(name, "codec_unpack_interp_%d", id);
+	b_report(name, 1, ops, b_time_ns() - start);
+
+	start = b_time_ns();
+	for(i = 0; i < ops; i++) {
+		v_cmd_codec_unpack(buffer, unpacked, 0);
+	}
+	sprintf(name, "codec_unpack_gen_%d", id);
+	b_report(name, 1, ops, b_time_ns() - start);
+
+	/* Whole command including header of command */
+	start = b_time_ns();
+	for(i = 0; i < ops; i++) {
+		v_cmd_pack(buffer, cmd, v_cmd_size(cmd), 0);
+	}
+	sprintf(name, "codec_cmd_pack_%d", id);
+	b_report(name, 1, ops, b_time_ns() - start);
+
+	v_cmd_destroy(&unpacked);
+	v_cmd_destroy(&cmd);
+}
+
+/**
+ * \brief This function compares interpreted and generated pack/unpack
+ * functions of commands.
+ */
+void b_codec_bench(const struct BenchOptions *opts)
+{
+	uint32 ops, i;
+
+	ops = (opts->max_items < CODEC_BENCH_MAX_OPS) ?
+			opts->max_items : CODEC_BENCH_MAX_OPS;
+
+	for(i = 0; i < sizeof(codec_bench_cmds)/sizeof(codec_bench_cmds[0]); i++) {
+		b_codec_cmd(codec_bench_cmds[i], ops);
+	}
+}
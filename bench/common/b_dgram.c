@@ -0,0 +1,232 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "verse_types.h"
+
+#include "v_network.h"
+
+#include "b_bench.h"
+
+/* Size of packets sent by benchmark */
+#define DGRAM_BENCH_PACKET_SIZE		1400
+/* Number of packets sent in one batch */
+#define DGRAM_BENCH_BATCH			16
+/* Maximal number of sent packets */
+#define DGRAM_BENCH_MAX_OPS			200000
+
+/**
+ * \brief This function creates non-blocking UDP socket bound to loopback.
+ */
+static int b_dgram_socket(struct sockaddr_in *addr)
+{
+	socklen_t addr_len = sizeof(struct sockaddr_in);
+	int sockfd, buf_size = 4*1024*1024;
+
+	if((sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1) {
+		return -1;
+	}
+	setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &buf_size, sizeof(buf_size));
+	setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &buf_size, sizeof(buf_size));
+
+	memset(addr, 0, sizeof(struct sockaddr_in));
+	addr->sin_family = AF_INET;
+	addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr->sin_port = 0;
+	if(bind(sockfd, (struct sockaddr*)addr, addr_len) == -1 ||
+			getsockname(sockfd, (struct sockaddr*)addr, &addr_len) == -1 ||
+			fcntl(sockfd, F_SETFL, O_NONBLOCK) == -1)
+	{
+		close(sockfd);
+		return -1;
+	}
+
+	return sockfd;
+}
+
+/**
+ * \brief This function receives all packets waiting in the socket with
+ * recvfrom(), with batches or with IO_CTX using UDP GRO and it returns
+ * number of received packets.
+ */
+static uint32 b_dgram_drain(int sockfd, struct VDgramBatch *batch,
+		struct IO_CTX *io_ctx, char *buf, uint64 *recv_ns)
+{
+	struct sockaddr_in addr;
+	socklen_t addr_len;
+	uint64 start;
+	uint32 received = 0;
+	int count, error_num;
+
+	start = b_time_ns();
+	if(io_ctx != NULL) {
+		while(v_receive_packet(io_ctx, &error_num) == 1) {
+			received++;
+		}
+	} else if(batch == NULL) {
+		addr_len = sizeof(addr);
+		while(recvfrom(sockfd, buf, DGRAM_BENCH_PACKET_SIZE, 0,
+				(struct sockaddr*)&addr, &addr_len) > 0)
+		{
+			received++;
+			addr_len = sizeof(addr);
+		}
+	} else {
+		while((count = v_dgram_batch_receive(batch, sockfd, IPV4, &error_num)) > 0) {
+			received += count;
+		}
+	}
+	*recv_ns += b_time_ns() - start;
+
+	return received;
+}
+
+/**
+ * \brief This function sends packets in batches and it receives them with
+ * batches or with IO_CTX using UDP GRO.
+ */
+static void b_dgram_batches(const char *send_name, const char *recv_name,
+		uint32 packets, int send_fd, int recv_fd,
+		struct sockaddr_in *recv_addr, struct VDgramBatch *send_batch,
+		struct VDgramBatch *recv_batch, struct IO_CTX *io_ctx, char *buf)
+{
+	uint64 send_ns = 0, recv_ns = 0, start;
+	uint32 i, j, sent = 0, received = 0;
+	int error_num;
+
+	for(i = 0; i < packets; i += DGRAM_BENCH_BATCH) {
+		for(j = 0; j < DGRAM_BENCH_BATCH; j++) {
+			memcpy(send_batch->bufs[j], buf, DGRAM_BENCH_PACKET_SIZE);
+			send_batch->sizes[j] = DGRAM_BENCH_PACKET_SIZE;
+			send_batch->addrs[j].ip_ver = IPV4;
+			memcpy(&send_batch->addrs[j].addr.ipv4, recv_addr, sizeof(struct sockaddr_in));
+		}
+		send_batch->count = DGRAM_BENCH_BATCH;
+		start = b_time_ns();
+		if(v_dgram_batch_send(send_batch, send_fd, &error_num) == SEND_PACKET_SUCCESS) {
+			sent += DGRAM_BENCH_BATCH;
+		}
+		send_ns += b_time_ns() - start;
+		received += b_dgram_drain(recv_fd, recv_batch, io_ctx, buf, &recv_ns);
+	}
+	b_report(send_name, DGRAM_BENCH_PACKET_SIZE, sent, send_ns);
+	b_report(recv_name, DGRAM_BENCH_PACKET_SIZE, received, recv_ns);
+}
+
+/**
+ * \brief This function measures sending and receiving of packets over
+ * loopback with one system call per packet, with batches of packets and
+ * with super-buffers segmented and coalesced by kernel (UDP GSO/GRO).
+ */
+void b_dgram_bench(const struct BenchOptions *opts)
+{
+	struct VDgramBatch *send_batch, *recv_batch;
+	struct IO_CTX io_ctx;
+	struct sockaddr_in send_addr, recv_addr;
+	char buf[DGRAM_BENCH_PACKET_SIZE];
+	uint64 send_ns, recv_ns, start;
+	uint32 i, j, packets, sent, received;
+	int send_fd, recv_fd;
+
+	packets = (opts->max_items < DGRAM_BENCH_MAX_OPS) ?
+			opts->max_items : DGRAM_BENCH_MAX_OPS;
+	packets -= packets % DGRAM_BENCH_BATCH;
+	if(packets == 0) {
+		packets = DGRAM_BENCH_BATCH;
+	}
+
+	send_fd = b_dgram_socket(&send_addr);
+	recv_fd = b_dgram_socket(&recv_addr);
+	send_batch = v_dgram_batch_create(DGRAM_BENCH_BATCH, DGRAM_BENCH_PACKET_SIZE);
+	recv_batch = v_dgram_batch_create(DGRAM_BENCH_BATCH, DGRAM_BENCH_PACKET_SIZE);
+	if(send_fd == -1 || recv_fd == -1 || send_batch == NULL || recv_batch == NULL) {
+		printf("dgram: could not create sockets\n");
+		goto end;
+	}
+	memset(buf, 0xAB, DGRAM_BENCH_PACKET_SIZE);
+
+	/* One system call per packet. Packets are received after each batch to
+	 * not overflow buffer of socket. */
+	send_ns = recv_ns = 0;
+	sent = received = 0;
+	for(i = 0; i < packets; i += DGRAM_BENCH_BATCH) {
+		start = b_time_ns();
+		for(j = 0; j < DGRAM_BENCH_BATCH; j++) {
+			if(sendto(send_fd, buf, DGRAM_BENCH_PACKET_SIZE, 0,
+					(struct sockaddr*)&recv_addr, sizeof(recv_addr)) > 0)
+			{
+				sent++;
+			}
+		}
+		send_ns += b_time_ns() - start;
+		received += b_dgram_drain(recv_fd, NULL, NULL, buf, &recv_ns);
+	}
+	b_report("dgram_sendto", DGRAM_BENCH_PACKET_SIZE, sent, send_ns);
+	b_report("dgram_recvfrom", DGRAM_BENCH_PACKET_SIZE, received, recv_ns);
+
+	/* Batches of packets */
+	b_dgram_batches("dgram_batch_send", "dgram_batch_receive", packets,
+			send_fd, recv_fd, &recv_addr, send_batch, recv_batch, NULL, buf);
+
+	/* Super-buffers of packets */
+	memset(&io_ctx, 0, sizeof(struct IO_CTX));
+	io_ctx.sockfd = recv_fd;
+	io_ctx.host_addr.ip_ver = IPV4;
+	io_ctx.buf = (char*)malloc(MAX_PACKET_SIZE);
+	send_batch->gso = v_dgram_gso_enable(send_fd);
+	if(io_ctx.buf != NULL && send_batch->gso == 1 && v_dgram_gro_enable(&io_ctx) == 1) {
+		b_dgram_batches("dgram_gso_send", "dgram_gro_receive", packets,
+				send_fd, recv_fd, &recv_addr, send_batch, NULL, &io_ctx, buf);
+	} else {
+		printf("dgram: UDP GSO/GRO is not supported\n");
+	}
+	v_dgram_gro_destroy(&io_ctx);
+	free(io_ctx.buf);
+
+end:
+	if(send_fd != -1) close(send_fd);
+	if(recv_fd != -1) close(recv_fd);
+	v_dgram_batch_destroy(send_batch);
+	v_dgram_batch_destroy(recv_batch);
+}
@@ -0,0 +1,164 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "verse.h"
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_commands.h"
+#include "v_layer_commands.h"
+#include "v_out_queue.h"
+#include "v_pool.h"
+
+#include "b_bench.h"
+
+/* Maximal number of subscribers of one layer */
+#define FANOUT_BENCH_MAX_SUBS	200
+/* Number of updates sent to all subscribers */
+#define FANOUT_BENCH_UPDATES	1000
+
+/**
+ * \brief This function pops all commands from outgoing queues of subscribers,
+ * it packs them to the buffer, as the sending thread would do, and it drops
+ * references at them. Only packing of commands is measured.
+ * \return This function returns time spent in packing of commands in ns.
+ */
+static uint64 b_fanout_drain(struct VOutQueue **out_queues, uint32 subs)
+{
+	struct Generic_Cmd *cmd;
+	char buffer[DEFAULT_MTU];
+	uint64 start, time_ns = 0;
+	uint16 count, len;
+	int8 share;
+	uint32 i;
+
+	for(i = 0; i < subs; i++) {
+		do {
+			len = DEFAULT_MTU;
+			cmd = v_out_queue_pop(out_queues[i], VRS_DEFAULT_PRIORITY, &count, &share, &len);
+			if(cmd != NULL) {
+				start = b_time_ns();
+				v_cmd_pack(buffer, cmd, v_cmd_size(cmd), 0);
+				time_ns += b_time_ns() - start;
+				v_cmd_destroy(&cmd);
+			}
+		} while(cmd != NULL);
+	}
+
+	return time_ns;
+}
+
+/**
+ * \brief This function sends layer_set_value commands to outgoing queues of
+ * all subscribers. When shared is equal to 1, then one command is shared by
+ * all queues. Otherwise new command is created for each subscriber. Results
+ * are not printed, when name is NULL. Allocations are counted in blocks
+ * allocated from pool (commands and bookkeeping of queues).
+ */
+static void b_fanout_run(struct VOutQueue **out_queues,
+		uint32 subs,
+		int shared,
+		const char *name)
+{
+	struct Generic_Cmd *cmd;
+	real32 vec[3] = {1.0f, 2.0f, 3.0f};
+	uint64 start, end, allocs, cmd_allocs = 0, time_ns = 0, pack_ns = 0;
+	uint32 update, i;
+
+	for(update = 0; update < FANOUT_BENCH_UPDATES; update++) {
+		start = b_time_ns();
+		allocs = v_pool_thread_alloc_count();
+		if(shared == 1) {
+			cmd = v_layer_set_value_create(1, 1, update, VRS_VALUE_TYPE_REAL32, 3, vec);
+			for(i = 0; i < subs; i++) {
+				v_out_queue_push_tail(out_queues[i], VRS_DEFAULT_PRIORITY, v_cmd_ref(cmd));
+			}
+			v_cmd_destroy(&cmd);
+		} else {
+			for(i = 0; i < subs; i++) {
+				cmd = v_layer_set_value_create(1, 1, update, VRS_VALUE_TYPE_REAL32, 3, vec);
+				v_out_queue_push_tail(out_queues[i], VRS_DEFAULT_PRIORITY, cmd);
+			}
+		}
+		cmd_allocs += v_pool_thread_alloc_count() - allocs;
+		end = b_time_ns();
+		time_ns += end - start;
+
+		/* Only packing of commands is measured during sending */
+		pack_ns += b_fanout_drain(out_queues, subs);
+	}
+
+	if(name != NULL) {
+		b_report(name, subs, FANOUT_BENCH_UPDATES, time_ns);
+		b_report_allocs(name, subs, FANOUT_BENCH_UPDATES, cmd_allocs);
+		/* Time of packing per one subscriber */
+		b_report(shared == 1 ? "fanout_shared_pack" : "fanout_copy_pack",
+				subs, (uint64)FANOUT_BENCH_UPDATES * subs, pack_ns);
+	}
+}
+
+/**
+ * \brief This function measures adding of one layer value to the outgoing
+ * queues of all layer subscribers.
+ */
+void b_fanout_bench(const struct BenchOptions *opts)
+{
+	struct VOutQueue *out_queues[FANOUT_BENCH_MAX_SUBS];
+	uint32 subs, i;
+
+	(void)opts;
+
+	for(i = 0; i < FANOUT_BENCH_MAX_SUBS; i++) {
+		out_queues[i] = v_out_queue_create();
+	}
+
+	/* Warm up pools and hashed arrays of queues */
+	b_fanout_run(out_queues, FANOUT_BENCH_MAX_SUBS, 0, NULL);
+
+	for(subs = 1; subs <= FANOUT_BENCH_MAX_SUBS; subs *= 10) {
+		b_fanout_run(out_queues, subs, 0, "fanout_copy");
+		b_fanout_run(out_queues, subs, 1, "fanout_shared");
+	}
+	b_fanout_run(out_queues, FANOUT_BENCH_MAX_SUBS, 0, "fanout_copy");
+	b_fanout_run(out_queues, FANOUT_BENCH_MAX_SUBS, 1, "fanout_shared");
+
+	for(i = 0; i < FANOUT_BENCH_MAX_SUBS; i++) {
+		v_out_queue_destroy(&out_queues[i]);
+	}
+}
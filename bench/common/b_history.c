@@ -0,0 +1,153 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "verse.h"
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_context.h"
+#include "v_connection.h"
+#include "v_commands.h"
+#include "v_layer_commands.h"
+#include "v_history.h"
+
+#include "b_bench.h"
+
+/* Number of packets in the history at once */
+#define HISTORY_BENCH_PACKETS	256
+/* Number of commands in one packet */
+#define HISTORY_BENCH_CMDS		16
+/* Maximal number of measured operations */
+#define HISTORY_BENCH_MAX_OPS	1000000
+
+/**
+ * \brief This function does one round of the benchmark: packets with
+ * commands are added to the history of sent packets, all packets are found
+ * and then they are acknowledged and removed from the history.
+ */
+static void b_history_round(struct vContext *C,
+		uint32 first_id,
+		uint64 *add_ns,
+		uint64 *find_ns,
+		uint64 *rem_ns,
+		uint64 *allocs)
+{
+	struct VDgramConn *dgram_conn = CTX_current_dgram_conn(C);
+	struct VPacket_History *history = &dgram_conn->packet_history;
+	struct Generic_Cmd *cmds[HISTORY_BENCH_PACKETS * HISTORY_BENCH_CMDS];
+	struct VSent_Packet *sent_packet;
+	real32 vec[3] = {1.0f, 2.0f, 3.0f};
+	uint64 start, alloc_start;
+	uint32 i, j;
+
+	for(i = 0; i < HISTORY_BENCH_PACKETS * HISTORY_BENCH_CMDS; i++) {
+		cmds[i] = v_layer_set_value_create(1, 1, i, VRS_VALUE_TYPE_REAL32, 3, vec);
+	}
+
+	alloc_start = b_alloc_total();
+
+	start = b_time_ns();
+	for(i = 0; i < HISTORY_BENCH_PACKETS; i++) {
+		sent_packet = v_packet_history_add_packet(history, first_id + i);
+		for(j = 0; j < HISTORY_BENCH_CMDS; j++) {
+			v_packet_history_add_cmd(history, sent_packet,
+					cmds[i * HISTORY_BENCH_CMDS + j], VRS_DEFAULT_PRIORITY);
+			dgram_conn->sent_size += v_cmd_size(cmds[i * HISTORY_BENCH_CMDS + j]);
+		}
+	}
+	*add_ns += b_time_ns() - start;
+
+	start = b_time_ns();
+	for(i = 0; i < HISTORY_BENCH_PACKETS; i++) {
+		sent_packet = v_packet_history_find_packet(history, first_id + i);
+	}
+	*find_ns += b_time_ns() - start;
+
+	start = b_time_ns();
+	for(i = 0; i < HISTORY_BENCH_PACKETS; i++) {
+		v_packet_history_rem_packet(C, first_id + i);
+	}
+	*rem_ns += b_time_ns() - start;
+
+	*allocs += b_alloc_total() - alloc_start;
+}
+
+/**
+ * \brief This function measures adding, searching and removing of packets
+ * in history of sent packets.
+ */
+void b_history_bench(const struct BenchOptions *opts)
+{
+	struct vContext *C;
+	struct VDgramConn *dgram_conn;
+	uint64 add_ns = 0, find_ns = 0, rem_ns = 0, allocs = 0, ops;
+	uint32 round, rounds;
+
+	rounds = ((opts->max_items < HISTORY_BENCH_MAX_OPS) ?
+			opts->max_items : HISTORY_BENCH_MAX_OPS) / HISTORY_BENCH_PACKETS;
+	if(rounds == 0) {
+		rounds = 1;
+	}
+
+	C = (struct vContext*)calloc(1, sizeof(struct vContext));
+	dgram_conn = (struct VDgramConn*)calloc(1, sizeof(struct VDgramConn));
+	v_packet_history_init(&dgram_conn->packet_history);
+	CTX_current_dgram_conn_set(C, dgram_conn);
+
+	/* Warm up pools and hashed linked list of history */
+	b_history_round(C, 0, &add_ns, &find_ns, &rem_ns, &allocs);
+	add_ns = find_ns = rem_ns = allocs = 0;
+
+	for(round = 0; round < rounds; round++) {
+		b_history_round(C, (round + 1) * HISTORY_BENCH_PACKETS,
+				&add_ns, &find_ns, &rem_ns, &allocs);
+	}
+
+	ops = (uint64)rounds * HISTORY_BENCH_PACKETS;
+
+	b_report("history_add_packet", HISTORY_BENCH_CMDS, ops, add_ns);
+	b_report("history_find_packet", HISTORY_BENCH_PACKETS, ops, find_ns);
+	b_report("history_rem_packet", HISTORY_BENCH_CMDS, ops, rem_ns);
+	b_report_allocs("history_packet", HISTORY_BENCH_CMDS, ops, allocs);
+
+	v_packet_history_destroy(&dgram_conn->packet_history);
+	free(dgram_conn);
+	free(C);
+}
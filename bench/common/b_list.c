@@ -0,0 +1,140 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "verse_types.h"
+#include "v_list.h"
+
+#include "b_bench.h"
+
+/* Number of lookups measured for each size of hashed linked list */
+#define HASH_BENCH_LOOKUPS	1000000
+
+/* Item stored in hashed linked list with the same key as VSNode has */
+typedef struct BenchItem {
+	uint32	id;
+	uint32	value;
+} BenchItem;
+
+/**
+ * \brief Scramble index to unique key (multiplication with odd number is
+ * bijection in 32bit arithmetic)
+ */
+static uint32 b_item_key(uint32 index)
+{
+	return index * 2654435761U;
+}
+
+/**
+ * \brief This function measures adding, finding and removing of items in
+ * hashed linked list with count items.
+ */
+static void b_hash_array_run(uint32 count)
+{
+	struct VHashArrayBase hash_array;
+	struct BenchItem *items, find_item;
+	struct VBucket *vbucket;
+	uint64 start, found = 0;
+	uint32 i, index;
+
+	items = (struct BenchItem*)malloc(count * sizeof(struct BenchItem));
+	if(items == NULL) {
+		printf("Not enough memory for %u items\n", count);
+		return;
+	}
+
+	v_hash_array_init(&hash_array, HASH_MOD_256,
+			offsetof(BenchItem, id), sizeof(uint32));
+
+	/* Adding */
+	start = b_time_ns();
+	for(i = 0; i < count; i++) {
+		items[i].id = b_item_key(i);
+		items[i].value = i;
+		v_hash_array_add_item(&hash_array, &items[i], sizeof(struct BenchItem));
+	}
+	b_report("hash_array_add", count, count, b_time_ns() - start);
+
+	/* Finding of existing items in random order */
+	start = b_time_ns();
+	for(i = 0, index = 0; i < HASH_BENCH_LOOKUPS; i++) {
+		index = (index * 1103515245U + 12345U) % count;
+		find_item.id = b_item_key(index);
+		vbucket = v_hash_array_find_item(&hash_array, &find_item);
+		if(vbucket != NULL) found++;
+	}
+	b_report("hash_array_find_hit", count, HASH_BENCH_LOOKUPS, b_time_ns() - start);
+
+	/* Finding of not existing items */
+	start = b_time_ns();
+	for(i = 0; i < HASH_BENCH_LOOKUPS; i++) {
+		find_item.id = b_item_key(count + i);
+		vbucket = v_hash_array_find_item(&hash_array, &find_item);
+		if(vbucket != NULL) found++;
+	}
+	b_report("hash_array_find_miss", count, HASH_BENCH_LOOKUPS, b_time_ns() - start);
+
+	if(found != HASH_BENCH_LOOKUPS) {
+		printf("Wrong number of found items: %lu\n", (unsigned long)found);
+	}
+
+	/* Removing */
+	start = b_time_ns();
+	for(i = 0; i < count; i++) {
+		v_hash_array_remove_item(&hash_array, &items[i]);
+	}
+	b_report("hash_array_remove", count, count, b_time_ns() - start);
+
+	v_hash_array_destroy(&hash_array);
+
+	free(items);
+}
+
+/**
+ * \brief This function runs benchmark of hashed linked list with growing
+ * number of items.
+ */
+void b_hash_array_bench(const struct BenchOptions *opts)
+{
+	uint32 count;
+
+	for(count = 1000; count <= opts->max_items; count *= 10) {
+		b_hash_array_run(count);
+	}
+}
@@ -0,0 +1,172 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "verse_types.h"
+
+#include "v_list.h"
+#include "v_in_queue.h"
+#include "v_out_queue.h"
+#include "v_history.h"
+
+#include "vs_layer_values.h"
+
+#include "b_bench.h"
+
+/* Number of sessions and layers used for measuring of memory */
+#define BENCH_MEM_SESSIONS		100
+#define BENCH_MEM_LAYERS		1000
+
+/**
+ * Value of vertex layer (three real32 components)
+ */
+typedef struct BenchLayerValue {
+	real32		vec[3];
+} BenchLayerValue;
+
+/**
+ * \brief This function returns number of bytes allocated at heap
+ */
+static uint64 b_heap_used(void)
+{
+#ifdef __GLIBC__
+#if (__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+	struct mallinfo2 mi = mallinfo2();
+#else
+	struct mallinfo mi = mallinfo();
+#endif
+	return (uint64)mi.uordblks + (uint64)mi.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * \brief This function prints result of one memory benchmark
+ */
+static void b_mem_report(const char *name, uint32 items, uint64 bytes)
+{
+	b_report_value(name, items,
+			(items > 0) ? (double)bytes / (double)items : 0.0, "B/item");
+}
+
+/**
+ * \brief This function measures memory used by queues and history of sessions
+ */
+static void b_mem_session(void)
+{
+	struct VInQueue *in_queue[BENCH_MEM_SESSIONS];
+	struct VOutQueue *out_queue[BENCH_MEM_SESSIONS];
+	struct VPacket_History *history;
+	uint64 before, after;
+	int i;
+
+	history = (struct VPacket_History*)calloc(BENCH_MEM_SESSIONS,
+			sizeof(struct VPacket_History));
+
+	before = b_heap_used();
+	for(i = 0; i < BENCH_MEM_SESSIONS; i++) {
+		in_queue[i] = v_in_queue_create();
+		out_queue[i] = v_out_queue_create();
+		v_packet_history_init(&history[i]);
+	}
+	after = b_heap_used();
+
+	b_mem_report("mem_session", BENCH_MEM_SESSIONS, after - before);
+
+	for(i = 0; i < BENCH_MEM_SESSIONS; i++) {
+		v_in_queue_destroy(&in_queue[i]);
+		v_out_queue_destroy(&out_queue[i]);
+		v_packet_history_destroy(&history[i]);
+	}
+
+	free(history);
+}
+
+/**
+ * \brief This function measures memory used by layers with count values
+ */
+static void b_mem_layer(uint32 count)
+{
+	struct VSLayerValues *layers;
+	struct BenchLayerValue value = {{0.0f, 0.0f, 0.0f}};
+	uint64 before, after;
+	char name[32];
+	uint32 i, j;
+
+	layers = (struct VSLayerValues*)calloc(BENCH_MEM_LAYERS,
+			sizeof(struct VSLayerValues));
+
+	before = b_heap_used();
+	for(i = 0; i < BENCH_MEM_LAYERS; i++) {
+		vs_layer_values_init(&layers[i], sizeof(struct BenchLayerValue));
+		for(j = 0; j < count; j++) {
+			vs_layer_values_set(&layers[i], j, &value);
+		}
+	}
+	after = b_heap_used();
+
+	sprintf(name, "mem_layer_%u_values", count);
+	b_mem_report(name, BENCH_MEM_LAYERS, after - before);
+
+	for(i = 0; i < BENCH_MEM_LAYERS; i++) {
+		vs_layer_values_destroy(&layers[i]);
+	}
+
+	free(layers);
+}
+
+/**
+ * \brief This function measures memory used by sessions and layers. The size
+ * of structures allocated by caller is not included.
+ */
+void b_mem_bench(const struct BenchOptions *opts)
+{
+	(void)opts;
+
+	b_mem_session();
+	b_mem_layer(0);
+	b_mem_layer(1);
+	b_mem_layer(16);
+	b_mem_layer(1000);
+}
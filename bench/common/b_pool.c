@@ -0,0 +1,145 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "verse.h"
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_context.h"
+#include "v_connection.h"
+#include "v_commands.h"
+#include "v_layer_commands.h"
+#include "v_in_queue.h"
+#include "v_out_queue.h"
+#include "v_history.h"
+
+#include "b_bench.h"
+
+/* Number of iterations used for warming up of pools and hashed arrays */
+#define POOL_BENCH_WARMUP		1000
+/* Maximal number of measured iterations */
+#define POOL_BENCH_MAX_OPS		1000000
+/* Number of different items set in the layer */
+#define POOL_BENCH_ITEMS		1024
+
+/**
+ * \brief This function does one iteration of layer set path: the command is
+ * received by server, it is pushed to and popped from incoming queue, new
+ * command is sent to the subscriber through outgoing queue and history of
+ * sent packets and the packet is finally acknowledged.
+ */
+static void b_pool_layer_set(struct vContext *C,
+		struct VInQueue *in_queue,
+		struct VOutQueue *out_queue,
+		uint32 packet_id,
+		uint32 item_id)
+{
+	struct VDgramConn *dgram_conn = CTX_current_dgram_conn(C);
+	struct VPacket_History *history = &dgram_conn->packet_history;
+	struct VSent_Packet *sent_packet;
+	struct Generic_Cmd *cmd;
+	real32 vec[3] = {1.0f, 2.0f, 3.0f};
+	uint16 count, len = DEFAULT_MTU;
+	int8 share;
+
+	/* Received command */
+	cmd = v_layer_set_value_create(1, 1, item_id, VRS_VALUE_TYPE_REAL32, 3, vec);
+	v_in_queue_push(in_queue, cmd);
+	cmd = v_in_queue_pop(in_queue);
+	v_cmd_destroy(&cmd);
+
+	/* Command sent to subscriber */
+	cmd = v_layer_set_value_create(1, 1, item_id, VRS_VALUE_TYPE_REAL32, 3, vec);
+	v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, cmd);
+	cmd = v_out_queue_pop(out_queue, VRS_DEFAULT_PRIORITY, &count, &share, &len);
+
+	sent_packet = v_packet_history_add_packet(history, packet_id);
+	v_packet_history_add_cmd(history, sent_packet, cmd, VRS_DEFAULT_PRIORITY);
+	dgram_conn->sent_size += v_cmd_size(cmd);
+
+	/* Packet was acknowledged */
+	v_packet_history_rem_packet(C, packet_id);
+}
+
+/**
+ * \brief This function measures time and number of heap allocations of
+ * steady state layer set path.
+ */
+void b_pool_bench(const struct BenchOptions *opts)
+{
+	struct vContext *C;
+	struct VDgramConn *dgram_conn;
+	struct VInQueue *in_queue;
+	struct VOutQueue *out_queue;
+	uint64 start, end, allocs;
+	uint32 i, ops;
+
+	ops = (opts->max_items < POOL_BENCH_MAX_OPS) ?
+			opts->max_items : POOL_BENCH_MAX_OPS;
+
+	C = (struct vContext*)calloc(1, sizeof(struct vContext));
+	dgram_conn = (struct VDgramConn*)calloc(1, sizeof(struct VDgramConn));
+	v_packet_history_init(&dgram_conn->packet_history);
+	CTX_current_dgram_conn_set(C, dgram_conn);
+
+	in_queue = v_in_queue_create();
+	out_queue = v_out_queue_create();
+
+	for(i = 0; i < POOL_BENCH_WARMUP; i++) {
+		b_pool_layer_set(C, in_queue, out_queue, i, i % POOL_BENCH_ITEMS);
+	}
+
+	allocs = b_alloc_count();
+	start = b_time_ns();
+	for(i = 0; i < ops; i++) {
+		b_pool_layer_set(C, in_queue, out_queue, POOL_BENCH_WARMUP + i,
+				i % POOL_BENCH_ITEMS);
+	}
+	end = b_time_ns();
+	allocs = b_alloc_count() - allocs;
+
+	b_report("pool_layer_set_path", POOL_BENCH_ITEMS, ops, end - start);
+	b_report_allocs("pool_layer_set_path", POOL_BENCH_ITEMS, ops, allocs);
+
+	v_in_queue_destroy(&in_queue);
+	v_out_queue_destroy(&out_queue);
+	v_packet_history_destroy(&dgram_conn->packet_history);
+	free(dgram_conn);
+	free(C);
+}
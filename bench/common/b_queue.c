@@ -0,0 +1,214 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "verse.h"
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_commands.h"
+#include "v_layer_commands.h"
+#include "v_node_commands.h"
+#include "v_in_queue.h"
+#include "v_out_queue.h"
+
+#include "b_bench.h"
+
+/* Number of commands pushed to the queue at once */
+#define QUEUE_BENCH_CMDS		1000
+/* Maximal number of measured operations */
+#define QUEUE_BENCH_MAX_OPS		1000000
+
+/**
+ * \brief This function creates layer_set_value commands with different items
+ */
+static void b_queue_cmds_create(struct Generic_Cmd **cmds)
+{
+	real32 vec[3] = {1.0f, 2.0f, 3.0f};
+	uint32 i;
+
+	for(i = 0; i < QUEUE_BENCH_CMDS; i++) {
+		cmds[i] = v_layer_set_value_create(1, 1, i, VRS_VALUE_TYPE_REAL32, 3, vec);
+	}
+}
+
+/**
+ * \brief This function creates node_subscribe commands with different
+ * addresses. These commands replace older commands with the same address.
+ */
+static void b_queue_unique_cmds_create(struct Generic_Cmd **cmds)
+{
+	uint32 i;
+
+	for(i = 0; i < QUEUE_BENCH_CMDS; i++) {
+		cmds[i] = v_node_subscribe_create(i, 1, 0);
+	}
+}
+
+/**
+ * \brief This function destroys commands popped from the queue
+ */
+static void b_queue_cmds_destroy(struct Generic_Cmd **cmds)
+{
+	uint32 i;
+
+	for(i = 0; i < QUEUE_BENCH_CMDS; i++) {
+		if(cmds[i] != NULL) {
+			v_cmd_destroy(&cmds[i]);
+		}
+	}
+}
+
+/**
+ * \brief This function measures pushing commands to the tail of outgoing
+ * queue and popping them from the queue
+ */
+static void b_out_queue_run(uint32 rounds, uint8 report)
+{
+	struct VOutQueue *out_queue = v_out_queue_create();
+	struct Generic_Cmd *cmds[QUEUE_BENCH_CMDS];
+	uint64 push_ns = 0, pop_ns = 0, push_allocs = 0, pop_allocs = 0, start, allocs;
+	uint16 count, len;
+	int8 share;
+	uint32 round, i;
+
+	for(round = 0; round < rounds; round++) {
+		b_queue_cmds_create(cmds);
+
+		allocs = b_alloc_total();
+		start = b_time_ns();
+		for(i = 0; i < QUEUE_BENCH_CMDS; i++) {
+			v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, cmds[i]);
+		}
+		push_ns += b_time_ns() - start;
+		push_allocs += b_alloc_total() - allocs;
+
+		allocs = b_alloc_total();
+		start = b_time_ns();
+		for(i = 0; i < QUEUE_BENCH_CMDS; i++) {
+			len = DEFAULT_MTU;
+			cmds[i] = v_out_queue_pop(out_queue, VRS_DEFAULT_PRIORITY, &count, &share, &len);
+		}
+		pop_ns += b_time_ns() - start;
+		pop_allocs += b_alloc_total() - allocs;
+
+		b_queue_cmds_destroy(cmds);
+	}
+
+	if(report == 1) {
+		b_report("out_queue_push_tail", QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, push_ns);
+		b_report_allocs("out_queue_push_tail", QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, push_allocs);
+		b_report("out_queue_pop", QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, pop_ns);
+		b_report_allocs("out_queue_pop", QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, pop_allocs);
+	}
+
+	v_out_queue_destroy(&out_queue);
+}
+
+/**
+ * \brief This function measures pushing commands to incoming queue and
+ * popping them from the queue
+ */
+static void b_in_queue_run(uint32 rounds,
+		const char *push_name,
+		const char *pop_name,
+		void (*cmds_create)(struct Generic_Cmd **cmds),
+		uint8 report)
+{
+	struct VInQueue *in_queue = v_in_queue_create();
+	struct Generic_Cmd *cmds[QUEUE_BENCH_CMDS];
+	uint64 push_ns = 0, pop_ns = 0, push_allocs = 0, pop_allocs = 0, start, allocs;
+	uint32 round, i;
+
+	for(round = 0; round < rounds; round++) {
+		cmds_create(cmds);
+
+		allocs = b_alloc_total();
+		start = b_time_ns();
+		for(i = 0; i < QUEUE_BENCH_CMDS; i++) {
+			v_in_queue_push(in_queue, cmds[i]);
+		}
+		push_ns += b_time_ns() - start;
+		push_allocs += b_alloc_total() - allocs;
+
+		allocs = b_alloc_total();
+		start = b_time_ns();
+		for(i = 0; i < QUEUE_BENCH_CMDS; i++) {
+			cmds[i] = v_in_queue_pop(in_queue);
+		}
+		pop_ns += b_time_ns() - start;
+		pop_allocs += b_alloc_total() - allocs;
+
+		b_queue_cmds_destroy(cmds);
+	}
+
+	if(report == 1) {
+		b_report(push_name, QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, push_ns);
+		b_report_allocs(push_name, QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, push_allocs);
+		b_report(pop_name, QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, pop_ns);
+		b_report_allocs(pop_name, QUEUE_BENCH_CMDS, (uint64)rounds * QUEUE_BENCH_CMDS, pop_allocs);
+	}
+
+	v_in_queue_destroy(&in_queue);
+}
+
+/**
+ * \brief This function measures operations of outgoing and incoming queues
+ */
+void b_queue_bench(const struct BenchOptions *opts)
+{
+	uint32 rounds;
+
+	rounds = ((opts->max_items < QUEUE_BENCH_MAX_OPS) ?
+			opts->max_items : QUEUE_BENCH_MAX_OPS) / QUEUE_BENCH_CMDS;
+	if(rounds == 0) {
+		rounds = 1;
+	}
+
+	/* Warm up pools and hashed arrays of queues */
+	b_out_queue_run(1, 0);
+	b_in_queue_run(1, NULL, NULL, b_queue_cmds_create, 0);
+	b_in_queue_run(1, NULL, NULL, b_queue_unique_cmds_create, 0);
+
+	b_out_queue_run(rounds, 1);
+	b_in_queue_run(rounds, "in_queue_push", "in_queue_pop",
+			b_queue_cmds_create, 1);
+	b_in_queue_run(rounds, "in_queue_push_unique", "in_queue_pop_unique",
+			b_queue_unique_cmds_create, 1);
+}
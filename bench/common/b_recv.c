@@ -0,0 +1,136 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "verse.h"
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_commands.h"
+#include "v_in_queue.h"
+#include "v_layer_commands.h"
+#include "v_pool.h"
+
+#include "b_bench.h"
+
+/* Number of layer values received in one packet (length of compressed
+ * command has to fit into one byte) */
+#define RECV_BENCH_CMDS		15
+/* Number of received packets */
+#define RECV_BENCH_PACKETS	10000
+
+/**
+ * \brief This function packs layer_set_value commands with shared address to
+ * the buffer, as they would be received in one packet
+ * \return This function returns size of packed commands.
+ */
+static uint16 b_recv_packet(char *buffer)
+{
+	struct Generic_Cmd *cmd;
+	real32 vec[3] = {1.0f, 2.0f, 3.0f};
+	uint16 buffer_pos = 0, length;
+	uint8 share = UINT32_SIZE + UINT16_SIZE;
+	int i;
+
+	for(i = 0; i < RECV_BENCH_CMDS; i++) {
+		cmd = v_layer_set_value_create(1, 1, i, VRS_VALUE_TYPE_REAL32, 3, vec);
+		if(i == 0) {
+			length = 3 + share + RECV_BENCH_CMDS*(v_cmd_struct_size(cmd) - 1 - share);
+			buffer_pos += v_cmd_pack(&buffer[buffer_pos], cmd, length, share);
+		} else {
+			buffer_pos += v_cmd_pack(&buffer[buffer_pos], cmd, 0, share);
+		}
+		v_cmd_destroy(&cmd);
+	}
+
+	return buffer_pos;
+}
+
+/**
+ * \brief This function unpacks received packets to the incoming queue and it
+ * pops all commands, as the data thread would do.
+ */
+static void b_recv_run(const char *buffer, uint16 size, uint8 views, const char *name)
+{
+	struct VInQueue *in_queue = v_in_queue_create();
+	struct Generic_Cmd *cmd;
+	union VInQueueCmdBuf cmd_buf;
+	uint64 start, end, allocs, mallocs;
+	uint32 i;
+
+	if(views == 1) {
+		in_queue->flags |= IN_QUEUE_CMD_VIEWS;
+	}
+
+	start = b_time_ns();
+	allocs = v_pool_thread_alloc_count();
+	mallocs = b_alloc_count();
+	for(i = 0; i < RECV_BENCH_PACKETS; i++) {
+		v_cmd_unpack(buffer, size, in_queue);
+		while( (cmd = v_in_queue_pop_buf(in_queue, &cmd_buf)) != NULL ) {
+			if(cmd != &cmd_buf.cmd) {
+				v_cmd_destroy(&cmd);
+			}
+		}
+	}
+	end = b_time_ns();
+	allocs = v_pool_thread_alloc_count() - allocs + b_alloc_count() - mallocs;
+
+	b_report(name, RECV_BENCH_CMDS, (uint64)RECV_BENCH_PACKETS * RECV_BENCH_CMDS, end - start);
+	b_report_allocs(name, RECV_BENCH_CMDS, (uint64)RECV_BENCH_PACKETS * RECV_BENCH_CMDS, allocs);
+
+	v_in_queue_destroy(&in_queue);
+}
+
+/**
+ * \brief This function measures unpacking of received node commands to
+ * allocated commands and to views of received buffer.
+ */
+void b_recv_bench(const struct BenchOptions *opts)
+{
+	char buffer[DEFAULT_MTU];
+	uint16 size;
+
+	(void)opts;
+
+	size = b_recv_packet(buffer);
+
+	b_recv_run(buffer, size, 0, "recv_unpack_copy");
+	b_recv_run(buffer, size, 1, "recv_unpack_views");
+}
@@ -0,0 +1,212 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "verse.h"
+#include "verse_types.h"
+
+#include "v_network.h"
+#include "v_context.h"
+#include "v_connection.h"
+#include "v_session.h"
+#include "v_commands.h"
+#include "v_layer_commands.h"
+#include "v_in_queue.h"
+#include "v_out_queue.h"
+#include "v_history.h"
+#include "v_resend_mechanism.h"
+
+#include "b_bench.h"
+
+/* Number of commands pushed to outgoing queue before sending */
+#define SEND_BENCH_CMDS			1000
+/* Maximal number of sent commands */
+#define SEND_BENCH_MAX_OPS		1000000
+/* Number of sparse priorities used by commands in the second run */
+#define SEND_BENCH_PRIOS		8
+
+/**
+ * \brief This function sends all commands from outgoing queue in packets
+ * stored in memory and returns number of sent packets.
+ */
+static uint32 b_send_queue(struct vContext *C,
+		uint64 *send_ns,
+		uint64 *allocs)
+{
+	struct VSession *vsession = CTX_current_session(C);
+	struct VDgramConn *vconn = CTX_current_dgram_conn(C);
+	uint64 start, alloc_start;
+	uint32 first_id = vconn->host_id + vconn->count_s_pay;
+	uint32 i, count;
+
+	alloc_start = b_alloc_total();
+	start = b_time_ns();
+	while(v_out_queue_get_count(vsession->out_queue) > 0) {
+		if(send_packet_in_OPEN_CLOSEREQ_state(C) == SEND_PACKET_ERROR) {
+			break;
+		}
+	}
+	*send_ns += b_time_ns() - start;
+	*allocs += b_alloc_total() - alloc_start;
+
+	/* Acknowledge all sent packets */
+	count = vconn->host_id + vconn->count_s_pay - first_id;
+	for(i = 0; i < count; i++) {
+		v_packet_history_rem_packet(C, first_id + i);
+	}
+
+	return count;
+}
+
+/**
+ * \brief This function pushes commands to the outgoing queue. When prio_count
+ * is bigger then one, then commands are spread over sparse priorities
+ * covering whole range of priorities.
+ */
+static void b_send_push_cmds(struct VSession *vsession, uint32 prio_count)
+{
+	real32 vec[3] = {1.0f, 2.0f, 3.0f};
+	uint32 i;
+	uint8 prio;
+
+	for(i = 0; i < SEND_BENCH_CMDS; i++) {
+		if(prio_count > 1) {
+			prio = (uint8)((i % prio_count) * ((MAX_PRIORITY + 1) / prio_count));
+		} else {
+			prio = VRS_DEFAULT_PRIORITY;
+		}
+		v_out_queue_push_tail(vsession->out_queue, prio,
+				v_layer_set_value_create(1, 1, i, VRS_VALUE_TYPE_REAL32, 3, vec));
+	}
+}
+
+/**
+ * \brief This function sends rounds of commands with prio_count priorities
+ * and reports results with the name prefix
+ */
+static void b_send_run(struct vContext *C,
+		uint32 rounds,
+		uint32 prio_count,
+		const char *name)
+{
+	struct VSession *vsession = CTX_current_session(C);
+	uint64 send_ns = 0, allocs = 0, packets = 0, cmds;
+	char report_name[64];
+	uint32 round;
+
+	/* Warm up pools, queues and history of sent packets */
+	b_send_push_cmds(vsession, prio_count);
+	b_send_queue(C, &send_ns, &allocs);
+	send_ns = allocs = 0;
+
+	for(round = 0; round < rounds; round++) {
+		b_send_push_cmds(vsession, prio_count);
+		packets += b_send_queue(C, &send_ns, &allocs);
+	}
+
+	cmds = (uint64)rounds * SEND_BENCH_CMDS;
+
+	snprintf(report_name, sizeof(report_name), "%s_per_packet", name);
+	b_report(report_name, SEND_BENCH_CMDS, packets, send_ns);
+	b_report_allocs(report_name, SEND_BENCH_CMDS, packets, allocs);
+	snprintf(report_name, sizeof(report_name), "%s_per_cmd", name);
+	b_report(report_name, SEND_BENCH_CMDS, cmds, send_ns);
+	snprintf(report_name, sizeof(report_name), "%s_cmds_per_packet", name);
+	b_report_value(report_name, SEND_BENCH_CMDS,
+			(packets > 0) ? (double)cmds / (double)packets : 0.0, "cmd/packet");
+}
+
+/**
+ * \brief This function measures sending of packets with commands from
+ * outgoing queue. Packets are not sent to the network, but they are only
+ * stored in the buffer of IO_CTX.
+ */
+void b_send_bench(const struct BenchOptions *opts)
+{
+	struct vContext *C;
+	struct VSession *vsession;
+	struct VDgramConn *vconn;
+	struct VPacket *s_packet, *r_packet;
+	uint32 rounds;
+
+	rounds = ((opts->max_items < SEND_BENCH_MAX_OPS) ?
+			opts->max_items : SEND_BENCH_MAX_OPS) / SEND_BENCH_CMDS;
+	if(rounds == 0) {
+		rounds = 1;
+	}
+
+	C = (struct vContext*)calloc(1, sizeof(struct vContext));
+	vsession = (struct VSession*)calloc(1, sizeof(struct VSession));
+	vconn = (struct VDgramConn*)calloc(1, sizeof(struct VDgramConn));
+	s_packet = (struct VPacket*)calloc(1, sizeof(struct VPacket));
+	r_packet = (struct VPacket*)calloc(1, sizeof(struct VPacket));
+
+	v_init_session(vsession);
+	vsession->in_queue = v_in_queue_create();
+	vsession->out_queue = v_out_queue_create();
+
+	v_conn_dgram_init(vconn);
+	vconn->host_state = UDP_SERVER_STATE_OPEN;
+	vconn->fc_meth = FC_NONE;
+	vconn->cc_meth = CC_NONE;
+	vconn->host_cmd_cmpr = CMPR_ADDR_SHARE;
+	vconn->peer_cmd_cmpr = CMPR_ADDR_SHARE;
+	vconn->io_ctx.mtu = DEFAULT_MTU;
+	vconn->io_ctx.flags = SOCKET_MEMORY;
+	vconn->io_ctx.sockfd = -1;
+	vsession->dgram_conn = vconn;
+
+	CTX_current_session_set(C, vsession);
+	CTX_current_dgram_conn_set(C, vconn);
+	CTX_io_ctx_set(C, &vconn->io_ctx);
+	CTX_s_packet_set(C, s_packet);
+	CTX_r_packet_set(C, r_packet);
+
+	b_send_run(C, rounds, 1, "send_packet");
+	b_send_run(C, rounds, SEND_BENCH_PRIOS, "send_packet_prios");
+
+	v_in_queue_destroy(&vsession->in_queue);
+	v_out_queue_destroy(&vsession->out_queue);
+	v_conn_dgram_destroy(vconn);
+	free(vconn);
+	free(vsession);
+	free(s_packet);
+	free(r_packet);
+	free(C);
+}
@@ -0,0 +1,77 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#ifndef B_BENCH_H_
+#define B_BENCH_H_
+
+#include "verse_types.h"
+
+/* Default maximal number of items used by benchmarks */
+#define BENCH_DEFAULT_MAX_ITEMS		10000000
+
+/* Formats of printed results */
+#define BENCH_FORMAT_TEXT			0
+#define BENCH_FORMAT_CSV			1
+
+/**
+ * Options shared by all benchmarks
+ */
+typedef struct BenchOptions {
+	uint32		max_items;		/* Maximal number of items used by benchmark */
+} BenchOptions;
+
+uint64 b_time_ns(void);
+void b_report(const char *name, uint32 items, uint64 ops, uint64 time_ns);
+void b_report_allocs(const char *name, uint32 items, uint64 ops, uint64 allocs);
+void b_report_value(const char *name, uint32 items, double value, const char *unit);
+uint64 b_alloc_count(void);
+uint64 b_alloc_total(void);
+
+void b_hash_array_bench(const struct BenchOptions *opts);
+void b_mem_bench(const struct BenchOptions *opts);
+void b_layer_bench(const struct BenchOptions *opts);
+void b_pool_bench(const struct BenchOptions *opts);
+void b_fanout_bench(const struct BenchOptions *opts);
+void b_codec_bench(const struct BenchOptions *opts);
+void b_recv_bench(const struct BenchOptions *opts);
+void b_queue_bench(const struct BenchOptions *opts);
+void b_history_bench(const struct BenchOptions *opts);
+void b_send_bench(const struct BenchOptions *opts);
+void b_dgram_bench(const struct BenchOptions *opts);
+void b_ack_nak_bench(const struct BenchOptions *opts);
+void b_cc_bench(const struct BenchOptions *opts);
+
+#endif /* B_BENCH_H_ */
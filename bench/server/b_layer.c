@@ -0,0 +1,174 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "verse_types.h"
+#include "v_list.h"
+
+#include "vs_layer_values.h"
+
+#include "b_bench.h"
+
+/* Maximal number of values in one benchmarked layer */
+#define LAYER_BENCH_MAX_VALUES	1000000
+
+/* Value of vertex layer (three real32 components) */
+typedef struct BenchVertex {
+	real32	vec[3];
+} BenchVertex;
+
+/* Value stored in hashed linked list like in older versions of server */
+typedef struct BenchHashValue {
+	uint32	id;
+	void	*value;
+} BenchHashValue;
+
+/**
+ * \brief This function measures layer with values stored in hashed linked
+ * list (one allocation of item and one allocation of value per item)
+ */
+static void b_layer_hash_run(uint32 count)
+{
+	struct VHashArrayBase values;
+	struct BenchHashValue *item, find_item;
+	struct BenchVertex vertex = {{1.0f, 2.0f, 3.0f}};
+	struct VBucket *vbucket;
+	uint64 start, sum = 0;
+	uint32 i;
+
+	v_hash_array_init(&values, HASH_MOD_65536,
+			offsetof(BenchHashValue, id), sizeof(uint32));
+
+	start = b_time_ns();
+	for(i = 0; i < count; i++) {
+		item = (struct BenchHashValue*)calloc(1, sizeof(struct BenchHashValue));
+		item->id = i;
+		item->value = calloc(1, sizeof(struct BenchVertex));
+		memcpy(item->value, &vertex, sizeof(struct BenchVertex));
+		v_hash_array_add_item(&values, item, sizeof(struct BenchHashValue));
+	}
+	b_report("layer_hash_set_new", count, count, b_time_ns() - start);
+
+	start = b_time_ns();
+	for(i = 0; i < count; i++) {
+		find_item.id = i;
+		vbucket = v_hash_array_find_item(&values, &find_item);
+		memcpy(((struct BenchHashValue*)vbucket->data)->value, &vertex, sizeof(struct BenchVertex));
+	}
+	b_report("layer_hash_set_update", count, count, b_time_ns() - start);
+
+	start = b_time_ns();
+	for(vbucket = values.lb.first; vbucket != NULL; vbucket = vbucket->next) {
+		sum += ((struct BenchHashValue*)vbucket->data)->id;
+	}
+	b_report("layer_hash_scan", count, count, b_time_ns() - start);
+
+	vbucket = values.lb.first;
+	while(vbucket != NULL) {
+		item = (struct BenchHashValue*)vbucket->data;
+		vbucket = vbucket->next;
+		v_hash_array_remove_item(&values, item);
+		free(item->value);
+		free(item);
+	}
+	v_hash_array_destroy(&values);
+
+	if(sum == 0 && count > 1) printf("Wrong sum\n");
+}
+
+/**
+ * \brief This function measures layer with values stored in columnar
+ * storage. Item IDs are contiguous (dense mode) or scrambled (sparse mode).
+ */
+static void b_layer_values_run(uint32 count, uint32 mul, const char *prefix)
+{
+	struct VSLayerValues values;
+	struct BenchVertex vertex = {{1.0f, 2.0f, 3.0f}};
+	uint64 start, sum = 0;
+	uint32 i, slot, item_id;
+	void *value;
+	char name[32];
+
+	vs_layer_values_init(&values, sizeof(struct BenchVertex));
+
+	start = b_time_ns();
+	for(i = 0; i < count; i++) {
+		vs_layer_values_set(&values, i * mul, &vertex);
+	}
+	sprintf(name, "%s_set_new", prefix);
+	b_report(name, count, count, b_time_ns() - start);
+
+	start = b_time_ns();
+	for(i = 0; i < count; i++) {
+		vs_layer_values_set(&values, i * mul, &vertex);
+	}
+	sprintf(name, "%s_set_update", prefix);
+	b_report(name, count, count, b_time_ns() - start);
+
+	start = b_time_ns();
+	slot = 0;
+	while(vs_layer_values_next(&values, &slot, &item_id, &value) == 1) {
+		sum += item_id;
+	}
+	sprintf(name, "%s_scan", prefix);
+	b_report(name, count, count, b_time_ns() - start);
+
+	vs_layer_values_destroy(&values);
+
+	if(sum == 0 && count > 1) printf("Wrong sum\n");
+}
+
+/**
+ * \brief This function measures setting and scanning of layer values
+ */
+void b_layer_bench(const struct BenchOptions *opts)
+{
+	uint32 count, max_count;
+
+	max_count = (opts->max_items < LAYER_BENCH_MAX_VALUES) ?
+			opts->max_items : LAYER_BENCH_MAX_VALUES;
+
+	for(count = 1000; count <= max_count; count *= 10) {
+		b_layer_hash_run(count);
+		b_layer_values_run(count, 1, "layer_dense");
+		b_layer_values_run(count, 2654435761U, "layer_sparse");
+	}
+}
@@ -0,0 +1,72 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#ifndef V_ATOMIC_H_
+#define V_ATOMIC_H_
+
+/* Atomic operations shared by reference counting of commands and
+ * lock-free lists */
+
+#ifdef WIN32
+#include <windows.h>
+
+#define V_ATOMIC_INC(ptr)	InterlockedIncrement((volatile LONG*)(ptr))
+#define V_ATOMIC_DEC(ptr)	InterlockedDecrement((volatile LONG*)(ptr))
+#define V_ATOMIC_ADD(ptr, val)	(InterlockedExchangeAdd((volatile LONG*)(ptr), (val)) + (val))
+#define V_ATOMIC_SUB(ptr, val)	(InterlockedExchangeAdd((volatile LONG*)(ptr), -(LONG)(val)) - (val))
+#define V_ATOMIC_XCHG_PTR(ptr, new_val) \
+	InterlockedExchangePointer((PVOID volatile*)(ptr), (new_val))
+#define V_ATOMIC_CAS(ptr, old_val, new_val) \
+	(InterlockedCompareExchange((volatile LONG*)(ptr), (new_val), (old_val)) == (old_val))
+#define V_ATOMIC_CAS_PTR(ptr, old_val, new_val) \
+	(InterlockedCompareExchangePointer((PVOID volatile*)(ptr), (new_val), (old_val)) == (old_val))
+#define V_BARRIER()			MemoryBarrier()
+#else
+#define V_ATOMIC_INC(ptr)	__sync_add_and_fetch((ptr), 1)
+#define V_ATOMIC_DEC(ptr)	__sync_sub_and_fetch((ptr), 1)
+#define V_ATOMIC_ADD(ptr, val)	__sync_add_and_fetch((ptr), (val))
+#define V_ATOMIC_SUB(ptr, val)	__sync_sub_and_fetch((ptr), (val))
+#define V_ATOMIC_XCHG_PTR(ptr, new_val) \
+	__atomic_exchange_n((ptr), (new_val), __ATOMIC_SEQ_CST)
+#define V_ATOMIC_CAS(ptr, old_val, new_val) \
+	__sync_bool_compare_and_swap((ptr), (old_val), (new_val))
+#define V_ATOMIC_CAS_PTR(ptr, old_val, new_val) \
+	__sync_bool_compare_and_swap((ptr), (old_val), (new_val))
+#define V_BARRIER()			__sync_synchronize()
+#endif
+
+#endif /* V_ATOMIC_H_ */
@@ -0,0 +1,67 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#ifndef V_CMD_CODEC_H_
+#define V_CMD_CODEC_H_
+
+#include "verse_types.h"
+#include "v_commands.h"
+
+/* Specialized function packing items of one command. Items of shared address
+ * are skipped. It returns size of packed items or -1 for unsupported share. */
+typedef int (*VCmdPackFunc)(char *buffer,
+		const struct Generic_Cmd *cmd,
+		const uint8 skip_items);
+
+/* Specialized function unpacking items of one command. Items of shared
+ * address are skipped. It returns size of unpacked items or -1 for
+ * unsupported share. */
+typedef int (*VCmdUnpackFunc)(const char *buffer,
+		struct Generic_Cmd *cmd,
+		const uint8 skip_items);
+
+/* Following functions are generated by verse_cmd_codegen during build. They
+ * return -1, when no specialized function exists for the command. */
+int v_cmd_codec_pack(char *buffer,
+		const struct Generic_Cmd *cmd,
+		const uint8 skip_items);
+uint8 v_cmd_codec_supported(const uint8 id);
+int v_cmd_codec_unpack(const char *buffer,
+		struct Generic_Cmd *cmd,
+		const uint8 skip_items);
+
+#endif /* V_CMD_CODEC_H_ */
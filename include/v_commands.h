@@ -283,6 +283,8 @@ uint16 v_cmd_pack_len(char *buffer, const uint16 length);
 
 void v_cmd_print(const unsigned char level,
 		const struct Generic_Cmd *cmd);
+struct Generic_Cmd *v_cmd_alloc(const uint8 id);
+struct Generic_Cmd *v_cmd_ref(struct Generic_Cmd *cmd);
 void v_cmd_destroy(struct Generic_Cmd **cmd);
 int v_cmd_struct_size(const struct Generic_Cmd *cmd);
 int v_cmd_size(const struct Generic_Cmd *cmd);
@@ -290,6 +292,13 @@ int v_cmd_pack(char *buffer,
 		const struct Generic_Cmd *cmd,
 		const uint16 length,
 		const uint8 type);
+int v_cmd_pack_items(char *buffer,
+		const struct Generic_Cmd *cmd,
+		const uint8 skip_items);
+int v_cmd_unpack_items(const char *buffer,
+		const uint16 buffer_len,
+		struct Generic_Cmd *cmd,
+		const uint8 skip_items);
 int v_cmd_unpack(const char *buffer,
 		unsigned short buffer_len,
 		struct VInQueue *v_in_queue);
@@ -297,8 +306,7 @@ int v_cmd_unpack(const char *buffer,
 uint8 v_cmd_cmp_addr(struct Generic_Cmd *cmd1,
 		struct Generic_Cmd *cmd2,
 		const uint8 current_size);
-uint16 v_cmd_count(struct Generic_Cmd *cmd,
-		uint16 max_len,
+uint16 v_cmd_item_len(const struct Generic_Cmd *cmd,
 		uint8 share);
 uint16 v_cmds_len(struct Generic_Cmd *cmd,
 		uint16 count,
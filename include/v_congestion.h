@@ -0,0 +1,181 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2010, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#if !defined V_CONGESTION_H
+#define V_CONGESTION_H
+
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+#include "verse_types.h"
+
+struct VDgramConn;
+struct VSent_Packet;
+
+#define CC_INIT_CWIN_PACKETS	10			/* Initial congestion window in packets (RFC 6928) */
+#define CC_MIN_CWIN_PACKETS		2			/* Minimal congestion window after loss in packets */
+#define CC_PACING_BURST_PACKETS	2			/* Count of packets, that pacer sends back to back */
+
+/* Constants of CUBIC (RFC 8312) */
+#define CUBIC_C					0.4			/* Scaling constant of cubic function */
+#define CUBIC_BETA				0.7			/* Multiplicative decrease factor */
+
+/* Constants of BBR */
+#define BBR_BW_FILTER_LEN		10			/* Count of rounds in max filter of delivery rate */
+#define BBR_MIN_RTT_WIN			10000000	/* Window of min filter of RTT [us] */
+#define BBR_PROBE_RTT_TIME		200000		/* Time spent in PROBE_RTT mode [us] */
+#define BBR_MIN_CWIN_PACKETS	4			/* Congestion window in PROBE_RTT mode in packets */
+#define BBR_HIGH_GAIN			2.885		/* Gain of STARTUP mode (2/ln(2)) */
+#define BBR_CYCLE_LEN			8			/* Count of phases in gain cycle of PROBE_BW mode */
+#define BBR_FULL_BW_COUNT		3			/* Count of rounds without growth of delivery rate */
+#define BBR_LOSS_THRESH			50			/* Loss of 1/50 (2 %) packets in round is caused by congestion */
+#define BBR_BETA				0.7			/* Decrease of upper bound of inflight data after high loss */
+
+/* Modes of BBR */
+#define BBR_STARTUP				1
+#define BBR_DRAIN				2
+#define BBR_PROBE_BW			3
+#define BBR_PROBE_RTT			4
+
+/**
+ * State of CUBIC congestion control
+ */
+typedef struct VCubic {
+	real64					w_max;			/* Window before the last reduction [packets] */
+	real64					w_est;			/* Estimated window of Reno in TCP-friendly region [packets] */
+	real64					k;				/* Time needed to reach w_max [s] */
+	struct timeval			epoch;			/* The start of current congestion avoidance epoch */
+	uint8					epoch_started;	/* The epoch was started */
+} VCubic;
+
+/**
+ * State of BBR congestion control. The model of path is bottleneck
+ * bandwidth (max filter of delivery rate) and round trip propagation time
+ * (min filter of RTT).
+ */
+typedef struct VBbr {
+	uint32					bw[BBR_BW_FILTER_LEN];	/* Max delivery rate of last rounds [B/s] */
+	uint32					btl_bw;			/* Estimated bottleneck bandwidth [B/s] */
+	uint32					min_rtt;		/* Estimated round trip propagation time [us] */
+	struct timeval			min_rtt_tv;		/* Time, when min_rtt was measured */
+	uint8					min_rtt_expired;	/* The min_rtt was not measured in BBR_MIN_RTT_WIN */
+	uint32					round;			/* Count of round trips */
+	uint32					next_round_delivered;	/* Delivered data, that finish current round */
+	uint32					round_delivered;	/* Delivered data at the start of current round */
+	uint32					round_lost;		/* Lost data at the start of current round */
+	uint32					inflight_hi;	/* Upper bound of inflight data set after high loss */
+	uint32					full_bw;		/* Delivery rate, that was not exceeded by 25 % */
+	uint8					full_bw_count;	/* Count of rounds without growth of delivery rate */
+	uint8					filled_pipe;	/* Bottleneck bandwidth was reached */
+	uint8					mode;			/* BBR_STARTUP, BBR_DRAIN, BBR_PROBE_BW or BBR_PROBE_RTT */
+	uint8					cycle_index;	/* Current phase of gain cycle */
+	struct timeval			cycle_tv;		/* The start of current phase */
+	struct timeval			probe_rtt_done_tv;	/* The end of PROBE_RTT mode */
+	uint8					probe_rtt_started;	/* Inflight data was drained in PROBE_RTT mode */
+	real64					pacing_gain;	/* Current gain of pacing rate */
+	real64					cwin_gain;		/* Current gain of congestion window */
+} VBbr;
+
+/**
+ * Common state of congestion control of one datagram connection
+ */
+typedef struct VCongestion {
+	const struct VCongestionOps	*ops;		/* Congestion control selected by negotiated method */
+	uint32					mss;			/* Maximal size of sent packet */
+	uint32					ssthresh;		/* Slow start threshold */
+	uint32					in_flight;		/* Size of sent packets that are in history of sent packets */
+	uint32					delivered;		/* Total size of acknowledged packets */
+	uint32					lost;			/* Total size of lost packets */
+	struct timeval			delivered_tv;	/* Time, when delivered was updated */
+	uint32					recover_id;		/* Losses of packets sent before this ID are the same congestion event */
+	uint8					in_recovery;	/* Loss of packet sent before recover_id was detected */
+	uint8					pacing;			/* Payload packets are paced (0 sends them at FPS tick) */
+	uint64					pacing_us;		/* Time, when previously sent packets leave the pacer [us] */
+	union {
+		struct VCubic		cubic;
+		struct VBbr			bbr;
+	} alg;
+} VCongestion;
+
+/**
+ * Interface of congestion control. The implementation updates congestion
+ * window (cwin) of datagram connection and it could return rate of pacing.
+ */
+typedef struct VCongestionOps {
+	uint8		cc_meth;		/* Method of Congestion Control (CC_NONE, CC_CUBIC, ...) */
+	const char	*name;
+	/* Initialize state of congestion control */
+	void		(*init)(struct VDgramConn *vconn);
+	/* The sent_packet was acknowledged */
+	void		(*on_ack)(struct VDgramConn *vconn,
+			const struct VSent_Packet *sent_packet,
+			const struct timeval *tv);
+	/* New congestion event was detected (timeout is 1 for expiration of RTO) */
+	void		(*on_loss)(struct VDgramConn *vconn,
+			const struct timeval *tv,
+			int timeout);
+	/* New sample of RTT [us] was measured */
+	void		(*on_rtt_sample)(struct VDgramConn *vconn,
+			uint32 rtt,
+			const struct timeval *tv);
+	/* Rate of sending packets [B/s], zero means no pacing */
+	uint32		(*pacing_rate)(struct VDgramConn *vconn);
+} VCongestionOps;
+
+const struct VCongestionOps *v_cc_get_ops(uint8 cc_meth);
+void v_cc_init(struct VDgramConn *vconn);
+int v_cc_can_send(struct VDgramConn *vconn);
+void v_cc_packet_sent(struct VDgramConn *vconn,
+		struct VSent_Packet *sent_packet,
+		uint16 size,
+		const struct timeval *tv);
+void v_cc_packet_acked(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv);
+void v_cc_packet_lost(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv);
+void v_cc_rtt_sample(struct VDgramConn *vconn,
+		uint32 rtt,
+		const struct timeval *tv);
+void v_cc_timeout(struct VDgramConn *vconn,
+		const struct timeval *tv);
+uint32 v_cc_pacing_rate(struct VDgramConn *vconn);
+uint32 v_cc_pacing_delay(struct VDgramConn *vconn,
+		const struct timeval *tv);
+
+#endif
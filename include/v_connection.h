@@ -45,6 +45,8 @@
 
 #include "v_network.h"
 #include "v_history.h"
+#include "v_congestion.h"
+#include "v_pmtud.h"
 #include "v_context.h"
 
 /* Client states (UDP) */
@@ -133,8 +135,14 @@ typedef struct VDgramConn {
 	/* Congestion and flow control */
 	unsigned char			fc_meth;			/* Negotiated Flow Control method */
 	unsigned char			cc_meth;			/* Negotiated Congestion Control method */
-	unsigned int			srtt;				/* Smoothed Round-Trip Time */
+	unsigned int			srtt;				/* Smoothed Round-Trip Time [us] */
+	unsigned int			rttvar;				/* Round-Trip Time variation [us] */
+	unsigned int			rto;				/* Retransmission timeout [us] */
+	unsigned int			rto_backoff;		/* Number of expirations of retransmission timer since last RTT sample */
+	unsigned int			karn_id;			/* ID of first payload packet sent after expiration of retransmission timer */
 	unsigned int			cwin;				/* Congestion Control Window */
+	struct VCongestion		cc;					/* State of Congestion Control */
+	struct VPmtud			pmtud;				/* State of PMTU discovery */
 	unsigned int			rwin_host;			/* Flow Control Window of host (my) */
 	unsigned int			rwin_peer;			/* Flow Control Window of peer */
 	unsigned int			sent_size;			/* Size of data that were sent and were not acknowledged */
@@ -142,6 +150,8 @@ typedef struct VDgramConn {
 	unsigned char			rwin_peer_scale;	/* Scaling of perr Flow Control Window */
 	unsigned char			host_cmd_cmpr;		/* Command compression used by host for sedning commands */
 	unsigned char			peer_cmd_cmpr;		/* Command compression used by peer for sending commands */
+	unsigned char			host_pmtu_probe;	/* Type of PMTU probes sent by host */
+	unsigned char			peer_pmtu_probe;	/* Type of PMTU probes sent by peer */
 	/* States */
 	struct VConnectionState	state[STATE_COUNT];	/* Array of structure storing state specific things (callbacks, counters, etc.) */
 	/* Histories */
@@ -39,55 +39,100 @@
 #include "verse_types.h"
 
 #include "v_list.h"
+#include "v_sys_commands.h"
 #include "v_out_queue.h"
 #include "v_context.h"
 
-#define INIT_ACK_NAK_HISTORY_SIZE	2
+#define INIT_ACK_NAK_HISTORY_SIZE	8	/* Initial count of ranges in ring of received packets (power of two) */
+
+#define INIT_PACKET_HISTORY_SIZE	64	/* Initial count of slots in ring of sent packets (power of two) */
+#define INIT_SENT_CMDS_SIZE			16	/* Initial length of array of sent commands in one packet */
 
 /**
  * This structure does not contain own command, but it only contain pointer
- * at command in the queue.
+ * at command in the queue. The bucket of hashed linked list of sent commands
+ * is part of this structure, thus no bucket is allocated for sent command.
  */
 typedef struct VSent_Command {
-	struct VSent_Command	*prev, *next;	/* Item of linked list */
-	struct VBucket			*vbucket;		/* Pointer at item of command data in bucket list */
+	struct VBucket			bucket;			/* Bucket in hashed linked list of sent commands */
+	struct VBucket			*vbucket;		/* Pointer at bucket or NULL, when command is obsolete */
 	uint8					id;				/* ID of command */
 	uint8					prio;			/* The priority that was used for sending this command */
 } VSent_Command;
 
 /**
- * Structure of sent packet. This structure contains the linked list of
- * pointers at commands. Commands are stored in queue. If any command with
- * the same address is sent to the peer in packet with higher packet ID,
- * then content of current command is obsolete and pointer at command is set
- * as NULL. Then it would be necessary to re-send only not NULL commands.
+ * Structure of sent packet. This structure contains the array of pointers at
+ * commands. Commands are stored in queue. If any command with the same
+ * address is sent to the peer in packet with higher packet ID, then content
+ * of current command is obsolete and pointer at command is set as NULL. Then
+ * it would be necessary to re-send only not NULL commands. Sent commands are
+ * allocated from pool and they are never moved, because their buckets are
+ * linked in hashed linked lists. The array and sent commands are kept, when
+ * packet is removed from the history, and they are reused by packets stored
+ * later in the same slot.
  */
 typedef struct VSent_Packet {
-	struct VSent_Packet		*prev, *next;	/* Item of linked list */
 	uint32					id;				/* ID of packet */
-	struct VListBase		cmds;			/* Linked list of pointers at commands */
+	uint8					used;			/* The slot is used by packet with this ID */
+	uint16					cmd_count;		/* Count of commands in the array */
+	uint16					cmd_len;		/* Length of allocated array of commands */
+	struct VSent_Command	**cmds;			/* Array of pointers at commands */
 	struct timeval			tv;				/* The time, when packet was sent */
+	uint16					size;			/* Size of sent packet */
+	uint32					delivered;		/* Delivered data of connection, when packet was sent */
+	struct timeval			delivered_tv;	/* Time of delivering of this data */
 } VSent_Packet;
 
 /**
- * Structure containing history of sent packets. The packets contains linked
- * list of sent commands. The command lists contains sent hashed commands.
+ * Structure containing history of sent packets. Sent packets are stored in
+ * ring of slots indexed by ID of packet, because IDs of sent payload packets
+ * are increasing. The packets contains array of sent commands. The command
+ * lists contains sent hashed commands.
  */
 typedef struct VPacket_History {
-	/* Linked list of sent packets */
-	struct VListBase		packets;
+	/* Ring of sent packets, the slot of packet is id & (size - 1) */
+	struct VSent_Packet		*packets;
+	uint32					size;			/* Count of slots in the ring (power of two) */
+	uint32					count;			/* Count of packets in the history */
+	uint32					first_id;		/* The oldest packet in the history */
+	uint32					last_id;		/* The newest packet in the history */
 	/* Own sent commands are stored in separated structure. Each type of command
 	 * has own slots */
 	struct VCommandQueue	*cmd_hist[MAX_CMD_ID+1];
 } VPacket_History;
 
 /**
- *  Array of compressed ACK and NAK commands, that are sent in ACK packet
+ * Range of received payload packets with following IDs
+ */
+typedef struct AckNakRange {
+	uint32					first;		/* ID of the first received packet in the range */
+	uint32					last;		/* ID of the last received packet in the range */
+} AckNakRange;
+
+/**
+ * Set of received payload packets, that were not confirmed by ANK ID yet.
+ * Received packets are stored as ring of ranges. Each range is sent as ACK
+ * command and gap between two ranges is sent as NAK command. Packets are
+ * received in order, so new ID only extends the last range or it adds new
+ * range after the gap.
+ *
+ *      +-----+-----+-----+-----+-----+-----+
+ *      | ACK | NAK | ACK | NAK | ACK | ACK |
+ *      +-----+-----+-----+-----+-----+-----+
+ *      | 107 | 115 | 146 | 157 | 179 | 183 |
+ *      +-----+-----+-----+-----+-----+-----+
+ *
+ * ack: +-----+     +-----+     +-----------+
+ * id:  |107  |115  |146  |157  |179   183  |
+ * nak: +     +-----+     +-----+           +
  */
 typedef struct AckNakHistory {
-	struct Ack_Nak_Cmd		*cmds;		/* Compressed array of ACK and NAK commands */
-	int						len;		/* Length of array */
-	int						count;		/* Count of items in the array */
+	struct AckNakRange		*ranges;	/* Ring of ranges of received packets */
+	int						len;		/* Length of ring (power of two) */
+	int						count;		/* Count of ranges in the ring */
+	int						head;		/* Index of the oldest range */
+	uint32					first_id;	/* The oldest not confirmed ID (could be lost) */
+	uint8					started;	/* Any payload packet was received */
 } AckNakHistory;
 
 void v_print_packet_history(struct VPacket_History *history);
@@ -106,8 +151,11 @@ int v_packet_history_rem_packet(struct vContext *C, uint32 id);
 void v_ack_nak_history_print(struct AckNakHistory *ack_nak_history);
 int v_ack_nak_history_remove_cmds(struct AckNakHistory *history,
 		unsigned int ank_id);
-int v_ack_nak_history_add_cmd(struct AckNakHistory *ack_nak_history,
-		struct Ack_Nak_Cmd *cmd);
+int v_ack_nak_history_add_id(struct AckNakHistory *ack_nak_history,
+		uint32 pay_id);
+int v_ack_nak_history_pack_cmds(struct AckNakHistory *ack_nak_history,
+		union VSystemCommands *sys_cmds,
+		int max_count);
 int v_ack_nak_history_init(struct AckNakHistory *ack_nak_history);
 void v_ack_nak_history_clear(struct AckNakHistory *history);
 
@@ -45,32 +45,97 @@
 
 #define IN_QUEUE_DEFAULT_MAX_SIZE 1048576
 
+/* Flag of incoming queue: fixed length node commands are not unpacked, when
+ * they are received, but they are stored as views of received buffer */
+#define IN_QUEUE_CMD_VIEWS			1
+
+/* Size of buffer for command unpacked from view. It is bigger then size of
+ * any command with fixed length. */
+#define IN_QUEUE_CMD_BUF_SIZE		64
+
+/**
+ * Copy of received node commands shared by views of commands, that were
+ * received in one packet. Reference counter is changed atomically.
+ */
+typedef struct VRecvBuffer {
+	volatile uint32			refcount;	/**< Number of views using this buffer */
+	uint16					size;		/**< Size of data in buffer */
+	uint8					data[1];	/**< Received node commands */
+} VRecvBuffer;
+
+/**
+ * View of received command, that is unpacked from received buffer, when it
+ * is popped from incoming queue.
+ */
+typedef struct VInQueueView {
+	struct VRecvBuffer		*rbuf;		/**< Received buffer (NULL for unpacked commands) */
+	uint16					addr;		/**< Position of first command with shared address */
+	uint16					offset;		/**< Position of own items of command */
+	uint8					skip_items;	/**< Number of items of shared address */
+} VInQueueView;
+
+/**
+ * Buffer for command unpacked from view
+ */
+typedef union VInQueueCmdBuf {
+	struct Generic_Cmd		cmd;
+	uint8					buf[IN_QUEUE_CMD_BUF_SIZE];
+} VInQueueCmdBuf;
+
 /**
- * Structure storing information about incoming command waiting in the incoming
- * queue
+ * Slot of incoming command waiting in the incoming queue. Slot of command,
+ * that could not be duplicated, is also stored in hashed array of producers
+ * and newer command or view with the same address only replaces command in
+ * the slot. Such slot points at the latest command or at one of its views.
+ * The other view is used for writing of newer view, thus consumer never reads
+ * view changed by producer. The slot is followed by copy of the command
+ * address, that is used as key of hashed array, because popped command does
+ * not belong to the queue.
  */
 typedef struct VInQueueCommand {
-	struct VOutQueueCommand	*prev, *next;	/**< To be able to add it to the linked list */
-	struct VBucket			*vbucket;		/**< Own data of command stored in hashed linked list of commands */
-	uint8					id;				/**< ID of command */
+	struct VInQueueCommand	* volatile next;	/**< Next slot in lock-free list of slots */
+	void					* volatile data;	/**< The latest command or view (NULL, when popped) */
+	struct VInQueueCommand	*retired_next;		/**< Next slot in list of popped slots */
+	struct VBucket			*vbucket;			/**< Bucket in hashed array of producers (NULL = not used) */
+	struct VInQueueView		views[2];			/**< Views of received command */
+	uint8					id;					/**< ID of command */
+	uint8					key[1];				/**< Copy of command up to the end of its address */
 } VInQueueCommand;
 
 /**
- * This structure is used for storing incoming data
+ * This structure is used for storing incoming data. The queue could be
+ * used by many producers (connection threads) and one consumer (data
+ * thread or vrs_callback_update()) without any lock. Producers use lock
+ * only for replacing of commands with the same address, thus producers
+ * never wait for the consumer.
  */
 typedef struct VInQueue {
-	pthread_mutex_t			lock;	/**< Mutex for locking queue (synchronization between threads) */
+	pthread_mutex_t			lock;		/**< Mutex of producers replacing commands with the same address */
 	struct VCommandQueue	*cmds[MAX_CMD_ID+1];
-	struct VListBase		queue;		/**< Linked list of commands */
-	uint32					size;		/**< Size of stored commands in bytes */
+	struct VInQueueCommand	* volatile head;	/**< First slot of list (used only by consumer) */
+	struct VInQueueCommand	* volatile tail;	/**< Last slot of list (exchanged by producers) */
+	struct VInQueueCommand	stub;		/**< Empty slot keeping list not empty */
+	struct VInQueueCommand	* volatile retired;	/**< Slots popped by consumer, that are in hashed array */
+	volatile uint32			size;		/**< Size of stored commands in bytes */
 	uint32					max_size;	/**< Maximal allowed size of commands stored in this queue */
-	uint32					count;		/**< Count of stored commands */
+	volatile uint32			count;		/**< Count of stored commands */
+	uint8					flags;		/**< Flags of queue (IN_QUEUE_CMD_VIEWS) */
 } VInQueue;
 
 uint32 v_in_queue_size(struct VInQueue *in_queue);
 uint32 v_in_queue_cmd_count(struct VInQueue *in_queue);
 struct Generic_Cmd *v_in_queue_pop(struct VInQueue *in_queue);
+struct Generic_Cmd *v_in_queue_pop_buf(struct VInQueue *in_queue,
+		union VInQueueCmdBuf *cmd_buf);
 int v_in_queue_push(struct VInQueue *in_queue, struct Generic_Cmd *cmd);
+struct VRecvBuffer *v_in_queue_rbuf_create(const char *data, const uint16 size);
+void v_in_queue_rbuf_release(struct VInQueue *in_queue, struct VRecvBuffer *rbuf);
+int v_in_queue_push_view(struct VInQueue *in_queue,
+		const uint8 id,
+		struct VRecvBuffer *rbuf,
+		const uint16 addr,
+		const uint16 offset,
+		const uint8 skip_items);
 int v_in_queue_init(struct VInQueue *in_queue, int max_size);
 struct VInQueue *v_in_queue_create(void);
 void v_in_queue_destroy(struct VInQueue **in_queue);
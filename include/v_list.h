@@ -49,6 +49,27 @@
 #define HASH_MOD_256		1
 #define HASH_MOD_65536		2
 #define	HASH_COPY_BUCKET	4
+#define HASH_EXTERN_BUCKET	8
+
+/* Keys with size up to this value are stored directly in slots of hashed
+ * linked list. Longer keys are compared using data of bucket. */
+#define HASH_INLINE_KEY_SIZE	16
+
+/* Length of array of slots allocated with first item of hashed linked list */
+#define HASH_INIT_LENGTH		8
+
+/* Maximal load of array of slots in percents. When this load is exceeded,
+ * then new array with double size is created. Linear probing needs short
+ * clusters, because unsuccessful search has to reach end of the cluster. */
+#define HASH_MAX_LOAD			60
+
+/* Minimal load of array of slots in percents. When load is lower, then new
+ * array with half size is created. */
+#define HASH_MIN_LOAD			15
+
+/* Number of slots migrated from old array of slots to the new array of slots
+ * during each modification of hashed linked list */
+#define HASH_REHASH_STEP		16
 
 typedef struct VItem {
 	struct VItem	*prev, *next;
@@ -75,22 +96,40 @@ typedef struct VArrayBase {
 
 typedef struct VBucket {
 	struct VBucket		*prev, *next;
+	struct VBucket		*dup_prev, *dup_next;	/* Cyclic list of buckets with the same key */
 	void				*data;
 	void				*ptr;
 } VBucket;
 
-typedef struct VBucketP {
-	struct VBucket		*vbucket;	/* Pointer at item in linked list */
-	struct VBucketP		*next;		/* Pointer at next item, when there is collision of hash function */
-} VBucketP;
+/**
+ * One slot of open addressing array. The slot is followed by copy of the key,
+ * when the key is not longer then HASH_INLINE_KEY_SIZE. Thus size of the slot
+ * is stored in VHashArrayBase. Each key is stored only in one slot and the slot
+ * points at the oldest bucket with this key. Other buckets with the same key
+ * are reachable using dup_next.
+ */
+typedef struct VHashSlot {
+	struct VBucket		*vbucket;	/* Pointer at item in linked list (NULL for empty slot) */
+	uint32				hash;		/* Full value of hash function */
+	uint8				key[1];		/* Inline copy of the key */
+} VHashSlot;
+
+/**
+ * Array of slots with linear probing
+ */
+typedef struct VHashTable {
+	uint8				*slots;		/* Array of slots */
+	uint32				length;		/* Number of slots (power of two) */
+	uint32				count;		/* Number of occupied slots (unique keys) */
+} VHashTable;
 
 typedef struct VHashArrayBase {
 	struct VListBase	lb;
-	struct VBucketP		*buckets;	/* Array of buckets */
-	uint32				length;		/* Length of the array of buckets (2^8 or 2^16)*/
+	struct VHashTable	table;		/* Current array of slots */
+	struct VHashTable	old_table;	/* Old array of slots, that is migrated to the current array */
+	uint32				rehash_index;	/* Index of next slot in old array to be migrated */
 	uint32				count;		/* Number of items in the linked list */
-	/* Pointer at hash function returning pointer at item in linked list */
-	int32				(*hash_func)(struct VHashArrayBase *hash_array, void *item);
+	uint16				slot_size;	/* Size of one slot including inline key */
 	uint8				key_offset;	/* Offset of key from the begining of the key */
 	uint8				key_size;	/* Size of key in bytes */
 	pthread_mutex_t		mutex;
@@ -123,9 +162,14 @@ struct VBucket *v_hash_array_find_item(struct VHashArrayBase *hash_array,
 		void *item);
 int v_hash_array_remove_item(struct VHashArrayBase *hash_array,
 		void *item);
+int v_hash_array_remove_bucket(struct VHashArrayBase *hash_array,
+		struct VBucket *vbucket);
 struct VBucket *v_hash_array_add_item(struct VHashArrayBase *hash_array,
 		void *item,
 		uint16 item_size);
+int v_hash_array_add_bucket(struct VHashArrayBase *hash_array,
+		struct VBucket *vbucket,
+		void *item);
 uint32 v_hash_array_count_items(struct VHashArrayBase *hash_array);
 int v_hash_array_destroy(struct VHashArrayBase *hash_array);
 int v_hash_array_init(struct VHashArrayBase *hash_array,
@@ -79,8 +79,20 @@
 #define MAX_NODE_COMMAND_COUNT		(MAX_PACKET_SIZE / (1+1))
 /* Default Ethernet MTU */
 #define DEFAULT_MTU					(1500 - 40 - 8)
-/* Define alpha value for computing SRTT */
-#define RTT_ALPHA					0.9
+/* Maximal number of packets sent or received with one system call */
+#define MAX_DGRAM_BATCH				256
+/* Maximal number of packets sent in one super-buffer with UDP GSO */
+#define MAX_GSO_SEGMENTS			64
+/* Maximal size of super-buffer sent with UDP GSO */
+#define MAX_GSO_SIZE				(USHRT_MAX - 8 - 40)
+/* Initial retransmission timeout in microseconds (RFC 6298) */
+#define RTO_INITIAL					1000000
+/* Minimal retransmission timeout in microseconds */
+#define RTO_MIN						200000
+/* Maximal retransmission timeout in microseconds */
+#define RTO_MAX						60000000
+/* Granularity of clock used for computing RTO in microseconds */
+#define RTO_CLOCK_GRANULARITY		1000
 
 /* It was not possible to send packet, because error of*/
 #define SEND_PACKET_ERROR			0
@@ -103,6 +115,10 @@
 
 #define SOCKET_CONNECTED			1
 #define SOCKET_SECURED				2
+/* Packets are not sent, but they stay in the buffer of IO_CTX (benchmarks) */
+#define SOCKET_MEMORY				4
+/* Socket is shared by many datagram connections and it is not closed with connection */
+#define SOCKET_SHARED				8
 
 /* How long should client or server wait for packet in select() function */
 #define TIMEOUT			1
@@ -221,6 +237,32 @@ typedef struct VNetworkAddress {
 	unsigned short			port;		/* Port number */
 } VNetworkAddress;
 
+/**
+ * Batch of datagrams sent or received with one system call
+ */
+typedef struct VDgramBatch {
+	uint16					len;		/* Maximal number of packets in batch */
+	uint16					count;		/* Current number of packets in batch */
+	uint16					slot_size;	/* Size of buffer of one packet */
+	uint8					active;		/* Sent packets are added to the batch */
+	uint8					gso;		/* Packets of same size are sent in super-buffer */
+	char					**bufs;		/* Buffers of packets */
+	ssize_t					*sizes;		/* Sizes of packets */
+	struct VNetworkAddress	*addrs;		/* Addresses of peers */
+	void					*msgs;		/* Array of messages used by sendmmsg() and recvmmsg() */
+	void					*iovs;		/* Array of I/O vectors used by messages */
+} VDgramBatch;
+
+/**
+ * Super-buffer of packets coalesced by kernel with UDP GRO
+ */
+typedef struct VDgramGro {
+	char					*buf;		/* Buffer with coalesced packets */
+	ssize_t					size;		/* Size of data in buffer */
+	ssize_t					pos;		/* Position of next packet in buffer */
+	uint16					seg_size;	/* Size of packets in buffer (last one could be smaller) */
+} VDgramGro;
+
 /* Context for sending and receiving packets */
 typedef struct IO_CTX {
 	struct VNetworkAddress	host_addr;		/* Address of application running this code */
@@ -230,6 +272,8 @@ typedef struct IO_CTX {
 	int						sockfd;			/* UDP/TCP/WebSocket socket */
 	unsigned char			flags;			/* Flags for sending and receiving context */
 	unsigned short			mtu;			/* MTU of connection discovered with PMTU */
+	struct VDgramBatch		*batch;			/* Packets sent with one system call (NULL = not used) */
+	struct VDgramGro		*gro;			/* Packets received in super-buffer (NULL = not used) */
 #ifdef WITH_OPENSSL
 	/* Security */
 	SSL						*ssl;
@@ -260,6 +304,20 @@ int v_tcp_write(struct IO_CTX *io_ctx, int *error_num);
 int v_receive_packet(struct IO_CTX *io_ctx, int *error_num);
 int v_send_packet(struct IO_CTX *io_ctx, int *error_num);
 
+struct VDgramBatch *v_dgram_batch_create(uint16 len, uint16 slot_size);
+void v_dgram_batch_destroy(struct VDgramBatch *batch);
+void v_dgram_batch_begin(struct IO_CTX *io_ctx);
+int v_dgram_batch_end(struct IO_CTX *io_ctx, int *error_num);
+int v_dgram_batch_send(struct VDgramBatch *batch, int sockfd, int *error_num);
+int v_dgram_batch_receive(struct VDgramBatch *batch, int sockfd,
+		unsigned short ip_ver, int *error_num);
+
+int v_dgram_gso_enable(int sockfd);
+uint16 v_dgram_pmtud_enable(struct IO_CTX *io_ctx);
+int v_dgram_gro_enable(struct IO_CTX *io_ctx);
+void v_dgram_gro_destroy(struct IO_CTX *io_ctx);
+int v_dgram_gro_pending(const struct IO_CTX *io_ctx);
+
 int v_unpack_packet_header(const char *buffer, const unsigned short buffer_len, struct VPacket *vpacket);
 int v_pack_packet_header(const VPacket *vpacket, char *buffer);
 
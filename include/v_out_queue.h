@@ -54,11 +54,33 @@
 #define MAX_REAL_PRIO_VAL	(VRS_DEFAULT_PRIORITY*1000)
 #define MIN_REAL_PRIO_VAL	1
 
+/* Count of bytes added to deficit of priority queue in each round of
+ * scheduler per one unit of real priority. Even the lowest priority could
+ * send few compressed commands in one round and default priority could send
+ * several packets in one round. */
+#define PRIO_QUANTUM_MUL	64
+
+/* Number of words in bitmap of not empty priority queues */
+#define PRIO_MAP_WORDS		((MAX_PRIORITY+1)/32)
+
 #define OUT_QUEUE_ADD_TAIL	1
 #define OUT_QUEUE_ADD_HEAD	2
 
 #define OUT_QUEUE_DEFAULT_MAX_SIZE 1048576
 
+/**
+ * Group of consecutive commands with the same ID in the priority queue. These
+ * commands could be compressed to one command in the packet. Values are
+ * updated, when command is added to the group or removed from the group.
+ */
+typedef struct VOutQueueRun {
+	uint16					count;			/**< Count of commands in the group */
+	uint16					len;			/**< Length of all commands of the group compressed to one command */
+	uint16					item_len;		/**< Length of one command without shared address */
+	uint8					hdr_len;		/**< Length of header (with one byte length) and shared address */
+	uint8					share;			/**< Size of address shared by all commands in the group */
+} VOutQueueRun;
+
 /**
  * Structure storing information about outgoing command waiting in the outgoing
  * queue
@@ -68,28 +90,31 @@ typedef struct VOutQueueCommand {
 	struct VBucket			*vbucket;		/**< Own data of command stored in hashed linked list of commands */
 	uint8					id;				/**< ID of command */
 	uint8					prio;			/**< Current priority of the command */
-	uint16					*counter;		/**< Pointer at number (allocated at heap) of following commands with same id */
-	int8					*share;			/**< Pointer at size (allocated at heap) of address that could be shared between commands with same id */
-	uint16					*len;			/**< Pointer at length of the compressed sequence of command with same ID */
+	struct VOutQueueRun		*run;			/**< Group of commands with same ID, NULL for alone command */
+	struct Generic_Cmd		*cmd;			/**< Command waiting in the staging list, before it is merged to priority queues */
 } VOutQueueCommand;
 
 /**
  * Queue for node commands of certain priority
  */
 typedef struct VPrioOutQueue {
-	struct VListBase	cmds;	/**< Linked list of commands */
-	uint32				size;	/**< Size of stored commands (with this priority) in bytes */
-	uint32				count;	/**< Count of stored commands (with this priority) */
-	real32				r_prio;	/**< Real value of this priority queue */
+	struct VListBase	cmds;		/**< Linked list of commands */
+	uint32				size;		/**< Size of stored commands (with this priority) in bytes */
+	uint32				count;		/**< Count of stored commands (with this priority) */
+	uint32				quantum;	/**< Bytes added to deficit in each round of scheduler (weight of this priority) */
+	uint32				deficit;	/**< Bytes, that could be sent from this queue in current round */
 } VPrioOutQueue;
 
 /**
  * List of queues for incoming and outgoing commands. This is actually quueue
  * for all commands divided to the subqueues for all possible priorities of
- * nodes.
+ * nodes. Producers (data thread, client API) only add commands to the
+ * lock-free staging list. Sender thread merges staged commands to priority
+ * queues and hashed arrays, that are private for this thread.
  */
 typedef struct VOutQueue {
-	pthread_mutex_t			lock;			/**< Mutex for locking queue (synchronization between threads) */
+	pthread_mutex_t			lock;			/**< Mutex for locking private priority queues (never used by producers) */
+	struct VOutQueueCommand	* volatile staged;	/**< Lock-free stack of commands pushed by producers and not merged yet */
 	struct VPrioOutQueue	*queues[MAX_PRIORITY+1];
 	struct VCommandQueue	*cmds[MAX_CMD_ID+1];
 	uint32					size;			/**< Size of stored commands in bytes */
@@ -97,8 +122,9 @@ typedef struct VOutQueue {
 	uint32					count;			/**< Count of stored commands */
 	uint8					max_prio;		/**< Maximal used priority queue */
 	uint8					min_prio;		/**< Minimal used priority queue */
-	real32					r_prio_sum_high;/**< Summary of all real priorities <MAX_PRIO, DEFAULT_PRIO> */
-	real32					r_prio_sum_low;	/**< Summary of all real priorities <DEFAULT_PRIO-1, MIN_PRIO> */
+	uint32					prio_map[PRIO_MAP_WORDS];	/**< Bitmap of not empty priority queues */
+	int16					drr_prio;		/**< Priority queue served in current round of scheduler (-1 when no queue is served) */
+	uint16					run_left;		/**< Count of commands from compressed group, that were not popped yet */
 } VOutQueue;
 
 int	v_out_queue_init(struct VOutQueue *out_queue, int max_size);
@@ -110,15 +136,16 @@ int v_out_queue_push_tail(struct VOutQueue *out_queue, uint8 prio, struct Generi
 struct Generic_Cmd * v_out_queue_pop(struct VOutQueue *out_queue, uint8 prio, uint16 *count, int8 *share, uint16 *len);
 struct Generic_Cmd *v_out_queue_find_cmd(struct VOutQueue *out_queue, struct Generic_Cmd *cmd);
 
+int v_out_queue_drr_next(struct VOutQueue *out_queue, uint8 *prio, uint32 *deficit);
+void v_out_queue_drr_charge(struct VOutQueue *out_queue, uint8 prio, uint32 len);
+
 uint32 v_out_queue_get_count_prio(struct VOutQueue *out_queue, uint8 prio);
 uint32 v_out_queue_get_size_prio(struct VOutQueue *out_queue, uint8 prio);
 uint32 v_out_queue_get_count(struct VOutQueue *out_queue);
 uint32 v_out_queue_get_size(struct VOutQueue *out_queue);
 uint8 v_out_queue_get_max_prio(struct VOutQueue *out_queue);
 uint8 v_out_queue_get_min_prio(struct VOutQueue *out_queue);
-real32 v_out_queue_get_prio(struct VOutQueue *out_queue, uint8 prio);
-real32 v_out_queue_get_prio_sum_high(struct VOutQueue *out_queue);
-real32 v_out_queue_get_prio_sum_low(struct VOutQueue *out_queue);
+uint32 v_out_queue_get_quantum(struct VOutQueue *out_queue, uint8 prio);
 
 #endif
 
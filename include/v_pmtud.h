@@ -0,0 +1,92 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2010, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+#if !defined V_PMTUD_H
+#define V_PMTUD_H
+
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+#include "verse_types.h"
+
+struct VDgramConn;
+struct VSent_Packet;
+
+#define PMTUD_BASE_MTU			(1280 - 40 - 8)	/* Size of packet delivered by any IPv6 path (BASE_PLPMTU) */
+#define PMTUD_MAX_MTU			(9000 - 20 - 8)	/* The biggest probed size of packet (jumbo frame) */
+#define PMTUD_MAX_PROBES		3			/* Count of lost probes, that proves size of packet is too big */
+#define PMTUD_SEARCH_STEP		16			/* Search is complete, when PMTU is known with this precision */
+#define PMTUD_RAISE_TIMER		600			/* Time between searches for bigger PMTU [s] */
+#define PMTUD_BLACK_HOLE_LOSSES	6			/* Count of consecutive lost big packets caused by black hole */
+
+/* States of PMTU discovery */
+#define PMTUD_DISABLED			0
+#define PMTUD_SEARCHING			1
+#define PMTUD_SEARCH_COMPLETE	2
+
+/**
+ * State of PMTU discovery. Padded keep alive packets are sent as probes and
+ * their size is found with binary search between low and high.
+ */
+typedef struct VPmtud {
+	uint8					state;			/* PMTUD_DISABLED, PMTUD_SEARCHING or PMTUD_SEARCH_COMPLETE */
+	uint16					max_mtu;		/* Maximal size of packet allowed by local interface */
+	uint16					low;			/* The biggest size of packet, that was delivered */
+	uint16					high;			/* The smallest size of packet, that was not delivered */
+	uint16					probe_size;		/* Size of probe in flight, zero, when no probe is in flight */
+	uint32					probe_id;		/* Payload ID of probe in flight */
+	uint8					probe_count;	/* Count of lost probes of current size */
+	uint8					black_hole_count;	/* Count of consecutive lost packets bigger then PMTUD_BASE_MTU */
+	struct timeval			search_tv;		/* Time, when last search was completed */
+} VPmtud;
+
+void v_pmtud_init(struct VDgramConn *vconn, uint16 max_mtu);
+uint16 v_pmtud_probe_size(struct VDgramConn *vconn,
+		const struct timeval *tv);
+void v_pmtud_probe_sent(struct VDgramConn *vconn,
+		uint32 id,
+		uint16 size);
+void v_pmtud_probe_failed(struct VDgramConn *vconn,
+		uint16 size,
+		const struct timeval *tv);
+void v_pmtud_packet_acked(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv);
+int v_pmtud_packet_lost(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv);
+
+#endif
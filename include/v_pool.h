@@ -0,0 +1,69 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#ifndef V_POOL_H_
+#define V_POOL_H_
+
+#include <stddef.h>
+
+#include "verse_types.h"
+#include "v_list.h"
+
+/* Size of blocks differs by this value in neighbouring size classes */
+#define POOL_CLASS_SIZE		16
+
+/* Number of size classes. Bigger blocks are allocated with malloc() */
+#define POOL_CLASS_COUNT	32
+
+/* Maximal size of block allocated from pool */
+#define POOL_MAX_SIZE		(POOL_CLASS_SIZE * POOL_CLASS_COUNT)
+
+/* Number of blocks moved between cache of thread and shared depot at once.
+ * It is also number of blocks allocated in one slab. */
+#define POOL_BATCH_SIZE		64
+
+/* Maximal number of free blocks in cache of one thread for each size class */
+#define POOL_CACHE_SIZE		(4 * POOL_BATCH_SIZE)
+
+void *v_pool_alloc(size_t size);
+void *v_pool_calloc(size_t size);
+void v_pool_free(void *ptr, size_t size);
+void v_pool_list_free(struct VListBase *listbase, size_t item_size);
+void v_pool_list_free_item(struct VListBase *listbase, void *item, size_t item_size);
+uint32 v_pool_slab_count(void);
+uint64 v_pool_thread_alloc_count(void);
+
+#endif /* V_POOL_H_ */
@@ -36,9 +36,18 @@
 #if !defined V_RESEND_MECHANISM_H
 #define V_RESEND_MECHANISM_H
 
-#define RESEND_TIMEOUT	2000000	/* This value is in microseconds */
+#include "verse_types.h"
+
+struct VDgramConn;
+
+#define RESEND_TIMEOUT	2000000	/* Keep alive interval of idle connection in microseconds */
+
+void v_rto_update(struct VDgramConn *vconn, unsigned long int rtt);
+void v_rto_timeout(struct VDgramConn *vconn);
+int v_rto_sample_valid(const struct VDgramConn *vconn, uint32 pay_id);
 
 int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C);
+long int pacing_delay_in_OPEN_CLOSEREQ_state(struct vContext *C);
 int handle_packet_in_OPEN_state(struct vContext *C);
 
 #endif
@@ -78,6 +78,8 @@ typedef struct VSession {
 	pthread_attr_t			tcp_thread_attr;/* Attributes of the TCP/WebSocket thread */
 	pthread_t				udp_thread;		/* UDP Thread for this session */
 	pthread_attr_t			udp_thread_attr;/* Attributes of the UDP thread */
+	void					*io_handle;		/* Datagram connection handled by I/O thread of server */
+	void					*stream_handle;	/* Stream connection handled by I/O thread of server */
 	/* Connection */
 	char 					*peer_hostname;	/* Hostname of the peer */
 	struct VNetworkAddress	peer_address;	/* Address of the peer and port number */
@@ -111,9 +113,27 @@ typedef struct VSession {
 	/* Information about client program */
 	char					*client_name;
 	char					*client_version;
+	/* List of sessions with received commands */
+	struct VSession			*ready_next;	/* Next session in the list of ready sessions */
+	volatile int32			ready;			/* Session is in the list of ready sessions */
+	uint32					data_cmds;		/* Commands dispatched to data workers of server and not handled yet */
 } VSession;
 
+/**
+ * Lock-free list of sessions with commands in incoming queue. Connection
+ * threads add sessions to the list and only one data thread takes them.
+ */
+typedef struct VSessionReadyList {
+	struct VSession * volatile	first;		/* Session added last to the list */
+} VSessionReadyList;
+
 void v_init_session(struct VSession *vsession);
 void v_destroy_session(struct VSession *vsession);
 
+void v_session_ready_init(struct VSessionReadyList *ready_list);
+int v_session_ready_push(struct VSessionReadyList *ready_list,
+		struct VSession *vsession);
+struct VSession *v_session_ready_pop_all(struct VSessionReadyList *ready_list);
+void v_session_ready_done(struct VSession *vsession);
+
 #endif
@@ -69,6 +69,7 @@ typedef int ssize_t;
 #define FTR_CMD_COMPRESS		8	/* Command compression */
 #define FTR_CLIENT_NAME			9	/* The name of Verse client application */
 #define FTR_CLIENT_VERSION		10	/* The version of Verse client application */
+#define FTR_PMTU_PROBE			11	/* Type of probes used for PMTU discovery */
 
 /* Minimal and maximal length of negotiate command */
 #define MIN_FTR_CMD_LEN			3
@@ -87,12 +88,22 @@ typedef int ssize_t;
 #define CC_RESERVED				0	/* Should never be used */
 #define CC_NONE					1
 #define CC_TCP_LIKE				2
+#define CC_CUBIC				3
+#define CC_BBR					4
+
+/* Bit of Congestion Control method in set of allowed methods */
+#define CC_MASK(cc_meth)		(1 << (cc_meth))
 
 /* Methods of Command Compression */
 #define CMPR_RESERVED			0	/* Should never be used */
 #define CMPR_NONE				1
 #define CMPR_ADDR_SHARE			2
 
+/* Types of PMTU probes */
+#define PMTU_PROBE_RESERVED		0	/* Should never be used */
+#define PMTU_PROBE_NONE			1	/* No probes are sent (PMTU discovery is disabled) */
+#define PMTU_PROBE_PADDED		2	/* Keep alive packets padded with reserved command ID */
+
 
 /* Following commands are real system commands, that are packed to the packets
  * and messages. On the other side these commands are never added to the
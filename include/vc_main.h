@@ -176,6 +176,8 @@ typedef struct VC_CTX {
 	uint8					print_log_level;			/**< Amount of information printed to log file */
 	FILE					*log_file;					/**< File used for logs */
 	uint8					rwin_scale;					/**< Scale of Flow Control Window */
+	uint8					dgram_offload;				/**< Receive packets coalesced by kernel (UDP GRO) */
+	uint8					dgram_pacing;				/**< Pace payload packets (0 sends them at each iteration of loop) */
 	char					*ca_path;
 	/* Data for connections */
 	struct VSession			**vsessions;				/**< List of sessions and session with connection attempts */
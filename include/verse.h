@@ -157,6 +157,8 @@ extern "C" {
 #define VRS_TP_WEBSOCKET			16
 #define VRS_CMD_CMPR_NONE			32	/* No command compression */
 #define VRS_CMD_CMPR_ADDR_SHARE		64	/* Share command addresses to compress commands */
+#define VRS_CC_NONE					128	/* No congestion control */
+#define VRS_CC_CUBIC				256	/* Prefer loss based congestion control (CUBIC) to BBR */
 
 /* Type of verse value */
 #define VRS_VALUE_TYPE_RESERVED		0
@@ -203,6 +205,12 @@ int vrs_set_debug_level(uint8_t debug_level);
 
 int vrs_set_client_info(char *name, char *version);
 
+int vrs_set_dgram_offload(const uint8_t offload);
+
+int vrs_set_dgram_pacing(const uint8_t pacing);
+
+int vrs_get_rto(const uint8_t session_id, uint32_t *srtt, uint32_t *rto);
+
 char *vrs_strerror(const uint32_t error_num);
 
 int vrs_send_fps(const uint8_t session_id,
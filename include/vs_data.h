@@ -25,6 +25,38 @@
 #ifndef VS_DATA_H_
 #define VS_DATA_H_
 
+#include <pthread.h>
+
+#include "verse_types.h"
+
+struct VS_CTX;
+struct VSession;
+struct Generic_Cmd;
+
+/**
+ * Received command waiting for data worker thread
+ */
+typedef struct VSDataCmd {
+	struct VSDataCmd	*next;
+	struct VSession		*vsession;		/* Session that sent this command */
+	struct Generic_Cmd	*cmd;			/* Received command */
+} VSDataCmd;
+
+/**
+ * Data worker thread handling commands of subset of nodes
+ */
+typedef struct VSDataWorker {
+	struct VS_CTX		*vs_ctx;
+	pthread_t			thread;
+	pthread_mutex_t		mutex;			/* Mutex protecting queue of commands */
+	pthread_cond_t		cond;			/* Condition signaled, when command was added */
+	struct VSDataCmd	*first;			/* First command in queue */
+	struct VSDataCmd	*last;			/* Last command in queue */
+	uint8				stop;			/* Worker should exit */
+} VSDataWorker;
+
+void vs_data_session_ready(struct VS_CTX *vs_ctx, struct VSession *vsession);
+void vs_data_session_close(struct VS_CTX *vs_ctx, struct VSession *vsession);
 void *vs_data_loop(void *arg);
 
 #endif /* VS_DATA_H_ */
@@ -54,4 +54,7 @@ typedef struct VSEntityFollower {
 	uint8						state;
 } VSEntityFolower;
 
+int vs_entity_send_cmd(struct VListBase *subscribers,
+		struct Generic_Cmd **cmd);
+
 #endif /* VS_ENTITY_H_ */
@@ -23,6 +23,8 @@
  */
 
 int vs_user_auth(struct vContext *C, const char *username, const char *data);
+int vs_TLS_setup(struct vContext *C);
+int vs_TLS_accept(struct vContext *C);
 int vs_TLS_handshake(struct vContext *C);
 int vs_TLS_teardown(struct vContext *C);
 void vs_CLOSING(struct vContext *C);
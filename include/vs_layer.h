@@ -30,20 +30,13 @@
 #include "v_list.h"
 
 #include "vs_node.h"
+#include "vs_layer_values.h"
 
 #define FIRST_LAYER_ID				0
 #define LAST_LAYER_ID				65534	/* 2^16 - 2 */
 
 #define MAX_LAYERS_COUNT			65534	/* Max number of layer that could be stored inside one node */
 
-/**
- * \brief The structure storing own value(s)
- */
-typedef struct VSLayerValue {
-	uint32	id;
-	void	*value;
-} VSLayerValue;
-
 /**
  * \brief The structure storing information about layer
  */
@@ -53,7 +46,7 @@ typedef struct VSLayer {
 	uint8					data_type;		/**< The type of values stored in this layer */
 	uint8					num_vec_comp;	/**< The number of vector components (1, 2, 3, 4) */
 	uint16					custom_type;	/**< The type of layer defined by client */
-	struct VHashArrayBase	values;			/**< The hashed linked list of values */
+	struct VSLayerValues	values;			/**< The columnar storage of values */
 	/* Parent-Child */
 	struct VSLayer			*parent;		/**< The parent layer */
 	struct VListBase		child_layers;	/**< The list of child layers */
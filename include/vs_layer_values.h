@@ -0,0 +1,92 @@
+/*
+ *
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ *
+ * Contributor(s): Jiri Hnidek <jiri.hnidek@tul.cz>.
+ *
+ */
+
+
+#ifndef VS_LAYER_VALUES_H_
+#define VS_LAYER_VALUES_H_
+
+#include "verse_types.h"
+
+/* Values are stored directly at index equal to ID of item, when IDs are small
+ * and contiguous (dense mode). Otherwise values are packed and index with
+ * open addressing is used for mapping ID of item to the slot (sparse mode). */
+#define VS_LAYER_VALUES_DENSE		0
+#define VS_LAYER_VALUES_SPARSE		1
+
+/* Minimal number of slots allocated for values */
+#define VS_LAYER_VALUES_MIN_LENGTH	64
+
+/* IDs lower then this limit are always stored in dense mode */
+#define VS_LAYER_VALUES_DENSE_LIMIT	1024
+
+/* Dense mode is used, when number of slots is not bigger then this multiple
+ * of number of stored values */
+#define VS_LAYER_VALUES_DENSE_RATIO	4
+
+/* The slot of index without item */
+#define VS_LAYER_VALUES_NO_SLOT		0xFFFFFFFF
+
+/**
+ * \brief Item of index mapping ID of item to the slot (sparse mode)
+ */
+typedef struct VSLayerIndexSlot {
+	uint32		id;				/**< The ID of item */
+	uint32		slot;			/**< The slot of value in array of values */
+} VSLayerIndexSlot;
+
+/**
+ * \brief Columnar storage of values of one layer. All values have the same
+ * data type and the same number of vector components, thus they are stored
+ * in one contiguous array.
+ */
+typedef struct VSLayerValues {
+	uint8					*data;			/**< The contiguous array of values */
+	uint32					*bitmap;		/**< The bitmap of used slots (dense mode) */
+	uint32					*ids;			/**< The IDs of items in slots (sparse mode) */
+	struct VSLayerIndexSlot	*index;			/**< The index of IDs (sparse mode) */
+	uint32					length;			/**< The number of allocated slots */
+	uint32					index_length;	/**< The number of slots in index (power of two) */
+	uint32					count;			/**< The number of stored values */
+	uint16					value_size;		/**< The size of one value in bytes */
+	uint8					mode;			/**< The mode of storage (dense or sparse) */
+} VSLayerValues;
+
+void vs_layer_values_init(struct VSLayerValues *values, uint16 value_size);
+
+void vs_layer_values_destroy(struct VSLayerValues *values);
+
+void *vs_layer_values_find(struct VSLayerValues *values, uint32 item_id);
+
+void *vs_layer_values_set(struct VSLayerValues *values,
+		uint32 item_id,
+		const void *value);
+
+int vs_layer_values_unset(struct VSLayerValues *values, uint32 item_id);
+
+int vs_layer_values_next(struct VSLayerValues *values,
+		uint32 *slot,
+		uint32 *item_id,
+		void **value);
+
+#endif /* VS_LAYER_VALUES_H_ */
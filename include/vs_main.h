@@ -43,10 +43,14 @@
 #include "vs_node.h"
 
 #include "v_connection.h"
+#include "v_session.h"
 #include "v_network.h"
 #include "v_context.h"
 #include "v_list.h"
 
+struct VSReactor;
+struct VSReactorConn;
+
 /* Default configuration file of verse server */
 #define DEFAULT_SERVER_CONFIG_FILE			"/etc/verse/server.ini"
 
@@ -63,6 +67,9 @@
 
 #define DATA_SEMAPHORE_NAME					"/vs_data_sem"
 
+/* Maximal number of data worker threads */
+#define MAX_DATA_WORKERS					64
+
 /**
  * States of Verse server
  */
@@ -97,9 +104,21 @@ typedef struct VSData {
 	struct VSNode		*user_node;					/* Pointer at parent of all user nodes (node_id=2) */
 	struct VSNode		*scene_node;				/* Pointer at parent of all scene nodes (node_id=3) */
 	/* Thread staff */
-	pthread_mutex_t		mutex;						/* Connection threads needs create avatar nodes occasionally */
+	pthread_rwlock_t	lock;						/* Read lock for commands of one node, write lock for
+													   changes of node tree (connection threads needs
+													   create avatar nodes occasionally) */
 	sem_t				*sem;						/* Semaphore used for notification data thread (some data were added to the queue) */
 	char				*sem_name;					/* The name of named semaphore */
+	struct VSessionReadyList	ready_sessions;		/* Sessions with commands in incoming queue */
+	/* Statistics of data thread */
+	uint64				wakeups;					/* Number of data thread wakeups with some ready sessions */
+	uint64				visited_sessions;			/* Number of sessions visited by data thread */
+	/* Data worker threads */
+	unsigned short		worker_count;				/* Number of data worker threads (0 = commands are handled by data thread) */
+	struct VSDataWorker	*workers;					/* Array of data worker threads */
+	pthread_mutex_t		workers_mutex;				/* Mutex protecting counter of pending commands */
+	pthread_cond_t		workers_idle;				/* Condition signaled, when all workers are idle */
+	unsigned int		pending_cmds;				/* Number of commands dispatched to workers and not handled yet */
 } VSData;
 
 /* Verse Server Context */
@@ -122,11 +141,26 @@ typedef struct VS_CTX {
 	unsigned short 		connected_clients;			/* Number of connected clients */
 	struct VSession		**vsessions;				/* List of sessions and session with connection attempts */
 	unsigned int		in_queue_max_size;			/* Default value of max size of incoming queue */
+	unsigned char		in_queue_cmd_views;			/* Store received commands as views of received buffer */
 	unsigned int		out_queue_max_size;			/* Default value of max size of outgoing queue */
+	unsigned short		dgram_batch;				/* Maximal number of packets sent or received with one system call */
+	unsigned char		dgram_offload;				/* Send packets of same size in super-buffers (UDP GSO) */
+	unsigned char		dgram_pacing;				/* Pace payload packets (0 sends them at tick of FPS) */
 	/* Ports for connections */
 	unsigned short		port_low;					/* The lowest port number in port range */
 	unsigned short		port_high;					/* The highest port number in port range */
 	struct VS_Port		*port_list;					/* List of free ports used for communication with clients */
+	/* I/O threads */
+	unsigned char		reactor;					/* Connections are handled by I/O threads */
+	unsigned short		io_thread_count;			/* Number of I/O threads (0 = number of processors) */
+	struct VSReactor	*reactors;					/* Array of I/O threads */
+	pthread_mutex_t		reactor_mutex;				/* Mutex protecting counters of connections */
+	pthread_cond_t		reactor_cond;				/* Condition signaled, when connection is closed */
+	unsigned int		stream_frees;				/* Number of threads freeing closed stream connections */
+	unsigned short		shared_port;				/* UDP port shared by all datagram connections (0 = port per connection) */
+	struct VHashArrayBase	peers;					/* Connections at shared port hashed by address of client */
+	struct VSReactorConn	*pending_conns;			/* Connections at shared port waiting for first packet */
+	pthread_rwlock_t	peers_lock;					/* Lock protecting connections at shared port */
 	/* Data for packet receiving */
 	struct IO_CTX 		tcp_io_ctx;					/* Verse context for TCP connection attempts */
 	struct IO_CTX		ws_io_ctx;					/* Verse context for WebSocket connection attempts */
@@ -141,7 +175,7 @@ typedef struct VS_CTX {
 	char				*hostname;					/* Hostname  used for UDP connection and
 													   negotiated during authentication of users */
 	char				*ded;						/* String of Data Exchange Definition (Version, URL, etc.) */
-	unsigned char		cc_meth;					/* Allowed methods of Congestion Control */
+	unsigned char		cc_meth;					/* Allowed methods of Congestion Control (set of CC_MASK bits) */
 	unsigned char		fc_meth;					/* Allowed methods of Flow Control */
 	unsigned char		rwin_scale;					/* Scale of Flow Control Window */
 	unsigned char		cmd_cmpr;					/* Prefered command compression */
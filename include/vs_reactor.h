@@ -0,0 +1,84 @@
+/*
+ *
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ *
+ * Contributor(s): Jiri Hnidek <jiri.hnidek@tul.cz>.
+ *
+ */
+
+
+#ifndef VS_REACTOR_H_
+#define VS_REACTOR_H_
+
+#include <pthread.h>
+
+#include "verse_types.h"
+
+struct VS_CTX;
+struct VSession;
+struct vContext;
+struct VPacket;
+struct VDgramBatch;
+struct VSReactorConn;
+struct VSReactorStream;
+struct VSReactorPacket;
+
+/* Maximal number of I/O threads */
+#define MAX_IO_THREADS			64
+/* Maximal number of events handled at once by one I/O thread */
+#define IO_THREAD_MAX_EVENTS	64
+
+/**
+ * Data of epoll event
+ */
+typedef struct VSReactorHandle {
+	uint8					type;		/* Type of file descriptor */
+	struct VSReactorConn	*conn;		/* Connection of this file descriptor (NULL for shared socket) */
+	struct VSReactorStream	*stream;	/* Stream connection of this file descriptor */
+} VSReactorHandle;
+
+/**
+ * I/O thread multiplexing stream and datagram connections of many sessions
+ */
+typedef struct VSReactor {
+	struct VS_CTX			*vs_ctx;
+	pthread_t				thread;
+	int						epoll_fd;		/* Descriptor of epoll instance */
+	struct VSReactorConn	*conns;			/* List of connections handled by this thread */
+	uint32					conn_count;		/* Number of connections handled by this thread */
+	struct VSReactorStream	*streams;		/* List of stream connections handled by this thread */
+	uint32					stream_count;	/* Number of stream connections handled by this thread */
+	/* Shared port */
+	int						shared_fd;		/* Socket bound to shared port with SO_REUSEPORT (-1 = not used) */
+	int						event_fd;		/* Notification about packets forwarded from other I/O threads */
+	struct VSReactorHandle	shared;			/* Handle of shared socket */
+	struct VSReactorHandle	event;			/* Handle of event descriptor */
+	struct VDgramBatch		*recv_batch;	/* Buffers for packets received with one system call */
+	struct VPacket			*peek_packet;	/* Packet used for finding token in first packet of connection */
+	pthread_mutex_t			inbox_mutex;	/* Mutex protecting list of forwarded packets */
+	struct VSReactorPacket	*inbox_first, *inbox_last;	/* Packets forwarded from other I/O threads */
+} VSReactor;
+
+int vs_reactor_init(struct VS_CTX *vs_ctx);
+void vs_reactor_destroy(struct VS_CTX *vs_ctx);
+int vs_reactor_add_dgram_conn(struct vContext *C);
+void vs_reactor_wait_dgram_conn(struct VS_CTX *vs_ctx, struct VSession *vsession);
+int vs_reactor_add_stream_conn(struct vContext *C);
+
+#endif /* VS_REACTOR_H_ */
@@ -29,6 +29,10 @@
 
 void vs_destroy_stream_ctx(VS_CTX *vs_ctx);
 int vs_init_stream_ctx(VS_CTX *vs_ctx);
+int vs_tcp_conn_init(struct vContext *C);
+void vs_tcp_conn_closing(struct vContext *C);
+void vs_tcp_conn_join_dgram(struct vContext *C);
+void vs_tcp_conn_free(struct vContext *C);
 void *vs_tcp_conn_loop(void *arg);
 int vs_main_listen_loop(VS_CTX *vs_ctx);
 
@@ -42,6 +42,12 @@ void vs_init_dgram_conn(struct VDgramConn *dgram_conn);
 void vs_destroy_vconn(struct VDgramConn *dgram_conn);
 int vs_handle_packet(struct vContext *C, int vs_STATE_handle_packet(struct vContext*C));
 int vs_send_packet(struct vContext *C);
+int vs_dgram_conn_init(struct vContext *C);
+int vs_dgram_conn_handle(struct vContext *C);
+int vs_dgram_conn_receive(struct vContext *C);
+int vs_dgram_conn_update(struct vContext *C);
+long int vs_dgram_conn_pacing_delay(struct vContext *C);
+void vs_dgram_conn_free(struct vContext *C);
 void *vs_main_dgram_loop(void *arg);
 void vs_close_dgram_conn(struct VDgramConn *dgram_conn);
 
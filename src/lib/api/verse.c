@@ -123,6 +123,82 @@ int vrs_set_client_info(char *name, char *version)
 	return ret;
 }
 
+/**
+ * \brief This function can enable receiving of packets coalesced by kernel
+ * (UDP GRO). It is used only by new unsecured datagram connections and only
+ * on systems, that support it.
+ * \param[in]	offload	The value 1 enables UDP GRO and value 0 disables it
+ */
+int vrs_set_dgram_offload(const uint8_t offload)
+{
+	vc_init_VC_CTX();
+
+	if(offload > 1) {
+		v_print_log(VRS_PRINT_ERROR, "Unsupported datagram offload: %d\n", offload);
+		return VRS_FAILURE;
+	}
+
+	vc_ctx->dgram_offload = offload;
+
+	return VRS_SUCCESS;
+}
+
+/**
+ * \brief This function can disable pacing of payload packets. Paced packets
+ * are spread over round-trip time according to congestion window. When
+ * pacing is disabled, then all packets allowed by windows are sent at once.
+ * It is used only by new datagram connections.
+ * \param[in]	pacing	The value 1 enables pacing and value 0 disables it
+ */
+int vrs_set_dgram_pacing(const uint8_t pacing)
+{
+	vc_init_VC_CTX();
+
+	if(pacing > 1) {
+		v_print_log(VRS_PRINT_ERROR, "Unsupported datagram pacing: %d\n", pacing);
+		return VRS_FAILURE;
+	}
+
+	vc_ctx->dgram_pacing = pacing;
+
+	return VRS_SUCCESS;
+}
+
+/**
+ * \brief This function returns smoothed round-trip time and current
+ * retransmission timeout of datagram connection with verse server.
+ * \param[in]	session_id	The ID of session with verse server.
+ * \param[out]	*srtt		The smoothed round-trip time in microseconds.
+ * \param[out]	*rto		The retransmission timeout in microseconds.
+ */
+int vrs_get_rto(const uint8_t session_id, uint32_t *srtt, uint32_t *rto)
+{
+	int i;
+
+	if(vc_ctx == NULL) {
+		if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "Basic callback functions were not set.\n");
+		return VRS_NO_CB_FUNC;
+	}
+
+	for(i=0; i<vc_ctx->max_sessions; i++) {
+		if(vc_ctx->vsessions[i] != NULL &&
+				vc_ctx->vsessions[i]->session_id == session_id &&
+				vc_ctx->vsessions[i]->dgram_conn != NULL)
+		{
+			if(srtt != NULL) {
+				*srtt = vc_ctx->vsessions[i]->dgram_conn->srtt;
+			}
+			if(rto != NULL) {
+				*rto = vc_ctx->vsessions[i]->dgram_conn->rto;
+			}
+			return VRS_SUCCESS;
+		}
+	}
+
+	v_print_log(VRS_PRINT_ERROR, "Invalid session_id: %d.\n", session_id);
+	return VRS_FAILURE;
+}
+
 /**
  * \brief This function tries to negotiate new FPS with server
  *
@@ -1240,6 +1316,13 @@ int vrs_send_connect_request(const char *hostname,
 	}
 #endif
 
+	/* Check consistency of congestion control flags */
+	if((_flags & VRS_CC_NONE) && (_flags & VRS_CC_CUBIC)) {
+		if(is_log_level(VRS_PRINT_ERROR))
+			v_print_log(VRS_PRINT_ERROR, "VRS_CC_NONE or VRS_CC_CUBIC could be set, not both.\n");
+		return VRS_FAILURE;
+	}
+
 	/* Set transport protocol */
 	if((_flags & VRS_TP_UDP) && (_flags & VRS_TP_TCP)) {
 		if(is_log_level(VRS_PRINT_ERROR))
@@ -1366,6 +1449,10 @@ int vrs_callback_update(const uint8_t session_id)
 				/* Pop all incoming commands from queue */
 				while(v_in_queue_cmd_count(vc_ctx->vsessions[i]->in_queue) > 0) {
 					cmd = v_in_queue_pop(vc_ctx->vsessions[i]->in_queue);
+					/* Command is still added by connection thread */
+					if(cmd == NULL) {
+						break;
+					}
 
 					vc_call_callback_func(session_id, cmd);
 
@@ -1475,7 +1562,7 @@ static int vc_send_command(const uint8 session_id,
 
 	if(vc_ctx == NULL) {
 		if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "Basic callback functions were not set.\n");
-		free(cmd);
+		v_cmd_destroy(&cmd);
 		return VRS_NO_CB_FUNC;
 	} else {
 		/* Go through all sessions ... */
@@ -1492,7 +1579,7 @@ static int vc_send_command(const uint8 session_id,
 	}
 
 	if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "Session %d does not exist.\n", session_id);
-	free(cmd);
+	v_cmd_destroy(&cmd);
 	return VRS_FAILURE;
 }
 
@@ -148,6 +148,8 @@ void vc_load_config_file(VC_CTX *ctx)
 	ctx->print_log_level = VRS_PRINT_NONE;	/* Client will print all messages to log file */
 	ctx->log_file = stdout;					/* Use stdout for log file */
 	ctx->rwin_scale = 0;					/* RWIN is multiple of 128B */
+	ctx->dgram_offload = 0;					/* Packets are not coalesced by kernel */
+	ctx->dgram_pacing = 1;					/* Payload packets are paced */
 	ctx->ca_path = strdup("/etc/pki/tls/certs/");	/* Default directory with CA certificates */
 }
 
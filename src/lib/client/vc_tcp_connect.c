@@ -65,6 +65,7 @@ extern void usleep(unsigned __int64 ticks);
 #include "vc_udp_connect.h"
 
 #include "v_common.h"
+#include "v_commands.h"
 #include "v_fake_commands.h"
 #include "v_pack.h"
 #include "v_unpack.h"
@@ -107,7 +108,7 @@ static int vc_get_username_passwd(struct VSession *vsession,
 				free(cmd);
 				return 0;
 			default:
-				free(cmd);
+				v_cmd_destroy(&cmd);
 				v_print_log(VRS_PRINT_DEBUG_MSG, "This command is not accepted during NEGOTIATE state\n");
 				break;
 			}
@@ -241,13 +241,12 @@ static int vc_REQUEST_CONFIRM_L_cb(struct vContext *C, struct Generic_Cmd *cmd)
 
 	/* Server should confirm client proposal of Congestion Control (local) */
 	if(confirm_l_cmd->feature == FTR_CC_ID) {
-		/* TODO: better implementation */
 		if(confirm_l_cmd->count == 1 &&	/* Any confirm command has to include only one value */
-				confirm_l_cmd->value[0].uint8 == CC_NONE) {	/* list of supported methods */
+				v_cc_get_ops(confirm_l_cmd->value[0].uint8) != NULL) {	/* list of supported methods */
 			v_print_log(VRS_PRINT_DEBUG_MSG,
 					"Local Congestion Control ID: %d confirmed\n",
 					confirm_l_cmd->value[0].uint8);
-			dgram_conn->cc_meth = CC_NONE;
+			dgram_conn->cc_meth = confirm_l_cmd->value[0].uint8;
 			return 1;
 		} else {
 			v_print_log(VRS_PRINT_ERROR, "Unsupported Congestion Control\n");
@@ -293,6 +292,20 @@ static int vc_REQUEST_CONFIRM_L_cb(struct vContext *C, struct Generic_Cmd *cmd)
 		}
 	}
 
+	/* Server should confirm, that it accepts padded PMTU probes. Probes are
+	 * not sent to old servers, that do not know this feature. */
+	if(confirm_l_cmd->feature == FTR_PMTU_PROBE) {
+		if(confirm_l_cmd->count == 1 &&
+				(confirm_l_cmd->value[0].uint8 == PMTU_PROBE_NONE ||
+				confirm_l_cmd->value[0].uint8 == PMTU_PROBE_PADDED))
+		{
+			v_print_log(VRS_PRINT_DEBUG_MSG, "Local PMTU probes: %d confirmed\n",
+					confirm_l_cmd->value[0].uint8);
+			dgram_conn->host_pmtu_probe = confirm_l_cmd->value[0].uint8;
+		}
+		return 1;
+	}
+
 	/* Ignore unknown feature */
 	return 1;
 }
@@ -308,13 +321,12 @@ static int vc_REQUEST_CONFIRM_R_cb(struct vContext *C, struct Generic_Cmd *cmd)
 
 	/* Server should confirm client proposal of Congestion Control (remote) */
 	if(confirm_r_cmd->feature == FTR_CC_ID) {
-		/* TODO: better implementation */
 		if(confirm_r_cmd->count == 1 &&	/* Any confirm command has to include only one value */
-				confirm_r_cmd->value[0].uint8 == CC_NONE) /* "List" of supported methods */
+				v_cc_get_ops(confirm_r_cmd->value[0].uint8) != NULL) /* List of supported methods */
 		{
 			v_print_log(VRS_PRINT_DEBUG_MSG, "Remote Congestion Control ID: %d confirmed\n",
 					confirm_r_cmd->value[0].uint8);
-			dgram_conn->cc_meth = CC_NONE;
+			dgram_conn->cc_meth = confirm_r_cmd->value[0].uint8;
 			return 1;
 		} else {
 			v_print_log(VRS_PRINT_ERROR, "Unsupported Congestion Control\n");
@@ -339,6 +351,19 @@ static int vc_REQUEST_CONFIRM_R_cb(struct vContext *C, struct Generic_Cmd *cmd)
 		}
 	}
 
+	/* Server should confirm, that it will send padded PMTU probes */
+	if(confirm_r_cmd->feature == FTR_PMTU_PROBE) {
+		if(confirm_r_cmd->count == 1 &&
+				(confirm_r_cmd->value[0].uint8 == PMTU_PROBE_NONE ||
+				confirm_r_cmd->value[0].uint8 == PMTU_PROBE_PADDED))
+		{
+			v_print_log(VRS_PRINT_DEBUG_MSG, "Remote PMTU probes: %d confirmed\n",
+					confirm_r_cmd->value[0].uint8);
+			dgram_conn->peer_pmtu_probe = confirm_r_cmd->value[0].uint8;
+		}
+		return 1;
+	}
+
 	return 1;
 }
 
@@ -350,8 +375,11 @@ void vc_REQUEST_init_send_packet(struct vContext *C)
 	struct VPacket *s_packet = CTX_s_packet(C);
 	int cmd_rank = 0;
 	static const uint8 cc_none = CC_NONE,
+			cc_cubic = CC_CUBIC,
+			cc_bbr = CC_BBR,
 			cmpr_none = CMPR_NONE,
-			cmpr_addr_share = CMPR_ADDR_SHARE;
+			cmpr_addr_share = CMPR_ADDR_SHARE,
+			pmtu_probe_padded = PMTU_PROBE_PADDED;
 
 	/* Verse packet header */
 	s_packet->header.version = 1;
@@ -368,13 +396,26 @@ void vc_REQUEST_init_send_packet(struct vContext *C)
 				CMD_CHANGE_L_ID, FTR_TOKEN, vsession->host_token.str, NULL);
 	}
 
-	/* Add CC (local) proposal */
-	cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
-			CMD_CHANGE_L_ID, FTR_CC_ID, &cc_none, NULL);
-
-	/* Add CC (remote) proposal */
-	cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
-			CMD_CHANGE_R_ID, FTR_CC_ID, &cc_none, NULL);
+	/* Add CC (local and remote) proposals. Methods are sorted by preference
+	 * of client and CC_NONE is proposed for servers without Congestion
+	 * Control. BBR is preferred by default and CUBIC is preferred, when
+	 * VRS_CC_CUBIC is set. */
+	if(vsession->flags & VRS_CC_NONE) {
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CHANGE_L_ID, FTR_CC_ID, &cc_none, NULL);
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CHANGE_R_ID, FTR_CC_ID, &cc_none, NULL);
+	} else if(vsession->flags & VRS_CC_CUBIC) {
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CHANGE_L_ID, FTR_CC_ID, &cc_cubic, &cc_bbr, &cc_none, NULL);
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CHANGE_R_ID, FTR_CC_ID, &cc_cubic, &cc_bbr, &cc_none, NULL);
+	} else {
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CHANGE_L_ID, FTR_CC_ID, &cc_bbr, &cc_cubic, &cc_none, NULL);
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CHANGE_R_ID, FTR_CC_ID, &cc_bbr, &cc_cubic, &cc_none, NULL);
+	}
 
 	/* Add Scale Window proposal */
 	cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
@@ -396,6 +437,14 @@ void vc_REQUEST_init_send_packet(struct vContext *C)
 		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
 				CMD_CHANGE_R_ID, FTR_CMD_COMPRESS, &cmpr_addr_share, NULL);
 	}
+
+	/* Add proposal of PMTU probes padded with reserved command ID. Client
+	 * wants to send them (local proposal) and it is able to receive them
+	 * (remote proposal). */
+	cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+			CMD_CHANGE_L_ID, FTR_PMTU_PROBE, &pmtu_probe_padded, NULL);
+	cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+			CMD_CHANGE_R_ID, FTR_PMTU_PROBE, &pmtu_probe_padded, NULL);
 }
 
 /**
@@ -671,9 +720,9 @@ int vc_OPEN_handle_packet(struct vContext *C)
 
 int vc_OPEN_loop(struct vContext *C)
 {
+	struct VC_CTX *vc_ctx = CTX_client_ctx(C);
 	struct VDgramConn *dgram_conn = CTX_current_dgram_conn(C);
 	struct VPacket *r_packet = CTX_r_packet(C);
-	struct Ack_Nak_Cmd ack_cmd;
 	int ret;
 
 	/* OPEN state */
@@ -683,15 +732,27 @@ int vc_OPEN_loop(struct vContext *C)
 		printf("%c[%dm", 27, 0);
 	}
 
-	/* Add ACK command to the list of ACK NAK commands to be send to the peer */
-	ack_cmd.id = CMD_ACK_ID;
-	ack_cmd.pay_id = r_packet->header.payload_id;
-	v_ack_nak_history_add_cmd(&dgram_conn->ack_nak, &ack_cmd);
+	/* Add ID of received packet to the list of ACK NAK commands to be send
+	 * to the peer */
+	v_ack_nak_history_add_id(&dgram_conn->ack_nak, r_packet->header.payload_id);
 
 	/* Receiving of last packet in previous packet had to be successful, because
 	 * client is in this state now :-). */
 	ret = RECEIVE_PACKET_SUCCESS;
 
+	/* Payload packets are paced or sent, when windows allow it */
+	dgram_conn->cc.pacing = vc_ctx->dgram_pacing;
+
+	/* Search for bigger MTU, when path allows it and server confirmed, that
+	 * it accepts padded probes */
+	v_pmtud_init(dgram_conn, (dgram_conn->host_pmtu_probe == PMTU_PROBE_PADDED) ?
+			v_dgram_pmtud_enable(&dgram_conn->io_ctx) : 0);
+
+	/* Bulk data sent by server could be received in super-buffers */
+	if(vc_ctx->dgram_offload == 1) {
+		v_dgram_gro_enable(&dgram_conn->io_ctx);
+	}
+
 	while(dgram_conn->host_state == UDP_CLIENT_STATE_OPEN) {
 
 		dgram_conn->state[UDP_CLIENT_STATE_OPEN].attempts++;
@@ -852,7 +913,7 @@ int vc_receive_and_handle_packet(struct vContext *C, int handle_packet(struct vC
 	struct IO_CTX *io_ctx = CTX_io_ctx(C);
 	struct VPacket *r_packet = CTX_r_packet(C);
 	int ret, error_num;
-	long int sec = 0, usec = 0;
+	long int sec = 0, usec = 0, pacing_delay;
 	fd_set set;
 	struct timeval tv;
 
@@ -870,6 +931,11 @@ int vc_receive_and_handle_packet(struct vContext *C, int handle_packet(struct vC
 		case UDP_CLIENT_STATE_OPEN:
 			sec = 0;
 			usec = 10000;
+			/* Wake up earlier, when pacer holds next payload packet */
+			pacing_delay = pacing_delay_in_OPEN_CLOSEREQ_state(C);
+			if(pacing_delay >= 0 && pacing_delay < usec) {
+				usec = pacing_delay;
+			}
 			break;
 	}
 
@@ -877,8 +943,11 @@ int vc_receive_and_handle_packet(struct vContext *C, int handle_packet(struct vC
 	tv.tv_sec = sec;
 	tv.tv_usec = usec;
 
-	/* Wait on response from server */
-	if( (ret = select(io_ctx->sockfd+1, &set, NULL, NULL, &tv)) == -1 ) {
+	/* Wait on response from server, when there is no packet received in
+	 * super-buffer yet */
+	if(v_dgram_gro_pending(io_ctx) == 1) {
+		ret = 1;
+	} else if( (ret = select(io_ctx->sockfd+1, &set, NULL, NULL, &tv)) == -1 ) {
 		if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "%s:%s():%d select(): %s\n", __FILE__, __FUNCTION__,  __LINE__, strerror(errno));
 		return RECEIVE_PACKET_ERROR;
 	}
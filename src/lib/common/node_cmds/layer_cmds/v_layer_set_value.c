@@ -63,8 +63,7 @@ struct Generic_Cmd *v_layer_set_value_create(const uint32 node_id,
 	/* Tricky part :-) */
 	cmd_id = CMD_LAYER_SET_UINT8 + 4*(data_type-1) + (count-1);
 
-	layer_set = (struct Generic_Cmd *)malloc(UINT8_SIZE +
-			cmd_struct[cmd_id].size);
+	layer_set = v_cmd_alloc(cmd_id);
 
 	if(layer_set == NULL) {
 		v_print_log(VRS_PRINT_ERROR, "Out of memory\n");
@@ -70,7 +70,7 @@ struct Generic_Cmd *v_layer_subscribe_create(const uint32 node_id,
 		const uint32 crc32)
 {
 	struct Generic_Cmd *layer_subscribe = NULL;
-	layer_subscribe = (struct Generic_Cmd *)malloc(UINT8_SIZE + cmd_struct[CMD_LAYER_SUBSCRIBE].size);
+	layer_subscribe = v_cmd_alloc(CMD_LAYER_SUBSCRIBE);
 	_v_layer_subscribe_init(layer_subscribe, node_id, layer_id, version, crc32);
 	return layer_subscribe;
 }
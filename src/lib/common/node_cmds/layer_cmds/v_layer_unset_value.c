@@ -67,7 +67,7 @@ struct Generic_Cmd *v_layer_unset_value_create(const uint32 node_id,
 		const uint32 item_id)
 {
 	struct Generic_Cmd *layer_subscribe = NULL;
-	layer_subscribe = (struct Generic_Cmd *)malloc(UINT8_SIZE + cmd_struct[CMD_LAYER_UNSET_VALUE].size);
+	layer_subscribe = v_cmd_alloc(CMD_LAYER_UNSET_VALUE);
 	_v_layer_unset_value_init(layer_subscribe, node_id, layer_id, item_id);
 	return layer_subscribe;
 }
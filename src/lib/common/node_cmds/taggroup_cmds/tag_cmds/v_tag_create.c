@@ -75,7 +75,7 @@ struct Generic_Cmd *v_tag_create_create(const uint32 node_id,
 		const uint16 type)
 {
 	struct Generic_Cmd *tag_create = NULL;
-	tag_create = (struct Generic_Cmd *)malloc(UINT8_SIZE + cmd_struct[CMD_TAG_CREATE].size);
+	tag_create = v_cmd_alloc(CMD_TAG_CREATE);
 	_v_tag_create_init(tag_create, node_id, taggroup_id, tag_id, data_type, count, type);
 	return tag_create;
 }
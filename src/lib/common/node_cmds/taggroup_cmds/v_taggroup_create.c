@@ -67,7 +67,7 @@ struct Generic_Cmd *v_taggroup_create_create(const uint32 node_id,
 		const uint16 type)
 {
 	struct Generic_Cmd *taggroup_create = NULL;
-	taggroup_create = (struct Generic_Cmd *)malloc(UINT8_SIZE + cmd_struct[CMD_TAGGROUP_CREATE].size);
+	taggroup_create = v_cmd_alloc(CMD_TAGGROUP_CREATE);
 	_v_taggroup_create_init(taggroup_create, node_id, taggroup_id, type);
 	return taggroup_create;
 }
@@ -61,7 +61,7 @@ struct Generic_Cmd *v_taggroup_destroy_create(uint32 node_id,
 		uint16 taggroup_id)
 {
 	struct Generic_Cmd *taggroup_destroy = NULL;
-	taggroup_destroy = (struct Generic_Cmd*)malloc(UINT8_SIZE + cmd_struct[CMD_TAGGROUP_DESTROY].size);
+	taggroup_destroy = v_cmd_alloc(CMD_TAGGROUP_DESTROY);
 	_v_taggroup_destroy_init(taggroup_destroy, node_id, taggroup_id);
 	return taggroup_destroy;
 }
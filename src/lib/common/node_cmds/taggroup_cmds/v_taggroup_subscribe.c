@@ -67,7 +67,7 @@ struct Generic_Cmd *v_taggroup_subscribe_create(uint32 node_id,
 		uint32 crc32)
 {
 	struct Generic_Cmd *taggroup_subscribe = NULL;
-	taggroup_subscribe = (struct Generic_Cmd*)malloc(UINT8_SIZE + cmd_struct[CMD_TAGGROUP_SUBSCRIBE].size);
+	taggroup_subscribe = v_cmd_alloc(CMD_TAGGROUP_SUBSCRIBE);
 	_v_taggroup_subscribe_init(taggroup_subscribe, node_id, taggroup_id, version, crc32);
 	return taggroup_subscribe;
 }
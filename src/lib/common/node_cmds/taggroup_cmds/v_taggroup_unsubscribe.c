@@ -67,7 +67,7 @@ struct Generic_Cmd *v_taggroup_unsubscribe_create(uint32 node_id,
 		uint32 crc32)
 {
 	struct Generic_Cmd *taggroup_unsubscribe = NULL;
-	taggroup_unsubscribe = (struct Generic_Cmd*)malloc(UINT8_SIZE + cmd_struct[CMD_TAGGROUP_UNSUBSCRIBE].size);
+	taggroup_unsubscribe = v_cmd_alloc(CMD_TAGGROUP_UNSUBSCRIBE);
 	_v_taggroup_unsubscribe_init(taggroup_unsubscribe, node_id, taggroup_id, version, crc32);
 	return taggroup_unsubscribe;
 }
@@ -61,7 +61,7 @@ static void _v_node_destroy_init(struct Generic_Cmd *node_destroy,
 struct Generic_Cmd *v_node_destroy_create(uint32 node_id)
 {
 	struct Generic_Cmd *node_destroy = NULL;
-	node_destroy = (struct Generic_Cmd*)malloc(UINT8_SIZE + cmd_struct[CMD_NODE_DESTROY].size);
+	node_destroy = v_cmd_alloc(CMD_NODE_DESTROY);
 	_v_node_destroy_init(node_destroy, node_id);
 	return node_destroy;
 }
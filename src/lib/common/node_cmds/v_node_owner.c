@@ -61,7 +61,7 @@ static void _v_node_owner_init(struct Generic_Cmd *node_owner,
 struct Generic_Cmd *v_node_owner_create(uint32 node_id, uint16 user_id)
 {
 	struct Generic_Cmd *node_owner = NULL;
-	node_owner = (struct Generic_Cmd*)malloc(UINT8_SIZE + cmd_struct[CMD_NODE_OWNER].size);
+	node_owner = v_cmd_alloc(CMD_NODE_OWNER);
 	_v_node_owner_init(node_owner, node_id, user_id);
 	return node_owner;
 }
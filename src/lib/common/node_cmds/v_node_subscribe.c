@@ -66,7 +66,7 @@ struct Generic_Cmd *v_node_subscribe_create(uint32 node_id,
 		uint32 crc32)
 {
 	struct Generic_Cmd *node_subscribe = NULL;
-	node_subscribe = (struct Generic_Cmd *)malloc(UINT8_SIZE + cmd_struct[CMD_NODE_SUBSCRIBE].size);
+	node_subscribe = v_cmd_alloc(CMD_NODE_SUBSCRIBE);
 	_v_node_subscribe_init(node_subscribe, node_id, version, crc32);
 	return node_subscribe;
 }
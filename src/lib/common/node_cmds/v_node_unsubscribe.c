@@ -66,7 +66,7 @@ struct Generic_Cmd *v_node_unsubscribe_create(uint32 node_id,
 		const uint32 crc32)
 {
 	struct Generic_Cmd *node_unsubscribe = NULL;
-	node_unsubscribe = (struct Generic_Cmd *)malloc(UINT8_SIZE + cmd_struct[CMD_NODE_UNSUBSCRIBE].size);
+	node_unsubscribe = v_cmd_alloc(CMD_NODE_UNSUBSCRIBE);
 	_v_node_unsubscribe_init(node_unsubscribe, node_id, version, crc32);
 	return node_unsubscribe;
 }
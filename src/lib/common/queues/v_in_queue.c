@@ -34,101 +34,527 @@
  */
 
 #include <assert.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "v_in_queue.h"
 #include "v_cmd_queue.h"
+#include "v_cmd_codec.h"
 #include "v_common.h"
+#include "v_atomic.h"
+#include "v_pool.h"
+
+extern const struct Cmd_Struct cmd_struct[];
+
+/**
+ * \brief This function creates copy of received node commands, that could be
+ * shared by views of commands
+ */
+struct VRecvBuffer *v_in_queue_rbuf_create(const char *data, const uint16 size)
+{
+	struct VRecvBuffer *rbuf;
+
+	rbuf = (struct VRecvBuffer*)v_pool_alloc(offsetof(struct VRecvBuffer, data) + size);
+
+	if(rbuf != NULL) {
+		rbuf->refcount = 1;
+		rbuf->size = size;
+		memcpy(rbuf->data, data, size);
+	}
+
+	return rbuf;
+}
+
+/**
+ * \brief This function drops one reference at received buffer.
+ */
+static void _v_in_queue_rbuf_release(struct VRecvBuffer *rbuf)
+{
+	if(V_ATOMIC_DEC(&rbuf->refcount) == 0) {
+		v_pool_free(rbuf, offsetof(struct VRecvBuffer, data) + rbuf->size);
+	}
+}
+
+/**
+ * \brief This function drops reference at received buffer, that was created
+ * during unpacking of received packet.
+ */
+void v_in_queue_rbuf_release(struct VInQueue *in_queue, struct VRecvBuffer *rbuf)
+{
+	(void)in_queue;
+	_v_in_queue_rbuf_release(rbuf);
+}
+
+/**
+ * \brief This function unpacks command from the view of received buffer.
+ * When address of command is shared with previous command, then address is
+ * unpacked from the first command in received buffer.
+ */
+static void _v_in_queue_view_unpack(const struct VInQueueView *view,
+		struct Generic_Cmd *cmd)
+{
+	if(view->skip_items > 0) {
+		v_cmd_codec_unpack((char*)&view->rbuf->data[view->addr], cmd, 0);
+	}
+	v_cmd_codec_unpack((char*)&view->rbuf->data[view->offset], cmd, view->skip_items);
+}
+
+/**
+ * \brief This function returns size of slot for command, that replaces older
+ * command with the same address. Such slot includes copy of the address.
+ */
+static size_t _v_in_queue_keyed_slot_size(const struct VCommandQueue *cmd_queue)
+{
+	size_t size = offsetof(struct VInQueueCommand, key) +
+			cmd_queue->cmds.key_offset + cmd_queue->cmds.key_size;
+
+	return (size > sizeof(struct VInQueueCommand)) ? size : sizeof(struct VInQueueCommand);
+}
+
+/**
+ * \brief This function returns size of slot popped from the queue
+ */
+static size_t _v_in_queue_slot_size(const struct VInQueue *in_queue,
+		const struct VInQueueCommand *queue_cmd)
+{
+	const struct VCommandQueue *cmd_queue = in_queue->cmds[queue_cmd->id];
+
+	if(cmd_queue->flag & REMOVE_HASH_DUPS) {
+		return _v_in_queue_keyed_slot_size(cmd_queue);
+	}
+
+	return sizeof(struct VInQueueCommand);
+}
+
+/**
+ * \brief This function returns view of command stored in the slot or NULL,
+ * when data of slot is unpacked command.
+ */
+static struct VInQueueView *_v_in_queue_slot_view(struct VInQueueCommand *queue_cmd,
+		void *data)
+{
+	if(data == (void*)&queue_cmd->views[0] || data == (void*)&queue_cmd->views[1]) {
+		return (struct VInQueueView*)data;
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief This function releases command or view replaced in the slot
+ */
+static void _v_in_queue_slot_release(struct VInQueueCommand *queue_cmd,
+		void *data)
+{
+	struct VInQueueView *view = _v_in_queue_slot_view(queue_cmd, data);
+	struct Generic_Cmd *cmd;
+
+	if(view != NULL) {
+		_v_in_queue_rbuf_release(view->rbuf);
+	} else {
+		cmd = (struct Generic_Cmd*)data;
+		v_cmd_destroy(&cmd);
+	}
+}
+
+/**
+ * \brief This function adds slot to the tail of lock-free list. It could be
+ * called by many producers at once.
+ */
+static void _v_in_queue_link(struct VInQueue *in_queue,
+		struct VInQueueCommand *queue_cmd)
+{
+	struct VInQueueCommand *prev;
+
+	queue_cmd->next = NULL;
+	prev = (struct VInQueueCommand*)V_ATOMIC_XCHG_PTR(&in_queue->tail, queue_cmd);
+	/* Consumer could not see slots added after queue_cmd until this
+	 * assignment */
+	prev->next = queue_cmd;
+}
+
+/**
+ * \brief This function removes slot from the head of lock-free list. It
+ * could be called only by one consumer.
+ * \return This function returns NULL, when list is empty or when some
+ * producer did not finish adding of slot yet.
+ */
+static struct VInQueueCommand *_v_in_queue_unlink(struct VInQueue *in_queue)
+{
+	struct VInQueueCommand *head = in_queue->head;
+	struct VInQueueCommand *next = head->next;
+
+	if(head == &in_queue->stub) {
+		if(next == NULL) {
+			return NULL;
+		}
+		in_queue->head = next;
+		head = next;
+		next = next->next;
+	}
+
+	if(next == NULL) {
+		/* The last slot could be removed only, when stub is added after it */
+		if(in_queue->tail != head) {
+			return NULL;
+		}
+		_v_in_queue_link(in_queue, &in_queue->stub);
+		next = head->next;
+		if(next == NULL) {
+			return NULL;
+		}
+	}
+
+	in_queue->head = next;
+	V_BARRIER();
+
+	return head;
+}
+
+/**
+ * \brief This function adds popped slot to the list of slots, that have to
+ * be removed from hashed array by producers.
+ */
+static void _v_in_queue_retire(struct VInQueue *in_queue,
+		struct VInQueueCommand *queue_cmd)
+{
+	struct VInQueueCommand *retired;
+
+	do {
+		retired = in_queue->retired;
+		queue_cmd->retired_next = retired;
+	} while(!V_ATOMIC_CAS_PTR(&in_queue->retired, retired, queue_cmd));
+}
+
+/**
+ * \brief This function removes slots popped by consumer from hashed arrays
+ * and it frees them. Mutex of producers has to be locked.
+ */
+static void _v_in_queue_free_retired(struct VInQueue *in_queue)
+{
+	struct VInQueueCommand *queue_cmd, *next;
+	struct VCommandQueue *cmd_queue;
+
+	if(in_queue->retired == NULL) {
+		return;
+	}
+
+	queue_cmd = (struct VInQueueCommand*)V_ATOMIC_XCHG_PTR(&in_queue->retired, NULL);
+
+	while(queue_cmd != NULL) {
+		next = queue_cmd->retired_next;
+		cmd_queue = in_queue->cmds[queue_cmd->id];
+		/* Slot could be already replaced with newer slot */
+		if(queue_cmd->vbucket != NULL) {
+			v_hash_array_remove_item(&cmd_queue->cmds, queue_cmd->key);
+		}
+		v_pool_free(queue_cmd, _v_in_queue_keyed_slot_size(cmd_queue));
+		queue_cmd = next;
+	}
+}
+
+/**
+ * \brief This function pop command from the queue for incoming commands.
+ * Command stored as view is unpacked to cmd_buf, when cmd_buf is not NULL.
+ * Otherwise new command is allocated for it. Only one thread could pop
+ * commands from the queue.
+ */
+static struct Generic_Cmd *_v_in_queue_pop(struct VInQueue *in_queue,
+		union VInQueueCmdBuf *cmd_buf)
+{
+	struct Generic_Cmd *cmd=NULL;
+	struct VInQueueCommand *queue_cmd;
+	struct VInQueueView *view;
+	void *data;
+	uint8 id;
+
+	queue_cmd = _v_in_queue_unlink(in_queue);
+
+	if(queue_cmd == NULL) {
+		return NULL;
+	}
+
+	id = queue_cmd->id;
+
+	if(in_queue->cmds[id]->flag & REMOVE_HASH_DUPS) {
+		/* Producers can not replace command in the slot since now */
+		data = V_ATOMIC_XCHG_PTR(&queue_cmd->data, NULL);
+	} else {
+		data = queue_cmd->data;
+	}
+
+	/* There should be some data */
+	assert(data!=NULL);
+
+	view = _v_in_queue_slot_view(queue_cmd, data);
+	if(view != NULL) {
+		if(cmd_buf != NULL) {
+			cmd = &cmd_buf->cmd;
+			cmd->id = id;
+		} else {
+			cmd = v_cmd_alloc(id);
+		}
+
+		_v_in_queue_view_unpack(view, cmd);
+		_v_in_queue_rbuf_release(view->rbuf);
+	} else {
+		cmd = (struct Generic_Cmd*)data;
+	}
+
+	if(in_queue->cmds[id]->flag & REMOVE_HASH_DUPS) {
+		_v_in_queue_retire(in_queue, queue_cmd);
+	} else {
+		v_pool_free(queue_cmd, sizeof(struct VInQueueCommand));
+	}
+
+	/* Update total count and size of commands */
+	V_ATOMIC_DEC(&in_queue->count);
+	V_ATOMIC_SUB(&in_queue->size, in_queue->cmds[id]->item_size);
+
+	return cmd;
+}
 
 /**
  * \brief This function pop command from the queue for incoming commands
  */
 struct Generic_Cmd *v_in_queue_pop(struct VInQueue *in_queue)
 {
-	struct Generic_Cmd *cmd=NULL;
+	return _v_in_queue_pop(in_queue, NULL);
+}
+
+/**
+ * \brief This function pop command from the queue for incoming commands.
+ * Command received as view is unpacked to the cmd_buf without any allocation.
+ * \return This function returns pointer at cmd_buf for such command, that
+ * must not be destroyed. Other commands has to be destroyed by caller.
+ */
+struct Generic_Cmd *v_in_queue_pop_buf(struct VInQueue *in_queue,
+		union VInQueueCmdBuf *cmd_buf)
+{
+	return _v_in_queue_pop(in_queue, cmd_buf);
+}
+
+/**
+ * \brief This function replaces command or view in the slot of command with
+ * the same address, when such slot is still waiting in the queue. Otherwise
+ * slot is removed from hashed array, because it was popped in the meantime.
+ * Mutex of producers has to be locked.
+ * \return This function returns 1, when data of slot were replaced.
+ */
+static int _v_in_queue_replace(struct VCommandQueue *cmd_queue,
+		struct VInQueueCommand *queue_cmd,
+		void *old_data,
+		void *data)
+{
+	/* Only consumer could change data in the slot to NULL */
+	if(old_data != NULL &&
+			V_ATOMIC_CAS_PTR(&queue_cmd->data, old_data, data))
+	{
+		/* Release original command or view */
+		_v_in_queue_slot_release(queue_cmd, old_data);
+		return 1;
+	}
+
+	/* Command was popped in the meantime, then new slot is needed and
+	 * this slot will be freed, when consumer retires it */
+	v_hash_array_remove_item(&cmd_queue->cmds, queue_cmd->key);
+	queue_cmd->vbucket = NULL;
+
+	return 0;
+}
+
+/**
+ * \brief This function adds new slot to the hashed array of producers and to
+ * the tail of queue. Mutex of producers has to be locked.
+ */
+static void _v_in_queue_add_keyed(struct VInQueue *in_queue,
+		struct VCommandQueue *cmd_queue,
+		struct VInQueueCommand *queue_cmd,
+		const struct Generic_Cmd *addr)
+{
+	uint16 key_size = cmd_queue->cmds.key_offset + cmd_queue->cmds.key_size;
+
+	memcpy(queue_cmd->key, addr, key_size);
+
+	/* Add copy of address to the hashed array of producers */
+	queue_cmd->vbucket = v_hash_array_add_item(&cmd_queue->cmds, queue_cmd->key, key_size);
+	if(queue_cmd->vbucket != NULL) {
+		queue_cmd->vbucket->ptr = (void*)queue_cmd;
+	}
+
+	/* Update count and size of queue */
+	V_ATOMIC_INC(&in_queue->count);
+	V_ATOMIC_ADD(&in_queue->size, cmd_queue->item_size);
+
+	/* Add own command to the tail of the queue */
+	_v_in_queue_link(in_queue, queue_cmd);
+}
+
+/**
+ * \brief This function push view of received command to the tail of queue
+ * for incoming commands. When duplicities of this command are not allowed,
+ * then only address of the command is unpacked and the view replaces older
+ * command or view with the same address in its slot. Other views are added
+ * without any lock.
+ */
+int v_in_queue_push_view(struct VInQueue *in_queue,
+		const uint8 id,
+		struct VRecvBuffer *rbuf,
+		const uint16 addr,
+		const uint16 offset,
+		const uint8 skip_items)
+{
+	struct VCommandQueue *cmd_queue = in_queue->cmds[id];
 	struct VInQueueCommand *queue_cmd;
+	struct VInQueueView view, *free_view;
+	union VInQueueCmdBuf addr_buf;
+	struct VBucket *vbucket;
+	void *old_data;
+
+	assert(UINT8_SIZE + cmd_struct[id].size <= IN_QUEUE_CMD_BUF_SIZE);
+
+	/* Command queue has to exist for this type of command */
+	assert(cmd_queue != NULL);
+
+	view.rbuf = rbuf;
+	view.addr = addr;
+	view.offset = offset;
+	view.skip_items = skip_items;
+
+	if(!(cmd_queue->flag & REMOVE_HASH_DUPS)) {
+		queue_cmd = (struct VInQueueCommand*)v_pool_calloc(sizeof(struct VInQueueCommand));
+		if(queue_cmd == NULL) {
+			return 0;
+		}
+
+		queue_cmd->id = id;
+		queue_cmd->views[0] = view;
+		queue_cmd->data = (void*)&queue_cmd->views[0];
+
+		V_ATOMIC_INC(&rbuf->refcount);
+
+		/* Update count and size of queue before command could be popped */
+		V_ATOMIC_INC(&in_queue->count);
+		V_ATOMIC_ADD(&in_queue->size, cmd_queue->item_size);
+
+		/* Add own command to the tail of the queue */
+		_v_in_queue_link(in_queue, queue_cmd);
+
+		return 1;
+	}
+
+	/* Address is unpacked to the stack only for searching in hashed array,
+	 * the command is still stored as view */
+	addr_buf.cmd.id = id;
+	_v_in_queue_view_unpack(&view, &addr_buf.cmd);
 
 	pthread_mutex_lock(&in_queue->lock);
 
-	queue_cmd = in_queue->queue.first;
+	_v_in_queue_free_retired(in_queue);
 
-	if(queue_cmd != NULL) {
-		cmd = (struct Generic_Cmd *)queue_cmd->vbucket->data;
+	V_ATOMIC_INC(&rbuf->refcount);
 
-		/* There should be some data */
-		assert(cmd!=NULL);
+	/* Try to find command with the same address */
+	vbucket = v_hash_array_find_item(&cmd_queue->cmds, (void*)&addr_buf.cmd);
+	if(vbucket != NULL) {
+		queue_cmd = (struct VInQueueCommand*)vbucket->ptr;
+		old_data = queue_cmd->data;
+		free_view = NULL;
 
-		/* Remove command from hashed linked list */
-		v_hash_array_remove_item(&in_queue->cmds[cmd->id]->cmds, (void*)cmd);
+		/* New view is written to the view, that is not used by the slot.
+		 * Consumer could read only view, that it removed from the slot. */
+		if(old_data != NULL) {
+			free_view = (old_data == (void*)&queue_cmd->views[0]) ?
+					&queue_cmd->views[1] : &queue_cmd->views[0];
+			*free_view = view;
+		}
 
-		/* Remove command from queue */
-		v_list_free_item(&in_queue->queue, queue_cmd);
+		if(_v_in_queue_replace(cmd_queue, queue_cmd, old_data, (void*)free_view) == 1) {
+			pthread_mutex_unlock(&in_queue->lock);
+			return 1;
+		}
+	}
 
-		/* Update total count and size of commands */
-		in_queue->count--;
-		in_queue->size -= in_queue->cmds[cmd->id]->item_size;
+	/* Create new slot in queue */
+	queue_cmd = (struct VInQueueCommand*)v_pool_calloc(_v_in_queue_keyed_slot_size(cmd_queue));
+	if(queue_cmd == NULL) {
+		_v_in_queue_rbuf_release(rbuf);
+		pthread_mutex_unlock(&in_queue->lock);
+		return 0;
 	}
 
+	queue_cmd->id = id;
+	queue_cmd->views[0] = view;
+	queue_cmd->data = (void*)&queue_cmd->views[0];
+
+	_v_in_queue_add_keyed(in_queue, cmd_queue, queue_cmd, &addr_buf.cmd);
+
 	pthread_mutex_unlock(&in_queue->lock);
 
-	return cmd;
+	return 1;
 }
 
 /**
  * \brief This function push incoming command to the tail of queue for
- * incoming commands
+ * incoming commands. When command with the same address is still waiting
+ * in the queue and duplicities are not allowed, then the command or view in
+ * its slot is replaced with new command atomically.
  */
 int v_in_queue_push(struct VInQueue *in_queue, struct Generic_Cmd *cmd)
 {
-	struct VBucket *vbucket = NULL;
-	int ret = 1;
-
-	/* Lock mutex */
-	pthread_mutex_lock(&in_queue->lock);
+	struct VCommandQueue *cmd_queue = in_queue->cmds[cmd->id];
+	struct VInQueueCommand *queue_cmd;
+	struct VBucket *vbucket;
 
 	/* Command queue has to exist for this type of command */
-	assert(in_queue->cmds[cmd->id] != NULL);
+	assert(cmd_queue != NULL);
 
-	/* Try to find command with the same address, when duplicities are not
-	 * allowed in command queue */
-	if( (in_queue->cmds[cmd->id]->flag & REMOVE_HASH_DUPS) &&
-		( vbucket = v_hash_array_find_item(&in_queue->cmds[cmd->id]->cmds, (void*)cmd) ) != NULL )
-	{
-		/* Bucket has to include not NULL pointer */
-		assert(vbucket->ptr!=NULL);
+	if(!(cmd_queue->flag & REMOVE_HASH_DUPS)) {
+		queue_cmd = (struct VInQueueCommand*)v_pool_calloc(sizeof(struct VInQueueCommand));
+		if(queue_cmd == NULL) {
+			return 0;
+		}
+		queue_cmd->id = cmd->id;
+		queue_cmd->data = (void*)cmd;
 
-		/* Debug print */
-#if 0
-		v_print_log(VRS_PRINT_DEBUG_MSG, "Replacing obsolete command with new\n");
-		v_cmd_print(VRS_PRINT_DEBUG_MSG, (struct Generic_Cmd*)vbucket->data);
-		v_cmd_print(VRS_PRINT_DEBUG_MSG, cmd);
-#endif
+		V_ATOMIC_INC(&in_queue->count);
+		V_ATOMIC_ADD(&in_queue->size, cmd_queue->item_size);
 
-		/* Destroy original command */
-		v_cmd_destroy((struct Generic_Cmd**)&vbucket->data);
+		_v_in_queue_link(in_queue, queue_cmd);
 
-		/* Replace current command with new data */
-		vbucket->data = (void*)cmd;
-	} else {
-		/* Create new command in queue */
-		struct VInQueueCommand *queue_cmd = (struct VInQueueCommand*)calloc(1, sizeof(struct VInQueueCommand));
+		return 1;
+	}
 
-		/* Add new command data */
-		queue_cmd->vbucket = v_hash_array_add_item(&in_queue->cmds[cmd->id]->cmds, cmd, in_queue->cmds[cmd->id]->item_size);
-		queue_cmd->vbucket->ptr = (void*)queue_cmd;
+	pthread_mutex_lock(&in_queue->lock);
 
-		/* Update count and size of queue */
-		in_queue->count++;
-		in_queue->size += in_queue->cmds[cmd->id]->item_size;
+	_v_in_queue_free_retired(in_queue);
 
-		/* Add own command to the tail of the queue */
-		v_list_add_tail(&in_queue->queue, queue_cmd);
+	/* Try to find command with the same address */
+	vbucket = v_hash_array_find_item(&cmd_queue->cmds, (void*)cmd);
+	if(vbucket != NULL) {
+		queue_cmd = (struct VInQueueCommand*)vbucket->ptr;
+		if(_v_in_queue_replace(cmd_queue, queue_cmd, queue_cmd->data, (void*)cmd) == 1) {
+			pthread_mutex_unlock(&in_queue->lock);
+			return 1;
+		}
 	}
-	/* Unlock mutex */
+
+	/* Create new command in queue */
+	queue_cmd = (struct VInQueueCommand*)v_pool_calloc(_v_in_queue_keyed_slot_size(cmd_queue));
+	if(queue_cmd == NULL) {
+		pthread_mutex_unlock(&in_queue->lock);
+		return 0;
+	}
+
+	queue_cmd->id = cmd->id;
+	queue_cmd->data = (void*)cmd;
+
+	_v_in_queue_add_keyed(in_queue, cmd_queue, queue_cmd, cmd);
+
 	pthread_mutex_unlock(&in_queue->lock);
 
-	return ret;
+	return 1;
 }
 
 /**
@@ -149,11 +575,15 @@ int v_in_queue_init(struct VInQueue *in_queue, int max_size)
 
 	in_queue->count = 0;
 	in_queue->size = 0;
+	in_queue->flags = 0;
 
 	in_queue->max_size = max_size;
 
-	in_queue->queue.first = NULL;
-	in_queue->queue.last = NULL;
+	/* Lock-free list always contains at least stub slot */
+	memset(&in_queue->stub, 0, sizeof(struct VInQueueCommand));
+	in_queue->head = &in_queue->stub;
+	in_queue->tail = &in_queue->stub;
+	in_queue->retired = NULL;
 
 	for(id=0; id<=MAX_CMD_ID; id++) {
 		in_queue->cmds[id] = v_cmd_queue_create(id, 0, 1);
@@ -184,14 +614,23 @@ struct VInQueue *v_in_queue_create(void)
  */
 void v_in_queue_destroy(struct VInQueue **in_queue)
 {
+	struct VInQueueCommand *queue_cmd;
 	int id;
 
 	pthread_mutex_lock(&(*in_queue)->lock);
 
+	/* Destroy commands and release buffers used by views of commands. No
+	 * producer could use the queue now. */
+	while((queue_cmd = _v_in_queue_unlink(*in_queue)) != NULL) {
+		_v_in_queue_slot_release(queue_cmd, queue_cmd->data);
+		v_pool_free(queue_cmd, _v_in_queue_slot_size(*in_queue, queue_cmd));
+	}
+
 	(*in_queue)->count = 0;
 	(*in_queue)->size = 0;
 
-	v_list_free(&(*in_queue)->queue);
+	/* Free slots popped before */
+	_v_in_queue_free_retired(*in_queue);
 
 	for(id=0; id<=MAX_CMD_ID; id++) {
 		if((*in_queue)->cmds[id] != NULL) {
@@ -214,25 +653,15 @@ void v_in_queue_destroy(struct VInQueue **in_queue)
  */
 uint32 v_in_queue_size(struct VInQueue *in_queue)
 {
-	uint32 size;
-
-	pthread_mutex_lock(&in_queue->lock);
-	size = in_queue->size;
-	pthread_mutex_unlock(&in_queue->lock);
-
-	return size;
+	return in_queue->size;
 }
 
 /**
- * \brief This function returns number of commands in queue
+ * \brief This function returns number of commands in queue. Commands, that
+ * are counted, could be still added by producers, thus v_in_queue_pop()
+ * could return NULL, even if this number is not zero.
  */
 uint32 v_in_queue_cmd_count(struct VInQueue *in_queue)
 {
-	uint32 count;
-
-	pthread_mutex_lock(&in_queue->lock);
-	count = in_queue->count;
-	pthread_mutex_unlock(&in_queue->lock);
-
-	return count;
+	return in_queue->count;
 }
@@ -44,26 +44,132 @@
 #include "v_out_queue.h"
 #include "v_cmd_queue.h"
 #include "v_common.h"
+#include "v_atomic.h"
+#include "v_pool.h"
 #include "v_commands.h"
 #include "v_fake_commands.h"
 #include "v_node_commands.h"
 
-static struct VPrioOutQueue * _v_out_prio_queue_create(real32 r_prio);
+static struct VPrioOutQueue * _v_out_prio_queue_create(uint32 quantum);
 static void _v_out_prio_queue_destroy(struct VPrioOutQueue *prio_queu);
+static void _v_out_queue_run_share(struct VOutQueueRun *run,
+		struct Generic_Cmd *cmd,
+		uint8 share);
+static uint16 _v_out_queue_run_len(struct VOutQueueRun *run, uint16 count);
+static uint16 _v_out_queue_run_count(struct VOutQueueRun *run, uint16 max_len);
+static void _v_out_queue_run_remove(struct VOutQueueCommand *queue_cmd);
 static void _v_out_queue_command_add(struct VPrioOutQueue *prio_queue,
 		uint8 flag,
 		uint8 share_addr,
 		struct VOutQueueCommand *queue_cmd,
 		struct Generic_Cmd *cmd);
 static struct VOutQueueCommand * _v_out_queue_command_create(struct VOutQueue *out_queue,
-		uint8 flag, uint8 prio, struct Generic_Cmd *cmd);
+		uint8 flag, uint8 prio, struct Generic_Cmd *cmd,
+		struct VOutQueueCommand *queue_cmd);
 static int _v_out_queue_push(struct VOutQueue *out_queue,
-		uint8 flag, uint8 prio,	struct Generic_Cmd *cmd);
+		uint8 flag, uint8 prio,	struct Generic_Cmd *cmd,
+		struct VOutQueueCommand *staged_cmd);
+static void _v_out_queue_merge(struct VOutQueue *out_queue);
+static int _v_out_queue_prio_below(struct VOutQueue *out_queue, int prio);
+static void _v_out_queue_prio_update(struct VOutQueue *out_queue, uint8 prio);
+
+/**
+ * \brief This function returns index of the most significant bit set in word
+ */
+static int _v_prio_map_msb(uint32 word)
+{
+#ifdef WIN32
+	int bit = 0;
+
+	while(word >>= 1) {
+		bit++;
+	}
+
+	return bit;
+#else
+	return 31 - __builtin_clz(word);
+#endif
+}
+
+/**
+ * \brief This function returns index of the least significant bit set in word
+ */
+static int _v_prio_map_lsb(uint32 word)
+{
+#ifdef WIN32
+	int bit = 0;
+
+	while(!(word & 1)) {
+		word >>= 1;
+		bit++;
+	}
+
+	return bit;
+#else
+	return __builtin_ctz(word);
+#endif
+}
+
+/**
+ * \brief This function returns the highest not empty priority queue, that is
+ * lower or equal to prio. It returns -1, when there is no such queue.
+ */
+static int _v_out_queue_prio_below(struct VOutQueue *out_queue, int prio)
+{
+	int i;
+	uint32 word;
+
+	if(prio < 0) {
+		return -1;
+	}
+
+	i = prio >> 5;
+	/* Mask bits of higher priorities in the first word */
+	word = out_queue->prio_map[i] & (0xFFFFFFFF >> (31 - (prio & 31)));
+
+	while(word == 0) {
+		if(--i < 0) {
+			return -1;
+		}
+		word = out_queue->prio_map[i];
+	}
+
+	return (i << 5) + _v_prio_map_msb(word);
+}
+
+/**
+ * \brief This function updates bitmap of not empty priority queues and
+ * maximal and minimal used priority. It has to be called, when count of
+ * commands in priority queue was changed.
+ */
+static void _v_out_queue_prio_update(struct VOutQueue *out_queue, uint8 prio)
+{
+	struct VPrioOutQueue *prio_queue = out_queue->queues[prio];
+	int i;
+
+	if(prio_queue->count > 0) {
+		out_queue->prio_map[prio >> 5] |= (1U << (prio & 31));
+	} else {
+		out_queue->prio_map[prio >> 5] &= ~(1U << (prio & 31));
+		/* Empty queue can not save deficit for following rounds */
+		prio_queue->deficit = 0;
+	}
+
+	i = _v_out_queue_prio_below(out_queue, MAX_PRIORITY);
+
+	if(i < 0) {
+		out_queue->max_prio = out_queue->min_prio = VRS_DEFAULT_PRIORITY;
+	} else {
+		out_queue->max_prio = (uint8)i;
+		for(i = 0; out_queue->prio_map[i] == 0; i++);
+		out_queue->min_prio = (uint8)((i << 5) + _v_prio_map_lsb(out_queue->prio_map[i]));
+	}
+}
 
 /**
  * \brief This function creates queue for commands with the priority
  */
-static struct VPrioOutQueue * _v_out_prio_queue_create(real32 r_prio)
+static struct VPrioOutQueue * _v_out_prio_queue_create(uint32 quantum)
 {
 	struct VPrioOutQueue *prio_queue = (struct VPrioOutQueue *)calloc(1, sizeof(struct VPrioOutQueue));
 
@@ -73,7 +179,8 @@ static struct VPrioOutQueue * _v_out_prio_queue_create(real32 r_prio)
 	prio_queue->count = 0;
 	prio_queue->size = 0;
 
-	prio_queue->r_prio = r_prio;
+	prio_queue->quantum = quantum;
+	prio_queue->deficit = 0;
 
 	return prio_queue;
 }
@@ -83,7 +190,83 @@ static struct VPrioOutQueue * _v_out_prio_queue_create(real32 r_prio)
  */
 static void _v_out_prio_queue_destroy(struct VPrioOutQueue *prio_queu)
 {
-	v_list_free(&prio_queu->cmds);
+	struct VOutQueueCommand *queue_cmd;
+
+	for(queue_cmd = prio_queu->cmds.first; queue_cmd != NULL; queue_cmd = queue_cmd->next) {
+		_v_out_queue_run_remove(queue_cmd);
+	}
+
+	v_pool_list_free(&prio_queu->cmds, sizeof(struct VOutQueueCommand));
+}
+
+/**
+ * \brief This function sets size of address shared by group of commands and
+ * lengths, that depend on this size
+ */
+static void _v_out_queue_run_share(struct VOutQueueRun *run,
+		struct Generic_Cmd *cmd,
+		uint8 share)
+{
+	run->share = share;
+	run->item_len = v_cmd_item_len(cmd, share);
+	run->hdr_len = v_cmds_len(cmd, 1, share, 0) - run->item_len;
+}
+
+/**
+ * \brief This function returns length of first count commands from the group
+ * compressed to one command
+ */
+static uint16 _v_out_queue_run_len(struct VOutQueueRun *run, uint16 count)
+{
+	uint32 len = run->hdr_len + count*run->item_len;
+
+	/* Length bigger then 254 is coded with: 0xFF(1B), Length(2B) */
+	return (len < 0xFF) ? len : len + UINT16_SIZE;
+}
+
+/**
+ * \brief This function returns count of commands from the beginning of the
+ * group, that could be compressed to the buffer with length max_len
+ */
+static uint16 _v_out_queue_run_count(struct VOutQueueRun *run, uint16 max_len)
+{
+	uint32 count, short_count;
+
+	if(max_len < run->hdr_len + run->item_len) {
+		return 0;
+	}
+
+	if(max_len < 0xFF) {
+		count = (max_len - run->hdr_len)/run->item_len;
+	} else {
+		count = (max_len - run->hdr_len - UINT16_SIZE)/run->item_len;
+		/* Shorter sequence could use one byte length */
+		short_count = (0xFE - run->hdr_len)/run->item_len;
+		if(short_count > count) {
+			count = short_count;
+		}
+	}
+
+	return (count < run->count) ? count : run->count;
+}
+
+/**
+ * \brief This function removes command from its group of commands with the
+ * same ID. The group is freed, when it was last command of the group.
+ */
+static void _v_out_queue_run_remove(struct VOutQueueCommand *queue_cmd)
+{
+	struct VOutQueueRun *run = queue_cmd->run;
+
+	if(run != NULL) {
+		run->count--;
+		if(run->count == 0) {
+			v_pool_free(run, sizeof(struct VOutQueueRun));
+		} else {
+			run->len = _v_out_queue_run_len(run, run->count);
+		}
+		queue_cmd->run = NULL;
+	}
 }
 
 /**
@@ -104,49 +287,38 @@ static void _v_out_queue_command_add(struct VPrioOutQueue *prio_queue,
 		border_queue_cmd = prio_queue->cmds.first;
 	}
 
-	/* Add command to the end of new priority queue. If needed
-	 * update counter of same commands in the queue */
-	if(border_queue_cmd != NULL) {
-
-		/* Is ID of this command same as ID of the last command
-		 * in this priority queue? */
-		if( (share_addr == 1) && (border_queue_cmd->id == queue_cmd->id)) {
-			struct Generic_Cmd *border_cmd = (struct Generic_Cmd *)border_queue_cmd->vbucket->data;
-
-			/* Is the last command in this priority queue and the
-			 * first command with this ID? */
-			if(border_queue_cmd->counter == NULL) {
-
-				/* Set initial number of commands with same ID */
-				border_queue_cmd->counter = (uint16*)malloc(sizeof(uint16));
-				*border_queue_cmd->counter = 1;
-
-				/* Compute size of address that could be shared */
-				border_queue_cmd->share = (int8*)malloc(sizeof(int8));
-				*border_queue_cmd->share = v_cmd_cmp_addr(border_cmd, cmd, 0xFF);
-
-				/* Allocate memory for length of compressed commands */
-				border_queue_cmd->len = (uint16*)malloc(sizeof(uint16));
-				*border_queue_cmd->len = v_cmds_len(border_cmd, *border_queue_cmd->counter, *border_queue_cmd->share, 0);
-
-			} else if(*border_queue_cmd->share > 0) {
-				/* Try to update size of address that could be shared */
-				*border_queue_cmd->share = v_cmd_cmp_addr(border_cmd, cmd, *border_queue_cmd->share);
+	queue_cmd->run = NULL;
+
+	/* Add command to the group of commands with the same ID at the border
+	 * of the queue. Fake commands are never compressed. */
+	if( (border_queue_cmd != NULL) &&
+			(share_addr == 1) &&
+			(queue_cmd->id >= MIN_CMD_ID) &&
+			(border_queue_cmd->id == queue_cmd->id) )
+	{
+		struct Generic_Cmd *border_cmd = (struct Generic_Cmd *)border_queue_cmd->vbucket->data;
+		struct VOutQueueRun *run = border_queue_cmd->run;
+		uint8 share;
+
+		/* Is the border command alone in this priority queue? */
+		if(run == NULL) {
+			run = (struct VOutQueueRun*)v_pool_alloc(sizeof(struct VOutQueueRun));
+			run->count = 1;
+			/* Compute size of address that could be shared */
+			_v_out_queue_run_share(run, border_cmd, v_cmd_cmp_addr(border_cmd, cmd, 0xFF));
+			border_queue_cmd->run = run;
+		} else if(run->share > 0) {
+			/* Try to update size of address that could be shared */
+			share = v_cmd_cmp_addr(border_cmd, cmd, run->share);
+			if(share != run->share) {
+				_v_out_queue_run_share(run, cmd, share);
 			}
+		}
 
-			/* Set up pointer */
-			queue_cmd->counter = border_queue_cmd->counter;
-			queue_cmd->share = border_queue_cmd->share;
-			queue_cmd->len = border_queue_cmd->len;
+		queue_cmd->run = run;
 
-			/* Update values */
-			(*queue_cmd->counter)++;
-			*queue_cmd->len = v_cmds_len(cmd, *queue_cmd->counter, *queue_cmd->share, *queue_cmd->len);
-		} else {
-			queue_cmd->counter = NULL;
-			queue_cmd->share = NULL;
-			queue_cmd->len = NULL;
-		}
+		run->count++;
+		run->len = _v_out_queue_run_len(run, run->count);
 	}
 
 	/* Will be command added to then head or tail of queue? */
@@ -159,22 +331,28 @@ static void _v_out_queue_command_add(struct VPrioOutQueue *prio_queue,
 }
 
 /**
- * \brief This function creates VQueueCommand to priority queue
+ * \brief This function creates VQueueCommand to priority queue. When
+ * queue_cmd is not NULL, then this slot of staged command is reused.
  */
 static struct VOutQueueCommand * _v_out_queue_command_create(struct VOutQueue *out_queue,
 		uint8 flag,
 		uint8 prio,
-		struct Generic_Cmd *cmd)
+		struct Generic_Cmd *cmd,
+		struct VOutQueueCommand *queue_cmd)
 {
 	/* Create new command in queue */
-	struct VOutQueueCommand *queue_cmd = (struct VOutQueueCommand*)calloc(1, sizeof(struct VOutQueueCommand));
+	if(queue_cmd == NULL) {
+		queue_cmd = (struct VOutQueueCommand*)v_pool_calloc(sizeof(struct VOutQueueCommand));
+	} else {
+		queue_cmd->prev = queue_cmd->next = NULL;
+		queue_cmd->cmd = NULL;
+	}
 
 	if(queue_cmd != NULL) {
 		/* Set up id and priority of command */
 		queue_cmd->id = cmd->id;
 		queue_cmd->prio = prio;
-		queue_cmd->counter = NULL;
-		queue_cmd->share = NULL;
+		queue_cmd->run = NULL;
 
 		if(out_queue->cmds[cmd->id]->flag & NOT_SHARE_ADDR) {
 			_v_out_queue_command_add(out_queue->queues[prio], flag, 0, queue_cmd, cmd);
@@ -188,14 +366,6 @@ static struct VOutQueueCommand * _v_out_queue_command_create(struct VOutQueue *o
 
 		assert(queue_cmd->vbucket->data != NULL);
 
-		/* When this priority queue was empty, then update summary of real priorities */
-		if(out_queue->queues[prio]->count == 0) {
-			if(prio>=VRS_DEFAULT_PRIORITY)
-				out_queue->r_prio_sum_high += out_queue->queues[prio]->r_prio;
-			else
-				out_queue->r_prio_sum_low += out_queue->queues[prio]->r_prio;
-		}
-
 		/* Update count and size of commands */
 		out_queue->count++;
 		out_queue->size += out_queue->cmds[cmd->id]->item_size;
@@ -203,25 +373,25 @@ static struct VOutQueueCommand * _v_out_queue_command_create(struct VOutQueue *o
 		out_queue->queues[prio]->count++;
 		out_queue->queues[prio]->size += out_queue->cmds[cmd->id]->item_size;
 
-		/* If necessary update maximal or minimal priority */
-		if(prio > out_queue->max_prio) {
-			out_queue->max_prio = prio;
-		} else if(prio < out_queue->min_prio) {
-			out_queue->min_prio = prio;
+		/* When this priority queue was empty, then mark it as used */
+		if(out_queue->queues[prio]->count == 1) {
+			_v_out_queue_prio_update(out_queue, prio);
 		}
-
 	}
 
 	return queue_cmd;
 }
 
 /**
- * \brief This function adds command to the head or tail of the queue
+ * \brief This function adds command to the head or tail of the queue. When
+ * staged_cmd is not NULL, then this slot is used for new command or it is
+ * freed, when command replaces older command with the same address.
  */
 static int _v_out_queue_push(struct VOutQueue *out_queue,
 		uint8 flag,
 		uint8 prio,
-		struct Generic_Cmd *cmd)
+		struct Generic_Cmd *cmd,
+		struct VOutQueueCommand *staged_cmd)
 {
 	struct VOutQueueCommand *queue_cmd;
 	struct VBucket *vbucket;
@@ -244,7 +414,7 @@ static int _v_out_queue_push(struct VOutQueue *out_queue,
 			if(queue_cmd->prio != prio) {
 
 				/* Remove old obsolete data */
-				v_hash_array_remove_item(&out_queue->cmds[cmd->id]->cmds, vbucket->data);
+				v_hash_array_remove_bucket(&out_queue->cmds[cmd->id]->cmds, vbucket);
 				/* Remove old  command */
 				v_list_rem_item(&out_queue->queues[queue_cmd->prio]->cmds, queue_cmd);
 
@@ -252,25 +422,12 @@ static int _v_out_queue_push(struct VOutQueue *out_queue,
 				out_queue->queues[queue_cmd->prio]->count--;
 				out_queue->queues[queue_cmd->prio]->size -= out_queue->cmds[cmd->id]->item_size;
 
-				/* If needed, then update counter of commands with the same id in the queue */
-				if(queue_cmd->counter != NULL) {
-					*queue_cmd->counter -= 1;
-					if(*queue_cmd->counter == 0) {
-						free(queue_cmd->counter);
-						queue_cmd->counter = NULL;
-						free(queue_cmd->share);
-						queue_cmd->share = NULL;
-						free(queue_cmd->len);
-						queue_cmd->len = NULL;
-					}
-				}
+				/* Remove command from the group of commands with the same ID */
+				_v_out_queue_run_remove(queue_cmd);
 
-				/* When this priority queue is empty now, then update summary of real priorities */
+				/* When old priority queue is empty now, then mark it as unused */
 				if(out_queue->queues[queue_cmd->prio]->count == 0) {
-					if(prio>=VRS_DEFAULT_PRIORITY)
-						out_queue->r_prio_sum_high -= out_queue->queues[queue_cmd->prio]->r_prio;
-					else
-						out_queue->r_prio_sum_low -= out_queue->queues[queue_cmd->prio]->r_prio;
+					_v_out_queue_prio_update(out_queue, queue_cmd->prio);
 				}
 
 				/* Update new priority command */
@@ -289,23 +446,13 @@ static int _v_out_queue_push(struct VOutQueue *out_queue,
 
 				assert(queue_cmd->vbucket->data != NULL);
 
-				/* When this priority queue was empty, then update summary of real priorities */
-				if(out_queue->queues[prio]->count == 0) {
-					if(prio>=VRS_DEFAULT_PRIORITY)
-						out_queue->r_prio_sum_high += out_queue->queues[prio]->r_prio;
-					else
-						out_queue->r_prio_sum_low += out_queue->queues[prio]->r_prio;
-				}
-
 				/* Update count and size in new priority queue */
 				out_queue->queues[prio]->count++;
 				out_queue->queues[prio]->size += out_queue->cmds[cmd->id]->item_size;
 
-				/* If necessary update maximal or minimal priority */
-				if(prio > out_queue->max_prio) {
-					out_queue->max_prio = prio;
-				} else if(prio < out_queue->min_prio) {
-					out_queue->min_prio = prio;
+				/* When new priority queue was empty, then mark it as used */
+				if(out_queue->queues[prio]->count == 1) {
+					_v_out_queue_prio_update(out_queue, prio);
 				}
 
 			} else {
@@ -322,9 +469,14 @@ static int _v_out_queue_push(struct VOutQueue *out_queue,
 				/* Replace data of current queue command with new data */
 				vbucket->data = (void*)cmd;
 			}
+
+			/* Slot of staged command is not needed any more */
+			if(staged_cmd != NULL) {
+				v_pool_free(staged_cmd, sizeof(struct VOutQueueCommand));
+			}
 		} else {
 			/* Add new command in queue */
-			queue_cmd = _v_out_queue_command_create(out_queue, flag, prio, cmd);
+			queue_cmd = _v_out_queue_command_create(out_queue, flag, prio, cmd, staged_cmd);
 
 			if(queue_cmd == NULL) {
 				ret = 0;
@@ -332,7 +484,7 @@ static int _v_out_queue_push(struct VOutQueue *out_queue,
 		}
 	} else {
 		/* Add new command in queue */
-		queue_cmd = _v_out_queue_command_create(out_queue, flag, prio, cmd);
+		queue_cmd = _v_out_queue_command_create(out_queue, flag, prio, cmd, staged_cmd);
 
 		if(queue_cmd == NULL) {
 			ret = 0;
@@ -342,6 +494,40 @@ static int _v_out_queue_push(struct VOutQueue *out_queue,
 	return ret;
 }
 
+/**
+ * \brief This function merges commands from the staging list to the priority
+ * queues. It has to be called only by sender thread with locked mutex.
+ * Commands are merged in the same order as they were pushed, because
+ * the staging list is reversed at first.
+ */
+static void _v_out_queue_merge(struct VOutQueue *out_queue)
+{
+	struct VOutQueueCommand *staged, *first = NULL, *next;
+	struct Generic_Cmd *cmd;
+
+	/* Fast path: nothing was pushed since last merge */
+	if(out_queue->staged == NULL) {
+		return;
+	}
+
+	staged = (struct VOutQueueCommand*)V_ATOMIC_XCHG_PTR(&out_queue->staged, NULL);
+
+	while(staged != NULL) {
+		next = staged->next;
+		staged->next = first;
+		first = staged;
+		staged = next;
+	}
+
+	while(first != NULL) {
+		next = first->next;
+		cmd = first->cmd;
+		/* Slot of staged command is reused, so it could not fail */
+		_v_out_queue_push(out_queue, OUT_QUEUE_ADD_TAIL, first->prio, cmd, first);
+		first = next;
+	}
+}
+
 /**
  * \brief This function add command to the head of the queue
  */
@@ -353,6 +539,9 @@ int v_out_queue_push_head(struct VOutQueue *out_queue, uint8 prio, struct Generi
 	/* Lock mutex */
 	pthread_mutex_lock(&out_queue->lock);
 
+	/* Newer commands could wait in the staging list */
+	_v_out_queue_merge(out_queue);
+
 	/* Try to find command with the same address, when duplicities are not
 	 * allowed in command queue */
 	if(out_queue->cmds[cmd->id]->flag & REMOVE_HASH_DUPS) {
@@ -364,13 +553,13 @@ int v_out_queue_push_head(struct VOutQueue *out_queue, uint8 prio, struct Generi
 			v_print_log_simple(VRS_PRINT_DEBUG_MSG, "\tRe-sending command: %d\n", cmd->id);
 			v_cmd_print(VRS_PRINT_DEBUG_MSG, (struct Generic_Cmd*)cmd);
 
-			ret = _v_out_queue_push(out_queue, OUT_QUEUE_ADD_HEAD, prio, cmd);
+			ret = _v_out_queue_push(out_queue, OUT_QUEUE_ADD_HEAD, prio, cmd, NULL);
 		}
 	} else {
 		v_print_log_simple(VRS_PRINT_DEBUG_MSG, "\tRe-sending command: %d\n", cmd->id);
 		v_cmd_print(VRS_PRINT_DEBUG_MSG, (struct Generic_Cmd*)cmd);
 
-		ret = _v_out_queue_push(out_queue, OUT_QUEUE_ADD_HEAD, prio, cmd);
+		ret = _v_out_queue_push(out_queue, OUT_QUEUE_ADD_HEAD, prio, cmd, NULL);
 	}
 
 	pthread_mutex_unlock(&out_queue->lock);
@@ -379,31 +568,47 @@ int v_out_queue_push_head(struct VOutQueue *out_queue, uint8 prio, struct Generi
 }
 
 /**
- * \brief This function add command to the tail of the queue
+ * \brief This function add command to the tail of the queue. It could be
+ * called by many producers at once and it never blocks sender thread.
+ * Command is only added to the lock-free staging list and it is merged to
+ * the priority queue (including removing of duplicities) by sender thread.
  */
 int v_out_queue_push_tail(struct VOutQueue *out_queue, uint8 prio, struct Generic_Cmd *cmd)
 {
-	int ret = 0;
+	struct VOutQueueCommand *queue_cmd, *staged;
 
-	/* Lock mutex */
-	pthread_mutex_lock(&out_queue->lock);
+	assert(cmd != NULL);
 
-	ret = _v_out_queue_push(out_queue, OUT_QUEUE_ADD_TAIL, prio, cmd);
+	queue_cmd = (struct VOutQueueCommand*)v_pool_calloc(sizeof(struct VOutQueueCommand));
 
-	pthread_mutex_unlock(&out_queue->lock);
+	if(queue_cmd == NULL) {
+		return 0;
+	}
 
-	return ret;
+	queue_cmd->id = cmd->id;
+	queue_cmd->prio = prio;
+	queue_cmd->cmd = cmd;
+
+	do {
+		staged = out_queue->staged;
+		queue_cmd->next = staged;
+	} while(!V_ATOMIC_CAS_PTR(&out_queue->staged, staged, queue_cmd));
+
+	return 1;
 }
 
 /*
  * \brief This function pop command from queue with specific priority.
  *
  * Returned command is allocated on the heap and have to be free from calling
- * function. When *count is not NULL, then this function will write number of
- * commands with same ID that could be compressed on this address. When *len
- * is not NULL, then this function will write length of compressed commands
- * at this address. When *len value is not 0, then this value represents maximal
- * size of commands that could be removed from this priority queue.
+ * function. When *count is not NULL and the command is the first command of
+ * the group of commands with the same ID, then this function will write number
+ * of commands from this group, that will be compressed together, at this
+ * address. Following count-1 calls of this function pop remaining commands
+ * of this group. When *len is not NULL, then this function will write length
+ * of compressed commands at this address. When *len value is not 0, then this
+ * value represents maximal size of commands that could be removed from this
+ * priority queue.
  *
  * \param[in]	*out_queue	The pointer at list of priority queues
  * \param[in]	prio		The value of priority
@@ -423,54 +628,62 @@ struct Generic_Cmd *v_out_queue_pop(struct VOutQueue *out_queue,
 {
 	struct VPrioOutQueue *prio_queue = out_queue->queues[prio];
 	struct VOutQueueCommand *queue_cmd;
+	struct VOutQueueRun *run;
 	struct Generic_Cmd *cmd=NULL;
-	int i, can_pop_cmd = 1;
+	uint16 run_count;
+	int can_pop_cmd = 1;
 
 	/* Lock mutex */
 	pthread_mutex_lock(&out_queue->lock);
 
-	/*printf("\tcount: %u, share: %u, len: %u\n", *count, *share, *len);*/
+	/* Merged command could remove command from the group, that is popped
+	 * just now, thus staged commands are merged after whole group */
+	if(out_queue->run_left == 0) {
+		_v_out_queue_merge(out_queue);
+	}
 
 	queue_cmd = prio_queue->cmds.first;
 
 	if(queue_cmd != NULL ) {
 		cmd = (struct Generic_Cmd *)queue_cmd->vbucket->data;
+		run = queue_cmd->run;
 
 		assert(cmd != NULL);
 
-		/* Return value of count and length of compressed commands */
-		if(queue_cmd->counter != NULL) {
+		if(out_queue->run_left > 0) {
+			/* Following command of the group was already counted in
+			 * the length of compressed commands */
+			assert(run != NULL);
+			out_queue->run_left--;
 			if(count != NULL) {
-				*count = *queue_cmd->counter;
+				*count = 0;
 			}
 			if(share != NULL) {
-				*share = *queue_cmd->share;
+				*share = run->share;
 			}
 			if(len != NULL) {
-				/* When *len value is not 0, then this value represents maximal
-				 * size of buffer that could be filled with this priority queue. This
-				 * function should return value, that is smaller or equal than this
-				 * maximum. */
-				if(*len != 0) {
-					if(*len < *queue_cmd->len) {
-						if (count != NULL) {
-							*count = v_cmd_count(cmd, *len, *queue_cmd->share);
-							/* FIXME: compute length and count correctly, when command is added to the queue */
-							*count = ((*count) > (*queue_cmd->counter)) ? *queue_cmd->counter : *count;
-							/* Is enough space in buffer to unpack this command? */
-							if(*count == 0) {
-								can_pop_cmd = 0;
-							}
-							*len = v_cmds_len(cmd, *count, *queue_cmd->share, 0);
-						} else {
-							can_pop_cmd = 0;
-						}
-					} else {
-						*len = *queue_cmd->len;
-					}
-				} else {
-					*len = *queue_cmd->len;
+				*len = 0;
+			}
+		} else if(count != NULL && run != NULL) {
+			/* Return value of count and length of compressed commands. When
+			 * *len value is not 0, then only part of the group, that fits to
+			 * this length, is returned. */
+			run_count = run->count;
+			if(len != NULL && *len != 0 && *len < run->len) {
+				run_count = _v_out_queue_run_count(run, *len);
+			}
+
+			if(run_count == 0) {
+				can_pop_cmd = 0;
+			} else {
+				*count = run_count;
+				if(share != NULL) {
+					*share = run->share;
+				}
+				if(len != NULL) {
+					*len = _v_out_queue_run_len(run, run_count);
 				}
+				out_queue->run_left = run_count - 1;
 			}
 		} else {
 			if(count != NULL) {
@@ -480,7 +693,7 @@ struct Generic_Cmd *v_out_queue_pop(struct VOutQueue *out_queue,
 				*share = 0;
 			}
 			if(len != NULL) {
-				if(v_cmd_size(cmd) > *len) {
+				if(*len != 0 && v_cmd_size(cmd) > *len) {
 					can_pop_cmd = 0;
 				}
 				*len = 0;
@@ -490,7 +703,7 @@ struct Generic_Cmd *v_out_queue_pop(struct VOutQueue *out_queue,
 		/* Is it possible to pop command from the queue */
 		if(can_pop_cmd == 1) {
 			/* Remove command from hashed linked list */
-			v_hash_array_remove_item(&out_queue->cmds[cmd->id]->cmds, (void*)cmd);
+			v_hash_array_remove_bucket(&out_queue->cmds[cmd->id]->cmds, queue_cmd->vbucket);
 
 			/* Remove command from priority queue */
 			v_list_rem_item(&prio_queue->cmds, queue_cmd);
@@ -503,54 +716,23 @@ struct Generic_Cmd *v_out_queue_pop(struct VOutQueue *out_queue,
 			out_queue->queues[prio]->count--;
 			out_queue->queues[prio]->size -= out_queue->cmds[cmd->id]->item_size;
 
-			/* If needed, then update counter of commands with the same id in the queue */
-			if(queue_cmd->counter != NULL) {
-				*queue_cmd->counter -= 1;
-				/* Free values, when it's last command in the queue */
-				if(*queue_cmd->counter == 0) {
-					free(queue_cmd->counter);
-					queue_cmd->counter = NULL;
-					free(queue_cmd->share);
-					queue_cmd->share = NULL;
-					free(queue_cmd->len);
-					queue_cmd->len = NULL;
-				}
-			}
+			/* Remove command from the group of commands with the same ID */
+			_v_out_queue_run_remove(queue_cmd);
 
-			/* When this priority queue is empty now, then update summary of
-			 * real priorities and it is possibly necessary to change maximal
-			 * or minimal priority queue*/
+			/* When this priority queue is empty now, then mark it as unused
+			 * and it is possibly necessary to change maximal or minimal
+			 * priority queue */
 			if(out_queue->queues[prio]->count == 0) {
-				if(prio>=VRS_DEFAULT_PRIORITY) {
-					out_queue->r_prio_sum_high -= out_queue->queues[prio]->r_prio;
-				} else {
-					out_queue->r_prio_sum_low -= out_queue->queues[prio]->r_prio;
-				}
-
-				if(out_queue->max_prio == prio && out_queue->min_prio != prio) {
-					for(i=prio; i>=out_queue->min_prio; i--) {
-						if(out_queue->queues[i]->count != 0) {
-							out_queue->max_prio = i;
-							break;
-						}
-					}
-				} else if(out_queue->min_prio == prio && out_queue->max_prio != prio) {
-					for(i=prio; i<=out_queue->max_prio; i++) {
-						if(out_queue->queues[i]->count != 0) {
-							out_queue->min_prio = i;
-							break;
-						}
-					}
-				} else if(out_queue->min_prio == prio && out_queue->max_prio == prio) {
-					out_queue->min_prio = out_queue->max_prio = VRS_DEFAULT_PRIORITY;
-				}
+				_v_out_queue_prio_update(out_queue, prio);
 			}
 
 			/* Free queue command */
-			free(queue_cmd);
+			v_pool_free(queue_cmd, sizeof(struct VOutQueueCommand));
 		} else {
 			cmd = NULL;
 		}
+	} else {
+		out_queue->run_left = 0;
 	}
 
 	pthread_mutex_unlock(&out_queue->lock);
@@ -558,6 +740,156 @@ struct Generic_Cmd *v_out_queue_pop(struct VOutQueue *out_queue,
 	return cmd;
 }
 
+/**
+ * \brief This function returns minimal count of bytes needed for sending
+ * the first command from the priority queue
+ */
+static uint32 _v_out_prio_queue_head_size(struct VPrioOutQueue *prio_queue)
+{
+	struct VOutQueueCommand *queue_cmd = prio_queue->cmds.first;
+	struct Generic_Cmd *cmd = (struct Generic_Cmd *)queue_cmd->vbucket->data;
+
+	/* The first command of the group is sent with header of compressed
+	 * commands */
+	if(queue_cmd->run != NULL) {
+		return _v_out_queue_run_len(queue_cmd->run, 1);
+	}
+
+	return v_cmd_size(cmd);
+}
+
+/**
+ * \brief This function returns next not empty priority queue in the round
+ * of scheduler. Priority queues are visited from the highest priority to the
+ * lowest one and then the next round starts.
+ */
+static int _v_out_queue_drr_after(struct VOutQueue *out_queue, int prio)
+{
+	prio = _v_out_queue_prio_below(out_queue, prio - 1);
+
+	return (prio < 0) ? out_queue->max_prio : prio;
+}
+
+/**
+ * \brief This function finds priority queue, that should be served by the
+ * deficit round robin scheduler.
+ *
+ * Only not empty priority queues are visited using bitmap of priorities. Each
+ * visited queue gets its quantum of bytes and it is served, until its deficit
+ * is not lower then size of the first command. When no queue could send its
+ * first command in the whole round, then missing rounds are skipped at once,
+ * thus cost of this function is O(count of not empty priority queues).
+ *
+ * \param[in]	*out_queue	The pointer at list of priority queues
+ * \param[out]	*prio		The priority of queue, that should be served
+ * \param[out]	*deficit	The count of bytes, that could be sent from this queue
+ *
+ * \return This function returns 1, when some priority queue could be served
+ * and it returns 0, when the queue is empty.
+ */
+int v_out_queue_drr_next(struct VOutQueue *out_queue, uint8 *prio, uint32 *deficit)
+{
+	struct VPrioOutQueue *prio_queue;
+	uint32 rounds, min_rounds;
+	int cur, start;
+
+	pthread_mutex_lock(&out_queue->lock);
+
+	_v_out_queue_merge(out_queue);
+
+	if(out_queue->count == 0) {
+		pthread_mutex_unlock(&out_queue->lock);
+		return 0;
+	}
+
+	/* The only not empty queue does not share bandwidth with other queues,
+	 * thus it is not limited by its deficit */
+	if(out_queue->max_prio == out_queue->min_prio) {
+		out_queue->drr_prio = out_queue->max_prio;
+		*prio = out_queue->max_prio;
+		*deficit = 0xFFFFFFFF;
+		pthread_mutex_unlock(&out_queue->lock);
+		return 1;
+	}
+
+	cur = out_queue->drr_prio;
+
+	/* Continue with the queue, that did not spend its deficit, because
+	 * previous packet was full */
+	if(cur >= 0 && out_queue->queues[cur]->count > 0 &&
+			out_queue->queues[cur]->deficit >= _v_out_prio_queue_head_size(out_queue->queues[cur]))
+	{
+		*prio = (uint8)cur;
+		*deficit = out_queue->queues[cur]->deficit;
+		pthread_mutex_unlock(&out_queue->lock);
+		return 1;
+	}
+
+	cur = (cur < 0) ? out_queue->max_prio : _v_out_queue_drr_after(out_queue, cur);
+	start = cur;
+
+	while(1) {
+		prio_queue = out_queue->queues[cur];
+		prio_queue->deficit += prio_queue->quantum;
+
+		if(prio_queue->deficit >= _v_out_prio_queue_head_size(prio_queue)) {
+			break;
+		}
+
+		cur = _v_out_queue_drr_after(out_queue, cur);
+
+		/* No queue could send its first command in this round. Find count
+		 * of rounds needed by the nearest queue and skip all these rounds
+		 * except the last one. */
+		if(cur == start) {
+			min_rounds = 0xFFFFFFFF;
+			do {
+				prio_queue = out_queue->queues[cur];
+				rounds = (_v_out_prio_queue_head_size(prio_queue) - prio_queue->deficit +
+						prio_queue->quantum - 1) / prio_queue->quantum;
+				if(rounds < min_rounds) {
+					min_rounds = rounds;
+				}
+				cur = _v_out_queue_drr_after(out_queue, cur);
+			} while(cur != start);
+
+			do {
+				prio_queue = out_queue->queues[cur];
+				prio_queue->deficit += (min_rounds - 1) * prio_queue->quantum;
+				cur = _v_out_queue_drr_after(out_queue, cur);
+			} while(cur != start);
+		}
+	}
+
+	out_queue->drr_prio = cur;
+
+	*prio = (uint8)cur;
+	*deficit = prio_queue->deficit;
+
+	pthread_mutex_unlock(&out_queue->lock);
+
+	return 1;
+}
+
+/**
+ * \brief This function subtracts count of bytes sent from priority queue
+ * from its deficit. The queue is served in next call of v_out_queue_drr_next()
+ * again, when there is still enough deficit for its first command.
+ */
+void v_out_queue_drr_charge(struct VOutQueue *out_queue, uint8 prio, uint32 len)
+{
+	struct VPrioOutQueue *prio_queue = out_queue->queues[prio];
+
+	pthread_mutex_lock(&out_queue->lock);
+
+	/* Deficit of empty queue was already cleared */
+	if(prio_queue->count > 0) {
+		prio_queue->deficit = (len < prio_queue->deficit) ? prio_queue->deficit - len : 0;
+	}
+
+	pthread_mutex_unlock(&out_queue->lock);
+}
+
 /**
  * \brief This function initialize queue for outgoing commands
  */
@@ -565,6 +897,7 @@ int v_out_queue_init(struct VOutQueue *out_queue, int max_size)
 {
 	int id, prio, res;
 	real32 r_prio;
+	uint32 quantum;
 
 	/* Initialize mutex of this queue */
 	if((res=pthread_mutex_init(&out_queue->lock, NULL))!=0) {
@@ -573,6 +906,8 @@ int v_out_queue_init(struct VOutQueue *out_queue, int max_size)
 		return 0;
 	}
 
+	out_queue->staged = NULL;
+
 	out_queue->count = 0;
 	out_queue->size = 0;
 
@@ -581,20 +916,24 @@ int v_out_queue_init(struct VOutQueue *out_queue, int max_size)
 	out_queue->max_prio = VRS_DEFAULT_PRIORITY;
 	out_queue->min_prio = VRS_DEFAULT_PRIORITY;
 
-	out_queue->r_prio_sum_high = 0.0;
-	out_queue->r_prio_sum_low = 0.0;
+	memset(out_queue->prio_map, 0, sizeof(out_queue->prio_map));
+	out_queue->drr_prio = -1;
+	out_queue->run_left = 0;
 
-	/* Set up high priorities */
+	/* Set up high priorities. Quantum of scheduler is integer value of
+	 * real priority, thus it is computed only once here. */
 	r_prio = VRS_DEFAULT_PRIORITY;
 	for(prio=VRS_DEFAULT_PRIORITY; prio<=MAX_PRIORITY; prio++) {
-		out_queue->queues[prio] = _v_out_prio_queue_create((r_prio<MAX_REAL_PRIO_VAL)?r_prio:MAX_REAL_PRIO_VAL);
+		quantum = (r_prio<MAX_REAL_PRIO_VAL) ? (uint32)(r_prio + 0.5f) : MAX_REAL_PRIO_VAL;
+		out_queue->queues[prio] = _v_out_prio_queue_create(quantum*PRIO_QUANTUM_MUL);
 		r_prio = r_prio + r_prio*REAL_PRIO_MUL;
 	}
 
 	/* Set up low priorities */
 	r_prio = VRS_DEFAULT_PRIORITY - 1;
 	for(prio=VRS_DEFAULT_PRIORITY-1; prio>=0; prio--) {
-		out_queue->queues[prio] = _v_out_prio_queue_create((r_prio>MIN_REAL_PRIO_VAL)?r_prio:MIN_REAL_PRIO_VAL);
+		quantum = (r_prio>MIN_REAL_PRIO_VAL) ? (uint32)(r_prio + 0.5f) : MIN_REAL_PRIO_VAL;
+		out_queue->queues[prio] = _v_out_prio_queue_create(quantum*PRIO_QUANTUM_MUL);
 		r_prio = r_prio - r_prio*REAL_PRIO_MUL;
 	}
 
@@ -632,14 +971,17 @@ void v_out_queue_destroy(struct VOutQueue **out_queue)
 
 	pthread_mutex_lock(&(*out_queue)->lock);
 
+	/* Staged commands are destroyed together with merged commands */
+	_v_out_queue_merge(*out_queue);
+
 	(*out_queue)->count = 0;
 	(*out_queue)->size = 0;
 
 	(*out_queue)->max_prio = VRS_DEFAULT_PRIORITY;
 	(*out_queue)->min_prio = VRS_DEFAULT_PRIORITY;
 
-	(*out_queue)->r_prio_sum_high = 0.0;
-	(*out_queue)->r_prio_sum_low = 0.0;
+	memset((*out_queue)->prio_map, 0, sizeof((*out_queue)->prio_map));
+	(*out_queue)->drr_prio = -1;
 
 	for(id=0; id<=MAX_PRIORITY; id++) {
 		if((*out_queue)->queues[id] != NULL) {
@@ -674,6 +1016,7 @@ uint32 v_out_queue_get_count_prio(struct VOutQueue *out_queue, uint8 prio)
 	uint32 count;
 
 	pthread_mutex_lock(&out_queue->lock);
+	_v_out_queue_merge(out_queue);
 	count = out_queue->queues[prio]->count;
 	pthread_mutex_unlock(&out_queue->lock);
 
@@ -685,6 +1028,7 @@ uint32 v_out_queue_get_size_prio(struct VOutQueue *out_queue, uint8 prio)
 	uint32 size;
 
 	pthread_mutex_lock(&out_queue->lock);
+	_v_out_queue_merge(out_queue);
 	size = out_queue->queues[prio]->size;
 	pthread_mutex_unlock(&out_queue->lock);
 
@@ -696,6 +1040,7 @@ uint32 v_out_queue_get_count(struct VOutQueue *out_queue)
 	uint32 count;
 
 	pthread_mutex_lock(&out_queue->lock);
+	_v_out_queue_merge(out_queue);
 	count = out_queue->count;
 	pthread_mutex_unlock(&out_queue->lock);
 
@@ -707,6 +1052,7 @@ uint32 v_out_queue_get_size(struct VOutQueue *out_queue)
 	uint32 size;
 
 	pthread_mutex_lock(&out_queue->lock);
+	_v_out_queue_merge(out_queue);
 	size = out_queue->size;
 	pthread_mutex_unlock(&out_queue->lock);
 
@@ -718,6 +1064,7 @@ uint8 v_out_queue_get_max_prio(struct VOutQueue *out_queue)
 	uint8 max;
 
 	pthread_mutex_lock(&out_queue->lock);
+	_v_out_queue_merge(out_queue);
 	max = out_queue->max_prio;
 	pthread_mutex_unlock(&out_queue->lock);
 
@@ -729,35 +1076,14 @@ uint8 v_out_queue_get_min_prio(struct VOutQueue *out_queue)
 	uint8 min;
 
 	pthread_mutex_lock(&out_queue->lock);
+	_v_out_queue_merge(out_queue);
 	min = out_queue->min_prio;
 	pthread_mutex_unlock(&out_queue->lock);
 
 	return min;
 }
 
-real32 v_out_queue_get_prio(struct VOutQueue *out_queue, uint8 prio)
-{
-	return out_queue->queues[prio]->r_prio;
-}
-
-real32 v_out_queue_get_prio_sum_high(struct VOutQueue *out_queue)
+uint32 v_out_queue_get_quantum(struct VOutQueue *out_queue, uint8 prio)
 {
-	real32 r_prio;
-
-	pthread_mutex_lock(&out_queue->lock);
-	r_prio = out_queue->r_prio_sum_high;
-	pthread_mutex_unlock(&out_queue->lock);
-
-	return r_prio;
-}
-
-real32 v_out_queue_get_prio_sum_low(struct VOutQueue *out_queue)
-{
-	real32 r_prio;
-
-	pthread_mutex_lock(&out_queue->lock);
-	r_prio = out_queue->r_prio_sum_low;
-	pthread_mutex_unlock(&out_queue->lock);
-
-	return r_prio;
+	return out_queue->queues[prio]->quantum;
 }
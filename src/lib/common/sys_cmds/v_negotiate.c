@@ -77,6 +77,7 @@ int v_add_negotiate_cmd(union VSystemCommands *sys_cmds,
 		case FTR_CC_ID:
 		case FTR_RWIN_SCALE:
 		case FTR_CMD_COMPRESS:
+		case FTR_PMTU_PROBE:
 			/* Add unsigned char value */
 			sys_cmds[cmd_rank].negotiate_cmd.value[ftr_rank].uint8 = *(uint8*)value;
 			break;
@@ -165,6 +166,9 @@ void v_print_negotiate_cmd(const unsigned char level, struct Negotiate_Cmd *nego
 		case FTR_CMD_COMPRESS:
 			v_print_log_simple(level, "feature: CMD_COMPRESS, ");
 			break;
+		case FTR_PMTU_PROBE:
+			v_print_log_simple(level, "feature: PMTU_PROBE, ");
+			break;
 		case FTR_CLIENT_NAME:
 			v_print_log_simple(level, "feature: CLIENT_NAME, ");
 			break;
@@ -182,6 +186,7 @@ void v_print_negotiate_cmd(const unsigned char level, struct Negotiate_Cmd *nego
 			case FTR_CC_ID:
 			case FTR_RWIN_SCALE:
 			case FTR_CMD_COMPRESS:
+			case FTR_PMTU_PROBE:
 				v_print_log_simple(level, "%d, ",
 						negotiate_cmd->value[i].uint8);
 				break;
@@ -266,6 +271,7 @@ int v_raw_unpack_negotiate_cmd(const char *buffer, ssize_t buffer_size, struct N
 		case FTR_CC_ID:
 		case FTR_RWIN_SCALE:
 		case FTR_CMD_COMPRESS:
+		case FTR_PMTU_PROBE:
 			negotiate_cmd->count = length - (1+lenlen+1);
 			break;
 		case FTR_HOST_URL:
@@ -296,6 +302,7 @@ int v_raw_unpack_negotiate_cmd(const char *buffer, ssize_t buffer_size, struct N
 			case FTR_CC_ID:
 			case FTR_RWIN_SCALE:
 			case FTR_CMD_COMPRESS:
+			case FTR_PMTU_PROBE:
 				buffer_pos += vnp_raw_unpack_uint8(&buffer[buffer_pos],
 						&negotiate_cmd->value[i].uint8);
 				break;
@@ -356,7 +363,8 @@ int v_raw_pack_negotiate_cmd(char *buffer, const struct Negotiate_Cmd *negotiate
 		negotiate_cmd->feature == FTR_FPS ||
 		negotiate_cmd->feature == FTR_CMD_COMPRESS ||
 		negotiate_cmd->feature == FTR_CLIENT_NAME ||
-		negotiate_cmd->feature == FTR_CLIENT_VERSION) )
+		negotiate_cmd->feature == FTR_CLIENT_VERSION ||
+		negotiate_cmd->feature == FTR_PMTU_PROBE) )
 	{
 		v_print_log(VRS_PRINT_WARNING, "Try to send UNKNOWN feature ID: %d\n",
 				negotiate_cmd->feature);
@@ -372,6 +380,7 @@ int v_raw_pack_negotiate_cmd(char *buffer, const struct Negotiate_Cmd *negotiate
 		case FTR_CC_ID:
 		case FTR_RWIN_SCALE:
 		case FTR_CMD_COMPRESS:
+		case FTR_PMTU_PROBE:
 			/* CommandID + Length + FeatureID + features */
 			length = 1 + 1 + 1 + negotiate_cmd->count*sizeof(uint8);
 			break;
@@ -405,6 +414,7 @@ int v_raw_pack_negotiate_cmd(char *buffer, const struct Negotiate_Cmd *negotiate
 			case FTR_CC_ID:
 			case FTR_RWIN_SCALE:
 			case FTR_CMD_COMPRESS:
+			case FTR_PMTU_PROBE:
 				buffer_pos += vnp_raw_pack_uint8(&buffer[buffer_pos], negotiate_cmd->value[i].uint8);
 				break;
 			case FTR_HOST_URL:
@@ -144,6 +144,11 @@ int v_unpack_packet_system_commands(const char *buffer,
 			if(cmd_id>MAX_SYS_CMD_ID) {
 				vpacket->sys_cmd[i].cmd.id = CMD_RESERVED_ID;
 				break;
+			} else if(cmd_id == CMD_RESERVED_ID) {
+				/* Rest of packet is padding of PMTU probe */
+				vpacket->sys_cmd[i].cmd.id = CMD_RESERVED_ID;
+				buffer_pos = buffer_len;
+				break;
 			} else {
 				vpacket->sys_cmd[i].cmd.id = cmd_id;
 				vpacket->sys_cmd[i+1].cmd.id = CMD_RESERVED_ID;
@@ -0,0 +1,366 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+/**
+ * \file v_cmd_codegen.c
+ *
+ * This file contains generator of specialized pack and unpack functions of
+ * node commands. It is compiled as host tool during build of verse library
+ * and it generates one straight-line encode and decode function for each
+ * node command with fixed length from the description in cmd_struct[].
+ * Items of command are laid one after another in memory, as they are in the
+ * packet. Thus consecutive items with the same size of word (e.g. values of
+ * VEC2/VEC3/VEC4 layer and tag commands) are byte-swapped in one run.
+ * Commands with variable length are packed and unpacked by interpreted
+ * functions in v_commands.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "verse_types.h"
+
+#include "v_commands.h"
+
+extern const struct Cmd_Struct cmd_struct[];
+
+/* Helper functions copied to the generated file. Values of 64 bit types are
+ * transmitted as two 32 bit words in order of memory (see vnp_raw_pack_uint64),
+ * thus they are byte-swapped as two 32 bit words too. */
+static const char *codec_helpers =
+"/* Copy bytes to the buffer */\n"
+"static size_t _v_codec_pack8(uint8 *dst, const uint8 *src, const size_t count)\n"
+"{\n"
+"\tmemcpy(dst, src, count);\n"
+"\treturn count;\n"
+"}\n"
+"\n"
+"/* Pack count of 16 bit words in network byte order */\n"
+"static size_t _v_codec_pack16(uint8 *dst, const uint8 *src, const size_t count)\n"
+"{\n"
+"\tuint16 value;\n"
+"\tsize_t i;\n"
+"\n"
+"\tfor(i = 0; i < count; i++) {\n"
+"\t\tmemcpy(&value, &src[2*i], 2);\n"
+"\t\tdst[2*i]   = (uint8)(value >> 8);\n"
+"\t\tdst[2*i+1] = (uint8)(value & 0xFF);\n"
+"\t}\n"
+"\treturn 2*count;\n"
+"}\n"
+"\n"
+"/* Pack count of 32 bit words in network byte order */\n"
+"static size_t _v_codec_pack32(uint8 *dst, const uint8 *src, const size_t count)\n"
+"{\n"
+"\tuint32 value;\n"
+"\tsize_t i;\n"
+"\n"
+"\tfor(i = 0; i < count; i++) {\n"
+"\t\tmemcpy(&value, &src[4*i], 4);\n"
+"\t\tdst[4*i]   = (uint8)(value >> 24);\n"
+"\t\tdst[4*i+1] = (uint8)((value >> 16) & 0xFF);\n"
+"\t\tdst[4*i+2] = (uint8)((value >> 8) & 0xFF);\n"
+"\t\tdst[4*i+3] = (uint8)(value & 0xFF);\n"
+"\t}\n"
+"\treturn 4*count;\n"
+"}\n"
+"\n"
+"/* Copy bytes from the buffer */\n"
+"static size_t _v_codec_unpack8(uint8 *dst, const uint8 *src, const size_t count)\n"
+"{\n"
+"\tmemcpy(dst, src, count);\n"
+"\treturn count;\n"
+"}\n"
+"\n"
+"/* Unpack count of 16 bit words from network byte order */\n"
+"static size_t _v_codec_unpack16(uint8 *dst, const uint8 *src, const size_t count)\n"
+"{\n"
+"\tuint16 value;\n"
+"\tsize_t i;\n"
+"\n"
+"\tfor(i = 0; i < count; i++) {\n"
+"\t\tvalue = (uint16)(((uint16)src[2*i] << 8) | src[2*i+1]);\n"
+"\t\tmemcpy(&dst[2*i], &value, 2);\n"
+"\t}\n"
+"\treturn 2*count;\n"
+"}\n"
+"\n"
+"/* Unpack count of 32 bit words from network byte order */\n"
+"static size_t _v_codec_unpack32(uint8 *dst, const uint8 *src, const size_t count)\n"
+"{\n"
+"\tuint32 value;\n"
+"\tsize_t i;\n"
+"\n"
+"\tfor(i = 0; i < count; i++) {\n"
+"\t\tvalue = ((uint32)src[4*i] << 24) | ((uint32)src[4*i+1] << 16) |\n"
+"\t\t\t\t((uint32)src[4*i+2] << 8) | (uint32)src[4*i+3];\n"
+"\t\tmemcpy(&dst[4*i], &value, 4);\n"
+"\t}\n"
+"\treturn 4*count;\n"
+"}\n";
+
+/**
+ * \brief This function returns size of word, that is byte-swapped, for the
+ * type of item. It returns 0 for items, that can not be generated.
+ */
+static int codegen_word_size(const enum Cmd_Item_Type type)
+{
+	switch(type) {
+	case ITEM_INT8:
+	case ITEM_UINT8:
+		return 1;
+	case ITEM_INT16:
+	case ITEM_UINT16:
+	case ITEM_REAL16:
+		return 2;
+	case ITEM_INT32:
+	case ITEM_UINT32:
+	case ITEM_REAL32:
+	case ITEM_INT64:
+	case ITEM_UINT64:
+	case ITEM_REAL64:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \brief This function checks, if specialized functions could be generated
+ * for the command. The command has to be node command with fixed length and
+ * its items have to be laid one after another in memory.
+ */
+static int codegen_supported(const struct Cmd_Struct *cmd)
+{
+	size_t offset = 0;
+	int i;
+
+	if( !(cmd->flag & NODE_CMD) || (cmd->flag & VAR_LEN) || cmd->item_count == 0) {
+		return 0;
+	}
+
+	for(i = 0; i < cmd->item_count; i++) {
+		if(codegen_word_size(cmd->items[i].type) == 0 ||
+				cmd->items[i].offset != offset ||
+				cmd->items[i].size % codegen_word_size(cmd->items[i].type) != 0)
+		{
+			return 0;
+		}
+		offset += cmd->items[i].size;
+	}
+
+	return offset == cmd->size;
+}
+
+/**
+ * \brief This function writes body of pack or unpack function of one command.
+ * Items of address could be skipped, when address is shared with previous
+ * command. Thus each item of address has its own case. Remaining items are
+ * merged into runs of words with the same size.
+ */
+static void codegen_items(FILE *out, const struct Cmd_Struct *cmd, const int pack)
+{
+	int i, j, word, count;
+
+	fprintf(out, "\tswitch(skip_items) {\n");
+
+	for(i = 0; i < cmd->item_count; i = j) {
+		word = codegen_word_size(cmd->items[i].type);
+		count = cmd->items[i].size / word;
+		j = i + 1;
+
+		if(i <= cmd->key_count) {
+			fprintf(out, "\tcase %d:\n", i);
+		}
+
+		/* Values are merged into runs of words with the same size */
+		if(i >= cmd->key_count) {
+			while(j < cmd->item_count &&
+					codegen_word_size(cmd->items[j].type) == word)
+			{
+				count += cmd->items[j].size / word;
+				j++;
+			}
+		}
+
+		if(pack == 1) {
+			fprintf(out, "\t\tpos += _v_codec_pack%d(&b[pos], &d[%d], %d);",
+					word*8, cmd->items[i].offset, count);
+		} else {
+			fprintf(out, "\t\tpos += _v_codec_unpack%d(&d[%d], &b[pos], %d);",
+					word*8, cmd->items[i].offset, count);
+		}
+		if(j - i > 1) {
+			fprintf(out, "\t/* %s .. %s */\n", cmd->items[i].name, cmd->items[j-1].name);
+		} else {
+			fprintf(out, "\t/* %s */\n", cmd->items[i].name);
+		}
+
+		/* Next item has its own case */
+		if(j < cmd->item_count && j <= cmd->key_count) {
+			fprintf(out, "\t\t/* Falls through */\n");
+		}
+	}
+
+	/* Whole command could be shared, when it does not contain any value */
+	if(cmd->key_count == cmd->item_count) {
+		fprintf(out, "\t\t/* Falls through */\n");
+		fprintf(out, "\tcase %d:\n", cmd->item_count);
+	}
+
+	fprintf(out, "\t\tbreak;\n");
+	fprintf(out, "\tdefault:\n");
+	fprintf(out, "\t\treturn -1;\n");
+	fprintf(out, "\t}\n");
+}
+
+/**
+ * \brief This function writes specialized pack and unpack functions of one
+ * command to the generated file.
+ */
+static void codegen_cmd(FILE *out, const int id, const struct Cmd_Struct *cmd)
+{
+	fprintf(out, "\n/* Pack items of %s command */\n", cmd->name);
+	fprintf(out, "static int _v_cmd_pack_%d(char *buffer,\n"
+			"\t\tconst struct Generic_Cmd *cmd,\n"
+			"\t\tconst uint8 skip_items)\n", id);
+	fprintf(out, "{\n");
+	fprintf(out, "\tuint8 *b = (uint8*)buffer;\n");
+	fprintf(out, "\tconst uint8 *d = cmd->data;\n");
+	fprintf(out, "\tsize_t pos = 0;\n\n");
+	codegen_items(out, cmd, 1);
+	fprintf(out, "\n\treturn (int)pos;\n");
+	fprintf(out, "}\n");
+
+	fprintf(out, "\n/* Unpack items of %s command */\n", cmd->name);
+	fprintf(out, "static int _v_cmd_unpack_%d(const char *buffer,\n"
+			"\t\tstruct Generic_Cmd *cmd,\n"
+			"\t\tconst uint8 skip_items)\n", id);
+	fprintf(out, "{\n");
+	fprintf(out, "\tconst uint8 *b = (const uint8*)buffer;\n");
+	fprintf(out, "\tuint8 *d = cmd->data;\n");
+	fprintf(out, "\tsize_t pos = 0;\n\n");
+	codegen_items(out, cmd, 0);
+	fprintf(out, "\n\treturn (int)pos;\n");
+	fprintf(out, "}\n");
+}
+
+/**
+ * \brief This function writes array of pointers at generated functions.
+ */
+static void codegen_table(FILE *out, const char *type, const char *prefix)
+{
+	int id;
+
+	fprintf(out, "\nstatic const %s _v_cmd_%s_codecs[MAX_CMD_ID+1] = {\n", type, prefix);
+	for(id = 0; id <= MAX_CMD_ID; id++) {
+		if(codegen_supported(&cmd_struct[id])) {
+			fprintf(out, "\t\t_v_cmd_%s_%d%s\n", prefix, id, (id < MAX_CMD_ID) ? "," : "");
+		} else {
+			fprintf(out, "\t\tNULL%s\n", (id < MAX_CMD_ID) ? "," : "");
+		}
+	}
+	fprintf(out, "};\n");
+}
+
+int main(int argc, char *argv[])
+{
+	FILE *out;
+	int id;
+
+	if(argc != 2) {
+		fprintf(stderr, "Usage: %s <output file>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if( (out = fopen(argv[1], "w")) == NULL ) {
+		perror("fopen");
+		return EXIT_FAILURE;
+	}
+
+	fprintf(out, "/*\n"
+			" * This file was generated by verse_cmd_codegen from cmd_struct[] in\n"
+			" * v_cmd_struct.c. Do not edit it.\n"
+			" */\n\n");
+	fprintf(out, "#include <stddef.h>\n"
+			"#include <string.h>\n\n"
+			"#include \"verse_types.h\"\n\n"
+			"#include \"v_commands.h\"\n"
+			"#include \"v_cmd_codec.h\"\n\n");
+	fprintf(out, "%s", codec_helpers);
+
+	for(id = 0; id <= MAX_CMD_ID; id++) {
+		if(codegen_supported(&cmd_struct[id])) {
+			codegen_cmd(out, id, &cmd_struct[id]);
+		}
+	}
+
+	codegen_table(out, "VCmdPackFunc", "pack");
+	codegen_table(out, "VCmdUnpackFunc", "unpack");
+
+	fprintf(out, "\n"
+			"int v_cmd_codec_pack(char *buffer,\n"
+			"\t\tconst struct Generic_Cmd *cmd,\n"
+			"\t\tconst uint8 skip_items)\n"
+			"{\n"
+			"\tif(_v_cmd_pack_codecs[cmd->id] == NULL) {\n"
+			"\t\treturn -1;\n"
+			"\t}\n"
+			"\treturn _v_cmd_pack_codecs[cmd->id](buffer, cmd, skip_items);\n"
+			"}\n"
+			"\n"
+			"uint8 v_cmd_codec_supported(const uint8 id)\n"
+			"{\n"
+			"\treturn _v_cmd_unpack_codecs[id] != NULL;\n"
+			"}\n"
+			"\n"
+			"int v_cmd_codec_unpack(const char *buffer,\n"
+			"\t\tstruct Generic_Cmd *cmd,\n"
+			"\t\tconst uint8 skip_items)\n"
+			"{\n"
+			"\tif(_v_cmd_unpack_codecs[cmd->id] == NULL) {\n"
+			"\t\treturn -1;\n"
+			"\t}\n"
+			"\treturn _v_cmd_unpack_codecs[cmd->id](buffer, cmd, skip_items);\n"
+			"}\n");
+
+	if(fclose(out) != 0) {
+		perror("fclose");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
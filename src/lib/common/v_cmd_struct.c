@@ -0,0 +1,1580 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stddef.h>
+
+#include "verse_types.h"
+
+#include "v_commands.h"
+
+/**
+ * Definition of structure of all supported commands. Following array should be
+ * automatically generated from configuration file. With following structure:
+ *
+ * Node_Cmd(SHARE_ADDR) {
+ * }
+ *
+ * Specialized pack and unpack functions of commands are generated from this
+ * array during build by verse_cmd_codegen. Thus this file does not depend on
+ * any other part of verse library.
+ */
+const struct Cmd_Struct cmd_struct[MAX_CMD_ID+1] = {
+		{ 0 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 1 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 2 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 3 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 4 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 5 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 6 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 7 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 8 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 9 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 10,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 11,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 12,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 13,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 14,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 15,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 16,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 17,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 18,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 19,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 20,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 21,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 22,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 23,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 24,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 25,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 26,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 27,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 28,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 29,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 30,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 31,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{
+				CMD_NODE_CREATE,	/* 32 */
+				NODE_CMD | SHARE_ADDR,
+				UINT16_SIZE + UINT32_SIZE,	/* Address size */
+				UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT16_SIZE, /* Command size in memory */
+				UINT8_SIZE  + UINT8_SIZE  + UINT8_SIZE  + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT16_SIZE, /* Minimal command size in packet */
+				4,	/* Number of items */
+				2,	/* Number of items that are part of address */
+				"Node_Create",	/* Name of command */
+				{	/* Items */
+						{ITEM_UINT16, UINT16_SIZE, 0, "User_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE, "Parent_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE + UINT32_SIZE, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Custom_Type"}
+				}
+		},
+		{
+				CMD_NODE_DESTROY,	/* 33 */
+				NODE_CMD | REM_DUP,
+				UINT32_SIZE, /* Address size */
+				UINT32_SIZE, /* Command size in memory */
+				UINT8_SIZE  + UINT8_SIZE + UINT32_SIZE, /* Minimal command size in packet */
+				1, /* Number of items */
+				1, /* Number of items that are part of address */
+				"Node_Destroy",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"}
+				}
+		},
+		{
+				CMD_NODE_SUBSCRIBE,	/* 34 */
+				NODE_CMD | REM_DUP,
+				UINT32_SIZE, /* Address size */
+				UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
+				3, /* Number of items */
+				1, /* Number of items that are part of address */
+				"Node_Subscribe",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Version"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT32_SIZE, "CRC_32"}
+				}
+		},
+		{
+				CMD_NODE_UNSUBSCRIBE,	/* 35 */
+				NODE_CMD | REM_DUP,
+				UINT32_SIZE, /* Address size */
+				UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
+				3,
+				1,
+				"Node_UnSubscribe",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Version"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT32_SIZE, "CRC_32"}
+				}
+		},
+		{ 36,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{
+				CMD_NODE_LINK,			/* 37 */
+				NODE_CMD | SHARE_ADDR,
+				UINT32_SIZE,
+				UINT32_SIZE + UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE,
+				2,
+				1,
+				"Node_Link",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Parent_Node_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Child_Node_ID"}
+				}
+		},
+		{
+				CMD_NODE_PERMISSION,		/* 38 */
+				NODE_CMD | SHARE_ADDR,		/* flags*/
+				UINT16_SIZE + UINT8_SIZE,	/* Address size */
+				UINT16_SIZE + UINT8_SIZE + UINT32_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE + UINT8_SIZE + UINT32_SIZE,	/* Minimal command size in packet */
+				3,	/* Number of items */
+				2,	/* Number of items that are part of address */
+				"Node_Permision",	/* Name */
+				{
+						{ITEM_UINT16, UINT16_SIZE, 0, "User_ID"},
+						{ITEM_UINT8,  UINT8_SIZE,  UINT16_SIZE, "Permissions"},
+						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE + UINT8_SIZE, "Node_ID"},
+				}
+		},
+		{
+				CMD_DEFAULT_PERMISSION,		/* 39 */
+				0,
+				0,
+				0,
+				0,
+				0,
+				0,
+				"Default_Node_Permissions",
+				{
+						{ITEM_RESERVED,0,0,""},
+				}
+		},
+		{
+				CMD_NODE_OWNER,				/* 40*/
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT16_SIZE,				/* Address size */
+				UINT16_SIZE + UINT32_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE + UINT32_SIZE,	/* Minimal command size in packet */
+				2,	/* Number of items */
+				1,	/* Number of items that are part of address */
+				"Node_Owner",
+				{
+						{ITEM_UINT16, UINT16_SIZE, 0, "User_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE, "Node_ID"}
+				}
+		},
+		{
+				CMD_NODE_LOCK,				/* 41 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE,	/* Address size */
+				UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
+				2,	/* Number of items */
+				1,	/* Number of items, that are part of address */
+				"Node_Lock",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Avatar_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Node_ID"}
+				}
+		},
+		{
+				CMD_NODE_UNLOCK,			/* 42 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE,				/* Address size */
+				UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
+				2,		/* Number of items */
+				1,		/* Number of items, that are part of address */
+				"Node_UnLock",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Avatar_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Node_ID"}
+				}
+		},
+		{
+				CMD_NODE_PRIORITY,	/* 43 */
+				NODE_CMD | SHARE_ADDR,
+				UINT8_SIZE,
+				UINT8_SIZE + UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE,
+				2,
+				1,
+				"Node_Priority",
+				{
+						{ITEM_UINT8,  UINT8_SIZE, 0, "Priority"},
+						{ITEM_UINT32, UINT32_SIZE, UINT8_SIZE, "Node_ID"}
+				}
+		},
+		{ 44,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 45,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 46,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 47,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 48,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 49,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 50,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 51,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 52,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 53,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 54,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 55,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 56,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 57,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 58,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 59,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 60,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 61,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 62,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{ 63,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		/* TagGroup and Tag Commands */
+		{
+				CMD_TAGGROUP_CREATE,	/* 64 */
+				NODE_CMD | SHARE_ADDR,
+				UINT32_SIZE,	/* Address size */
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, /* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, /* Minimal command size in packet */
+				3,
+				1,
+				"TagGroup_Create",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Custom_Type"}
+				}
+		},
+		{
+				CMD_TAGGROUP_DESTROY,	/* 65 */
+				NODE_CMD | SHARE_ADDR,
+				UINT32_SIZE,
+				UINT32_SIZE + UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE,
+				2,
+				1,
+				"TagGroup_Destroy",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"}
+				}
+		},
+		{
+				CMD_TAGGROUP_SUBSCRIBE,	/* 66 */
+				NODE_CMD | SHARE_ADDR,
+				UINT32_SIZE,
+				UINT32_SIZE + UINT16_SIZE  + UINT32_SIZE + UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
+				4,
+				1,
+				"TagGroup_Subscribe",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
+				}
+		},
+		{
+				CMD_TAGGROUP_UNSUBSCRIBE,	/* 67 */
+				NODE_CMD | SHARE_ADDR,
+				UINT32_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
+				4,
+				1,
+				"TagGroup_Unsubscribe",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
+				}
+		},
+		{
+				CMD_TAG_CREATE,		/* 68 */
+				NODE_CMD | SHARE_ADDR,
+				UINT32_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE, /* Minimal command size in packet */
+				6,
+				2,
+				"Tag_Create",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT8,  UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Data_Type"},
+						{ITEM_UINT8,  UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Count"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Custom_Type"}
+				}
+		},
+		{
+				CMD_TAG_DESTROY,	/* 69 */
+				NODE_CMD | SHARE_ADDR,
+				UINT32_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				3,
+				2,
+				"Tag_Destroy",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"}
+				}
+		},
+		/* Uint8 */
+		{
+				CMD_TAG_SET_UINT8,	/* 70 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT8_SIZE,
+				4,
+				3,
+				"Tag_Set_UInt8_Scalar",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC2_UINT8,	/* 71 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT8_SIZE,
+				5,
+				3,
+				"Tag_Set_UInt8_Vec2",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Value[1]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC3_UINT8,	/* 72 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT8_SIZE,
+				6,
+				3,
+				"Tag_Set_UInt8_Vec3",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Value[1]"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC4_UINT8,	/* 73 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT8_SIZE,
+				7,
+				3,
+				"Tag_Set_UInt8_Vec4",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Value[1]"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"},
+						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[3]"}
+				}
+		},
+		/* Uint16 */
+		{
+				CMD_TAG_SET_UINT16,	/* 74 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT16_SIZE,
+				4,
+				3,
+				"Tag_Set_UInt16",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC2_UINT16,	/* 75 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT16_SIZE,
+				5,
+				3,
+				"Tag_Set_UInt16_Vec2",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC3_UINT16,	/* 76 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT16_SIZE,
+				6,
+				3,
+				"Tag_Set_UInt16_Vec3",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC4_UINT16,	/* 77 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT16_SIZE,
+				7,
+				3,
+				"Tag_Set_UInt16_Vec4",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[3]"}
+				}
+		},
+		/* Uint32 */
+		{
+				CMD_TAG_SET_UINT32,	/* 78 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE,
+				4,
+				3,
+				"Tag_Set_UInt32",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC2_UINT32,	/* 79 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT32_SIZE,
+				5,
+				3,
+				"Tag_Set_UInt32_Vec2",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[1]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC3_UINT32,	/* 80 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT32_SIZE,
+				6,
+				3,
+				"Tag_Set_UInt32_Vec3",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[1]"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC4_UINT32,	/* 81 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT32_SIZE,
+				7,
+				3,
+				"Tag_Set_UInt32_Vec4",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[1]"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"},
+						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[3]"}
+				}
+		},
+		/* Uint64 */
+		{
+				CMD_TAG_SET_UINT64,	/* 82 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT64_SIZE,
+				4,
+				3,
+				"Tag_Set_UInt64",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC2_UINT64,	/* 83 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT64_SIZE,
+				5,
+				3,
+				"Tag_Set_Vec2_UInt64",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE, "Value[1]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC3_UINT64,	/* 84 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT64_SIZE,
+				6,
+				3,
+				"Tag_Set_Vec3_UInt64",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE, "Value[1]"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC4_UINT64,	/* 85 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT64_SIZE,
+				7,
+				3,
+				"Tag_Set_Vec4_UInt64",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE, "Value[1]"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"},
+						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[3]"}
+				}
+		},
+		/* Real16 */
+		{
+				CMD_TAG_SET_REAL16,	/* 86 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL16_SIZE,
+				4,
+				3,
+				"Tag_Set_Real16",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC2_REAL16,	/* 87 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL16_SIZE,
+				5,
+				3,
+				"Tag_Set_Real16_Vec2",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC3_REAL16,	/* 88 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL16_SIZE,
+				6,
+				3,
+				"Tag_Set_Real16_Vec3",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE, "Value[1]"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_TAG_SET_VEC4_REAL16,	/* 89 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL16_SIZE,
+				7,
+				3,
+				"Tag_Set_Real16_Vec4",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE, "Value[1]"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
+						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[3]"},
+				}
+		},
+		/* Real32 */
+		{
+				CMD_TAG_SET_REAL32,	/* 90 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE,
+				4,
+				3,
+				"Tag_Set_Real32",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC2_REAL32,	/* 91 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL32_SIZE,
+				5,
+				3,
+				"Tag_Set_Real32_Vec2",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE, "Value[1]"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC3_REAL32,	/* 92 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL32_SIZE,
+				6,
+				3,
+				"Tag_Set_Real16_Vec3",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE, "Value[1]"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_TAG_SET_VEC4_REAL32,	/* 93 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL32_SIZE,
+				7,
+				3,
+				"Tag_Set_Real32_Vec4",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE, "Value[1]"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
+						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[3]"},
+				}
+		},
+		/* Real64 */
+		{
+				CMD_TAG_SET_REAL64,	/* 94 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL64_SIZE,
+				4,
+				3,
+				"Tag_Set_Real64",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{
+				CMD_TAG_SET_VEC2_REAL64,	/* 95 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL64_SIZE,
+				5,
+				3,
+				"Tag_Set_Real64_Vec2",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_TAG_SET_VEC3_REAL64,	/* 96 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL64_SIZE,
+				6,
+				3,
+				"Tag_Set_Real64_Vec3",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE, "Value[1]"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_TAG_SET_VEC4_REAL64,	/* 97 */
+				NODE_CMD | SHARE_ADDR | REM_DUP,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL64_SIZE,
+				7,
+				3,
+				"Tag_Set_Real64_Vec4",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE, "Value[1]"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
+						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[3]"}
+				}
+		},
+		/* String8 */
+		{
+				CMD_TAG_SET_STRING8,	/* 98 */
+				NODE_CMD | SHARE_ADDR | REM_DUP | VAR_LEN,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + STRING8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE,
+				4,
+				3,
+				"Tag_Set_String8",
+				{
+						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
+						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
+						{ITEM_STRING8, STRING8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
+				}
+		},
+		{ 99,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+
+		{100,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{101,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{102,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{103,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{104,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{105,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{106,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{107,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{108,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{109,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{110,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{111,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{112,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{113,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{114,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{115,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{116,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{117,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{118,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{119,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{120,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{121,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{122,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{123,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{124,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{125,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{126,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{127,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+
+		/* Layers commands */
+		{
+				CMD_LAYER_CREATE,			/* 128 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address size */
+				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE,	/* Minimal command size in packet */
+				6,							/* Number of items */
+				2,							/* Number of items that are part of address */
+				"Layer_Create",				/* Command name */
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Parent_Layer_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Layer_ID"},
+						{ITEM_UINT8, UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Data_Type"},
+						{ITEM_UINT8, UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Count"},
+						{ITEM_UINT16, UINT16_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Custom_Type"}
+				}
+		},
+		{
+				CMD_LAYER_DESTROY,			/* 129 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE,				/* Address size */
+				UINT32_SIZE + UINT16_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE,
+				2,							/* Number of items */
+				1,							/* Number of items that are part of address */
+				"Layer_Destroy",			/* Command name */
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"}
+
+				}
+		},
+		{
+				CMD_LAYER_SUBSCRIBE,		/* 130 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE,				/* Address size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
+				4,							/* Number of items */
+				1,							/* Number of items that are part of address */
+				"Layer_Subscribe",			/* Command name */
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
+				}
+		},
+		{
+				CMD_LAYER_UNSUBSCRIBE,		/* 131 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE,				/* Address size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
+				4,							/* Number of items */
+				1,							/* Number of items that are part of address */
+				"Layer_UnSubscribe",		/* Command name */
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
+				}
+		},
+		{
+				CMD_LAYER_UNSET_VALUE,		/* 132 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE,	/* Command size in memory */
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE,
+				3,							/* Number of items */
+				2,							/* Number of items that are part of address */
+				"Layer_UnSet_Value",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+				}
+		},
+		/* Uint8 */
+		{
+				CMD_LAYER_SET_UINT8,		/* 133 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE,
+				4,
+				2,
+				"Layer_Set_Value_Uint8",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC2_UINT8,	/* 134 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT8_SIZE,
+				5,
+				2,
+				"Layer_Set_Value_Uint8_Vec2",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC3_UINT8,	/* 135 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT8_SIZE,
+				6,
+				2,
+				"Layer_Set_Value_Uint8_Vec3",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE, "Value[1]"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC4_UINT8,	/* 136 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT8_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT8_SIZE,
+				7,
+				2,
+				"Layer_Set_Value_Uint8_Vec4",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE, "Value[1]"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"},
+						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[3]"},
+				}
+		},
+		/* Uint16 */
+		{
+				CMD_LAYER_SET_UINT16,		/* 137 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE,
+				4,
+				2,
+				"Layer_Set_Value_Uint16",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC2_UINT16,	/* 138 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT16_SIZE,
+				5,
+				2,
+				"Layer_Set_Value_Uint16_Vec2",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC3_UINT16,	/* 139 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT16_SIZE,
+				6,
+				2,
+				"Layer_Set_Value_Uint16_Vec3",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE, "Value[1]"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC4_UINT16,	/* 140 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT16_SIZE,
+				7,
+				2,
+				"Layer_Set_Value_Uint16_Vec4",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE, "Value[1]"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE  + UINT16_SIZE, "Value[3]"},
+				}
+		},
+		/* Uint32 */
+		{
+				CMD_LAYER_SET_UINT32,		/* 141 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
+				4,
+				2,
+				"Layer_Set_Value_Uint32",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC2_UINT32,	/* 142 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT32_SIZE,
+				5,
+				2,
+				"Layer_Set_Value_Uint32_Vec2",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC3_UINT32,	/* 143 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT32_SIZE,
+				6,
+				2,
+				"Layer_Set_Value_Uint32_Vec3",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[1]"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC4_UINT32,	/* 144 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT32_SIZE,
+				7,
+				2,
+				"Layer_Set_Value_Uint32_Vec4",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[1]"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[3]"},
+				}
+		},
+		/* Uint64 */
+		{
+				CMD_LAYER_SET_UINT64,		/* 145 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE,
+				4,
+				2,
+				"Layer_Set_Value_Uint64",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC2_UINT64,	/* 146 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT64_SIZE,
+				5,
+				2,
+				"Layer_Set_Value_Uint64_Vec2",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC3_UINT64,	/* 147 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT64_SIZE,
+				6,
+				2,
+				"Layer_Set_Value_Uint64_Vec3",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE, "Value[1]"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC4_UINT64,	/* 148 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT64_SIZE,
+				7,
+				2,
+				"Layer_Set_Value_Uint64_Vec4",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE, "Value[1]"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"},
+						{ITEM_UINT64, UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[3]"},
+				}
+		},
+		/* Real16 */
+		{
+				CMD_LAYER_SET_REAL16,		/* 149 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE,
+				4,
+				2,
+				"Layer_Set_Value_Real16",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC2_REAL16,	/* 150 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL16_SIZE,
+				5,
+				2,
+				"Layer_Set_Value_Real16_Vec2",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC3_REAL16,	/* 151 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL16_SIZE,
+				6,
+				2,
+				"Layer_Set_Value_Real16_Vec3",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE, "Value[1]"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC4_REAL16,	/* 152 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL16_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL16_SIZE,
+				7,
+				2,
+				"Layer_Set_Value_Real16_Vec4",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE, "Value[1]"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
+						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[3]"},
+				}
+		},
+		/* Real32 */
+		{
+				CMD_LAYER_SET_REAL32,		/* 153 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE,
+				4,
+				2,
+				"Layer_Set_Value_Real32",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC2_REAL32,	/* 154 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL32_SIZE,
+				5,
+				2,
+				"Layer_Set_Value_Real32_Vec2",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC3_REAL32,	/* 155 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL32_SIZE,
+				6,
+				2,
+				"Layer_Set_Value_Real32_Vec3",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE, "Value[1]"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC4_REAL32,	/* 156 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL32_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL32_SIZE,
+				7,
+				2,
+				"Layer_Set_Value_Real32_Vec4",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE, "Value[1]"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
+						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[3]"},
+				}
+		},
+		/* Real64 */
+		{
+				CMD_LAYER_SET_REAL64,		/* 157 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE,
+				4,
+				2,
+				"Layer_Set_Value_Real64",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC2_REAL64,	/* 158 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL64_SIZE,
+				5,
+				2,
+				"Layer_Set_Value_Real64_Vec2",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE, "Value[1]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC3_REAL64,	/* 159 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL64_SIZE,
+				6,
+				2,
+				"Layer_Set_Value_Real64_Vec3",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE, "Value[1]"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
+				}
+		},
+		{
+				CMD_LAYER_SET_VEC4_REAL64,	/* 159 */
+				NODE_CMD | SHARE_ADDR,		/* Flags */
+				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
+				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL64_SIZE,
+				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL64_SIZE,
+				7,
+				2,
+				"Layer_Set_Value_Real64_Vec4",
+				{
+						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
+						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
+						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE, "Value[1]"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
+						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[3]"},
+				}
+		},
+
+		{161,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{162,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{163,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{164,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{165,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{166,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{167,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{168,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{169,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{170,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{171,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{172,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{173,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{174,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{175,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{176,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{177,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{178,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{179,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{180,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{181,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{182,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{183,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{184,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{185,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{186,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{187,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{188,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{189,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{190,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{191,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{192,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{193,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{194,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{195,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{196,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{197,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{198,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{199,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+
+		{200,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{201,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{202,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{203,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{204,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{205,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{206,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{207,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{208,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{209,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{210,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{211,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{212,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{213,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{214,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{215,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{216,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{217,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{218,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{219,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{220,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{221,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{222,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{223,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{224,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{225,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{226,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{227,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{228,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{229,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{230,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{231,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{232,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{233,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{234,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{235,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{236,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{237,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{238,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{239,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{240,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{241,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{242,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{243,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{244,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{245,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{246,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{247,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{248,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{249,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{250,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{251,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{252,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{253,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{254,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
+		{255,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}}
+};
@@ -45,1548 +45,18 @@
 #include "v_unpack.h"
 #include "v_pack.h"
 #include "v_list.h"
+#include "v_pool.h"
+#include "v_atomic.h"
 
 #include "v_commands.h"
+#include "v_cmd_codec.h"
 #include "v_fake_commands.h"
 #include "v_node_commands.h"
 #include "v_taggroup_commands.h"
 #include "v_cmd_queue.h"
 #include "v_in_queue.h"
 
-/**
- * Definition of structure of all supported commands. Following array should be
- * automatically generated from configuration file. With following structure:
- *
- * Node_Cmd(SHARE_ADDR) {
- * }
- */
-const struct Cmd_Struct cmd_struct[MAX_CMD_ID+1] = {
-		{ 0 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 1 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 2 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 3 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 4 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 5 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 6 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 7 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 8 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 9 ,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 10,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 11,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 12,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 13,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 14,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 15,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 16,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 17,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 18,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 19,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 20,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 21,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 22,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 23,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 24,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 25,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 26,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 27,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 28,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 29,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 30,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 31,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{
-				CMD_NODE_CREATE,	/* 32 */
-				NODE_CMD | SHARE_ADDR,
-				UINT16_SIZE + UINT32_SIZE,	/* Address size */
-				UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT16_SIZE, /* Command size in memory */
-				UINT8_SIZE  + UINT8_SIZE  + UINT8_SIZE  + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT16_SIZE, /* Minimal command size in packet */
-				4,	/* Number of items */
-				2,	/* Number of items that are part of address */
-				"Node_Create",	/* Name of command */
-				{	/* Items */
-						{ITEM_UINT16, UINT16_SIZE, 0, "User_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE, "Parent_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE + UINT32_SIZE, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Custom_Type"}
-				}
-		},
-		{
-				CMD_NODE_DESTROY,	/* 33 */
-				NODE_CMD | REM_DUP,
-				UINT32_SIZE, /* Address size */
-				UINT32_SIZE, /* Command size in memory */
-				UINT8_SIZE  + UINT8_SIZE + UINT32_SIZE, /* Minimal command size in packet */
-				1, /* Number of items */
-				1, /* Number of items that are part of address */
-				"Node_Destroy",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"}
-				}
-		},
-		{
-				CMD_NODE_SUBSCRIBE,	/* 34 */
-				NODE_CMD | REM_DUP,
-				UINT32_SIZE, /* Address size */
-				UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
-				3, /* Number of items */
-				1, /* Number of items that are part of address */
-				"Node_Subscribe",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Version"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT32_SIZE, "CRC_32"}
-				}
-		},
-		{
-				CMD_NODE_UNSUBSCRIBE,	/* 35 */
-				NODE_CMD | REM_DUP,
-				UINT32_SIZE, /* Address size */
-				UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
-				3,
-				1,
-				"Node_UnSubscribe",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Version"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT32_SIZE, "CRC_32"}
-				}
-		},
-		{ 36,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{
-				CMD_NODE_LINK,			/* 37 */
-				NODE_CMD | SHARE_ADDR,
-				UINT32_SIZE,
-				UINT32_SIZE + UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE,
-				2,
-				1,
-				"Node_Link",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Parent_Node_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Child_Node_ID"}
-				}
-		},
-		{
-				CMD_NODE_PERMISSION,		/* 38 */
-				NODE_CMD | SHARE_ADDR,		/* flags*/
-				UINT16_SIZE + UINT8_SIZE,	/* Address size */
-				UINT16_SIZE + UINT8_SIZE + UINT32_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE + UINT8_SIZE + UINT32_SIZE,	/* Minimal command size in packet */
-				3,	/* Number of items */
-				2,	/* Number of items that are part of address */
-				"Node_Permision",	/* Name */
-				{
-						{ITEM_UINT16, UINT16_SIZE, 0, "User_ID"},
-						{ITEM_UINT8,  UINT8_SIZE,  UINT16_SIZE, "Permissions"},
-						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE + UINT8_SIZE, "Node_ID"},
-				}
-		},
-		{
-				CMD_DEFAULT_PERMISSION,		/* 39 */
-				0,
-				0,
-				0,
-				0,
-				0,
-				0,
-				"Default_Node_Permissions",
-				{
-						{ITEM_RESERVED,0,0,""},
-				}
-		},
-		{
-				CMD_NODE_OWNER,				/* 40*/
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT16_SIZE,				/* Address size */
-				UINT16_SIZE + UINT32_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE + UINT32_SIZE,	/* Minimal command size in packet */
-				2,	/* Number of items */
-				1,	/* Number of items that are part of address */
-				"Node_Owner",
-				{
-						{ITEM_UINT16, UINT16_SIZE, 0, "User_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT16_SIZE, "Node_ID"}
-				}
-		},
-		{
-				CMD_NODE_LOCK,				/* 41 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE,	/* Address size */
-				UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
-				2,	/* Number of items */
-				1,	/* Number of items, that are part of address */
-				"Node_Lock",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Avatar_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Node_ID"}
-				}
-		},
-		{
-				CMD_NODE_UNLOCK,			/* 42 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE,				/* Address size */
-				UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT32_SIZE, /* Minimal command size in packet */
-				2,		/* Number of items */
-				1,		/* Number of items, that are part of address */
-				"Node_UnLock",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Avatar_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE, "Node_ID"}
-				}
-		},
-		{
-				CMD_NODE_PRIORITY,	/* 43 */
-				NODE_CMD | SHARE_ADDR,
-				UINT8_SIZE,
-				UINT8_SIZE + UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE,
-				2,
-				1,
-				"Node_Priority",
-				{
-						{ITEM_UINT8,  UINT8_SIZE, 0, "Priority"},
-						{ITEM_UINT32, UINT32_SIZE, UINT8_SIZE, "Node_ID"}
-				}
-		},
-		{ 44,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 45,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 46,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 47,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 48,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 49,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 50,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 51,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 52,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 53,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 54,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 55,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 56,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 57,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 58,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 59,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 60,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 61,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 62,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{ 63,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		/* TagGroup and Tag Commands */
-		{
-				CMD_TAGGROUP_CREATE,	/* 64 */
-				NODE_CMD | SHARE_ADDR,
-				UINT32_SIZE,	/* Address size */
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, /* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, /* Minimal command size in packet */
-				3,
-				1,
-				"TagGroup_Create",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Custom_Type"}
-				}
-		},
-		{
-				CMD_TAGGROUP_DESTROY,	/* 65 */
-				NODE_CMD | SHARE_ADDR,
-				UINT32_SIZE,
-				UINT32_SIZE + UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE,
-				2,
-				1,
-				"TagGroup_Destroy",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"}
-				}
-		},
-		{
-				CMD_TAGGROUP_SUBSCRIBE,	/* 66 */
-				NODE_CMD | SHARE_ADDR,
-				UINT32_SIZE,
-				UINT32_SIZE + UINT16_SIZE  + UINT32_SIZE + UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
-				4,
-				1,
-				"TagGroup_Subscribe",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
-				}
-		},
-		{
-				CMD_TAGGROUP_UNSUBSCRIBE,	/* 67 */
-				NODE_CMD | SHARE_ADDR,
-				UINT32_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
-				4,
-				1,
-				"TagGroup_Unsubscribe",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
-				}
-		},
-		{
-				CMD_TAG_CREATE,		/* 68 */
-				NODE_CMD | SHARE_ADDR,
-				UINT32_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE, /* Minimal command size in packet */
-				6,
-				2,
-				"Tag_Create",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT8,  UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Data_Type"},
-						{ITEM_UINT8,  UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Count"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Custom_Type"}
-				}
-		},
-		{
-				CMD_TAG_DESTROY,	/* 69 */
-				NODE_CMD | SHARE_ADDR,
-				UINT32_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				3,
-				2,
-				"Tag_Destroy",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"}
-				}
-		},
-		/* Uint8 */
-		{
-				CMD_TAG_SET_UINT8,	/* 70 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT8_SIZE,
-				4,
-				3,
-				"Tag_Set_UInt8_Scalar",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_UINT8,	/* 71 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT8_SIZE,
-				5,
-				3,
-				"Tag_Set_UInt8_Vec2",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Value[1]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC3_UINT8,	/* 72 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT8_SIZE,
-				6,
-				3,
-				"Tag_Set_UInt8_Vec3",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Value[1]"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC4_UINT8,	/* 73 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT8_SIZE,
-				7,
-				3,
-				"Tag_Set_UInt8_Vec4",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Value[1]"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"},
-						{ITEM_UINT8,   UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[3]"}
-				}
-		},
-		/* Uint16 */
-		{
-				CMD_TAG_SET_UINT16,	/* 74 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT16_SIZE,
-				4,
-				3,
-				"Tag_Set_UInt16",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_UINT16,	/* 75 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT16_SIZE,
-				5,
-				3,
-				"Tag_Set_UInt16_Vec2",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC3_UINT16,	/* 76 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT16_SIZE,
-				6,
-				3,
-				"Tag_Set_UInt16_Vec3",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC4_UINT16,	/* 77 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT16_SIZE,
-				7,
-				3,
-				"Tag_Set_UInt16_Vec4",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[3]"}
-				}
-		},
-		/* Uint32 */
-		{
-				CMD_TAG_SET_UINT32,	/* 78 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE,
-				4,
-				3,
-				"Tag_Set_UInt32",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_UINT32,	/* 79 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT32_SIZE,
-				5,
-				3,
-				"Tag_Set_UInt32_Vec2",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[1]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC3_UINT32,	/* 80 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT32_SIZE,
-				6,
-				3,
-				"Tag_Set_UInt32_Vec3",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[1]"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC4_UINT32,	/* 81 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT32_SIZE,
-				7,
-				3,
-				"Tag_Set_UInt32_Vec4",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[1]"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"},
-						{ITEM_UINT32,  UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[3]"}
-				}
-		},
-		/* Uint64 */
-		{
-				CMD_TAG_SET_UINT64,	/* 82 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*UINT64_SIZE,
-				4,
-				3,
-				"Tag_Set_UInt64",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_UINT64,	/* 83 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*UINT64_SIZE,
-				5,
-				3,
-				"Tag_Set_Vec2_UInt64",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE, "Value[1]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC3_UINT64,	/* 84 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*UINT64_SIZE,
-				6,
-				3,
-				"Tag_Set_Vec3_UInt64",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE, "Value[1]"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC4_UINT64,	/* 85 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*UINT64_SIZE,
-				7,
-				3,
-				"Tag_Set_Vec4_UInt64",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE, "Value[1]"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"},
-						{ITEM_UINT64,  UINT64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT64_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[3]"}
-				}
-		},
-		/* Real16 */
-		{
-				CMD_TAG_SET_REAL16,	/* 86 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL16_SIZE,
-				4,
-				3,
-				"Tag_Set_Real16",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_REAL16,	/* 87 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL16_SIZE,
-				5,
-				3,
-				"Tag_Set_Real16_Vec2",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[1]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC3_REAL16,	/* 88 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL16_SIZE,
-				6,
-				3,
-				"Tag_Set_Real16_Vec3",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE, "Value[1]"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_TAG_SET_VEC4_REAL16,	/* 89 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL16_SIZE,
-				7,
-				3,
-				"Tag_Set_Real16_Vec4",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE, "Value[1]"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
-						{ITEM_REAL16,  REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[3]"},
-				}
-		},
-		/* Real32 */
-		{
-				CMD_TAG_SET_REAL32,	/* 90 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE,
-				4,
-				3,
-				"Tag_Set_Real32",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_REAL32,	/* 91 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL32_SIZE,
-				5,
-				3,
-				"Tag_Set_Real32_Vec2",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE, "Value[1]"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC3_REAL32,	/* 92 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL32_SIZE,
-				6,
-				3,
-				"Tag_Set_Real16_Vec3",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE, "Value[1]"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_TAG_SET_VEC4_REAL32,	/* 93 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL32_SIZE,
-				7,
-				3,
-				"Tag_Set_Real32_Vec4",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE, "Value[1]"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
-						{ITEM_REAL32,  REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[3]"},
-				}
-		},
-		/* Real64 */
-		{
-				CMD_TAG_SET_REAL64,	/* 94 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 1*REAL64_SIZE,
-				4,
-				3,
-				"Tag_Set_Real64",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_REAL64,	/* 95 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 2*REAL64_SIZE,
-				5,
-				3,
-				"Tag_Set_Real64_Vec2",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_TAG_SET_VEC3_REAL64,	/* 96 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 3*REAL64_SIZE,
-				6,
-				3,
-				"Tag_Set_Real64_Vec3",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE, "Value[1]"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_TAG_SET_VEC2_REAL64,	/* 97 */
-				NODE_CMD | SHARE_ADDR | REM_DUP,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + 4*REAL64_SIZE,
-				7,
-				3,
-				"Tag_Set_Real64_Vec4",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[0]"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE, "Value[1]"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
-						{ITEM_REAL64,  REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + REAL64_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[3]"}
-				}
-		},
-		/* String8 */
-		{
-				CMD_TAG_SET_STRING8,	/* 98 */
-				NODE_CMD | SHARE_ADDR | REM_DUP | VAR_LEN,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE,
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + STRING8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE,
-				4,
-				3,
-				"Tag_Set_String8",
-				{
-						{ITEM_UINT32,  UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE, "TagGroup_ID"},
-						{ITEM_UINT16,  UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Tag_ID"},
-						{ITEM_STRING8, STRING8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value"}
-				}
-		},
-		{ 99,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-
-		{100,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{101,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{102,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{103,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{104,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{105,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{106,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{107,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{108,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{109,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{110,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{111,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{112,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{113,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{114,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{115,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{116,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{117,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{118,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{119,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{120,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{121,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{122,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{123,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{124,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{125,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{126,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{127,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-
-		/* Layers commands */
-		{
-				CMD_LAYER_CREATE,			/* 128 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address size */
-				UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE + UINT16_SIZE,	/* Minimal command size in packet */
-				6,							/* Number of items */
-				2,							/* Number of items that are part of address */
-				"Layer_Create",				/* Command name */
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Parent_Layer_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE + UINT16_SIZE, "Layer_ID"},
-						{ITEM_UINT8, UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Data_Type"},
-						{ITEM_UINT8, UINT8_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE, "Count"},
-						{ITEM_UINT16, UINT16_SIZE,  UINT32_SIZE + UINT16_SIZE + UINT16_SIZE + UINT8_SIZE + UINT8_SIZE, "Custom_Type"}
-				}
-		},
-		{
-				CMD_LAYER_DESTROY,			/* 129 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE,				/* Address size */
-				UINT32_SIZE + UINT16_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE,
-				2,							/* Number of items */
-				1,							/* Number of items that are part of address */
-				"Layer_Destroy",			/* Command name */
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"}
-
-				}
-		},
-		{
-				CMD_LAYER_SUBSCRIBE,		/* 130 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE,				/* Address size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
-				4,							/* Number of items */
-				1,							/* Number of items that are part of address */
-				"Layer_Subscribe",			/* Command name */
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
-				}
-		},
-		{
-				CMD_LAYER_UNSUBSCRIBE,		/* 131 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE,				/* Address size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
-				4,							/* Number of items */
-				1,							/* Number of items that are part of address */
-				"Layer_UnSubscribe",		/* Command name */
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Version"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "CRC32"}
-				}
-		},
-		{
-				CMD_LAYER_UNSET_VALUE,		/* 132 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE,	/* Command size in memory */
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE,
-				3,							/* Number of items */
-				2,							/* Number of items that are part of address */
-				"Layer_UnSet_Value",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-				}
-		},
-		/* Uint8 */
-		{
-				CMD_LAYER_SET_UINT8,		/* 133 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE,
-				4,
-				2,
-				"Layer_Set_Value_Uint8",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC2_UINT8,	/* 134 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT8_SIZE,
-				5,
-				2,
-				"Layer_Set_Value_Uint8_Vec2",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC3_UINT8,	/* 135 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT8_SIZE,
-				6,
-				2,
-				"Layer_Set_Value_Uint8_Vec3",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE, "Value[1]"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC4_UINT8,	/* 136 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT8_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT8_SIZE,
-				7,
-				2,
-				"Layer_Set_Value_Uint8_Vec4",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE, "Value[1]"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[2]"},
-						{ITEM_UINT8,  UINT8_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT8_SIZE + UINT8_SIZE + UINT8_SIZE, "Value[3]"},
-				}
-		},
-		/* Uint16 */
-		{
-				CMD_LAYER_SET_UINT16,		/* 137 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE,
-				4,
-				2,
-				"Layer_Set_Value_Uint16",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC2_UINT16,	/* 138 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT16_SIZE,
-				5,
-				2,
-				"Layer_Set_Value_Uint16_Vec2",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC3_UINT16,	/* 139 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT16_SIZE,
-				6,
-				2,
-				"Layer_Set_Value_Uint16_Vec3",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE, "Value[1]"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC4_UINT16,	/* 140 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT16_SIZE,
-				7,
-				2,
-				"Layer_Set_Value_Uint16_Vec4",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE, "Value[1]"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE, "Value[2]"},
-						{ITEM_UINT16, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT16_SIZE + UINT16_SIZE  + UINT16_SIZE, "Value[3]"},
-				}
-		},
-		/* Uint32 */
-		{
-				CMD_LAYER_SET_UINT32,		/* 141 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE,
-				4,
-				2,
-				"Layer_Set_Value_Uint32",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC2_UINT32,	/* 142 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT32_SIZE,
-				5,
-				2,
-				"Layer_Set_Value_Uint32_Vec2",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC3_UINT32,	/* 143 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT32_SIZE,
-				6,
-				2,
-				"Layer_Set_Value_Uint32_Vec3",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[1]"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC4_UINT32,	/* 144 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT32_SIZE,
-				7,
-				2,
-				"Layer_Set_Value_Uint32_Vec4",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[1]"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[2]"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE + UINT32_SIZE, "Value[3]"},
-				}
-		},
-		/* Uint64 */
-		{
-				CMD_LAYER_SET_UINT64,		/* 145 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE,
-				4,
-				2,
-				"Layer_Set_Value_Uint64",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC2_UINT64,	/* 146 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*UINT64_SIZE,
-				5,
-				2,
-				"Layer_Set_Value_Uint64_Vec2",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC3_UINT64,	/* 147 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*UINT64_SIZE,
-				6,
-				2,
-				"Layer_Set_Value_Uint64_Vec3",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE, "Value[1]"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC4_UINT64,	/* 148 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*UINT64_SIZE,
-				7,
-				2,
-				"Layer_Set_Value_Uint64_Vec4",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE, "Value[1]"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[2]"},
-						{ITEM_UINT64, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + UINT64_SIZE + UINT64_SIZE + UINT64_SIZE, "Value[3]"},
-				}
-		},
-		/* Real16 */
-		{
-				CMD_LAYER_SET_REAL16,		/* 149 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE,
-				4,
-				2,
-				"Layer_Set_Value_Real16",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC2_REAL16,	/* 150 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL16_SIZE,
-				5,
-				2,
-				"Layer_Set_Value_Real16_Vec2",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC3_REAL16,	/* 151 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL16_SIZE,
-				6,
-				2,
-				"Layer_Set_Value_Real16_Vec3",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE, "Value[1]"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC4_REAL16,	/* 152 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL16_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL16_SIZE,
-				7,
-				2,
-				"Layer_Set_Value_Real16_Vec4",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE, "Value[1]"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[2]"},
-						{ITEM_REAL16, REAL16_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL16_SIZE + REAL16_SIZE + REAL16_SIZE, "Value[3]"},
-				}
-		},
-		/* Real32 */
-		{
-				CMD_LAYER_SET_REAL32,		/* 153 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE,
-				4,
-				2,
-				"Layer_Set_Value_Real32",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC2_REAL32,	/* 154 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL32_SIZE,
-				5,
-				2,
-				"Layer_Set_Value_Real32_Vec2",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC3_REAL32,	/* 155 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL32_SIZE,
-				6,
-				2,
-				"Layer_Set_Value_Real32_Vec3",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE, "Value[1]"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC4_REAL32,	/* 156 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL32_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL32_SIZE,
-				7,
-				2,
-				"Layer_Set_Value_Real32_Vec4",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE, "Value[1]"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[2]"},
-						{ITEM_REAL32, REAL32_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL32_SIZE + REAL32_SIZE + REAL32_SIZE, "Value[3]"},
-				}
-		},
-		/* Real64 */
-		{
-				CMD_LAYER_SET_REAL64,		/* 157 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE,
-				4,
-				2,
-				"Layer_Set_Value_Real64",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC2_REAL64,	/* 158 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 2*REAL64_SIZE,
-				5,
-				2,
-				"Layer_Set_Value_Real64_Vec2",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE, "Value[1]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC3_REAL64,	/* 159 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 3*REAL64_SIZE,
-				6,
-				2,
-				"Layer_Set_Value_Real64_Vec3",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE, "Value[1]"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
-				}
-		},
-		{
-				CMD_LAYER_SET_VEC4_REAL64,	/* 159 */
-				NODE_CMD | SHARE_ADDR,		/* Flags */
-				UINT32_SIZE + UINT16_SIZE,	/* Address Size */
-				UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL64_SIZE,
-				UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + 4*REAL64_SIZE,
-				7,
-				2,
-				"Layer_Set_Value_Real64_Vec4",
-				{
-						{ITEM_UINT32, UINT32_SIZE, 0, "Node_ID"},
-						{ITEM_UINT16, UINT16_SIZE, UINT32_SIZE, "Layer_ID"},
-						{ITEM_UINT32, UINT32_SIZE, UINT32_SIZE + UINT16_SIZE, "Item_ID"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE, "Value[0]"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE, "Value[1]"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[2]"},
-						{ITEM_REAL64, REAL64_SIZE, UINT32_SIZE + UINT16_SIZE + UINT32_SIZE + REAL64_SIZE + REAL64_SIZE + REAL64_SIZE, "Value[3]"},
-				}
-		},
-
-		{161,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{162,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{163,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{164,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{165,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{166,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{167,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{168,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{169,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{170,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{171,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{172,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{173,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{174,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{175,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{176,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{177,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{178,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{179,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{180,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{181,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{182,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{183,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{184,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{185,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{186,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{187,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{188,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{189,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{190,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{191,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{192,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{193,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{194,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{195,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{196,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{197,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{198,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{199,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-
-		{200,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{201,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{202,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{203,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{204,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{205,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{206,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{207,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{208,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{209,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{210,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{211,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{212,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{213,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{214,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{215,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{216,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{217,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{218,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{219,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{220,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{221,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{222,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{223,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{224,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{225,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{226,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{227,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{228,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{229,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{230,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{231,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{232,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{233,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{234,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{235,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{236,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{237,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{238,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{239,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{240,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{241,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{242,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{243,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{244,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{245,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{246,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{247,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{248,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{249,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{250,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{251,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{252,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{253,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{254,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}},
-		{255,0,0,0,0,0,0,"",{{ITEM_RESERVED,0,0,""},}}
-};
+extern const struct Cmd_Struct cmd_struct[];
 
 /**
  * \brief This function prints content of the command
@@ -1646,16 +116,87 @@ void v_cmd_print(const unsigned char level,
 	}
 }
 
+/**
+ * Header stored in front of each node command. Node commands are not changed,
+ * when they are added to the outgoing queue. Thus one command could be shared
+ * by queues and histories of several sessions and it is destroyed, when the
+ * last reference is dropped.
+ */
+typedef struct VCmdHeader {
+	volatile int32	refcount;	/* Number of references at command */
+	volatile int32	wire_state;	/* State of cached network encoded items */
+	uint8			*wire;		/* Network encoded items of shared command */
+} VCmdHeader;
+
+#define CMD_HEADER(cmd)		((struct VCmdHeader*)(cmd) - 1)
+#define CMD_ALLOC_SIZE(id)	(sizeof(struct VCmdHeader) + UINT8_SIZE + cmd_struct[(id)].size)
+
+/* States of cached network encoded items */
+#define CMD_WIRE_NONE		0
+#define CMD_WIRE_BUILDING	1
+#define CMD_WIRE_READY		2
+
+/**
+ * \brief This function allocates new node command with one reference. Only
+ * id of the command is set.
+ * \param[in]	id	The ID of node command
+ * \return This function returns pointer at new command or NULL, when there
+ * is not enough memory.
+ */
+struct Generic_Cmd *v_cmd_alloc(const uint8 id)
+{
+	struct VCmdHeader *header;
+	struct Generic_Cmd *cmd;
+
+	assert(id >= MIN_CMD_ID);
+
+	header = (struct VCmdHeader*)v_pool_alloc(CMD_ALLOC_SIZE(id));
+	if(header == NULL) {
+		v_print_log(VRS_PRINT_ERROR, "Out of memory\n");
+		return NULL;
+	}
+
+	header->refcount = 1;
+	header->wire_state = CMD_WIRE_NONE;
+	header->wire = NULL;
+
+	cmd = (struct Generic_Cmd*)(header + 1);
+	cmd->id = id;
+
+	return cmd;
+}
+
+/**
+ * \brief This function adds new reference at node command. It is used, when
+ * one command is added to the outgoing queues of several sessions. Each
+ * reference has to be dropped with v_cmd_destroy().
+ * \return This function returns pointer at the same command.
+ */
+struct Generic_Cmd *v_cmd_ref(struct Generic_Cmd *cmd)
+{
+	assert(cmd->id >= MIN_CMD_ID);
+
+	V_ATOMIC_INC(&CMD_HEADER(cmd)->refcount);
+
+	return cmd;
+}
+
 /**
  * \brief This function destroy command.
  *
  * This function should be called, when command is removed from the queue or
- * history of sent commands.
+ * history of sent commands. Node command is freed, when the last reference
+ * at this command is dropped.
  */
 void v_cmd_destroy(struct Generic_Cmd **cmd)
 {
 	if( (*cmd)->id >= MIN_CMD_ID ) {
 		/* Regular commands */
+		if(V_ATOMIC_DEC(&CMD_HEADER(*cmd)->refcount) > 0) {
+			*cmd = NULL;
+			return;
+		}
+
 		if( cmd_struct[(*cmd)->id].flag & VAR_LEN ) {
 			int i;
 			for(i=0; i< cmd_struct[(*cmd)->id].item_count; i++) {
@@ -1665,7 +206,10 @@ void v_cmd_destroy(struct Generic_Cmd **cmd)
 				}
 			}
 		}
-		free(*cmd);
+		if(CMD_HEADER(*cmd)->wire != NULL) {
+			v_pool_free(CMD_HEADER(*cmd)->wire, cmd_struct[(*cmd)->id].size);
+		}
+		v_pool_free(CMD_HEADER(*cmd), CMD_ALLOC_SIZE((*cmd)->id));
 		*cmd = NULL;
 	} else {
 		/* Fake commands */
@@ -1734,18 +278,83 @@ uint16 v_cmd_unpack_len(const char *buffer,
 	return buffer_pos;
 }
 
+/**
+ * \brief This function unpacks items of command starting with item skip_items
+ * from the buffer. This function interprets description of command in
+ * cmd_struct[] and it is used for commands, that do not have specialized
+ * unpack function generated by verse_cmd_codegen.
+ * \return This function returns size of unpacked items.
+ */
+int v_cmd_unpack_items(const char *buffer,
+		const uint16 buffer_len,
+		struct Generic_Cmd *cmd,
+		const uint8 skip_items)
+{
+	uint16 buffer_pos = 0;
+	int j;
+
+	for(j = skip_items; j<cmd_struct[cmd->id].item_count; j++) {
+		switch(cmd_struct[cmd->id].items[j].type) {
+		case ITEM_RESERVED:
+			assert(cmd_struct[cmd->id].items[j].type==ITEM_RESERVED);
+			break;
+		case ITEM_INT8:
+		case ITEM_UINT8:
+			buffer_pos += vnp_raw_unpack_uint8(&buffer[buffer_pos],
+					(uint8*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
+			break;
+		case ITEM_INT16:
+		case ITEM_UINT16:
+			buffer_pos += vnp_raw_unpack_uint16(&buffer[buffer_pos],
+					(uint16*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
+			break;
+		case ITEM_INT32:
+		case ITEM_UINT32:
+			buffer_pos += vnp_raw_unpack_uint32(&buffer[buffer_pos],
+					(uint32*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
+			break;
+		case ITEM_INT64:
+		case ITEM_UINT64:
+			buffer_pos += vnp_raw_unpack_uint64(&buffer[buffer_pos],
+					(uint64*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
+			break;
+		case ITEM_REAL16:
+			buffer_pos += vnp_raw_unpack_real16(&buffer[buffer_pos],
+					(real16*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
+			break;
+		case ITEM_REAL32:
+			buffer_pos += vnp_raw_unpack_real32(&buffer[buffer_pos],
+					(real32*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
+			break;
+		case ITEM_REAL64:
+			buffer_pos += vnp_raw_unpack_real64(&buffer[buffer_pos],
+					(real64*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
+			break;
+		case ITEM_STRING8:
+			buffer_pos += vnp_raw_unpack_string8(&buffer[buffer_pos],
+					buffer_len - buffer_pos,
+					(char**)&(cmd->data[cmd_struct[cmd->id].items[j].offset]));
+			break;
+		}
+	}
+
+	return buffer_pos;
+}
+
 /**
  * \brief This function unpack one command from the buffer
  */
 static int _v_cmd_unpack(const char *buffer,
 		unsigned short buffer_len,
-		struct VInQueue *v_in_queue)
+		struct VInQueue *v_in_queue,
+		struct VRecvBuffer *rbuf,
+		const uint16 rbuf_pos)
 {
 	struct Generic_Cmd *cmd, *first_cmd = NULL;
 	uint32 buffer_pos = 0;
 	uint16 length, cmd_data_len;
 	uint8 cmd_id, cmd_addr_len, share=0, skip_items=0;
-	int i, j;
+	int i, ret;
 
 	/* Get ID (OpCode) of the command */
 	buffer_pos += vnp_raw_unpack_uint8(&buffer[buffer_pos], &cmd_id);
@@ -1819,64 +428,48 @@ static int _v_cmd_unpack(const char *buffer,
 
 		/* TODO: check if commands could be unpacked (enough buffer size) */
 
+		/* Commands with specialized unpack function are not unpacked now, but
+		 * views of received buffer are added to the queue. Commands are
+		 * unpacked, when they are popped from the queue. */
+		if(rbuf != NULL && v_cmd_codec_supported(cmd_id) == 1 &&
+				UINT8_SIZE + cmd_struct[cmd_id].size <= IN_QUEUE_CMD_BUF_SIZE)
+		{
+			uint16 addr = rbuf_pos + buffer_pos, cmd_len;
+
+			for(i=0; i < count; i++) {
+				cmd_len = (i==0) ? cmd_struct[cmd_id].size : cmd_data_len;
+				if(buffer_pos + cmd_len > buffer_len) {
+					buffer_pos = buffer_len;
+					break;
+				}
+				v_in_queue_push_view(v_in_queue, cmd_id, rbuf, addr,
+						rbuf_pos + buffer_pos, (i==0) ? 0 : skip_items);
+				buffer_pos += cmd_len;
+			}
+
+			return buffer_pos;
+		}
+
 		/* Unpack own commands compressed to this command */
 		for(i=0; (i < count) && (buffer_pos < buffer_len); i++) {
 			/* This creates new command */
-			cmd = (struct Generic_Cmd*)malloc((UINT8_SIZE + cmd_struct[cmd_id].size)*sizeof(uint8));
-			cmd->id = cmd_id;
+			cmd = v_cmd_alloc(cmd_id);
 
 			if( (share > 0) && (i > 0) ) {
 				memcpy(cmd->data, first_cmd->data, share);
 			}
 
-			for(j = (i==0) ? 0 : skip_items ; j<cmd_struct[cmd_id].item_count; j++) {
-				switch(cmd_struct[cmd_id].items[j].type) {
-				case ITEM_RESERVED:
-					assert(cmd_struct[cmd_id].items[j].type==ITEM_RESERVED);
-					break;
-				case ITEM_INT8:
-				case ITEM_UINT8:
-					buffer_pos += vnp_raw_unpack_uint8(&buffer[buffer_pos],
-							(uint8*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_INT16:
-				case ITEM_UINT16:
-					buffer_pos += vnp_raw_unpack_uint16(&buffer[buffer_pos],
-							(uint16*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_INT32:
-				case ITEM_UINT32:
-					buffer_pos += vnp_raw_unpack_uint32(&buffer[buffer_pos],
-							(uint32*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_INT64:
-				case ITEM_UINT64:
-					buffer_pos += vnp_raw_unpack_uint64(&buffer[buffer_pos],
-							(uint64*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_REAL16:
-					buffer_pos += vnp_raw_unpack_real16(&buffer[buffer_pos],
-							(real16*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_REAL32:
-					buffer_pos += vnp_raw_unpack_real32(&buffer[buffer_pos],
-							(real32*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_REAL64:
-					buffer_pos += vnp_raw_unpack_real64(&buffer[buffer_pos],
-							(real64*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_STRING8:
-					/* Only command with variable length can include string */
-					assert(0);
-					break;
-				}
+			ret = v_cmd_codec_unpack(&buffer[buffer_pos], cmd, (i==0) ? 0 : skip_items);
+			if(ret < 0) {
+				ret = v_cmd_unpack_items(&buffer[buffer_pos], buffer_len - buffer_pos,
+						cmd, (i==0) ? 0 : skip_items);
 			}
+			buffer_pos += ret;
 
 			/* Copy content of first command, when address the first command is
 			 * shared */
 			if(share > 0 && i==0) {
-				first_cmd = (struct Generic_Cmd*)calloc((UINT8_SIZE + cmd_struct[cmd_id].size), sizeof(uint8));
+				first_cmd = (struct Generic_Cmd*)v_pool_alloc(UINT8_SIZE + cmd_struct[cmd_id].size);
 				memcpy(first_cmd, cmd, (UINT8_SIZE + cmd_struct[cmd_id].size)*sizeof(uint8));
 			}
 
@@ -1892,68 +485,25 @@ static int _v_cmd_unpack(const char *buffer,
 		}
 
 		if(first_cmd != NULL) {
-			free(first_cmd);
+			v_pool_free(first_cmd, UINT8_SIZE + cmd_struct[cmd_id].size);
 			first_cmd = NULL;
 		}
 	} else {
 		for(i=0; buffer_pos<length; i++) {
 			/* This create new command */
-			cmd = (struct Generic_Cmd*)malloc((UINT8_SIZE + cmd_struct[cmd_id].size)*sizeof(uint8));
-			cmd->id = cmd_id;
+			cmd = v_cmd_alloc(cmd_id);
 
 			if( (share > 0) && (i > 0) ) {
 				memcpy(cmd->data, first_cmd->data, share);
 			}
 
-			for(j = (i==0) ? 0 : skip_items ; j<cmd_struct[cmd_id].item_count; j++) {
-				switch(cmd_struct[cmd_id].items[j].type) {
-				case ITEM_RESERVED:
-					assert(cmd_struct[cmd_id].items[j].type==ITEM_RESERVED);
-					break;
-				case ITEM_INT8:
-				case ITEM_UINT8:
-					buffer_pos += vnp_raw_unpack_uint8(&buffer[buffer_pos],
-							(uint8*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_INT16:
-				case ITEM_UINT16:
-					buffer_pos += vnp_raw_unpack_uint16(&buffer[buffer_pos],
-							(uint16*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_INT32:
-				case ITEM_UINT32:
-					buffer_pos += vnp_raw_unpack_uint32(&buffer[buffer_pos],
-							(uint32*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_INT64:
-				case ITEM_UINT64:
-					buffer_pos += vnp_raw_unpack_uint64(&buffer[buffer_pos],
-							(uint64*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_REAL16:
-					buffer_pos += vnp_raw_unpack_real16(&buffer[buffer_pos],
-							(real16*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_REAL32:
-					buffer_pos += vnp_raw_unpack_real32(&buffer[buffer_pos],
-							(real32*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_REAL64:
-					buffer_pos += vnp_raw_unpack_real64(&buffer[buffer_pos],
-							(real64*)&cmd->data[cmd_struct[cmd->id].items[j].offset]);
-					break;
-				case ITEM_STRING8:
-					buffer_pos += vnp_raw_unpack_string8(&buffer[buffer_pos],
-							buffer_len - buffer_pos,
-							(char**)&(cmd->data[cmd_struct[cmd->id].items[j].offset]));
-					break;
-				}
-			}
+			buffer_pos += v_cmd_unpack_items(&buffer[buffer_pos], buffer_len - buffer_pos,
+					cmd, (i==0) ? 0 : skip_items);
 
 			/* Copy content of first command, when address the first command is
 			 * shared */
 			if(share > 0 && i==0) {
-				first_cmd = (struct Generic_Cmd*)calloc((UINT8_SIZE + cmd_struct[cmd_id].size), sizeof(uint8));
+				first_cmd = (struct Generic_Cmd*)v_pool_alloc(UINT8_SIZE + cmd_struct[cmd_id].size);
 				memcpy(first_cmd, cmd, (UINT8_SIZE + cmd_struct[cmd_id].size)*sizeof(uint8));
 			}
 
@@ -1969,7 +519,7 @@ static int _v_cmd_unpack(const char *buffer,
 		}
 
 		if(first_cmd != NULL) {
-			free(first_cmd);
+			v_pool_free(first_cmd, UINT8_SIZE + cmd_struct[cmd_id].size);
 			first_cmd = NULL;
 		}
 	}
@@ -1991,16 +541,29 @@ int v_cmd_unpack(const char *buffer,
 		unsigned short buffer_len,
 		struct VInQueue *v_in_queue)
 {
+	struct VRecvBuffer *rbuf = NULL;
 	uint32 buffer_pos = 0;
 
+	/* Received buffer is reused for next packet. Thus node commands are
+	 * copied at once to the buffer shared by views of commands. */
+	if(v_in_queue->flags & IN_QUEUE_CMD_VIEWS) {
+		rbuf = v_in_queue_rbuf_create(buffer, buffer_len);
+	}
+
 	while( buffer_pos < buffer_len )
 	{
 		/* At least command id and its length has to be unpacked */
 		if((buffer_len-buffer_pos) >= 2) {
-			buffer_pos += _v_cmd_unpack(&buffer[buffer_pos], buffer_len - buffer_pos, v_in_queue);
+			buffer_pos += _v_cmd_unpack(&buffer[buffer_pos], buffer_len - buffer_pos,
+					v_in_queue, rbuf, buffer_pos);
 		}
 	}
 
+	/* Buffer is freed, when no view uses it */
+	if(rbuf != NULL) {
+		v_in_queue_rbuf_release(v_in_queue, rbuf);
+	}
+
 	return buffer_pos;
 }
 
@@ -2037,57 +600,19 @@ uint16 v_cmd_pack_len(char *buffer, const uint16 length)
 }
 
 /**
- * \brief This function pack command to the buffer that will be sent to the
- * peer.
- *
- * \param[in] *buffer	The buffer to be send
- * \param[in] *cmd		The pointer at generic command
- * \param[in] length	The length of the command. If this value is zero, then
- * the command will be piggy-packed to the previous command with the same id.
- * \param[in] share		The size of address, that will be shared. This value is
- * used, when previous parameter (length) is equal to zero.
- *
- * \return This function returns size of data that successfully packed to the
- * buffer. When command is not known, the this function returns 0.
+ * \brief This function packs items of command starting with item skip_items
+ * to the buffer. This function interprets description of command in
+ * cmd_struct[] and it is used for commands, that do not have specialized
+ * pack function generated by verse_cmd_codegen.
+ * \return This function returns size of packed items.
  */
-int v_cmd_pack(char *buffer,
+int v_cmd_pack_items(char *buffer,
 		const struct Generic_Cmd *cmd,
-		const uint16 length,
-		const uint8 share)
+		const uint8 skip_items)
 {
 	uint16 buffer_pos = 0;
-	uint8 skip_items=0;
 	int i;
 
-	if(length != 0) {
-		/* Pack Command ID */
-		buffer_pos += vnp_raw_pack_uint8(&buffer[buffer_pos], cmd->id);
-
-		/* Pack length of the command */
-		buffer_pos += v_cmd_pack_len(&buffer[buffer_pos], length);
-
-		/* When command support sharing, then pack sharing */
-		if( cmd_struct[cmd->id].flag & SHARE_ADDR ) {
-			/* Pack size (in bytes) of address that will be shared */
-			buffer_pos += vnp_raw_pack_uint8(&buffer[buffer_pos], share);
-		}
-	} else if( (cmd_struct[cmd->id].flag & SHARE_ADDR) && (share!=0) ) {
-		size_t shared_size;
-		/* Compute, how many items could be skipped */
-
-		/* TODO: create more effective algorithm */
-		for(i=0, shared_size=0;
-				(shared_size<share) &&
-				(i<cmd_struct[cmd->id].key_count);
-				i++)
-		{
-			shared_size += cmd_struct[cmd->id].items[i].size;
-			skip_items++;
-		}
-
-		assert(shared_size == share);
-	}
-
 	for(i=skip_items; i<cmd_struct[cmd->id].item_count; i++) {
 		switch(cmd_struct[cmd->id].items[i].type) {
 		case ITEM_RESERVED:
@@ -2135,6 +660,128 @@ int v_cmd_pack(char *buffer,
 	return buffer_pos;
 }
 
+/**
+ * \brief This function returns all items of shared command encoded in network
+ * byte order. Items are encoded only once, when the command is packed to the
+ * first packet, and they are copied to packets of other sessions.
+ *
+ * Items of fixed length command have the same size in memory and in packet.
+ * Thus the shared part of address is always prefix of encoded items.
+ *
+ * \return This function returns pointer at encoded items or NULL, when command
+ * is not shared, it has variable length or encoded items are just created by
+ * other thread.
+ */
+static const uint8 *_v_cmd_wire(const struct Generic_Cmd *cmd)
+{
+	struct VCmdHeader *header;
+	uint8 *wire;
+
+	if( cmd->id < MIN_CMD_ID || (cmd_struct[cmd->id].flag & VAR_LEN) ) {
+		return NULL;
+	}
+
+	header = CMD_HEADER(cmd);
+
+	if(header->wire_state == CMD_WIRE_READY) {
+		V_BARRIER();
+		return header->wire;
+	}
+
+	/* Command used only by one session is packed directly */
+	if(header->refcount < 2) {
+		return NULL;
+	}
+
+	if(V_ATOMIC_CAS(&header->wire_state, CMD_WIRE_NONE, CMD_WIRE_BUILDING)) {
+		wire = (uint8*)v_pool_alloc(cmd_struct[cmd->id].size);
+		if(wire == NULL) {
+			header->wire_state = CMD_WIRE_NONE;
+			return NULL;
+		}
+
+		if(v_cmd_codec_pack((char*)wire, cmd, 0) < 0) {
+			v_cmd_pack_items((char*)wire, cmd, 0);
+		}
+
+		header->wire = wire;
+		V_BARRIER();
+		header->wire_state = CMD_WIRE_READY;
+
+		return wire;
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief This function pack command to the buffer that will be sent to the
+ * peer.
+ *
+ * \param[in] *buffer	The buffer to be send
+ * \param[in] *cmd		The pointer at generic command
+ * \param[in] length	The length of the command. If this value is zero, then
+ * the command will be piggy-packed to the previous command with the same id.
+ * \param[in] share		The size of address, that will be shared. This value is
+ * used, when previous parameter (length) is equal to zero.
+ *
+ * \return This function returns size of data that successfully packed to the
+ * buffer. When command is not known, the this function returns 0.
+ */
+int v_cmd_pack(char *buffer,
+		const struct Generic_Cmd *cmd,
+		const uint16 length,
+		const uint8 share)
+{
+	const uint8 *wire;
+	uint16 buffer_pos = 0;
+	uint8 skip_items=0;
+	size_t shared_size = 0;
+	int i, ret;
+
+	if(length != 0) {
+		/* Pack Command ID */
+		buffer_pos += vnp_raw_pack_uint8(&buffer[buffer_pos], cmd->id);
+
+		/* Pack length of the command */
+		buffer_pos += v_cmd_pack_len(&buffer[buffer_pos], length);
+
+		/* When command support sharing, then pack sharing */
+		if( cmd_struct[cmd->id].flag & SHARE_ADDR ) {
+			/* Pack size (in bytes) of address that will be shared */
+			buffer_pos += vnp_raw_pack_uint8(&buffer[buffer_pos], share);
+		}
+	} else if( (cmd_struct[cmd->id].flag & SHARE_ADDR) && (share!=0) ) {
+		/* Compute, how many items could be skipped */
+
+		/* TODO: create more effective algorithm */
+		for(i=0;
+				(shared_size<share) &&
+				(i<cmd_struct[cmd->id].key_count);
+				i++)
+		{
+			shared_size += cmd_struct[cmd->id].items[i].size;
+			skip_items++;
+		}
+
+		assert(shared_size == share);
+	}
+
+	/* Copy items encoded for other session */
+	if( (wire = _v_cmd_wire(cmd)) != NULL ) {
+		memcpy(&buffer[buffer_pos], &wire[shared_size],
+				cmd_struct[cmd->id].size - shared_size);
+		return buffer_pos + cmd_struct[cmd->id].size - shared_size;
+	}
+
+	if( (ret = v_cmd_codec_pack(&buffer[buffer_pos], cmd, skip_items)) < 0 ) {
+		ret = v_cmd_pack_items(&buffer[buffer_pos], cmd, skip_items);
+	}
+	buffer_pos += ret;
+
+	return buffer_pos;
+}
+
 /**
  * \brief This function compares addresses and return size of address that
  * could be shared. If commands can't share addresses, then this function will
@@ -2173,45 +820,23 @@ uint8 v_cmd_cmp_addr(struct Generic_Cmd *cmd1,
 }
 
 /**
- * \brief This function computes how many commands could be compressed to the
- * buffer with the length: max_len.
+ * \brief This function computes length of one command in the sequence of
+ * compressed commands with fixed length.
  *
- * \param[in]	*cmd	The pointer at first command in line
- * \param[in]	max_len	The maximal length of the buffer size
+ * \param[in]	*cmd	The pointer at command in line
  * \param[in]	share	The length of the address that is shared by commands
  *
- * \return This function return number of commands that could be packet to the
- * buffer with limited size.
+ * \return This function returns count of bytes added to the sequence of
+ * compressed commands by this command.
  */
-uint16 v_cmd_count(struct Generic_Cmd *cmd,
-		uint16 max_len,
+uint16 v_cmd_item_len(const struct Generic_Cmd *cmd,
 		uint8 share)
 {
-	uint16 new_count;
-
 	if(cmd_struct[cmd->id].flag & SHARE_ADDR) {
-		if( ! (cmd_struct[cmd->id].flag & VAR_LEN) ) {
-			if(max_len < 0xFF) {
-				new_count = (max_len - (UINT8_SIZE + UINT8_SIZE + UINT8_SIZE + share))/(cmd_struct[cmd->id].size - share);
-			} else {
-				new_count = (max_len - (UINT8_SIZE + UINT8_SIZE + UINT16_SIZE + UINT8_SIZE + share))/(cmd_struct[cmd->id].size - share);
-			}
-		} else {
-			new_count = 0;
-		}
+		return cmd_struct[cmd->id].size - share;
 	} else {
-		if( ! (cmd_struct[cmd->id].flag & VAR_LEN) ) {
-			if(max_len < 0xFF) {
-				new_count = (max_len - (UINT8_SIZE + UINT8_SIZE))/(cmd_struct[cmd->id].size - UINT8_SIZE);
-			} else {
-				new_count = (max_len - (UINT8_SIZE + UINT8_SIZE + UINT16_SIZE))/(cmd_struct[cmd->id].size - UINT8_SIZE);
-			}
-		} else {
-			new_count = 0;
-		}
+		return cmd_struct[cmd->id].size;
 	}
-
-	return new_count;
 }
 
 /**
@@ -0,0 +1,731 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2010, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <string.h>
+
+#include "verse_types.h"
+
+#include "v_common.h"
+#include "v_network.h"
+#include "v_sys_commands.h"
+#include "v_history.h"
+#include "v_connection.h"
+#include "v_congestion.h"
+
+/* Gains of pacing rate in phases of PROBE_BW mode */
+static const real64 bbr_pacing_gains[BBR_CYCLE_LEN] = {
+		1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0
+};
+
+/**
+ * \brief This function returns time in microseconds
+ */
+static uint64 cc_time_us(const struct timeval *tv)
+{
+	return (uint64)tv->tv_sec*1000000 + (uint64)tv->tv_usec;
+}
+
+/**
+ * \brief This function computes cube root of non-negative number with
+ * Newton's method (libm is not linked with verse library).
+ */
+static real64 cc_cbrt(real64 x)
+{
+	real64 y, next;
+	int i;
+
+	if(x <= 0.0) {
+		return 0.0;
+	}
+
+	/* Initial value is greater than result, so sequence is decreasing */
+	y = (x > 1.0) ? x : 1.0;
+	for(i = 0; i < 100; i++) {
+		next = (2.0*y + x/(y*y))/3.0;
+		if(!(next < y)) {
+			break;
+		}
+		y = next;
+	}
+
+	return y;
+}
+
+/**
+ * \brief Initialize state of connection without Congestion Control
+ */
+static void cc_none_init(struct VDgramConn *vconn)
+{
+	vconn->cwin = 0xFFFFFFFF;
+}
+
+/**
+ * \brief Initialize state of CUBIC
+ */
+static void cubic_init(struct VDgramConn *vconn)
+{
+	struct VCubic *cubic = &vconn->cc.alg.cubic;
+
+	cubic->w_max = 0.0;
+	cubic->w_est = 0.0;
+	cubic->k = 0.0;
+	cubic->epoch_started = 0;
+}
+
+/**
+ * \brief This function increases congestion window of CUBIC, when packet
+ * was acknowledged (RFC 8312, section 4)
+ */
+static void cubic_on_ack(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+	struct VCubic *cubic = &cc->alg.cubic;
+	real64 cwin, acked, target, t;
+
+	/* Window is not increased until packets sent after congestion event
+	 * are acknowledged */
+	if(cc->in_recovery == 1) {
+		return;
+	}
+
+	/* Slow start */
+	if(vconn->cwin < cc->ssthresh) {
+		vconn->cwin += sent_packet->size;
+		return;
+	}
+
+	cwin = (real64)vconn->cwin/cc->mss;
+	acked = (real64)sent_packet->size/cc->mss;
+
+	/* Start new epoch of congestion avoidance */
+	if(cubic->epoch_started == 0) {
+		cubic->epoch = *tv;
+		cubic->epoch_started = 1;
+		if(cwin < cubic->w_max) {
+			cubic->k = cc_cbrt((cubic->w_max - cwin)/CUBIC_C);
+		} else {
+			cubic->k = 0.0;
+			cubic->w_max = cwin;
+		}
+		cubic->w_est = cwin;
+	}
+
+	/* Target window one RTT ahead: W(t) = C*(t - K)^3 + W_max */
+	t = (real64)(cc_time_us(tv) - cc_time_us(&cubic->epoch) + vconn->srtt)/1000000.0;
+	target = CUBIC_C*(t - cubic->k)*(t - cubic->k)*(t - cubic->k) + cubic->w_max;
+	if(target < cwin) {
+		target = cwin;
+	} else if(target > 1.5*cwin) {
+		target = 1.5*cwin;
+	}
+
+	/* Window of Reno with the same average throughput (TCP-friendly region) */
+	cubic->w_est += (3.0*(1.0 - CUBIC_BETA)/(1.0 + CUBIC_BETA))*acked/cwin;
+
+	cwin += (target - cwin)/cwin*acked;
+	if(cubic->w_est > cwin) {
+		cwin = cubic->w_est;
+	}
+
+	vconn->cwin = (uint32)(cwin*cc->mss);
+}
+
+/**
+ * \brief This function decreases congestion window of CUBIC, when
+ * congestion event was detected (RFC 8312, sections 4.5 - 4.7)
+ */
+static void cubic_on_loss(struct VDgramConn *vconn,
+		const struct timeval *tv,
+		int timeout)
+{
+	struct VCongestion *cc = &vconn->cc;
+	struct VCubic *cubic = &cc->alg.cubic;
+	real64 cwin = (real64)vconn->cwin/cc->mss;
+
+	(void)tv;
+
+	/* Fast convergence: release bandwidth for new flows */
+	if(cwin < cubic->w_max) {
+		cubic->w_max = cwin*(1.0 + CUBIC_BETA)/2.0;
+	} else {
+		cubic->w_max = cwin;
+	}
+
+	cc->ssthresh = (uint32)(vconn->cwin*CUBIC_BETA);
+	if(cc->ssthresh < CC_MIN_CWIN_PACKETS*cc->mss) {
+		cc->ssthresh = CC_MIN_CWIN_PACKETS*cc->mss;
+	}
+
+	vconn->cwin = (timeout == 1) ? cc->mss : cc->ssthresh;
+	cubic->epoch_started = 0;
+}
+
+/**
+ * \brief This function returns pacing rate of CUBIC. The window is spread
+ * over SRTT with small headroom for growth of window.
+ */
+static uint32 cubic_pacing_rate(struct VDgramConn *vconn)
+{
+	uint64 rate;
+
+	if(vconn->srtt == 0) {
+		return 0;
+	}
+
+	rate = (uint64)vconn->cwin*1000000/vconn->srtt;
+	rate = (vconn->cwin < vconn->cc.ssthresh) ? 2*rate : (rate*6)/5;
+
+	return (rate < 0xFFFFFFFF) ? (uint32)rate : 0xFFFFFFFF;
+}
+
+/**
+ * \brief This function returns estimated bandwidth-delay product
+ * multiplied by gain
+ */
+static uint32 bbr_bdp(struct VDgramConn *vconn, real64 gain)
+{
+	struct VBbr *bbr = &vconn->cc.alg.bbr;
+	uint64 bdp;
+
+	if(bbr->btl_bw == 0 || bbr->min_rtt == 0) {
+		return CC_INIT_CWIN_PACKETS*vconn->cc.mss;
+	}
+
+	bdp = (uint64)(gain*((uint64)bbr->btl_bw*bbr->min_rtt/1000000));
+
+	return (bdp < 0xFFFFFFFF) ? (uint32)bdp : 0xFFFFFFFF;
+}
+
+/**
+ * \brief Switch BBR to STARTUP or PROBE_BW mode
+ */
+static void bbr_enter_mode(struct VDgramConn *vconn,
+		uint8 mode,
+		const struct timeval *tv)
+{
+	struct VBbr *bbr = &vconn->cc.alg.bbr;
+
+	bbr->mode = mode;
+
+	switch(mode) {
+	case BBR_STARTUP:
+		bbr->pacing_gain = BBR_HIGH_GAIN;
+		bbr->cwin_gain = BBR_HIGH_GAIN;
+		break;
+	case BBR_DRAIN:
+		bbr->pacing_gain = 1.0/BBR_HIGH_GAIN;
+		bbr->cwin_gain = BBR_HIGH_GAIN;
+		break;
+	case BBR_PROBE_BW:
+		/* Do not start with phase draining queue */
+		bbr->cycle_index = vconn->host_id % BBR_CYCLE_LEN;
+		if(bbr->cycle_index == 1) {
+			bbr->cycle_index = 2;
+		}
+		bbr->cycle_tv = *tv;
+		bbr->pacing_gain = bbr_pacing_gains[bbr->cycle_index];
+		bbr->cwin_gain = 2.0;
+		break;
+	case BBR_PROBE_RTT:
+		bbr->pacing_gain = 1.0;
+		bbr->cwin_gain = 1.0;
+		bbr->probe_rtt_started = 0;
+		break;
+	}
+}
+
+/**
+ * \brief Initialize state of BBR
+ */
+static void bbr_init(struct VDgramConn *vconn)
+{
+	struct VBbr *bbr = &vconn->cc.alg.bbr;
+	struct timeval tv;
+
+	memset(bbr, 0, sizeof(struct VBbr));
+	bbr->inflight_hi = 0xFFFFFFFF;
+	gettimeofday(&tv, NULL);
+	bbr_enter_mode(vconn, BBR_STARTUP, &tv);
+}
+
+/**
+ * \brief This function updates min filter of RTT
+ */
+static void bbr_on_rtt_sample(struct VDgramConn *vconn,
+		uint32 rtt,
+		const struct timeval *tv)
+{
+	struct VBbr *bbr = &vconn->cc.alg.bbr;
+	int expired = 0;
+
+	if(bbr->min_rtt != 0 &&
+			cc_time_us(tv) - cc_time_us(&bbr->min_rtt_tv) > BBR_MIN_RTT_WIN) {
+		expired = 1;
+		bbr->min_rtt_expired = 1;
+	}
+
+	if(bbr->min_rtt == 0 || rtt <= bbr->min_rtt || expired == 1) {
+		bbr->min_rtt = rtt;
+		bbr->min_rtt_tv = *tv;
+	}
+}
+
+/**
+ * \brief This function updates model of path (delivery rate and round
+ * trips), it switches modes of BBR and it sets congestion window, when
+ * packet was acknowledged.
+ */
+static void bbr_on_ack(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+	struct VBbr *bbr = &cc->alg.bbr;
+	uint64 now = cc_time_us(tv), interval, rate = 0;
+	uint32 target, round_delivered, round_lost, min_cwin = BBR_MIN_CWIN_PACKETS*cc->mss;
+	int i, round_start = 0;
+
+	/* Delivery rate of data acknowledged since this packet was sent. Samples
+	 * shorter than min_rtt are caused by compression of ACKs */
+	interval = now - cc_time_us(&sent_packet->delivered_tv);
+	if(interval > 0 && interval >= bbr->min_rtt) {
+		rate = (uint64)(cc->delivered - sent_packet->delivered)*1000000/interval;
+		if(rate > 0xFFFFFFFF) {
+			rate = 0xFFFFFFFF;
+		}
+	}
+
+	/* Round trip is finished, when packet sent after the start of round
+	 * was acknowledged */
+	if((int32)(sent_packet->delivered - bbr->next_round_delivered) >= 0) {
+		bbr->next_round_delivered = cc->delivered;
+		bbr->round++;
+		bbr->bw[bbr->round % BBR_BW_FILTER_LEN] = 0;
+		round_start = 1;
+
+		/* Random loss is ignored, but loss higher then BBR_LOSS_THRESH
+		 * means overflow of buffer at bottleneck. Then inflight data are
+		 * bounded, otherwise the bound is slowly increased, when bandwidth
+		 * is probed. */
+		round_delivered = cc->delivered - bbr->round_delivered;
+		round_lost = cc->lost - bbr->round_lost;
+		if(round_lost > 0 && round_lost*BBR_LOSS_THRESH > round_delivered + round_lost) {
+			target = (uint32)(vconn->cwin*BBR_BETA);
+			if(target < bbr_bdp(vconn, 1.0)) {
+				target = bbr_bdp(vconn, 1.0);
+			}
+			if(target < bbr->inflight_hi) {
+				bbr->inflight_hi = target;
+			}
+			bbr->filled_pipe = 1;
+		} else if(bbr->inflight_hi != 0xFFFFFFFF &&
+				bbr->mode == BBR_PROBE_BW && bbr->cycle_index == 0) {
+			bbr->inflight_hi += cc->mss;
+		}
+		bbr->round_delivered = cc->delivered;
+		bbr->round_lost = cc->lost;
+	}
+
+	/* Max filter of delivery rate */
+	if(rate > bbr->bw[bbr->round % BBR_BW_FILTER_LEN]) {
+		bbr->bw[bbr->round % BBR_BW_FILTER_LEN] = (uint32)rate;
+	}
+	bbr->btl_bw = 0;
+	for(i = 0; i < BBR_BW_FILTER_LEN; i++) {
+		if(bbr->bw[i] > bbr->btl_bw) {
+			bbr->btl_bw = bbr->bw[i];
+		}
+	}
+
+	/* The pipe is full, when delivery rate did not grow by 25 % in
+	 * several rounds */
+	if(round_start == 1 && bbr->filled_pipe == 0) {
+		if(bbr->btl_bw >= bbr->full_bw + bbr->full_bw/4) {
+			bbr->full_bw = bbr->btl_bw;
+			bbr->full_bw_count = 0;
+		} else if(++bbr->full_bw_count >= BBR_FULL_BW_COUNT) {
+			bbr->filled_pipe = 1;
+		}
+	}
+
+	switch(bbr->mode) {
+	case BBR_STARTUP:
+		if(bbr->filled_pipe == 1) {
+			bbr_enter_mode(vconn, BBR_DRAIN, tv);
+		}
+		break;
+	case BBR_DRAIN:
+		/* Queue created in STARTUP mode was drained */
+		if(cc->in_flight <= bbr_bdp(vconn, 1.0)) {
+			bbr_enter_mode(vconn, BBR_PROBE_BW, tv);
+		}
+		break;
+	case BBR_PROBE_BW:
+		if(now - cc_time_us(&bbr->cycle_tv) > bbr->min_rtt) {
+			bbr->cycle_index = (bbr->cycle_index + 1) % BBR_CYCLE_LEN;
+			bbr->cycle_tv = *tv;
+			bbr->pacing_gain = bbr_pacing_gains[bbr->cycle_index];
+		}
+		break;
+	case BBR_PROBE_RTT:
+		/* Keep small window for BBR_PROBE_RTT_TIME after inflight data
+		 * was drained */
+		if(bbr->probe_rtt_started == 0) {
+			if(cc->in_flight <= min_cwin) {
+				bbr->probe_rtt_started = 1;
+				bbr->probe_rtt_done_tv.tv_sec = tv->tv_sec + (tv->tv_usec + BBR_PROBE_RTT_TIME)/1000000;
+				bbr->probe_rtt_done_tv.tv_usec = (tv->tv_usec + BBR_PROBE_RTT_TIME)%1000000;
+			}
+		} else if(now >= cc_time_us(&bbr->probe_rtt_done_tv)) {
+			bbr->min_rtt_tv = *tv;
+			bbr->min_rtt_expired = 0;
+			bbr_enter_mode(vconn,
+					(bbr->filled_pipe == 1) ? BBR_PROBE_BW : BBR_STARTUP, tv);
+		}
+		break;
+	}
+
+	/* Estimation of min_rtt is too old */
+	if(bbr->min_rtt_expired == 1 && bbr->mode != BBR_PROBE_RTT) {
+		bbr_enter_mode(vconn, BBR_PROBE_RTT, tv);
+	}
+
+	/* Set congestion window */
+	if(bbr->mode == BBR_PROBE_RTT) {
+		if(vconn->cwin > min_cwin) {
+			vconn->cwin = min_cwin;
+		}
+	} else {
+		target = bbr_bdp(vconn, bbr->cwin_gain) + 3*cc->mss;
+		if(bbr->filled_pipe == 1) {
+			vconn->cwin = (vconn->cwin + sent_packet->size < target) ?
+					vconn->cwin + sent_packet->size : target;
+		} else if(vconn->cwin < target ||
+				cc->delivered < CC_INIT_CWIN_PACKETS*cc->mss) {
+			vconn->cwin += sent_packet->size;
+		}
+		if(vconn->cwin > bbr->inflight_hi) {
+			vconn->cwin = bbr->inflight_hi;
+		}
+		if(vconn->cwin < min_cwin) {
+			vconn->cwin = min_cwin;
+		}
+	}
+}
+
+/**
+ * \brief BBR does not consider random loss of packet as signal of
+ * congestion (rate of loss is checked every round). Only expiration of
+ * retransmission timer reduces window immediately.
+ */
+static void bbr_on_loss(struct VDgramConn *vconn,
+		const struct timeval *tv,
+		int timeout)
+{
+	(void)tv;
+
+	if(timeout == 1) {
+		vconn->cwin = BBR_MIN_CWIN_PACKETS*vconn->cc.mss;
+	}
+}
+
+/**
+ * \brief This function returns pacing rate of BBR
+ */
+static uint32 bbr_pacing_rate(struct VDgramConn *vconn)
+{
+	struct VBbr *bbr = &vconn->cc.alg.bbr;
+	uint64 rate;
+
+	if(bbr->btl_bw == 0) {
+		/* No delivery rate was measured yet */
+		if(vconn->srtt == 0) {
+			return 0;
+		}
+		rate = (uint64)(BBR_HIGH_GAIN*vconn->cwin)*1000000/vconn->srtt;
+	} else {
+		rate = (uint64)(bbr->pacing_gain*bbr->btl_bw);
+	}
+
+	return (rate < 0xFFFFFFFF) ? (uint32)rate : 0xFFFFFFFF;
+}
+
+static const struct VCongestionOps cc_none_ops = {
+		CC_NONE, "none",
+		cc_none_init, NULL, NULL, NULL, NULL
+};
+
+static const struct VCongestionOps cc_cubic_ops = {
+		CC_CUBIC, "cubic",
+		cubic_init, cubic_on_ack, cubic_on_loss, NULL, cubic_pacing_rate
+};
+
+static const struct VCongestionOps cc_bbr_ops = {
+		CC_BBR, "bbr",
+		bbr_init, bbr_on_ack, bbr_on_loss, bbr_on_rtt_sample, bbr_pacing_rate
+};
+
+/**
+ * \brief This function returns implementation of Congestion Control method
+ *
+ * \param[in]	cc_meth	The negotiated method of Congestion Control
+ *
+ * \return This function returns pointer at implementation of method. When
+ * method is not supported, then NULL is returned.
+ */
+const struct VCongestionOps *v_cc_get_ops(uint8 cc_meth)
+{
+	switch(cc_meth) {
+	case CC_NONE:
+		return &cc_none_ops;
+	case CC_TCP_LIKE:
+		/* CUBIC is default Congestion Control of TCP */
+	case CC_CUBIC:
+		return &cc_cubic_ops;
+	case CC_BBR:
+		return &cc_bbr_ops;
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief This function initializes Congestion Control selected by
+ * negotiated method. It has to be called, when MTU of connection is known.
+ */
+void v_cc_init(struct VDgramConn *vconn)
+{
+	struct VCongestion *cc = &vconn->cc;
+
+	cc->ops = v_cc_get_ops(vconn->cc_meth);
+	if(cc->ops == NULL) {
+		v_print_log(VRS_PRINT_WARNING,
+				"Unsupported Congestion Control method: %d\n", vconn->cc_meth);
+		cc->ops = &cc_none_ops;
+	}
+
+	cc->mss = (vconn->io_ctx.mtu > 0) ? (uint32)vconn->io_ctx.mtu : DEFAULT_MTU;
+	cc->ssthresh = 0xFFFFFFFF;
+	cc->recover_id = vconn->host_id + vconn->count_s_pay;
+	cc->in_recovery = 0;
+
+	vconn->cwin = CC_INIT_CWIN_PACKETS*cc->mss;
+	cc->ops->init(vconn);
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Congestion Control: %s, cwin: %u\n",
+			cc->ops->name, vconn->cwin);
+}
+
+/**
+ * \brief This function returns 1, when congestion window allows sending of
+ * next payload packet. Otherwise it returns 0.
+ */
+int v_cc_can_send(struct VDgramConn *vconn)
+{
+	return (vconn->cc.in_flight < vconn->cwin) ? 1 : 0;
+}
+
+/**
+ * \brief This function stores size of sent packet and state of delivered
+ * data to the packet in the history of sent packets.
+ */
+void v_cc_packet_sent(struct VDgramConn *vconn,
+		struct VSent_Packet *sent_packet,
+		uint16 size,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+	uint64 now;
+	uint32 rate;
+
+	/* Delivery rate is not measured over idle period */
+	if(cc->in_flight == 0) {
+		cc->delivered_tv = *tv;
+	}
+
+	sent_packet->size = size;
+	sent_packet->delivered = cc->delivered;
+	sent_packet->delivered_tv = cc->delivered_tv;
+
+	cc->in_flight += size;
+
+	/* Next packet could leave the pacer, when this packet would be
+	 * transmitted at pacing rate. Unused time of idle period is not
+	 * accumulated, so the pacer never releases a whole window at once. */
+	if(cc->pacing == 1 && (rate = v_cc_pacing_rate(vconn)) != 0) {
+		now = cc_time_us(tv);
+		if(cc->pacing_us < now) {
+			cc->pacing_us = now;
+		}
+		cc->pacing_us += (uint64)size*1000000/rate;
+	}
+}
+
+/**
+ * \brief This function is called, when sent packet was acknowledged. It has
+ * to be called before the packet is removed from the history of sent
+ * packets.
+ */
+void v_cc_packet_acked(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+
+	cc->delivered += sent_packet->size;
+	cc->delivered_tv = *tv;
+
+	/* Recovery is finished, when packet sent after congestion event was
+	 * acknowledged */
+	if(cc->in_recovery == 1 &&
+			(int32)(sent_packet->id - cc->recover_id) >= 0) {
+		cc->in_recovery = 0;
+	}
+
+	if(cc->ops != NULL && cc->ops->on_ack != NULL) {
+		cc->ops->on_ack(vconn, sent_packet, tv);
+	}
+}
+
+/**
+ * \brief This function is called, when sent packet was negatively
+ * acknowledged. Losses of packets sent in the same window are one
+ * congestion event.
+ */
+void v_cc_packet_lost(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+
+	cc->lost += sent_packet->size;
+
+	if(cc->in_recovery == 1 &&
+			(int32)(sent_packet->id - cc->recover_id) < 0) {
+		return;
+	}
+
+	cc->recover_id = vconn->host_id + vconn->count_s_pay;
+	cc->in_recovery = 1;
+
+	if(cc->ops != NULL && cc->ops->on_loss != NULL) {
+		cc->ops->on_loss(vconn, tv, 0);
+	}
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Congestion event, cwin: %u, ssthresh: %u\n",
+			vconn->cwin, cc->ssthresh);
+}
+
+/**
+ * \brief This function is called with new sample of RTT in microseconds
+ */
+void v_cc_rtt_sample(struct VDgramConn *vconn,
+		uint32 rtt,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+
+	if(cc->ops != NULL && cc->ops->on_rtt_sample != NULL) {
+		cc->ops->on_rtt_sample(vconn, rtt, tv);
+	}
+}
+
+/**
+ * \brief This function is called, when retransmission timer expired
+ */
+void v_cc_timeout(struct VDgramConn *vconn,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+
+	cc->recover_id = vconn->host_id + vconn->count_s_pay;
+	cc->in_recovery = 1;
+
+	if(cc->ops != NULL && cc->ops->on_loss != NULL) {
+		cc->ops->on_loss(vconn, tv, 1);
+	}
+}
+
+/**
+ * \brief This function returns rate of pacing in bytes per second. Zero
+ * value means, that packets are not paced.
+ */
+uint32 v_cc_pacing_rate(struct VDgramConn *vconn)
+{
+	struct VCongestion *cc = &vconn->cc;
+
+	if(cc->ops != NULL && cc->ops->pacing_rate != NULL) {
+		return cc->ops->pacing_rate(vconn);
+	}
+
+	return 0;
+}
+
+/**
+ * \brief This function returns time in microseconds, that has to elapse
+ * before next payload packet could be sent. Pacer allows sending of
+ * CC_PACING_BURST_PACKETS packets back to back, because timers of the
+ * system have limited resolution.
+ *
+ * \param[in]	*vconn	The datagram connection
+ * \param[in]	*tv		The current time
+ *
+ * \return This function returns zero, when packet could be sent now or
+ * packets are not paced.
+ */
+uint32 v_cc_pacing_delay(struct VDgramConn *vconn,
+		const struct timeval *tv)
+{
+	struct VCongestion *cc = &vconn->cc;
+	uint64 now, burst;
+	uint32 rate;
+
+	if(cc->pacing == 0 || (rate = v_cc_pacing_rate(vconn)) == 0) {
+		return 0;
+	}
+
+	/* Time needed for sending previous packets of burst */
+	now = cc_time_us(tv);
+	burst = (uint64)(CC_PACING_BURST_PACKETS - 1)*cc->mss*1000000/rate;
+
+	if(cc->pacing_us <= now + burst) {
+		return 0;
+	}
+
+	return (uint32)(cc->pacing_us - burst - now);
+}
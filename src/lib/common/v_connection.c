@@ -188,17 +188,27 @@ void v_conn_dgram_init(struct VDgramConn *dgram_conn)
 	dgram_conn->count_s_ack = 0;
 	/* Ack Ration staff */
 	dgram_conn->last_acked_pay = 0;
-	/* Default Smoothed RTT */
+	/* Default Smoothed RTT and retransmission timeout */
 	dgram_conn->srtt = 0;
+	dgram_conn->rttvar = 0;
+	dgram_conn->rto = RTO_INITIAL;
+	dgram_conn->rto_backoff = 0;
+	dgram_conn->karn_id = 0;
 	dgram_conn->rwin_host = 0xFFFFFFFF;	/* Default value */
 	dgram_conn->rwin_peer = 0xFFFFFFFF;	/* Default value */
 	dgram_conn->sent_size = 0;
 	dgram_conn->rwin_host_scale = 0;	/* rwin_host is >> by this value for outgoing packet */
 	dgram_conn->rwin_peer_scale = 0;	/* rwin_host is << by this value for incoming packet */
-	dgram_conn->cwin = 0xFFFFFFFF;		/* TODO: Congestion Control */
+	dgram_conn->cwin = 0xFFFFFFFF;		/* Congestion Control is initialized in OPEN state */
+	memset(&dgram_conn->cc, 0, sizeof(struct VCongestion));
+	dgram_conn->cc.pacing = 1;			/* Payload packets are paced by default */
+	memset(&dgram_conn->pmtud, 0, sizeof(struct VPmtud));	/* PMTU discovery is started in OPEN state */
 	/* Command compression */
 	dgram_conn->host_cmd_cmpr = CMPR_RESERVED;
 	dgram_conn->peer_cmd_cmpr = CMPR_RESERVED;
+	/* PMTU probes are sent only, when peer confirmed, that it accepts them */
+	dgram_conn->host_pmtu_probe = PMTU_PROBE_RESERVED;
+	dgram_conn->peer_pmtu_probe = PMTU_PROBE_RESERVED;
 	/* Initialize array of ACK and NAK commands, that are sent to the peer */
 	v_ack_nak_history_init(&dgram_conn->ack_nak);
 	/* Initialize history of sent packets */
@@ -236,6 +246,13 @@ void v_conn_dgram_destroy(struct VDgramConn *dgram_conn)
 
 	v_ack_nak_history_clear(&dgram_conn->ack_nak);
 
+	if(dgram_conn->io_ctx.batch != NULL) {
+		v_dgram_batch_destroy(dgram_conn->io_ctx.batch);
+		dgram_conn->io_ctx.batch = NULL;
+	}
+
+	v_dgram_gro_destroy(&dgram_conn->io_ctx);
+
 #ifdef WIN32
 	closesocket(dgram_conn->io_ctx.sockfd);
 #else
@@ -261,6 +278,13 @@ void v_conn_dgram_clear(struct VDgramConn *dgram_conn)
 	}
 #endif
 
+	if(dgram_conn->io_ctx.batch != NULL) {
+		v_dgram_batch_destroy(dgram_conn->io_ctx.batch);
+		dgram_conn->io_ctx.batch = NULL;
+	}
+
+	v_dgram_gro_destroy(&dgram_conn->io_ctx);
+
 #ifdef WIN32
 	closesocket(dgram_conn->io_ctx.sockfd);
 #else
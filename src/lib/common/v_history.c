@@ -45,6 +45,7 @@
 #include "v_node_commands.h"
 #include "v_common.h"
 #include "v_list.h"
+#include "v_pool.h"
 #include "v_cmd_queue.h"
 #include "v_out_queue.h"
 #include "v_connection.h"
@@ -61,13 +62,17 @@ void v_print_packet_history(struct VPacket_History *history)
 {
 	struct VSent_Packet *packet;
 	struct VBucket *vbucket;
+	uint32 id;
 	int cmd_id;
 
 	v_print_log(VRS_PRINT_DEBUG_MSG, "Packet history:\n\t");
-	packet = history->packets.first;
-	while(packet!=NULL) {
-		v_print_log_simple(VRS_PRINT_DEBUG_MSG, "%d, ", packet->id);
-		packet = packet->next;
+	if(history->count > 0) {
+		for(id = history->first_id; id != history->last_id + 1; id++) {
+			packet = &history->packets[id & (history->size - 1)];
+			if(packet->used == 1 && packet->id == id) {
+				v_print_log_simple(VRS_PRINT_DEBUG_MSG, "%d, ", packet->id);
+			}
+		}
 	}
 	v_print_log_simple(VRS_PRINT_DEBUG_MSG, "\n");
 
@@ -84,24 +89,45 @@ void v_print_packet_history(struct VPacket_History *history)
 }
 
 /**
- * \brief This function destroy history of sent packets. It free linked list of
+ * \brief This function frees array of pointers at sent commands and sent
+ * commands of one slot in the ring of sent packets.
+ */
+static void _v_sent_packet_free_cmds(struct VSent_Packet *sent_packet)
+{
+	uint16 i;
+
+	for(i = 0; i < sent_packet->cmd_len; i++) {
+		v_pool_free(sent_packet->cmds[i], sizeof(struct VSent_Command));
+	}
+	free(sent_packet->cmds);
+	sent_packet->cmds = NULL;
+	sent_packet->cmd_len = 0;
+	sent_packet->cmd_count = 0;
+}
+
+/**
+ * \brief This function destroy history of sent packets. It free ring of
  * sent packets and all hashed linked lists of commands.
  * \param[in]	*history	The history of sent packets.
  */
 void v_packet_history_destroy(struct VPacket_History *history)
 {
-	struct VSent_Packet *sent_packet;
+	uint32 i;
 	int cmd_id;
 
-	/* Free all pointer at commands in all sent packet */
-	sent_packet = history->packets.first;
-	while(sent_packet != NULL) {
-		v_list_free(&sent_packet->cmds);
-		sent_packet = sent_packet->next;
+	/* Free arrays of pointers at commands in all slots of sent packets */
+	if(history->packets != NULL) {
+		for(i = 0; i < history->size; i++) {
+			if(history->packets[i].cmds != NULL) {
+				_v_sent_packet_free_cmds(&history->packets[i]);
+			}
+		}
+		free(history->packets);
+		history->packets = NULL;
 	}
 
-	/* Free linked list of sent packets */
-	v_list_free(&history->packets);
+	history->size = 0;
+	history->count = 0;
 
 	/* Free commands in hashed linked lists */
 	for(cmd_id=0; cmd_id <= MAX_CMD_ID; cmd_id++) {
@@ -115,25 +141,32 @@ void v_packet_history_destroy(struct VPacket_History *history)
 
 /**
  * \brief This function initialize history of sent packets. It means, that
- * linked list of sent packet is initialized and hashed linked lists of
- * supported commands are initialized.
+ * ring of sent packet is allocated and hashed linked lists of supported
+ * commands are initialized.
  * \param[in]	*history	The history of sent packets.
  */
 void v_packet_history_init(struct VPacket_History *history)
 {
 	int cmd_id;
 
-	history->packets.first = NULL;
-	history->packets.last = NULL;
+	history->packets = (struct VSent_Packet*)calloc(INIT_PACKET_HISTORY_SIZE, sizeof(struct VSent_Packet));
+	history->size = (history->packets != NULL) ? INIT_PACKET_HISTORY_SIZE : 0;
+	history->count = 0;
+	history->first_id = 0;
+	history->last_id = 0;
 
 	for(cmd_id=0; cmd_id<=MAX_CMD_ID; cmd_id++) {
 		history->cmd_hist[cmd_id] = v_cmd_queue_create(cmd_id, 0, 0);
+		/* Buckets are part of sent commands */
+		if(history->cmd_hist[cmd_id] != NULL) {
+			history->cmd_hist[cmd_id]->cmds.flags |= HASH_EXTERN_BUCKET;
+		}
 	}
 }
 
 /**
- * \brief Find packet with id in the linked list of sent packet. When such
- * packet is not found, then NULL is returned.
+ * \brief Find packet with id in the ring of sent packet. When such packet is
+ * not found, then NULL is returned.
  * \param[in]	*history	The history of sent packets.
  * \param[in]	id			The ID of packet.
  * \return		This function returns pointer at structure VSent_Packet.
@@ -141,16 +174,60 @@ void v_packet_history_init(struct VPacket_History *history)
 struct VSent_Packet *v_packet_history_find_packet(struct VPacket_History *history,
 		uint32 id)
 {
-	struct VSent_Packet *packet = NULL;
+	struct VSent_Packet *packet;
 
-	packet = history->packets.first;
+	/* Unsigned difference is bigger than size for IDs older than first ID */
+	if(history->count == 0 || (id - history->first_id) >= history->size) {
+		return NULL;
+	}
+
+	packet = &history->packets[id & (history->size - 1)];
 
-	while(packet != NULL) {
-		if(packet->id == id) break;
-		packet = packet->next;
+	if(packet->used == 1 && packet->id == id) {
+		return packet;
 	}
 
-	return packet;
+	return NULL;
+}
+
+/**
+ * \brief This function resizes ring of sent packets to be able to store
+ * packets with IDs from first_id to last_id. Packets are moved to new slots,
+ * but arrays of sent commands are not moved, so pointers at sent commands
+ * stored in hashed linked lists are still valid.
+ */
+static int _v_packet_history_resize(struct VPacket_History *history,
+		uint32 first_id,
+		uint32 last_id)
+{
+	struct VSent_Packet *packets, *packet;
+	uint32 size = history->size, i;
+
+	while(size <= last_id - first_id) {
+		size <<= 1;
+	}
+
+	packets = (struct VSent_Packet*)calloc(size, sizeof(struct VSent_Packet));
+	if(packets == NULL) {
+		return 0;
+	}
+
+	for(i = 0; i < history->size; i++) {
+		packet = &history->packets[i];
+		if(packet->used == 1) {
+			packets[packet->id & (size - 1)] = *packet;
+		} else if(packet->cmds != NULL) {
+			_v_sent_packet_free_cmds(packet);
+		}
+	}
+
+	free(history->packets);
+	history->packets = packets;
+	history->size = size;
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Size of packet history: %d\n", size);
+
+	return 1;
 }
 
 /**
@@ -164,26 +241,77 @@ struct VSent_Packet *v_packet_history_add_packet(struct VPacket_History *history
 		uint32 id)
 {
 	struct VSent_Packet *packet = NULL;
+	uint32 first_id = id, last_id = id;
 
-	packet = (struct VSent_Packet*)malloc(sizeof(struct VSent_Packet));
-
-	/* Check if memory for sent packet was allocated */
-	if(packet != NULL) {
-		packet->cmds.first = NULL;
-		packet->cmds.last = NULL;
+	if(history->count > 0) {
+		/* IDs of sent packets are increasing, but older ID is not forbidden */
+		first_id = ((int32)(id - history->first_id) < 0) ? id : history->first_id;
+		last_id = ((int32)(id - history->last_id) > 0) ? id : history->last_id;
+	}
 
-		packet->id = id;
+	/* Ring has to be bigger, when window of not acknowledged packets is
+	 * bigger than count of slots */
+	if(history->size <= last_id - first_id) {
+		if(_v_packet_history_resize(history, first_id, last_id) != 1) {
+			v_print_log(VRS_PRINT_DEBUG_MSG, "Unable to allocate enough memory for sent packet: %d\n", id);
+			return NULL;
+		}
+	}
 
-		v_print_log(VRS_PRINT_DEBUG_MSG, "Adding packet: %d to history\n", packet->id);
+	packet = &history->packets[id & (history->size - 1)];
 
-		v_list_add_tail(&history->packets, packet);
-	} else {
-		v_print_log(VRS_PRINT_DEBUG_MSG, "Unable to allocate enough memory for sent packet: %d\n", id);
+	if(packet->used == 1) {
+		/* Packet with the same ID is already in the history */
+		return packet;
 	}
 
+	packet->id = id;
+	packet->used = 1;
+	packet->cmd_count = 0;
+	packet->size = 0;
+
+	history->first_id = first_id;
+	history->last_id = last_id;
+	history->count++;
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Adding packet: %d to history\n", packet->id);
+
 	return packet;
 }
 
+/**
+ * \brief This function adds item to the array of sent commands. When the
+ * array is full, then it is reallocated and new sent commands are allocated
+ * from pool. Sent commands are not moved, because their buckets are stored in
+ * hashed linked list.
+ */
+static struct VSent_Command *_v_sent_packet_add_cmd(struct VSent_Packet *sent_packet)
+{
+	struct VSent_Command **cmds;
+	uint16 len, i;
+
+	if(sent_packet->cmd_count == sent_packet->cmd_len) {
+		len = (sent_packet->cmd_len == 0) ? INIT_SENT_CMDS_SIZE : sent_packet->cmd_len * 2;
+		cmds = (struct VSent_Command**)realloc(sent_packet->cmds, len * sizeof(struct VSent_Command*));
+		if(cmds == NULL) {
+			return NULL;
+		}
+		sent_packet->cmds = cmds;
+		for(i = sent_packet->cmd_len; i < len; i++) {
+			cmds[i] = (struct VSent_Command*)v_pool_alloc(sizeof(struct VSent_Command));
+			if(cmds[i] == NULL) {
+				break;
+			}
+		}
+		sent_packet->cmd_len = i;
+		if(sent_packet->cmd_count == sent_packet->cmd_len) {
+			return NULL;
+		}
+	}
+
+	return sent_packet->cmds[sent_packet->cmd_count++];
+}
+
 /**
  * \brief This function add command to the history of sent command
  *
@@ -208,7 +336,6 @@ int v_packet_history_add_cmd(struct VPacket_History *history,
 	struct VBucket *vbucket;
 	void *_cmd = (void*)cmd;
 	uint8 cmd_id = cmd->id;
-	uint16 cmd_size = v_cmd_struct_size(cmd);
 	int ret = 0;
 
 	/* Are duplications allowed for this type of commands? */
@@ -235,7 +362,7 @@ int v_packet_history_add_cmd(struct VPacket_History *history,
 
 			/* Remove data with the same key as cmd_data has from hashed linked
 			 * list */
-			ret = v_hash_array_remove_item(&history->cmd_hist[cmd_id]->cmds, vbucket->data);
+			ret = v_hash_array_remove_bucket(&history->cmd_hist[cmd_id]->cmds, vbucket);
 
 			if(ret == 1) {
 				/* Destroy original command */
@@ -247,39 +374,32 @@ int v_packet_history_add_cmd(struct VPacket_History *history,
 		}
 	}
 
-	/* Add own command data to the hashed linked list */
-	vbucket = v_hash_array_add_item(&history->cmd_hist[cmd_id]->cmds, _cmd, cmd_size);
-
-	if(vbucket != NULL) {
-		/* Create new command */
-		sent_cmd = (struct VSent_Command*)malloc(sizeof(struct VSent_Command));
-		/* Check if it was possible to allocate enough memory for sent command */
-		if(sent_cmd != NULL) {
-			sent_cmd->id = cmd_id;
-			/* Add command to the linked list of sent packet */
-			v_list_add_tail(&sent_packet->cmds, sent_cmd);
-			/* Set up pointer at command data */
-			sent_cmd->vbucket = vbucket;
-			/* Set up pointer at owner of this command item to be able to obsolete
-			 * this command in future */
-			vbucket->ptr = (void*)sent_cmd;
-			/* Store information about command priority. Lost commands should
-			 * be re-send with same priority*/
-			sent_cmd->prio = prio;
-
-			ret = 1;
-		} else {
-			/* When memory wasn't allocated, then free bucket from hashed
-			 * linked list */
-			v_print_log(VRS_PRINT_ERROR, "Unable allocate enough memory for sent command\n");
-			ret = v_hash_array_remove_item(&history->cmd_hist[cmd_id]->cmds, _cmd);
-			if(ret == 1) {
-				v_cmd_destroy(_cmd);
-			}
-			ret = 0;
-		}
+	/* Add new command to the array of sent packet */
+	sent_cmd = _v_sent_packet_add_cmd(sent_packet);
+
+	/* Check if it was possible to allocate enough memory for sent command */
+	if(sent_cmd == NULL) {
+		v_print_log(VRS_PRINT_ERROR, "Unable allocate enough memory for sent command\n");
+		return 0;
+	}
+
+	/* Add own command data to the hashed linked list using bucket of sent
+	 * command */
+	if(v_hash_array_add_bucket(&history->cmd_hist[cmd_id]->cmds, &sent_cmd->bucket, _cmd) == 1) {
+		sent_cmd->id = cmd_id;
+		/* Set up pointer at command data */
+		sent_cmd->vbucket = &sent_cmd->bucket;
+		/* Set up pointer at owner of this command item to be able to obsolete
+		 * this command in future */
+		sent_cmd->bucket.ptr = (void*)sent_cmd;
+		/* Store information about command priority. Lost commands should
+		 * be re-send with same priority*/
+		sent_cmd->prio = prio;
+
+		ret = 1;
 	} else {
 		v_print_log(VRS_PRINT_ERROR, "Unable to add command (id: %d) to packet history\n", cmd_id);
+		sent_packet->cmd_count--;
 		ret = 0;
 	}
 
@@ -309,13 +429,14 @@ int v_packet_history_rem_packet(struct vContext *C, uint32 id)
 
 	if(sent_packet != NULL) {
 		struct VSent_Command *sent_cmd;
+		uint16 i;
 
 		v_print_log(VRS_PRINT_DEBUG_MSG, "Removing packet: %d from history\n", sent_packet->id);
 
-		/* Go through the whole list of sent commands and free them from the
+		/* Go through the whole array of sent commands and free them from the
 		 * hashed linked list */
-		sent_cmd = sent_packet->cmds.first;
-		while(sent_cmd != NULL) {
+		for(i = 0; i < sent_packet->cmd_count; i++) {
+			sent_cmd = sent_packet->cmds[i];
 			/* Remove own command from hashed linked list if it wasn't already
 			 * removed, when command was obsoleted by some newer packet */
 			if(sent_cmd->vbucket!=NULL) {
@@ -379,7 +500,7 @@ int v_packet_history_rem_packet(struct vContext *C, uint32 id)
 				}
 
 				/* Remove command from the history of sent commands */
-				ret = v_hash_array_remove_item(&history->cmd_hist[sent_cmd->id]->cmds, sent_cmd->vbucket->data);
+				ret = v_hash_array_remove_bucket(&history->cmd_hist[sent_cmd->id]->cmds, sent_cmd->vbucket);
 
 				if(ret == 1) {
 					/* Destroy command */
@@ -389,15 +510,23 @@ int v_packet_history_rem_packet(struct vContext *C, uint32 id)
 					ret = 0;
 				}
 			}
-			sent_cmd = sent_cmd->next;
 		}
 
-		/* Free linked list of sent commands */
-		v_list_free(&sent_packet->cmds);
+		/* Packet is not in flight anymore */
+		dgram_conn->cc.in_flight -= sent_packet->size;
 
-		/* Remove packet itself from the linked list of sent packet */
-		v_list_rem_item(&history->packets, sent_packet);
-		free(sent_packet);
+		/* Array of sent commands is kept for next packet in this slot */
+		sent_packet->cmd_count = 0;
+		sent_packet->used = 0;
+		history->count--;
+
+		/* Move the oldest packet in the history to the next used slot */
+		if(history->count > 0 && id == history->first_id) {
+			do {
+				history->first_id++;
+				sent_packet = &history->packets[history->first_id & (history->size - 1)];
+			} while(sent_packet->used == 0 || sent_packet->id != history->first_id);
+		}
 
 		ret = 1;
 	} else {
@@ -410,56 +539,46 @@ int v_packet_history_rem_packet(struct vContext *C, uint32 id)
 	/* When pure ack packet caused adding some fake commands to the queue, then
 	 * poke server data thread */
 	if( (vs_ctx != NULL) && (is_fake_cmd_received == 1) && (r_packet->data == NULL)) {
-		sem_post(vs_ctx->data.sem);
+		if(v_session_ready_push(&vs_ctx->data.ready_sessions, CTX_current_session(C)) == 1) {
+			sem_post(vs_ctx->data.sem);
+		}
 	}
 
 	return ret;
 }
 
 /**
- * \brief This function print all commands in history of ACK and NAK commands.
+ * \brief This function print all ranges in history of ACK and NAK commands.
  * \param[in]	*history	The structure storing history of ACK and NAK
  * commands.
  */
 void v_ack_nak_history_print(struct AckNakHistory *history)
 {
+	struct AckNakRange *range;
 	int i;
 
-	printf("Ack Nak History: count: %d, len: %d\n", history->count, history->len);
+	printf("Ack Nak History: count: %d, len: %d, first: %d\n",
+			history->count, history->len, history->first_id);
 	for(i=0; i<history->count; i++) {
-		v_print_ack_nak_cmd(VRS_PRINT_DEBUG_MSG, &history->cmds[i]);
+		range = &history->ranges[(history->head + i) & (history->len - 1)];
+		v_print_log_simple(VRS_PRINT_DEBUG_MSG, "\tACK RANGE, %d - %d\n",
+				range->first, range->last);
 	}
-
 }
 
-/**
- * Example of list of ACK and NAK command in history, that is compressed
- *
- *      +-----+-----+-----+-----+-----+-----+
- *      | ACK | NAK | ACK | NAK | ACK | ACK |
- *      +-----+-----+-----+-----+-----+-----+
- *      | 107 | 115 | 146 | 157 | 179 | 183 |
- *      +-----+-----+-----+-----+-----+-----+
- *
- * ack: +-----+     +-----+     +-----------+
- * id:  |107  |115  |146  |157  |179   183  |
- * nak: +     +-----+     +-----+           +
- *
- */
-
 /**
  * \brief This function removes ACK and NAK commands from the history of
- * commands. ANK ID is used as rule for removing. It means, that all commands
+ * commands. ANK ID is used as rule for removing. It means, that all ranges
  * with PAY ID less or equal to the ANK ID will be removed from the history.
  * \param[in]	*history	The structure storing history of ack and nak
  * commands
  * \param[in]	ank_id		The ANK_ID is the ID of last acknowledged Payload ID.
- * \returns 	This function returns 1, when array was successfully reduced
+ * \returns 	This function returns 1, when history was successfully reduced
  * and it returns 0, when reducing was not possible, because function was
  * called with some strange values. */
 int v_ack_nak_history_remove_cmds(struct AckNakHistory *history, unsigned int ank_id)
 {
-	int i,j;
+	struct AckNakRange *range;
 
 	/* If history is already empty, then it is not neccessary to remove any
 	 * command */
@@ -470,59 +589,30 @@ int v_ack_nak_history_remove_cmds(struct AckNakHistory *history, unsigned int an
 
 	/* ANK ID could not be bigger then last acknowledged Payload ID, because
 	 * it was not sent yet */
-	if( ank_id > history->cmds[history->count-1].pay_id ) {
+	range = &history->ranges[(history->head + history->count - 1) & (history->len - 1)];
+	if( ank_id > range->last ) {
 		v_print_log(VRS_PRINT_WARNING, "ANK_ID: %d is bigger then last ACK(PAY_ID): %d\n",
-				ank_id, history->cmds[history->count-1].pay_id);
+				ank_id, range->last);
 		return 0;
 	}
 
-	/* Find place, where we cut off array of ACK NAK history */
-	for(i=0; i<history->count; i++) {
-		if(history->cmds[i].pay_id >= ank_id)
-			break;
+	/* Peer does not need ACK and NAK commands for older packets */
+	if(ank_id < history->first_id) {
+		return 1;
 	}
-
-	/* Is ACK command directly on the index? */
-	if(history->cmds[i].pay_id == ank_id) {
-		/* Will it be cut somewhere in the middle of the list? */
-		if((i+1) < history->count) {
-			/* Could be first ACK command from subsequence removed? */
-			if(history->cmds[i+1].pay_id==ank_id+1) {
-				/* Move ACK and NAK commands to the beginning of the array */
-				for(j=0, i=i+1; i<history->count; j++, i++) {
-					history->cmds[j].id = history->cmds[i].id;
-					history->cmds[j].pay_id = history->cmds[i].pay_id;
-				}
-				history->count = j;
-			} else {
-				/* Update first item in list of ACK and NAK commands */
-				history->cmds[0].id = history->cmds[i].id;
-				history->cmds[0].pay_id = ank_id+1;
-				/* Move ACK and NAK commands to the beginning of the array */
-				for(j=1, i=i+1; i<history->count; j++, i++) {
-					history->cmds[j].id = history->cmds[i].id;
-					history->cmds[j].pay_id = history->cmds[i].pay_id;
-				}
-				history->count = j;
-			}
+	history->first_id = ank_id + 1;
+
+	/* Remove all confirmed ranges and cut off the first not confirmed range */
+	while(history->count > 0) {
+		range = &history->ranges[history->head];
+		if(range->last <= ank_id) {
+			history->head = (history->head + 1) & (history->len - 1);
+			history->count--;
 		} else {
-			/* If last PAY ID of ANK NAK history is equal to the ANK ID,
-			 * then consider history as empty. */
-			history->count = 0;
-		}
-	} else if(history->cmds[i].pay_id > ank_id) {
-		if(i>0) {
-			history->cmds[0].id = history->cmds[i-1].id;
-			history->cmds[0].pay_id = ank_id;
-			/* Move ACK and NAK commands to the beginning of the array */
-			for(j=1; i<history->count; j++, i++) {
-				history->cmds[j].id = history->cmds[i].id;
-				history->cmds[j].pay_id = history->cmds[i].pay_id;
+			if(range->first <= ank_id) {
+				range->first = ank_id + 1;
 			}
-			history->count = j;
-		} else {
-			/* This should not happen. */
-			return 0;
+			break;
 		}
 	}
 
@@ -530,80 +620,127 @@ int v_ack_nak_history_remove_cmds(struct AckNakHistory *history, unsigned int an
 }
 
 /**
- * \brief This function adds ACK or NAK command to the end of the list of
- * commands and implement compression of commands.
+ * \brief This function adds ID of received payload packet to the history
+ * of ACK and NAK commands. Packets are received in order, so new ID extends
+ * the last range or new range is added after the gap of lost packets.
  * \param[in]	*history	The structure storing history of ACK and NAK
  * commands
- * \param[in]	*cmd		The structure sroting ACK or NAK command
- * \returns		This function returns 1, when command was successfully added
- * at the end of list of command and it returns 0, when some error occurs. */
-int v_ack_nak_history_add_cmd(struct AckNakHistory *history, struct Ack_Nak_Cmd *cmd)
+ * \param[in]	pay_id		The ID of received payload packet
+ * \returns		This function returns 1, when ID was successfully added to the
+ * history and it returns 0, when some error occurs. */
+int v_ack_nak_history_add_id(struct AckNakHistory *history, uint32 pay_id)
 {
-	/* If there is not enough space for new item, them realloc array */
-	if(history->count+1 > history->len) {
-		history->len *= 2;
-		if( (history->cmds = (struct Ack_Nak_Cmd*)realloc(history->cmds, sizeof(struct Ack_Nak_Cmd)*history->len)) == NULL) {
-			history->len = 0;
-			history->count = 0;
+	struct AckNakRange *range, *ranges;
+	int i;
+
+	if(history->count > 0) {
+		range = &history->ranges[(history->head + history->count - 1) & (history->len - 1)];
+		/* The most common case: no packet was lost */
+		if(pay_id == range->last + 1) {
+			range->last = pay_id;
+			return 1;
+		}
+		/* Delayed packets are not acknowledged again */
+		if(pay_id <= range->last) {
+			return 1;
+		}
+	} else if(history->started == 0) {
+		history->first_id = pay_id;
+		history->started = 1;
+	} else if(pay_id < history->first_id) {
+		return 1;
+	}
+
+	/* If there is not enough space for new range, then resize ring */
+	if(history->count == history->len) {
+		ranges = (struct AckNakRange*)malloc(sizeof(struct AckNakRange) * history->len * 2);
+		if(ranges == NULL) {
 			return 0;
 		}
+		for(i=0; i<history->count; i++) {
+			ranges[i] = history->ranges[(history->head + i) & (history->len - 1)];
+		}
+		free(history->ranges);
+		history->ranges = ranges;
+		history->head = 0;
+		history->len *= 2;
 	}
 
-	/* When array is empty, then simply add command at the first position of the list */
-	if(history->count==0) {
-		history->cmds[0].id = cmd->id;
-		history->cmds[0].pay_id = cmd->pay_id;
-		history->count++;
-	} else {
-		if(cmd->id == CMD_ACK_ID) {
-			/* When we want to add ACK command at the end of the of the list, then we have to check several things */
-			if(history->cmds[history->count-1].id == CMD_ACK_ID) {
-				/* Add last ACK command in the last sequence of ACK commands */
-				if(history->count==1 ||
-						(history->count>1 && history->cmds[history->count-2].id == CMD_NAK_ID)) {
-					history->cmds[history->count].id = cmd->id;
-					history->cmds[history->count].pay_id = cmd->pay_id;
-					history->count++;
-				/* Only update last ACK command in the last sequence of ACK commands */
-				} else {
-					history->cmds[history->count-1].id = cmd->id;
-					history->cmds[history->count-1].pay_id = cmd->pay_id;
-				}
-			/* When last command in array is NAK command, then we have to add this ACK command */
-			} else if(history->cmds[history->count-1].id == CMD_NAK_ID) {
-				history->cmds[history->count].id = cmd->id;
-				history->cmds[history->count].pay_id = cmd->pay_id;
-				history->count++;
-			}
-		/* Adding NAK command to the array */
-		} else if(cmd->id == CMD_NAK_ID) {
-			/* When last command in the array is ACK command, then we have to add this command to the array */
-			if(history->cmds[history->count-1].id == CMD_ACK_ID) {
-				/* When, there is trailing sequence of two ACK command, then rewrite last ACK command*/
-				if(history->count>1 && history->cmds[history->count-2].id == CMD_ACK_ID) {
-					history->cmds[history->count-1].id = cmd->id;
-					history->cmds[history->count-1].pay_id = cmd->pay_id;
-				} else {
-					history->cmds[history->count].id = cmd->id;
-					history->cmds[history->count].pay_id = cmd->pay_id;
-					history->count++;
-				}
+	range = &history->ranges[(history->head + history->count) & (history->len - 1)];
+	range->first = pay_id;
+	range->last = pay_id;
+	history->count++;
+
+	return 1;
+}
+
+/**
+ * \brief This function writes minimal sequence of ACK and NAK commands
+ * describing history to the array of system commands. When there is not
+ * enough space for all commands, then the oldest ranges are written and
+ * the sequence always ends with ACK command.
+ * \param[in]	*history	The structure storing history of ACK and NAK
+ * commands
+ * \param[out]	*sys_cmds	The array of system commands of sent packet
+ * \param[in]	max_count	The maximal count of written commands
+ * \returns		This function returns count of written commands.
+ */
+int v_ack_nak_history_pack_cmds(struct AckNakHistory *history,
+		union VSystemCommands *sys_cmds,
+		int max_count)
+{
+	struct AckNakRange *range;
+	int i, cmd_rank = 0;
+
+	if(history->count == 0 || max_count < 1) {
+		return 0;
+	}
+
+	/* Packets lost before the first range */
+	range = &history->ranges[history->head];
+	if(history->first_id < range->first && max_count >= 2) {
+		sys_cmds[cmd_rank].nak_cmd.id = CMD_NAK_ID;
+		sys_cmds[cmd_rank].nak_cmd.pay_id = history->first_id;
+		cmd_rank++;
+	}
+
+	for(i=0; i<history->count && cmd_rank<max_count; i++) {
+		range = &history->ranges[(history->head + i) & (history->len - 1)];
+
+		sys_cmds[cmd_rank].ack_cmd.id = CMD_ACK_ID;
+		sys_cmds[cmd_rank].ack_cmd.pay_id = range->first;
+		cmd_rank++;
+
+		/* NAK command has to be followed by ACK command of next range.
+		 * Otherwise the last ACK command closes this range. */
+		if(i + 1 < history->count && cmd_rank + 2 <= max_count) {
+			sys_cmds[cmd_rank].nak_cmd.id = CMD_NAK_ID;
+			sys_cmds[cmd_rank].nak_cmd.pay_id = range->last + 1;
+			cmd_rank++;
+		} else {
+			if(range->last != range->first && cmd_rank < max_count) {
+				sys_cmds[cmd_rank].ack_cmd.id = CMD_ACK_ID;
+				sys_cmds[cmd_rank].ack_cmd.pay_id = range->last;
+				cmd_rank++;
 			}
+			break;
 		}
 	}
 
-	return 1;
+	return cmd_rank;
 }
 
 /* Initialize history of ACK and NAK commands */
 int v_ack_nak_history_init(struct AckNakHistory *history)
 {
-	if(history->cmds == NULL) {
-		if( (history->cmds = (struct Ack_Nak_Cmd*)malloc(sizeof(struct Ack_Nak_Cmd)*INIT_ACK_NAK_HISTORY_SIZE)) != NULL) {
-			history->count = 0;
+	if(history->ranges == NULL) {
+		history->count = 0;
+		history->head = 0;
+		history->first_id = 0;
+		history->started = 0;
+		if( (history->ranges = (struct AckNakRange*)malloc(sizeof(struct AckNakRange)*INIT_ACK_NAK_HISTORY_SIZE)) != NULL) {
 			history->len = INIT_ACK_NAK_HISTORY_SIZE;
 		} else {
-			history->count = 0;
 			history->len = 0;
 			return 0;
 		}
@@ -614,10 +751,12 @@ int v_ack_nak_history_init(struct AckNakHistory *history)
 /* Free allocated space for history of ack nak commands */
 void v_ack_nak_history_clear(struct AckNakHistory *history)
 {
-	if(history->cmds != NULL) {
-		free(history->cmds);
-		history->cmds = NULL;
+	if(history->ranges != NULL) {
+		free(history->ranges);
+		history->ranges = NULL;
 		history->count = 0;
 		history->len = 0;
+		history->head = 0;
+		history->started = 0;
 	}
 }
@@ -35,11 +35,13 @@
 
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <pthread.h>
 #include <string.h>
 #include <assert.h>
 
 #include "v_list.h"
+#include "v_pool.h"
 #include "v_common.h"
 
 void v_list_add_head(struct VListBase *listbase, void *vitem)
@@ -430,129 +432,282 @@ int v_array_init(struct VArrayBase *arraybase)
 
 /* -------------- Two way linked list with hashed access array -------------- */
 
+
+/* Special value of pointer at bucket used for removed items in old array of
+ * slots during incremental resizing */
+static struct VBucket v_hash_removed_bucket;
+#define HASH_REMOVED_BUCKET		(&v_hash_removed_bucket)
+
+#define HASH_SLOT(hash_array, table, index) \
+	((struct VHashSlot*)((table)->slots + (size_t)(index)*(hash_array)->slot_size))
+
 /**
- * \brief This function is hash function, that compute simple hash: modulo 256
- * from key of the item. The key is specified in has_array structure as
- * key_offset and key_size. This function doesn't include lock of the mutex,
- * because this function is always called, when has_array is already locked.
- * \param[in]	*hash_array	The pointer at structure storing linked list and
- * own array of access array
- * \param[in]	*item		The pointer at item containing key for computing
- * hash function.
- * \return This function returns index to the array of hashes, when
- * hash_array->key_size is bigger then 0, otherwise it returns -1, because it
- * is not possible to compute hash function from key with zero size.
+ * \brief This function computes hash value from key of the item. The key is
+ * specified in hash_array structure as key_offset and key_size. It uses
+ * FNV-1a and final mixing of bits, because only lower bits of hash value are
+ * used as index to the array of slots. This function doesn't include lock of
+ * the mutex, because this function is always called, when hash_array is
+ * already locked.
+ * \param[in]	*hash_array	The pointer at hashed linked list
+ * \param[in]	*item		The pointer at item containing key
+ * \return This function returns hash value of the key.
  */
-static int32 v_hash_func_uint16(struct VHashArrayBase *hash_array, void *item)
+static uint32 v_hash_func(struct VHashArrayBase *hash_array, void *item)
 {
-	uint8 *data = NULL;
-	int32 hash_value = -1;
-	int16 i = 0;
-	long unsigned int tmp = 0;
-
-	if(hash_array->key_size == 0) return -1;
-
-	/* Compute index from address */
-	if(hash_array->key_size % 2 == 0) {
-		for(tmp=0, i=0, data=(uint8*)item + hash_array->key_offset;
-				i < hash_array->key_size;
-				i+=2, data+=2)
-		{
-			tmp += *(uint16*)data;
+	const uint8 *data = (uint8*)item + hash_array->key_offset;
+	uint32 hash = 2166136261U;
+	uint16 i;
+
+	for(i = 0; i < hash_array->key_size; i++) {
+		hash ^= data[i];
+		hash *= 16777619U;
+	}
+
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6BU;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35U;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+/**
+ * \brief This function returns 1, when the slot contains item with the same
+ * key as the item has. Otherwise it returns 0.
+ */
+static int v_hash_slot_match(struct VHashArrayBase *hash_array,
+		struct VHashSlot *slot,
+		uint32 hash,
+		void *item)
+{
+	const uint8 *key = (uint8*)item + hash_array->key_offset;
+
+	if(slot->hash != hash) {
+		return 0;
+	}
+
+	if(hash_array->key_size <= HASH_INLINE_KEY_SIZE) {
+		return memcmp(key, slot->key, hash_array->key_size) == 0;
+	}
+
+	/* Bucket has to include some data */
+	assert(slot->vbucket->data != NULL);
+
+	return memcmp(key,
+			(uint8*)slot->vbucket->data + hash_array->key_offset,
+			hash_array->key_size) == 0;
+}
+
+/**
+ * \brief This function tries to find index of slot in one array of slots.
+ * Each key is stored only in one slot.
+ * \return This function returns index of found slot or -1, when no item
+ * with the same key is stored in this array.
+ */
+static int64 v_hash_table_find_slot(struct VHashArrayBase *hash_array,
+		struct VHashTable *table,
+		uint32 hash,
+		void *item)
+{
+	struct VHashSlot *slot;
+	uint32 mask = table->length - 1;
+	uint32 index, i;
+
+	if(table->count == 0) {
+		return -1;
+	}
+
+	for(i = 0, index = hash & mask; i < table->length; i++, index = (index + 1) & mask) {
+		slot = HASH_SLOT(hash_array, table, index);
+
+		/* End of the cluster */
+		if(slot->vbucket == NULL) {
+			break;
 		}
-	} else {
-		for(tmp=0, i=0, data=(uint8*)item + hash_array->key_offset;
-				i < hash_array->key_size-1;
-				i+=2, data+=2)
-		{
-			tmp += *(uint16*)data;
+
+		if(slot->vbucket == HASH_REMOVED_BUCKET) {
+			continue;
+		}
+
+		if(v_hash_slot_match(hash_array, slot, hash, item) == 1) {
+			return index;
 		}
-		/* Add not padded data to the tmp variable */
-		tmp += *(uint8*)data;
 	}
 
-	hash_value = tmp % hash_array->length;
+	return -1;
+}
 
-	return hash_value;
+/**
+ * \brief This function tries to find slot with the key of the item in old and
+ * current array of slots.
+ * \param[out]	**table	The pointer at array of slots containing found slot
+ * \return This function returns index of found slot or -1, when no item
+ * with the same key is stored in hashed linked list.
+ */
+static int64 v_hash_array_find_slot(struct VHashArrayBase *hash_array,
+		uint32 hash,
+		void *item,
+		struct VHashTable **table)
+{
+	int64 index;
+
+	*table = &hash_array->old_table;
+	index = v_hash_table_find_slot(hash_array, *table, hash, item);
+	if(index == -1) {
+		*table = &hash_array->table;
+		index = v_hash_table_find_slot(hash_array, *table, hash, item);
+	}
+
+	return index;
 }
 
 /**
- * \brief The hash function, that implement simple hash function: modulo 65536.
- * The size of array of hashes is 65536*sizeof(VBucketP). This function doesn't
- * include lock of the mutex, because this function is always called, when
- * has_array is already locked.
- * \param[in]	*hash_array	The pointer at hashed linked list
- * \param[in[	*item		The pointer at item containing key to be used as
- * input to hash function
- * \return	This function returns index to the array of hashes, when
- * hash_array->key_size is bigger then 0, otherwise it returns -1, because it
- * is not possible to compute hash function from key with zero size.
+ * \brief This function stores bucket to the first free slot in the current
+ * array of slots. The array has to contain at least one free slot.
  */
-static int32 v_hash_func_uint32(struct VHashArrayBase *hash_array, void *item)
+static void v_hash_table_insert(struct VHashArrayBase *hash_array,
+		uint32 hash,
+		struct VBucket *vbucket,
+		const uint8 *key)
 {
-	uint8 *data = NULL;
-	int16 i = 0;
-	int32 hash_value = -1;
-	uint32 modulo = 0;
-	long unsigned int tmp = 0;
-
-	if(hash_array->key_size == 0) return -1;
-
-	modulo = hash_array->key_size % 4;
-	/* Compute index from address */
-	switch(modulo) {
-		case 0:
-			for(tmp=0, i=0, data=(uint8*)item + hash_array->key_offset;
-					i < hash_array->key_size;
-					i+=4, data+=4)
-			{
-				tmp += *(uint32*)data;
-			}
-			break;
-		case 1:
-			for(tmp=0, i=0, data=(uint8*)item + hash_array->key_offset;
-					i < hash_array->key_size-1;
-					i+=4, data+=4)
-			{
-				tmp += *(uint32*)data;
-			}
-			tmp += *(uint16*)data;
-			data += 2;
-			tmp += *(uint8*)data;
-			break;
-		case 2:
-			for(tmp=0, i=0, data=(uint8*)item + hash_array->key_offset;
-					i < hash_array->key_size-1;
-					i+=4, data+=4)
-			{
-				tmp += *(uint32*)data;
-			}
-			tmp += *(uint16*)data;
-			break;
-		case 3:
-			for(tmp=0, i=0, data=(uint8*)item + hash_array->key_offset;
-					i < hash_array->key_size-1;
-					i+=4, data+=4)
-			{
-				tmp += *(uint32*)data;
-			}
-			tmp += *(uint8*)data;
+	struct VHashTable *table = &hash_array->table;
+	struct VHashSlot *slot;
+	uint32 mask = table->length - 1;
+	uint32 index = hash & mask;
+
+	assert(table->count < table->length);
+
+	for(slot = HASH_SLOT(hash_array, table, index);
+			slot->vbucket != NULL;
+			index = (index + 1) & mask, slot = HASH_SLOT(hash_array, table, index)) {}
+
+	slot->vbucket = vbucket;
+	slot->hash = hash;
+	if(hash_array->key_size <= HASH_INLINE_KEY_SIZE) {
+		memcpy(slot->key, key, hash_array->key_size);
+	}
+
+	table->count++;
+}
+
+/**
+ * \brief This function clears slot in the current array of slots. Following
+ * slots of the same cluster are shifted back, because there are no markers of
+ * removed items in the current array of slots.
+ */
+static void v_hash_table_clear_slot(struct VHashArrayBase *hash_array,
+		uint32 index)
+{
+	struct VHashTable *table = &hash_array->table;
+	struct VHashSlot *slot, *next_slot;
+	uint32 mask = table->length - 1;
+	uint32 next, home;
+
+	slot = HASH_SLOT(hash_array, table, index);
+
+	for(next = (index + 1) & mask; ; next = (next + 1) & mask) {
+		next_slot = HASH_SLOT(hash_array, table, next);
+
+		if(next_slot->vbucket == NULL) {
 			break;
+		}
+
+		/* Can be item from the next slot moved to the cleared slot? It is
+		 * not possible, when its home index is cyclically in (index, next> */
+		home = next_slot->hash & mask;
+		if( (index <= next) ?
+				(index < home && home <= next) :
+				(index < home || home <= next) )
+		{
+			continue;
+		}
+
+		memcpy(slot, next_slot, hash_array->slot_size);
+		index = next;
+		slot = next_slot;
 	}
 
-	hash_value = tmp % hash_array->length;
+	slot->vbucket = NULL;
+	table->count--;
+}
+
+/**
+ * \brief This function migrates several slots from the old array of slots to
+ * the current array of slots. When all slots are migrated, then old array is
+ * freed. Thus items are never rehashed at once and adding of item has bounded
+ * latency.
+ */
+static void v_hash_array_rehash(struct VHashArrayBase *hash_array,
+		uint32 steps)
+{
+	struct VHashTable *old_table = &hash_array->old_table;
+	struct VHashSlot *slot;
+
+	if(old_table->slots == NULL) {
+		return;
+	}
+
+	while(steps > 0 && hash_array->rehash_index < old_table->length) {
+		slot = HASH_SLOT(hash_array, old_table, hash_array->rehash_index);
+		if(slot->vbucket != NULL && slot->vbucket != HASH_REMOVED_BUCKET) {
+			v_hash_table_insert(hash_array, slot->hash, slot->vbucket,
+					(hash_array->key_size <= HASH_INLINE_KEY_SIZE) ?
+							slot->key :
+							(uint8*)slot->vbucket->data + hash_array->key_offset);
+			slot->vbucket = HASH_REMOVED_BUCKET;
+			old_table->count--;
+		}
+		hash_array->rehash_index++;
+		steps--;
+	}
 
-	return hash_value;
+	if(hash_array->rehash_index == old_table->length) {
+		assert(old_table->count == 0);
+		free(old_table->slots);
+		old_table->slots = NULL;
+		old_table->length = 0;
+		old_table->count = 0;
+		hash_array->rehash_index = 0;
+	}
 }
 
-/*static void print_mem(void *mem, uint32 size)
+/**
+ * \brief This function allocates new array of slots with length. Current
+ * array of slots becomes old array of slots and its items are migrated
+ * incrementally.
+ * \return This function returns 1, when new array was allocated and it
+ * returns 0, when there is not enough memory.
+ */
+static int v_hash_array_resize(struct VHashArrayBase *hash_array,
+		uint32 length)
 {
-	int i;
-	for(i=0; i<size; i++) {
-		printf("%X", (int)*((char*)mem+i));
+	uint8 *slots;
+
+	/* Finish previous migration first */
+	if(hash_array->old_table.slots != NULL) {
+		v_hash_array_rehash(hash_array, hash_array->old_table.length);
+	}
+
+	slots = (uint8*)calloc(length, hash_array->slot_size);
+	if(slots == NULL) {
+		v_print_log(VRS_PRINT_ERROR, "calloc(): no memory allocated\n");
+		return 0;
 	}
-	printf("\n");
-}*/
+
+	if(hash_array->table.count > 0) {
+		hash_array->old_table = hash_array->table;
+		hash_array->rehash_index = 0;
+	} else {
+		free(hash_array->table.slots);
+	}
+
+	hash_array->table.slots = slots;
+	hash_array->table.length = length;
+	hash_array->table.count = 0;
+
+	return 1;
+}
 
 /**
  * \brief		This function tries to find item in hashed linked list.
@@ -560,109 +715,128 @@ static int32 v_hash_func_uint32(struct VHashArrayBase *hash_array, void *item)
  * \param[in]	*item		The pointer at item containing key for hash
  * function. The relative position of key in item is stored in hash_array.
  * \return		This function returns pointer at bucket, when item was found
- * in hashed linked list and it returns NULL, when item was not found.
+ * in hashed linked list and it returns NULL, when item was not found. When
+ * more items have the same key, then the oldest one is returned.
  */
 struct VBucket *v_hash_array_find_item(struct VHashArrayBase *hash_array,
 		void *item)
 {
 	struct VBucket *vbucket = NULL;
-	int64 index = -1;
+	struct VHashTable *table;
+	int64 index;
 
 	pthread_mutex_lock(&hash_array->mutex);
 
-	/* Hashed linked list has to include array of buckets */
-	assert(hash_array->buckets != NULL);
-
-	/* Hashed linked list has to have own hash function */
-	assert(hash_array->hash_func != NULL);
-
-	index = hash_array->hash_func(hash_array, item);
-
-	/* Found index has to be in  valid range? */
-	assert(index >= 0 && index < hash_array->length);
-
-	/* Is there any collision at this index? */
-	if(hash_array->buckets[index].next == NULL) {
-		/* If there is no collision, then return pointer at item */
-		vbucket = hash_array->buckets[index].vbucket;
-
-		/* Is there any bucket with data? */
-		if(vbucket != NULL) {
-			/* Bucket has to include some data */
-			assert(vbucket->data != NULL);
-
-			/* And check if the key of found bucket has the same as key
-			 * as the item has. */
-			if( !(memcmp((uint8*)item + hash_array->key_offset,
-					(uint8*)vbucket->data + hash_array->key_offset,
-					hash_array->key_size) == 0) )
-			{
-				/* This happens, when item is in the collision with the
-				 * bucket in the hashed linked list, but item and found bucket
-				 * has different key */
-				vbucket = NULL;
-			}
-		}
-	} else {
-		struct VBucketP *bucket_p;
+	index = v_hash_array_find_slot(hash_array, v_hash_func(hash_array, item),
+			item, &table);
+	if(index != -1) {
+		vbucket = HASH_SLOT(hash_array, table, index)->vbucket;
+	}
 
-		/* When collision is at this index, then go through the list
-		 * and compare addresses of each item and key */
-		for( bucket_p = &hash_array->buckets[index];
-				bucket_p != NULL;
-				bucket_p = bucket_p->next)
-		{
-			/* All pointers at buckets have to include some bucket */
-			assert(bucket_p->vbucket != NULL);
+	pthread_mutex_unlock(&hash_array->mutex);
 
-			/* All buckets have to include pointer at data */
-			assert(bucket_p->vbucket->data != NULL);
+	return vbucket;
+}
 
-			if( memcmp((uint8*)item + hash_array->key_offset,
-					(uint8*)bucket_p->vbucket->data + hash_array->key_offset,
-					hash_array->key_size) == 0 )
-			{
-				vbucket = bucket_p->vbucket;
-				break;
-			}
-		}
+/**
+ * \brief This function tries to find the oldest bucket with the key of the
+ * item and it makes array of slots bigger, when new key would exceed maximal
+ * load. This function doesn't include lock of the mutex.
+ * \param[out]	**head	The pointer at the oldest bucket with the same key or
+ * NULL, when no item has the same key.
+ * \return This function returns 1, when new bucket can be added and it
+ * returns 0, when there is not enough memory for new array of slots.
+ */
+static int v_hash_array_prepare_add(struct VHashArrayBase *hash_array,
+		uint32 hash,
+		void *item,
+		struct VBucket **head)
+{
+	struct VHashTable *table;
+	int64 index;
+
+	*head = NULL;
+
+	index = v_hash_array_find_slot(hash_array, hash, item, &table);
+	if(index != -1) {
+		*head = HASH_SLOT(hash_array, table, index)->vbucket;
 	}
 
-	pthread_mutex_unlock(&hash_array->mutex);
+	/* Array of slots is allocated with first item and it is made bigger,
+	 * when maximal load would be exceeded by new key */
+	if(hash_array->table.slots == NULL) {
+		return v_hash_array_resize(hash_array, HASH_INIT_LENGTH);
+	} else if( *head == NULL &&
+			(uint64)(hash_array->table.count + hash_array->old_table.count + 1) * 100 >
+			(uint64)hash_array->table.length * HASH_MAX_LOAD )
+	{
+		return v_hash_array_resize(hash_array, hash_array->table.length * 2);
+	}
 
-	return vbucket;
+	v_hash_array_rehash(hash_array, HASH_REHASH_STEP);
+
+	return 1;
+}
+
+/**
+ * \brief This function adds bucket to the end of linked list and to the end
+ * of list of buckets with the same key. When no item has the same key, then
+ * new slot is used. This function doesn't include lock of the mutex.
+ */
+static void v_hash_array_link_bucket(struct VHashArrayBase *hash_array,
+		uint32 hash,
+		struct VBucket *vbucket,
+		struct VBucket *head,
+		void *item)
+{
+	v_list_add_tail(&hash_array->lb, vbucket);
+
+	if(head != NULL) {
+		/* Add bucket to the end of cyclic list of buckets with the same key */
+		vbucket->dup_next = head;
+		vbucket->dup_prev = head->dup_prev;
+		head->dup_prev->dup_next = vbucket;
+		head->dup_prev = vbucket;
+	} else {
+		vbucket->dup_next = vbucket;
+		vbucket->dup_prev = vbucket;
+		v_hash_table_insert(hash_array, hash, vbucket,
+				(uint8*)item + hash_array->key_offset);
+	}
+
+	hash_array->count++;
 }
 
 /**
  * \brief This function adds new item to the linked list and add new record
- * to the array of hashes. The item_size has to be bigger then
- * (key_offset + key_size).
+ * to the array of slots. The item_size has to be bigger then
+ * (key_offset + key_size). When some item with the same key is already
+ * stored in hashed linked list, then new bucket is only added to the end of
+ * list of buckets with this key and no new slot is used.
  */
 struct VBucket *v_hash_array_add_item(struct VHashArrayBase *hash_array,
 		void *item,
 		uint16 item_size)
 {
-	struct VBucket *vbucket = NULL;
-	int64 index = -1;
+	struct VBucket *vbucket = NULL, *head;
+	uint32 hash;
 
 	pthread_mutex_lock(&hash_array->mutex);
 
-	/* Hashed linked list has to have own hash function */
-	assert(hash_array->hash_func != NULL);
-
-	/* Hashed linked list has to have buckets */
-	assert(hash_array->buckets != NULL);
-
 	/* The item_size has to be bigger then (key_offset + key_size).*/
 	assert( item_size >= (hash_array->key_offset + hash_array->key_size) );
 
-	index = hash_array->hash_func(hash_array, item);
+	/* Buckets of this hashed linked list are provided by caller */
+	assert( !(hash_array->flags & HASH_EXTERN_BUCKET) );
 
-	/* Is computed index in allowed range */
-	assert(index >= 0 && index < hash_array->length);
+	hash = v_hash_func(hash_array, item);
+
+	if(v_hash_array_prepare_add(hash_array, hash, item, &head) != 1) {
+		goto end;
+	}
 
 	/* Create new bucket */
-	vbucket = (struct VBucket*)calloc(1, sizeof(struct VBucket));
+	vbucket = (struct VBucket*)v_pool_calloc(sizeof(struct VBucket));
 
 	/* Check if it was possible to allocate memory for bucket */
 	if(vbucket == NULL) {
@@ -671,8 +845,6 @@ struct VBucket *v_hash_array_add_item(struct VHashArrayBase *hash_array,
 		goto end;
 	}
 
-	v_list_add_tail(&hash_array->lb, vbucket);
-
 	if(hash_array->flags & HASH_COPY_BUCKET) {
 		/* Allocate memory for item */
 		vbucket->data = malloc(item_size);
@@ -680,8 +852,7 @@ struct VBucket *v_hash_array_add_item(struct VHashArrayBase *hash_array,
 		if(vbucket->data == NULL) {
 			v_print_log(VRS_PRINT_ERROR,
 					"Not enough memory for new data of bucket\n");
-			v_list_rem_item(&hash_array->lb, vbucket);
-			free(vbucket);
+			v_pool_free(vbucket, sizeof(struct VBucket));
 			vbucket = NULL;
 			goto end;
 		}
@@ -691,57 +862,121 @@ struct VBucket *v_hash_array_add_item(struct VHashArrayBase *hash_array,
 		vbucket->data = item;
 	}
 
-	if(hash_array->buckets[index].vbucket == NULL) {
-		/* It is first item at this index */
-		hash_array->buckets[index].vbucket = vbucket;
-		hash_array->buckets[index].next = NULL;
-	} else {
-		/* There is collision at this index */
-		struct VBucketP *vbucket_p, *new_vbucket_p;
+	v_hash_array_link_bucket(hash_array, hash, vbucket, head, item);
 
-		/* Create new bucket pointer */
-		new_vbucket_p = (struct VBucketP *)calloc(1, sizeof(struct VBucketP));
+end:
+	pthread_mutex_unlock(&hash_array->mutex);
 
-		/* Check if it was possible to allocate memory for pointer at
-		 * bucket */
-		if(new_vbucket_p == NULL) {
-			v_print_log(VRS_PRINT_ERROR,
-					"Not enough memory for new pointer at bucket\n");
-			v_list_rem_item(&hash_array->lb, vbucket);
-			if(hash_array->flags & HASH_COPY_BUCKET) {
-				free(vbucket->data);
-			}
-			free(vbucket);
-			vbucket = NULL;
-			goto end;
-		}
+	return vbucket;
+}
 
-		/* Go to the end of the list */
-		for(vbucket_p = &hash_array->buckets[index];
-				vbucket_p->next != NULL;
-				vbucket_p = vbucket_p->next) {}
+/**
+ * \brief This function adds item to the hashed linked list using bucket
+ * provided by caller. It can be used only for hashed linked list initialized
+ * with flag HASH_EXTERN_BUCKET. The bucket has to be valid until it is
+ * removed from hashed linked list, but no memory is allocated for it.
+ * \param[in]	*hash_array	The pointer at hashed linked list
+ * \param[in]	*vbucket	The pointer at bucket owned by caller
+ * \param[in]	*item		The pointer at item containing key
+ * \return This function returns 1, when bucket was added and it returns 0,
+ * when there is not enough memory for array of slots.
+ */
+int v_hash_array_add_bucket(struct VHashArrayBase *hash_array,
+		struct VBucket *vbucket,
+		void *item)
+{
+	struct VBucket *head;
+	uint32 hash;
+	int ret = 0;
 
-		/* Paste new bucket pointer at the end of the linked list */
-		vbucket_p->next = new_vbucket_p;
+	pthread_mutex_lock(&hash_array->mutex);
 
-		new_vbucket_p->vbucket = vbucket;
-		new_vbucket_p->next = NULL;
-	}
+	assert( hash_array->flags & HASH_EXTERN_BUCKET );
 
-	hash_array->count++;
+	hash = v_hash_func(hash_array, item);
+
+	if(v_hash_array_prepare_add(hash_array, hash, item, &head) == 1) {
+		vbucket->data = item;
+		vbucket->ptr = NULL;
+		v_hash_array_link_bucket(hash_array, hash, vbucket, head, item);
+		ret = 1;
+	}
 
-end:
 	pthread_mutex_unlock(&hash_array->mutex);
 
-	return vbucket;
+	return ret;
+}
+
+/**
+ * \brief This function removes bucket from the list of buckets with the same
+ * key and from the linked list. When the bucket is referenced by the slot,
+ * then the slot is updated to the next bucket with the same key or it is
+ * cleared. Nothing else than the slot of the key is searched, thus removing
+ * is not slower, when there are many items with the same key. This function
+ * doesn't include lock of the mutex.
+ */
+static void v_hash_array_unlink_bucket(struct VHashArrayBase *hash_array,
+		struct VHashTable *table,
+		int64 index,
+		struct VBucket *vbucket)
+{
+	struct VHashSlot *slot = HASH_SLOT(hash_array, table, index);
+
+	if(slot->vbucket == vbucket) {
+		if(vbucket->dup_next != vbucket) {
+			/* Next bucket becomes the oldest bucket with this key */
+			slot->vbucket = vbucket->dup_next;
+		} else if(table == &hash_array->table) {
+			v_hash_table_clear_slot(hash_array, (uint32)index);
+		} else {
+			/* Removed items in old array of slots are only marked, because
+			 * migration of slots goes through this array sequentially */
+			slot->vbucket = HASH_REMOVED_BUCKET;
+			table->count--;
+		}
+	}
+
+	vbucket->dup_prev->dup_next = vbucket->dup_next;
+	vbucket->dup_next->dup_prev = vbucket->dup_prev;
+
+	/* Free data of the item, when the item was copied */
+	if(hash_array->flags & HASH_COPY_BUCKET) {
+		free(vbucket->data);
+		vbucket->data = NULL;
+	}
+	vbucket->ptr = NULL;
+
+	/* Remove bucket from the linked list of buckets */
+	v_list_rem_item(&hash_array->lb, vbucket);
+
+	/* Free bucket, when it is not owned by caller */
+	if(!(hash_array->flags & HASH_EXTERN_BUCKET)) {
+		v_pool_free(vbucket, sizeof(struct VBucket));
+	}
+
+	hash_array->count--;
+
+	/* Make array of slots smaller, when most of slots is not used */
+	if( hash_array->old_table.slots == NULL &&
+			hash_array->table.length > HASH_INIT_LENGTH &&
+			(uint64)hash_array->table.count * 100 <
+			(uint64)hash_array->table.length * HASH_MIN_LOAD )
+	{
+		v_hash_array_resize(hash_array, hash_array->table.length / 2);
+	} else {
+		v_hash_array_rehash(hash_array, HASH_REHASH_STEP);
+	}
 }
 
 /**
  * \brief This function tries to remove item from hashed linked list. The size
  * of item has to be bigger then key_offset and key_size, because the key in
  * this item is used as input for hash function. When corresponding bucket is
- * found, then it is removed from hashed linked list. If flag of hash_array is
- * set to HASH_COPY_BUCKET, then data of bucket are freed.
+ * found, then it is removed from hashed linked list. When more buckets have
+ * the same key, then bucket with pointer at this item is preferred and buckets
+ * are checked from the oldest one. If no bucket points at this item, then the
+ * oldest bucket is removed. If flag of hash_array is set to HASH_COPY_BUCKET,
+ * then data of bucket are freed.
  * \param[in]	*hash_array	The pointer at hashed linked list
  * \param		*item		The pointer at item to try to removed from hashed
  * linked list
@@ -750,128 +985,79 @@ end:
  */
 int v_hash_array_remove_item(struct VHashArrayBase *hash_array, void *item)
 {
+	struct VBucket *head, *vbucket;
+	struct VHashTable *table;
+	int64 index;
 	int ret = 0;
-	int64 index = -1;
 
 	pthread_mutex_lock(&hash_array->mutex);
 
-	if(hash_array->buckets != NULL) {
-
-		/* Each hash array has to have own hash function */
-		assert(hash_array->hash_func != NULL);
-
-		index = hash_array->hash_func(hash_array, item);
-
-		/* Hash function has to return index in allowed range */
-		assert(index >=0 && index < hash_array->length);
-
-		/* Was any bucket found at this index? */
-		if(hash_array->buckets[index].vbucket != NULL) {
-
-			/* Is there any collision at this index? */
-			if(hash_array->buckets[index].next == NULL) {
-				/* If there is no collision, then it is simple */
-
-				/* Bucket has to include some data */
-				assert(hash_array->buckets[index].vbucket->data != NULL);
-
-				/* Is this really item, that we try to remove */
-				if( (memcmp((uint8*)item + hash_array->key_offset,
-						(uint8*)hash_array->buckets[index].vbucket->data + hash_array->key_offset,
-						hash_array->key_size) == 0))
-				{
-					/* Free data of the item, when the item was copied */
-					if(hash_array->flags & HASH_COPY_BUCKET) {
-						free(hash_array->buckets[index].vbucket->data);
-						hash_array->buckets[index].vbucket->data = NULL;
-					}
-					hash_array->buckets[index].vbucket->ptr = NULL;
-
-					/* Remove bucket from the linked list of buckets */
-					v_list_rem_item(&hash_array->lb, hash_array->buckets[index].vbucket);
-
-					/* Free bucket */
-					free(hash_array->buckets[index].vbucket);
-					/* Update VbucketP pointer */
-					hash_array->buckets[index].vbucket = NULL;
-
-					hash_array->count--;
-
-					ret = 1;
-				} else {
-					v_print_log(VRS_PRINT_DEBUG_MSG, "Item wasn't removed, key of item doesn't match at index: %d\n", index);
-				}
-			} else {
-				/* When collision is at this index, then it is necessary to find
-				 * right bucket. Go through the list and compare key of each item */
-				struct VBucketP *vbucket_p, *prev_vbucket_p;
-
-				for( vbucket_p = &hash_array->buckets[index], prev_vbucket_p = NULL;
-						vbucket_p != NULL;
-						prev_vbucket_p = vbucket_p, vbucket_p = vbucket_p->next)
-				{
-					/* Pointer at bucket has to include valid pointer */
-					assert(vbucket_p->vbucket != NULL);
-
-					/* Bucket has to include pointer at data*/
-					assert(vbucket_p->vbucket->data != NULL);
-
-					if( memcmp((uint8*)item + hash_array->key_offset,
-							(uint8*)vbucket_p->vbucket->data + hash_array->key_offset,
-							hash_array->key_size) == 0 )
-					{
-						/* Free data of the item, when the item was copied */
-						if(hash_array->flags & HASH_COPY_BUCKET) {
-							free(vbucket_p->vbucket->data);
-							vbucket_p->vbucket->data = NULL;
-						}
-						vbucket_p->vbucket->ptr = NULL;
-
-						/* Remove bucket from the linked list */
-						v_list_rem_item(&hash_array->lb, vbucket_p->vbucket);
-
-						/* Free bucket */
-						free(vbucket_p->vbucket);
-						vbucket_p->vbucket = NULL;
-
-						/* Update VbucketP linked list */
-						if(prev_vbucket_p == NULL) {
-							struct VBucketP *next_vbucket_p = vbucket_p->next;
-							/* In this case first VBucketP is removed from
-							 * the list and second VBucketP will be removed.
-							 * Second VBucketP has to exist, because we are
-							 * handling collision */
-							vbucket_p->vbucket = vbucket_p->next->vbucket;
-							vbucket_p->next = vbucket_p->next->next;
-							free(next_vbucket_p);
-						} else {
-							if(vbucket_p->next==NULL) {
-								/* In this case last VBucketP is removed from the list */
-								prev_vbucket_p->next = NULL;
-								free(vbucket_p);
-							} else {
-								/* VBucketP between other VBucketPs is removed */
-								prev_vbucket_p->next = vbucket_p->next;
-								free(vbucket_p);
-							}
-						}
-
-						hash_array->count--;
-
-						ret = 1;
-						break;
-					}
-				}
-
-				if(ret != 1) {
-					v_print_log(VRS_PRINT_DEBUG_MSG, "Item wasn't removed, no item with the same key at index: %d\n", index);
-				}
+	if(hash_array->count == 0) {
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Item wasn't removed, hashed linked list is empty\n");
+		goto end;
+	}
+
+	index = v_hash_array_find_slot(hash_array, v_hash_func(hash_array, item),
+			item, &table);
+	if(index == -1) {
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Item wasn't removed, no item with the same key\n");
+		goto end;
+	}
+
+	head = HASH_SLOT(hash_array, table, index)->vbucket;
+	vbucket = head;
+	/* Copied data of bucket can't be equal to the item */
+	if(!(hash_array->flags & HASH_COPY_BUCKET)) {
+		while(vbucket->data != item) {
+			vbucket = vbucket->dup_next;
+			if(vbucket == head) {
+				break;
 			}
-		} else {
-			v_print_log(VRS_PRINT_DEBUG_MSG, "Item wasn't removed, no item at index: %d\n", index);
 		}
 	}
 
+	v_hash_array_unlink_bucket(hash_array, table, index, vbucket);
+
+	ret = 1;
+
+end:
+	pthread_mutex_unlock(&hash_array->mutex);
+
+	return ret;
+}
+
+/**
+ * \brief This function removes bucket returned by v_hash_array_add_item()
+ * or v_hash_array_find_item() from hashed linked list. Unlike
+ * v_hash_array_remove_item(), it doesn't have to search list of buckets with
+ * the same key. If flag of hash_array is set to HASH_COPY_BUCKET, then data
+ * of bucket are freed.
+ * \param[in]	*hash_array	The pointer at hashed linked list
+ * \param[in]	*vbucket	The pointer at bucket stored in this hashed linked list
+ * \return	This function returns 1, when bucket was removed and it returns 0,
+ * when no slot with the key of bucket was found.
+ */
+int v_hash_array_remove_bucket(struct VHashArrayBase *hash_array,
+		struct VBucket *vbucket)
+{
+	struct VHashTable *table;
+	int64 index;
+	int ret = 0;
+
+	pthread_mutex_lock(&hash_array->mutex);
+
+	index = v_hash_array_find_slot(hash_array,
+			v_hash_func(hash_array, vbucket->data), vbucket->data, &table);
+	if(index == -1) {
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Bucket wasn't removed, no item with the same key\n");
+		goto end;
+	}
+
+	v_hash_array_unlink_bucket(hash_array, table, index, vbucket);
+
+	ret = 1;
+
+end:
 	pthread_mutex_unlock(&hash_array->mutex);
 
 	return ret;
@@ -905,9 +1091,7 @@ uint32 v_hash_array_count_items(struct VHashArrayBase *hash_array)
  */
 int v_hash_array_destroy(struct VHashArrayBase *hash_array)
 {
-	uint32 i;
 	struct VBucket *vbucket;
-	struct VBucketP *vbucket_p, *next_vbucket_p;
 
 	pthread_mutex_lock(&hash_array->mutex);
 
@@ -921,29 +1105,27 @@ int v_hash_array_destroy(struct VHashArrayBase *hash_array)
 		}
 	}
 
-	v_list_free(&hash_array->lb);
-
-	/* Go to through the whole access array and free VBucketP for indexes
-	 * with collisions */
-	for(i = 0; i< hash_array->length; i++) {
-		if(hash_array->buckets[i].next != NULL) {
-			vbucket_p = hash_array->buckets[i].next;
-			while(vbucket_p != NULL) {
-				next_vbucket_p = vbucket_p->next;
-				free(vbucket_p);
-				vbucket_p = next_vbucket_p;
-			}
-		}
+	if(hash_array->flags & HASH_EXTERN_BUCKET) {
+		hash_array->lb.first = NULL;
+		hash_array->lb.last = NULL;
+	} else {
+		v_pool_list_free(&hash_array->lb, sizeof(struct VBucket));
 	}
 
-	free(hash_array->buckets);
-	hash_array->buckets = NULL;
+	free(hash_array->table.slots);
+	hash_array->table.slots = NULL;
+	hash_array->table.length = 0;
+	hash_array->table.count = 0;
+
+	free(hash_array->old_table.slots);
+	hash_array->old_table.slots = NULL;
+	hash_array->old_table.length = 0;
+	hash_array->old_table.count = 0;
 
+	hash_array->rehash_index = 0;
 	hash_array->count = 0;
-	hash_array->hash_func = NULL;
 	hash_array->key_offset = 0;
 	hash_array->key_size = 0;
-	hash_array->length = 0;
 
 	pthread_mutex_unlock(&hash_array->mutex);
 
@@ -955,11 +1137,15 @@ int v_hash_array_destroy(struct VHashArrayBase *hash_array)
 /**
  * \brief This function initialize new hashed linked list. This hashed linked
  * list could store hashed data, or it could include only pointers at external
- * data. Two hash functions are supported now.
+ * data. The array of slots uses open addressing. It is not allocated until
+ * first item is added and then it grows and shrinks incrementally according
+ * to the number of items. The flags HASH_MOD_256 and HASH_MOD_65536 are kept
+ * for compatibility and they have the same meaning now.
  * \param[out]	*hash_array	The pointer at hashed linked list to be initialized
  * \param[in]	flags		The flags, where type of hash is specified and this
- * flag specify, if items will be copied to the bucket, or buckets will include
- * only pointers at items.
+ * flag specify, if items will be copied to the bucket, or buckets will
+ * include only pointers at items. With HASH_EXTERN_BUCKET buckets are
+ * provided by v_hash_array_add_bucket() and they are never freed.
  * \param[in]	key_offset	The offset of key in item
  * \param[in]	key_size	The size of key in item
  * \return This function returns 1, when hashed linked list is initialized and
@@ -970,8 +1156,8 @@ int v_hash_array_init(struct VHashArrayBase *hash_array,
 		uint8 key_offset,
 		uint8 key_size)
 {
-	uint32 i;
 	int res, ret = 0;
+	size_t slot_size;
 
 	/* Initialize mutex of this array */
 	if((res = pthread_mutex_init(&hash_array->mutex, NULL)) != 0) {
@@ -985,50 +1171,37 @@ int v_hash_array_init(struct VHashArrayBase *hash_array,
 	/* Default values */
 	hash_array->lb.first = NULL;
 	hash_array->lb.last = NULL;
+	hash_array->table.slots = NULL;
+	hash_array->table.length = 0;
+	hash_array->table.count = 0;
+	hash_array->old_table.slots = NULL;
+	hash_array->old_table.length = 0;
+	hash_array->old_table.count = 0;
+	hash_array->rehash_index = 0;
 	hash_array->count = 0;
-	hash_array->length = 0;
-	hash_array->buckets = NULL;
-	hash_array->hash_func = NULL;
 	hash_array->key_offset = 0;
 	hash_array->key_size = 0;
 	hash_array->flags = 0;
 
-	if(flags & HASH_MOD_256) {
-		hash_array->length = 256;
-		hash_array->buckets = (struct VBucketP*)calloc(hash_array->length,
-				sizeof(struct VBucketP));
-		if(hash_array->buckets == NULL) {
-			v_print_log(VRS_PRINT_ERROR, "calloc(): no memory allocated\n");
-			goto end;
-		}
-		for(i=0; i<hash_array->length; i++) {
-			hash_array->buckets[i].vbucket = NULL;
-			hash_array->buckets[i].next = NULL;
-		}
-		hash_array->hash_func = v_hash_func_uint16;
-	} else if(flags & HASH_MOD_65536) {
-		hash_array->length = 65536;
-		hash_array->buckets = (struct VBucketP*)calloc(hash_array->length,
-				sizeof(struct VBucketP));
-		if(hash_array->buckets == NULL) {
-			v_print_log(VRS_PRINT_ERROR, "calloc(): no memory allocated\n");
-			goto end;
-		}
-		for(i=0; i<hash_array->length; i++) {
-			hash_array->buckets[i].vbucket = NULL;
-			hash_array->buckets[i].next = NULL;
-		}
-		hash_array->hash_func = v_hash_func_uint32;
-	} else {
+	if(!(flags & (HASH_MOD_256 | HASH_MOD_65536))) {
 		v_print_log(VRS_PRINT_ERROR, "Unsupported hash function\n");
 		goto end;
 	}
 
-	ret = 1;
+	/* Compute size of slot with inline key aligned to the size of pointer */
+	slot_size = offsetof(VHashSlot, key);
+	if(key_size <= HASH_INLINE_KEY_SIZE) {
+		slot_size += key_size;
+	}
+	slot_size = (slot_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+	hash_array->slot_size = (uint16)slot_size;
+
 	hash_array->key_offset = key_offset;
 	hash_array->key_size = key_size;
 	hash_array->flags = flags;
 
+	ret = 1;
+
 end:
 	pthread_mutex_unlock(&hash_array->mutex);
 
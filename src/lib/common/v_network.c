@@ -33,6 +33,11 @@
  *
  */
 
+#ifdef __linux__
+/* sendmmsg() and recvmmsg() */
+#define _GNU_SOURCE
+#endif
+
 #ifdef WITH_OPENSSL
 #include <openssl/ssl.h>
 #include <openssl/err.h>
@@ -47,6 +52,9 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #endif
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
 
 #include <errno.h>
 #include <limits.h>
@@ -685,12 +693,87 @@ int v_tcp_write(struct IO_CTX *io_ctx, int *error_num)
 #endif
 }
 
+#ifdef __linux__
+/**
+ * \brief This function receives packet from socket with enabled UDP GRO.
+ * Packets coalesced by kernel are stored in super-buffer and they are copied
+ * to the buffer of IO_CTX one by one.
+ * \return This function returns 1, when packet was received. Otherwise it
+ * returns -1.
+ */
+static int v_receive_packet_gro(struct IO_CTX *io_ctx, int *error_num)
+{
+	struct VDgramGro *gro = io_ctx->gro;
+	char control[CMSG_SPACE(sizeof(int))];
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	int seg_size;
+
+	if(gro->pos >= gro->size) {
+		memset(&msg, 0, sizeof(struct msghdr));
+		iov.iov_base = gro->buf;
+		iov.iov_len = MAX_PACKET_SIZE;
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		if(!(io_ctx->flags & SOCKET_CONNECTED)) {
+			io_ctx->peer_addr.ip_ver = io_ctx->host_addr.ip_ver;
+			if(io_ctx->host_addr.ip_ver == IPV4) {
+				msg.msg_name = &io_ctx->peer_addr.addr.ipv4;
+				msg.msg_namelen = sizeof(io_ctx->peer_addr.addr.ipv4);
+			} else {
+				msg.msg_name = &io_ctx->peer_addr.addr.ipv6;
+				msg.msg_namelen = sizeof(io_ctx->peer_addr.addr.ipv6);
+			}
+		}
+
+		if((gro->size = recvmsg(io_ctx->sockfd, &msg, 0)) == -1) {
+			*error_num = errno;
+			gro->size = 0;
+			io_ctx->buf_size = 0;
+			v_print_log(VRS_PRINT_ERROR, "recvmsg(): %s\n", strerror(*error_num));
+			return -1;
+		}
+
+		/* Packets were not coalesced, when there is no GRO control message */
+		gro->pos = 0;
+		gro->seg_size = gro->size;
+		for(cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if(cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+				memcpy(&seg_size, CMSG_DATA(cmsg), sizeof(int));
+				if(seg_size > 0 && seg_size < gro->size) {
+					gro->seg_size = seg_size;
+				}
+				break;
+			}
+		}
+	}
+
+	io_ctx->buf_size = gro->size - gro->pos;
+	if(io_ctx->buf_size > gro->seg_size) {
+		io_ctx->buf_size = gro->seg_size;
+	}
+	memcpy(io_ctx->buf, &gro->buf[gro->pos], io_ctx->buf_size);
+	gro->pos += io_ctx->buf_size;
+
+	return 1;
+}
+#endif
+
 /* Receive Verse packet through unsecured UDP socket. */
 int v_receive_packet(struct IO_CTX *io_ctx, int *error_num)
 {
 	unsigned int addr_len = 0;
 	*error_num = 0;
 
+#ifdef __linux__
+	if(io_ctx->gro != NULL) {
+		return v_receive_packet_gro(io_ctx, error_num);
+	}
+#endif
+
 #ifdef WITH_OPENSSL
 	if(io_ctx->flags & SOCKET_SECURED) {
 again:
@@ -766,12 +849,60 @@ again:
 
 }
 
+/**
+ * \brief This function adds packet from the buffer of IO_CTX to the batch
+ * of packets. When batch is full, then all packets are sent.
+ * \return This function returns 1, when packet was added to the batch and
+ * it returns 0, when packet has to be sent without batch.
+ */
+static int v_dgram_batch_add(struct IO_CTX *io_ctx, int *error_num)
+{
+	struct VDgramBatch *batch = io_ctx->batch;
+
+	/* Packet is bigger then slot of batch */
+	if(io_ctx->buf_size > batch->slot_size) {
+		v_dgram_batch_send(batch, io_ctx->sockfd, error_num);
+		return 0;
+	}
+
+	memcpy(batch->bufs[batch->count], io_ctx->buf, io_ctx->buf_size);
+	batch->sizes[batch->count] = io_ctx->buf_size;
+	/* Address of peer is used only by unconnected socket */
+	if(io_ctx->flags & SOCKET_CONNECTED) {
+		batch->addrs[batch->count].ip_ver = 0;
+	} else {
+		memcpy(&batch->addrs[batch->count], &io_ctx->peer_addr, sizeof(struct VNetworkAddress));
+	}
+	batch->count++;
+
+	if(batch->count == batch->len) {
+		v_dgram_batch_send(batch, io_ctx->sockfd, error_num);
+	}
+
+	return 1;
+}
+
 /* Send Verse packet through unsecured UDP socket. */
 int v_send_packet(struct IO_CTX *io_ctx, int *error_num)
 {
 	int ret;
 	if(error_num != NULL) *error_num = 0;
 
+	/* In-memory context does not use any socket */
+	if(io_ctx->flags & SOCKET_MEMORY) {
+		return SEND_PACKET_SUCCESS;
+	}
+
+	/* Packet is only copied to the batch, that is sent later */
+	if(io_ctx->batch != NULL &&
+			io_ctx->batch->active == 1 &&
+			!(io_ctx->flags & SOCKET_SECURED))
+	{
+		if(v_dgram_batch_add(io_ctx, error_num) == 1) {
+			return SEND_PACKET_SUCCESS;
+		}
+	}
+
 #ifdef WITH_OPENSSL
 	if(io_ctx->flags & SOCKET_SECURED) {
 again:
@@ -838,3 +969,578 @@ again:
 	return SEND_PACKET_SUCCESS;
 }
 
+/**
+ * \brief This function creates batch of datagrams.
+ * \param[in]	len			The maximal number of packets in batch
+ * \param[in]	slot_size	The maximal size of one packet in batch
+ * \return This function returns pointer at new batch or NULL, when it was
+ * not possible to allocate memory.
+ */
+struct VDgramBatch *v_dgram_batch_create(uint16 len, uint16 slot_size)
+{
+	struct VDgramBatch *batch;
+	uint16 i;
+
+	if(len == 0 || len > MAX_DGRAM_BATCH) {
+		return NULL;
+	}
+
+	batch = (struct VDgramBatch*)calloc(1, sizeof(struct VDgramBatch));
+	if(batch == NULL) {
+		return NULL;
+	}
+
+	batch->len = len;
+	batch->slot_size = slot_size;
+	batch->bufs = (char**)calloc(len, sizeof(char*));
+	batch->sizes = (ssize_t*)calloc(len, sizeof(ssize_t));
+	batch->addrs = (struct VNetworkAddress*)calloc(len, sizeof(struct VNetworkAddress));
+#ifdef __linux__
+	batch->msgs = calloc(len, sizeof(struct mmsghdr));
+	batch->iovs = calloc(len, sizeof(struct iovec));
+	if(batch->msgs == NULL || batch->iovs == NULL) {
+		v_dgram_batch_destroy(batch);
+		return NULL;
+	}
+#endif
+	if(batch->bufs == NULL || batch->sizes == NULL || batch->addrs == NULL) {
+		v_dgram_batch_destroy(batch);
+		return NULL;
+	}
+
+	for(i = 0; i < len; i++) {
+		batch->bufs[i] = (char*)malloc(slot_size);
+		if(batch->bufs[i] == NULL) {
+			v_dgram_batch_destroy(batch);
+			return NULL;
+		}
+	}
+
+	return batch;
+}
+
+/**
+ * \brief This function frees batch of datagrams. Packets, that were not sent
+ * yet, are dropped.
+ */
+void v_dgram_batch_destroy(struct VDgramBatch *batch)
+{
+	uint16 i;
+
+	if(batch == NULL) {
+		return;
+	}
+
+	if(batch->bufs != NULL) {
+		for(i = 0; i < batch->len; i++) {
+			if(batch->bufs[i] != NULL) {
+				free(batch->bufs[i]);
+			}
+		}
+		free(batch->bufs);
+	}
+	if(batch->sizes != NULL) free(batch->sizes);
+	if(batch->addrs != NULL) free(batch->addrs);
+	if(batch->msgs != NULL) free(batch->msgs);
+	if(batch->iovs != NULL) free(batch->iovs);
+
+	free(batch);
+}
+
+/**
+ * \brief Since now packets sent with v_send_packet() are collected in the
+ * batch of IO_CTX. It does nothing, when IO_CTX has no batch.
+ */
+void v_dgram_batch_begin(struct IO_CTX *io_ctx)
+{
+	if(io_ctx->batch != NULL) {
+		io_ctx->batch->active = 1;
+	}
+}
+
+/**
+ * \brief This function sends all packets collected in the batch of IO_CTX
+ * and it stops collecting packets.
+ * \return This function returns SEND_PACKET_SUCCESS or SEND_PACKET_ERROR.
+ */
+int v_dgram_batch_end(struct IO_CTX *io_ctx, int *error_num)
+{
+	int ret = SEND_PACKET_SUCCESS;
+
+	if(io_ctx->batch != NULL) {
+		if(io_ctx->batch->count > 0) {
+			ret = v_dgram_batch_send(io_ctx->batch, io_ctx->sockfd, error_num);
+		}
+		io_ctx->batch->active = 0;
+	}
+
+	return ret;
+}
+
+#ifdef __linux__
+/**
+ * \brief This function sends packets first .. first+count-1 of batch with
+ * sendmmsg().
+ * \return This function returns SEND_PACKET_SUCCESS or SEND_PACKET_ERROR.
+ */
+static int v_dgram_batch_send_mmsg(struct VDgramBatch *batch,
+		int sockfd,
+		uint16 first,
+		uint16 count,
+		int *error_num)
+{
+	struct mmsghdr *msgs = (struct mmsghdr*)batch->msgs;
+	int sent;
+
+	while(count > 0) {
+		sent = sendmmsg(sockfd, &msgs[first], count, 0);
+		if(sent == -1) {
+			if(errno == EINTR) {
+				continue;
+			}
+			/* Probe of PMTU discovery is bigger then MTU of interface.
+			 * It is dropped like lost packet. */
+			if(errno == EMSGSIZE) {
+				first++;
+				count--;
+				continue;
+			}
+			if(error_num != NULL) *error_num = errno;
+			v_print_log(VRS_PRINT_ERROR, "sendmmsg(): %s\n", strerror(errno));
+			return SEND_PACKET_ERROR;
+		}
+		v_print_log(VRS_PRINT_DEBUG_MSG, "sendmmsg() %d packets\n", sent);
+		first += sent;
+		count -= sent;
+	}
+
+	return SEND_PACKET_SUCCESS;
+}
+
+/**
+ * \brief This function returns number of packets starting at first, that
+ * could be sent in one super-buffer with UDP GSO. All packets have to be
+ * sent to the same address and they have to have the same size. Only the
+ * last packet could be smaller.
+ */
+static uint16 v_dgram_batch_gso_run(const struct VDgramBatch *batch, uint16 first)
+{
+	ssize_t seg_size = batch->sizes[first], total = seg_size;
+	uint16 i;
+
+	for(i = first + 1;
+			i < batch->count && i - first < MAX_GSO_SEGMENTS &&
+			total + batch->sizes[i] <= MAX_GSO_SIZE;
+			i++)
+	{
+		if(batch->sizes[i] > seg_size ||
+				memcmp(&batch->addrs[i], &batch->addrs[first], sizeof(struct VNetworkAddress)) != 0)
+		{
+			break;
+		}
+		total += batch->sizes[i];
+		/* Smaller packet terminates super-buffer */
+		if(batch->sizes[i] < seg_size) {
+			i++;
+			break;
+		}
+	}
+
+	return i - first;
+}
+
+/**
+ * \brief This function sends packets first .. first+count-1 of batch in
+ * one super-buffer, that is split to packets by kernel (UDP GSO).
+ * \return This function returns SEND_PACKET_SUCCESS or SEND_PACKET_ERROR.
+ */
+static int v_dgram_batch_send_gso(struct VDgramBatch *batch,
+		int sockfd,
+		uint16 first,
+		uint16 count,
+		int *error_num)
+{
+	struct mmsghdr *msgs = (struct mmsghdr*)batch->msgs;
+	struct iovec *iovs = (struct iovec*)batch->iovs;
+	char control[CMSG_SPACE(sizeof(uint16))];
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	uint16 seg_size = batch->sizes[first];
+
+	memset(&msg, 0, sizeof(struct msghdr));
+	memset(control, 0, sizeof(control));
+	msg.msg_name = msgs[first].msg_hdr.msg_name;
+	msg.msg_namelen = msgs[first].msg_hdr.msg_namelen;
+	msg.msg_iov = &iovs[first];
+	msg.msg_iovlen = count;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_UDP;
+	cmsg->cmsg_type = UDP_SEGMENT;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(uint16));
+	memcpy(CMSG_DATA(cmsg), &seg_size, sizeof(uint16));
+
+	while(sendmsg(sockfd, &msg, 0) == -1) {
+		if(errno == EINTR) {
+			continue;
+		}
+		if(error_num != NULL) *error_num = errno;
+		/* Kernel or device does not support GSO, then packets are sent
+		 * without it since now */
+		if(errno == EIO || errno == EINVAL || errno == ENOPROTOOPT ||
+				errno == EOPNOTSUPP)
+		{
+			v_print_log(VRS_PRINT_WARNING, "UDP GSO disabled: %s\n", strerror(errno));
+			batch->gso = 0;
+		} else {
+			v_print_log(VRS_PRINT_ERROR, "sendmsg(): %s\n", strerror(errno));
+		}
+		return SEND_PACKET_ERROR;
+	}
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "sendmsg() %d packets with GSO\n", count);
+
+	return SEND_PACKET_SUCCESS;
+}
+#endif
+
+/**
+ * \brief This function sends all packets of batch with one system call,
+ * when it is supported by system. When UDP GSO is enabled for the batch,
+ * then consecutive packets of the same size are sent in one super-buffer.
+ * Packets are dropped, when it is not possible to send them, because they
+ * will be resent.
+ * \return This function returns SEND_PACKET_SUCCESS or SEND_PACKET_ERROR.
+ */
+int v_dgram_batch_send(struct VDgramBatch *batch, int sockfd, int *error_num)
+{
+	int ret = SEND_PACKET_SUCCESS;
+	uint16 i;
+#ifdef __linux__
+	struct mmsghdr *msgs = (struct mmsghdr*)batch->msgs;
+	struct iovec *iovs = (struct iovec*)batch->iovs;
+	uint16 first, run;
+#else
+	struct sockaddr *addr;
+	socklen_t addr_len;
+#endif
+
+	if(error_num != NULL) *error_num = 0;
+
+#ifdef __linux__
+	for(i = 0; i < batch->count; i++) {
+		iovs[i].iov_base = batch->bufs[i];
+		iovs[i].iov_len = batch->sizes[i];
+		memset(&msgs[i].msg_hdr, 0, sizeof(struct msghdr));
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		if(batch->addrs[i].ip_ver == IPV4) {
+			msgs[i].msg_hdr.msg_name = &batch->addrs[i].addr.ipv4;
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		} else if(batch->addrs[i].ip_ver == IPV6) {
+			msgs[i].msg_hdr.msg_name = &batch->addrs[i].addr.ipv6;
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in6);
+		}
+	}
+
+	/* Packets, that could not be sent in super-buffer, are sent together
+	 * with sendmmsg() */
+	first = i = 0;
+	while(batch->gso == 1 && i < batch->count && ret == SEND_PACKET_SUCCESS) {
+		run = v_dgram_batch_gso_run(batch, i);
+		if(run < 2) {
+			i++;
+			continue;
+		}
+		if(i > first) {
+			ret = v_dgram_batch_send_mmsg(batch, sockfd, first, i - first, error_num);
+			first = i;
+		}
+		if(ret == SEND_PACKET_SUCCESS) {
+			ret = v_dgram_batch_send_gso(batch, sockfd, i, run, error_num);
+			if(ret == SEND_PACKET_SUCCESS) {
+				i += run;
+				first = i;
+			} else if(batch->gso == 0) {
+				/* Packets of the run are sent with sendmmsg() */
+				ret = SEND_PACKET_SUCCESS;
+			}
+		}
+	}
+	if(ret == SEND_PACKET_SUCCESS && first < batch->count) {
+		ret = v_dgram_batch_send_mmsg(batch, sockfd, first, batch->count - first, error_num);
+	}
+#else
+	for(i = 0; i < batch->count; i++) {
+		if(batch->addrs[i].ip_ver == IPV4) {
+			addr = (struct sockaddr*)&batch->addrs[i].addr.ipv4;
+			addr_len = sizeof(struct sockaddr_in);
+		} else if(batch->addrs[i].ip_ver == IPV6) {
+			addr = (struct sockaddr*)&batch->addrs[i].addr.ipv6;
+			addr_len = sizeof(struct sockaddr_in6);
+		} else {
+			addr = NULL;
+			addr_len = 0;
+		}
+		if(sendto(sockfd, batch->bufs[i], batch->sizes[i], 0, addr, addr_len) == -1) {
+			if(error_num != NULL) *error_num = errno;
+			v_print_log(VRS_PRINT_ERROR, "sendto(): %s\n", strerror(errno));
+			ret = SEND_PACKET_ERROR;
+			break;
+		}
+	}
+#endif
+
+	batch->count = 0;
+
+	return ret;
+}
+
+/**
+ * \brief This function receives as many packets as fits to the batch with
+ * one system call, when it is supported by system. Socket has to be
+ * non-blocking. Truncated packets have size 0.
+ * \param[out]	*batch		The batch, where packets are stored
+ * \param[in]	sockfd		The socket
+ * \param[in]	ip_ver		The version of IP used by the socket
+ * \param[out]	*error_num	The error number of failed system call
+ * \return This function returns number of received packets or -1, when
+ * error occurred.
+ */
+int v_dgram_batch_receive(struct VDgramBatch *batch,
+		int sockfd,
+		unsigned short ip_ver,
+		int *error_num)
+{
+	int count;
+#ifdef __linux__
+	struct mmsghdr *msgs = (struct mmsghdr*)batch->msgs;
+	struct iovec *iovs = (struct iovec*)batch->iovs;
+	int i;
+#else
+	socklen_t addr_len;
+	ssize_t size;
+#endif
+
+	*error_num = 0;
+
+#ifdef __linux__
+	for(i = 0; i < batch->len; i++) {
+		iovs[i].iov_base = batch->bufs[i];
+		iovs[i].iov_len = batch->slot_size;
+		memset(&msgs[i].msg_hdr, 0, sizeof(struct msghdr));
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		if(ip_ver == IPV4) {
+			msgs[i].msg_hdr.msg_name = &batch->addrs[i].addr.ipv4;
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		} else {
+			msgs[i].msg_hdr.msg_name = &batch->addrs[i].addr.ipv6;
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in6);
+		}
+	}
+
+	do {
+		count = recvmmsg(sockfd, msgs, batch->len, MSG_DONTWAIT, NULL);
+	} while(count == -1 && errno == EINTR);
+
+	if(count == -1) {
+		*error_num = errno;
+		if(errno != EAGAIN && errno != EWOULDBLOCK) {
+			v_print_log(VRS_PRINT_ERROR, "recvmmsg(): %s\n", strerror(errno));
+		}
+		batch->count = 0;
+		return -1;
+	}
+
+	for(i = 0; i < count; i++) {
+		batch->addrs[i].ip_ver = ip_ver;
+		batch->addrs[i].protocol = UDP;
+		batch->sizes[i] = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) ? 0 : msgs[i].msg_len;
+	}
+#else
+	for(count = 0; count < batch->len; count++) {
+		batch->addrs[count].ip_ver = ip_ver;
+		batch->addrs[count].protocol = UDP;
+		if(ip_ver == IPV4) {
+			addr_len = sizeof(struct sockaddr_in);
+			size = recvfrom(sockfd, batch->bufs[count], batch->slot_size, 0,
+					(struct sockaddr*)&batch->addrs[count].addr.ipv4, &addr_len);
+		} else {
+			addr_len = sizeof(struct sockaddr_in6);
+			size = recvfrom(sockfd, batch->bufs[count], batch->slot_size, 0,
+					(struct sockaddr*)&batch->addrs[count].addr.ipv6, &addr_len);
+		}
+		if(size == -1) {
+			if(count == 0) {
+				*error_num = errno;
+				batch->count = 0;
+				return -1;
+			}
+			break;
+		}
+		batch->sizes[count] = size;
+	}
+#endif
+
+	batch->count = count;
+
+	return count;
+}
+
+/**
+ * \brief This function tests, if UDP GSO could be used for the socket.
+ * \return This function returns 1, when packets could be sent in
+ * super-buffers. Otherwise it returns 0.
+ */
+int v_dgram_gso_enable(int sockfd)
+{
+#ifdef __linux__
+	int seg_size = 0;
+
+	/* Segment size is set for each super-buffer, thus socket default is
+	 * only cleared */
+	if(setsockopt(sockfd, SOL_UDP, UDP_SEGMENT, &seg_size, sizeof(seg_size)) == -1) {
+		v_print_log(VRS_PRINT_WARNING, "UDP GSO is not supported: %s\n", strerror(errno));
+		return 0;
+	}
+	return 1;
+#else
+	(void)sockfd;
+	return 0;
+#endif
+}
+
+/**
+ * \brief This function sets Don't Fragment flag of all packets sent through
+ * the socket of IO_CTX. Packets bigger then PMTU are dropped and they are
+ * not fragmented, which is required by packetization layer PMTU discovery.
+ * PMTU discovery is not used for socket shared by many connections, because
+ * this flag would change sending of packets of all connections and the
+ * socket is not connected to one peer.
+ * \return This function returns maximal size of packet allowed by local
+ * interface (USHRT_MAX, when it is not known yet) and it returns 0, when
+ * PMTU discovery is not supported.
+ */
+uint16 v_dgram_pmtud_enable(struct IO_CTX *io_ctx)
+{
+#ifdef __linux__
+	int flag, mtu = 0, header_size;
+	socklen_t len = sizeof(mtu);
+
+	/* DTLS handles MTU itself */
+	if(io_ctx->flags & SOCKET_SECURED) {
+		return 0;
+	}
+
+	/* Socket is shared with other connections */
+	if(io_ctx->flags & SOCKET_SHARED) {
+		return 0;
+	}
+
+	if(io_ctx->host_addr.ip_ver == IPV4) {
+		flag = IP_PMTUDISC_PROBE;
+		if(setsockopt(io_ctx->sockfd, IPPROTO_IP, IP_MTU_DISCOVER, &flag, sizeof(flag)) == -1) {
+			v_print_log(VRS_PRINT_WARNING, "PMTU discovery is not supported: %s\n", strerror(errno));
+			return 0;
+		}
+		header_size = 20 + 8;
+		/* MTU of route is known only for connected socket */
+		if((io_ctx->flags & SOCKET_CONNECTED) &&
+				getsockopt(io_ctx->sockfd, IPPROTO_IP, IP_MTU, &mtu, &len) == -1) {
+			mtu = 0;
+		}
+	} else if(io_ctx->host_addr.ip_ver == IPV6) {
+		flag = IPV6_PMTUDISC_PROBE;
+		if(setsockopt(io_ctx->sockfd, IPPROTO_IPV6, IPV6_MTU_DISCOVER, &flag, sizeof(flag)) == -1) {
+			v_print_log(VRS_PRINT_WARNING, "PMTU discovery is not supported: %s\n", strerror(errno));
+			return 0;
+		}
+		header_size = 40 + 8;
+		if((io_ctx->flags & SOCKET_CONNECTED) &&
+				getsockopt(io_ctx->sockfd, IPPROTO_IPV6, IPV6_MTU, &mtu, &len) == -1) {
+			mtu = 0;
+		}
+	} else {
+		return 0;
+	}
+
+	if(mtu > header_size && mtu - header_size < USHRT_MAX) {
+		return (uint16)(mtu - header_size);
+	}
+
+	return USHRT_MAX;
+#else
+	(void)io_ctx;
+	return 0;
+#endif
+}
+
+/**
+ * \brief This function enables UDP GRO for the socket of IO_CTX. Packets
+ * coalesced by kernel are returned by v_receive_packet() one by one.
+ * \return This function returns 1, when UDP GRO was enabled. Otherwise
+ * it returns 0 and packets are received without it.
+ */
+int v_dgram_gro_enable(struct IO_CTX *io_ctx)
+{
+#ifdef __linux__
+	int flag = 1;
+
+	if(io_ctx->gro != NULL) {
+		return 1;
+	}
+
+	/* DTLS records could not be coalesced */
+	if(io_ctx->flags & SOCKET_SECURED) {
+		return 0;
+	}
+
+	if(setsockopt(io_ctx->sockfd, SOL_UDP, UDP_GRO, &flag, sizeof(flag)) == -1) {
+		v_print_log(VRS_PRINT_WARNING, "UDP GRO is not supported: %s\n", strerror(errno));
+		return 0;
+	}
+
+	io_ctx->gro = (struct VDgramGro*)calloc(1, sizeof(struct VDgramGro));
+	if(io_ctx->gro != NULL) {
+		io_ctx->gro->buf = (char*)malloc(MAX_PACKET_SIZE);
+		if(io_ctx->gro->buf != NULL) {
+			return 1;
+		}
+		free(io_ctx->gro);
+		io_ctx->gro = NULL;
+	}
+
+	flag = 0;
+	setsockopt(io_ctx->sockfd, SOL_UDP, UDP_GRO, &flag, sizeof(flag));
+	return 0;
+#else
+	(void)io_ctx;
+	return 0;
+#endif
+}
+
+/**
+ * \brief This function frees buffer used for UDP GRO. Packets, that were
+ * not returned yet, are dropped.
+ */
+void v_dgram_gro_destroy(struct IO_CTX *io_ctx)
+{
+	if(io_ctx->gro != NULL) {
+		free(io_ctx->gro->buf);
+		free(io_ctx->gro);
+		io_ctx->gro = NULL;
+	}
+}
+
+/**
+ * \brief This function returns 1, when some packets received in super-buffer
+ * were not returned by v_receive_packet() yet. The socket does not have to
+ * be polled in this case.
+ */
+int v_dgram_gro_pending(const struct IO_CTX *io_ctx)
+{
+	return (io_ctx->gro != NULL && io_ctx->gro->pos < io_ctx->gro->size) ? 1 : 0;
+}
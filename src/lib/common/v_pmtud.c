@@ -0,0 +1,254 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2010, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <string.h>
+
+#include "verse_types.h"
+
+#include "v_common.h"
+#include "v_network.h"
+#include "v_history.h"
+#include "v_connection.h"
+#include "v_pmtud.h"
+
+/**
+ * \brief This function changes MTU of datagram connection. Commands are
+ * packed to bigger or smaller packets since next sent packet.
+ */
+static void pmtud_set_mtu(struct VDgramConn *vconn, uint16 mtu)
+{
+	vconn->io_ctx.mtu = mtu;
+	vconn->cc.mss = mtu;
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "PMTU: %d\n", mtu);
+}
+
+/**
+ * \brief This function finishes search, when PMTU is known with precision
+ * PMTUD_SEARCH_STEP.
+ */
+static void pmtud_check_search(struct VDgramConn *vconn,
+		const struct timeval *tv)
+{
+	struct VPmtud *pmtud = &vconn->pmtud;
+
+	if(pmtud->state == PMTUD_SEARCHING &&
+			pmtud->high - pmtud->low <= PMTUD_SEARCH_STEP) {
+		pmtud->state = PMTUD_SEARCH_COMPLETE;
+		pmtud->search_tv = *tv;
+		v_print_log(VRS_PRINT_DEBUG_MSG, "PMTU search complete: %d\n",
+				vconn->io_ctx.mtu);
+	}
+}
+
+/**
+ * \brief This function starts PMTU discovery of datagram connection. It has
+ * to be called, when initial MTU of connection is set.
+ *
+ * \param[in]	*vconn	The datagram connection
+ * \param[in]	max_mtu	The maximal size of packet allowed by local interface.
+ * Zero value disables PMTU discovery.
+ */
+void v_pmtud_init(struct VDgramConn *vconn, uint16 max_mtu)
+{
+	struct VPmtud *pmtud = &vconn->pmtud;
+	struct timeval tv;
+
+	memset(pmtud, 0, sizeof(struct VPmtud));
+
+	if(max_mtu == 0) {
+		pmtud->state = PMTUD_DISABLED;
+		return;
+	}
+
+	if(max_mtu > PMTUD_MAX_MTU) {
+		max_mtu = PMTUD_MAX_MTU;
+	}
+	pmtud->max_mtu = max_mtu;
+
+	/* Bigger packets could not be sent through local interface at all */
+	if(vconn->io_ctx.mtu > max_mtu) {
+		pmtud_set_mtu(vconn, max_mtu);
+	}
+
+	pmtud->low = vconn->io_ctx.mtu;
+	pmtud->high = max_mtu + 1;
+	pmtud->state = PMTUD_SEARCHING;
+
+	gettimeofday(&tv, NULL);
+	pmtud_check_search(vconn, &tv);
+}
+
+/**
+ * \brief This function returns size of probe, that should be sent now. Only
+ * one probe is in flight and search is started again after
+ * PMTUD_RAISE_TIMER seconds, because path could be changed.
+ *
+ * \return This function returns zero, when no probe should be sent.
+ */
+uint16 v_pmtud_probe_size(struct VDgramConn *vconn,
+		const struct timeval *tv)
+{
+	struct VPmtud *pmtud = &vconn->pmtud;
+
+	if(pmtud->state == PMTUD_DISABLED || pmtud->probe_size != 0) {
+		return 0;
+	}
+
+	if(pmtud->state == PMTUD_SEARCH_COMPLETE) {
+		if(tv->tv_sec - pmtud->search_tv.tv_sec < PMTUD_RAISE_TIMER ||
+				pmtud->max_mtu + 1 - pmtud->low <= PMTUD_SEARCH_STEP) {
+			return 0;
+		}
+		pmtud->state = PMTUD_SEARCHING;
+		pmtud->high = pmtud->max_mtu + 1;
+		pmtud->probe_count = 0;
+	}
+
+	return pmtud->low + (pmtud->high - pmtud->low)/2;
+}
+
+/**
+ * \brief This function stores payload ID of sent probe
+ */
+void v_pmtud_probe_sent(struct VDgramConn *vconn,
+		uint32 id,
+		uint16 size)
+{
+	struct VPmtud *pmtud = &vconn->pmtud;
+
+	pmtud->probe_id = id;
+	pmtud->probe_size = size;
+}
+
+/**
+ * \brief This function is called, when probe could not be sent, because it
+ * is bigger then MTU of local interface.
+ */
+void v_pmtud_probe_failed(struct VDgramConn *vconn,
+		uint16 size,
+		const struct timeval *tv)
+{
+	struct VPmtud *pmtud = &vconn->pmtud;
+
+	if(pmtud->state == PMTUD_DISABLED || size <= pmtud->low) {
+		return;
+	}
+
+	pmtud->max_mtu = size - 1;
+	pmtud->high = size;
+	pmtud->probe_count = 0;
+	pmtud_check_search(vconn, tv);
+}
+
+/**
+ * \brief This function is called, when sent packet was acknowledged. The
+ * MTU of connection is increased, when probe was delivered.
+ */
+void v_pmtud_packet_acked(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv)
+{
+	struct VPmtud *pmtud = &vconn->pmtud;
+
+	if(pmtud->state == PMTUD_DISABLED) {
+		return;
+	}
+
+	if(sent_packet->size > PMTUD_BASE_MTU) {
+		pmtud->black_hole_count = 0;
+	}
+
+	if(pmtud->probe_size != 0 && sent_packet->id == pmtud->probe_id) {
+		if(pmtud->probe_size > pmtud->low) {
+			pmtud->low = pmtud->probe_size;
+			pmtud_set_mtu(vconn, pmtud->low);
+		}
+		pmtud->probe_size = 0;
+		pmtud->probe_count = 0;
+		pmtud_check_search(vconn, tv);
+	}
+}
+
+/**
+ * \brief This function is called, when sent packet was negatively
+ * acknowledged. Size of probe is considered too big after PMTUD_MAX_PROBES
+ * lost probes. When many packets bigger then PMTUD_BASE_MTU were lost in
+ * the row, then path probably drops them (black hole) and MTU is reduced
+ * to PMTUD_BASE_MTU until new search finds bigger PMTU.
+ *
+ * \return This function returns 1, when lost packet was probe. Such loss is
+ * not signal of congestion.
+ */
+int v_pmtud_packet_lost(struct VDgramConn *vconn,
+		const struct VSent_Packet *sent_packet,
+		const struct timeval *tv)
+{
+	struct VPmtud *pmtud = &vconn->pmtud;
+
+	if(pmtud->state == PMTUD_DISABLED) {
+		return 0;
+	}
+
+	if(pmtud->probe_size != 0 && sent_packet->id == pmtud->probe_id) {
+		pmtud->probe_count++;
+		if(pmtud->probe_count >= PMTUD_MAX_PROBES) {
+			pmtud->high = pmtud->probe_size;
+			pmtud->probe_count = 0;
+			pmtud_check_search(vconn, tv);
+		}
+		pmtud->probe_size = 0;
+		return 1;
+	}
+
+	if(sent_packet->size > PMTUD_BASE_MTU &&
+			vconn->io_ctx.mtu > PMTUD_BASE_MTU &&
+			++pmtud->black_hole_count >= PMTUD_BLACK_HOLE_LOSSES)
+	{
+		v_print_log(VRS_PRINT_WARNING, "PMTU black hole detected, MTU: %d -> %d\n",
+				vconn->io_ctx.mtu, PMTUD_BASE_MTU);
+		pmtud->high = vconn->io_ctx.mtu;
+		pmtud->low = PMTUD_BASE_MTU;
+		pmtud_set_mtu(vconn, PMTUD_BASE_MTU);
+		pmtud->black_hole_count = 0;
+		pmtud->probe_size = 0;
+		pmtud->probe_count = 0;
+		pmtud->state = PMTUD_SEARCHING;
+		pmtud_check_search(vconn, tv);
+	}
+
+	return 0;
+}
@@ -0,0 +1,351 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "v_pool.h"
+#include "v_common.h"
+
+#if defined(_MSC_VER)
+#define V_POOL_TLS	__declspec(thread)
+#else
+#define V_POOL_TLS	__thread
+#endif
+
+/**
+ * Free block of memory. Free blocks of one size class are stored in the
+ * single linked list.
+ */
+typedef struct VPoolBlock {
+	struct VPoolBlock	*next;
+} VPoolBlock;
+
+/**
+ * Free blocks cached by one thread. No locking is needed for this cache.
+ */
+typedef struct VPoolCache {
+	struct VPoolBlock	*free[POOL_CLASS_COUNT];	/* Lists of free blocks */
+	uint32				count[POOL_CLASS_COUNT];	/* Numbers of free blocks */
+	uint64				alloc_count;				/* Number of allocated blocks */
+	uint8				registered;					/* Destructor of cache is registered */
+} VPoolCache;
+
+/**
+ * Free blocks shared by all threads. Blocks are moved between depot and
+ * caches of threads in batches.
+ */
+typedef struct VPoolDepot {
+	pthread_mutex_t		mutex;
+	struct VPoolBlock	*free[POOL_CLASS_COUNT];	/* Lists of free blocks */
+	uint32				count[POOL_CLASS_COUNT];	/* Numbers of free blocks */
+	uint32				slab_count;					/* Number of allocated slabs */
+} VPoolDepot;
+
+static struct VPoolDepot v_pool_depot = {PTHREAD_MUTEX_INITIALIZER, {NULL}, {0}, 0};
+static pthread_once_t v_pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t v_pool_key;
+static V_POOL_TLS struct VPoolCache v_pool_cache;
+
+/**
+ * \brief This function returns size class of block with size
+ */
+static uint32 v_pool_class(size_t size)
+{
+	return (size > 0) ? (uint32)((size - 1) / POOL_CLASS_SIZE) : 0;
+}
+
+/**
+ * \brief This function moves count free blocks of size class from the cache
+ * of thread to the shared depot.
+ */
+static void v_pool_flush(struct VPoolCache *cache, uint32 class_id, uint32 count)
+{
+	struct VPoolBlock *first, *last;
+	uint32 i;
+
+	if(count == 0 || cache->free[class_id] == NULL) {
+		return;
+	}
+
+	first = last = cache->free[class_id];
+	for(i = 1; i < count && last->next != NULL; i++) {
+		last = last->next;
+	}
+
+	cache->free[class_id] = last->next;
+	cache->count[class_id] -= i;
+
+	pthread_mutex_lock(&v_pool_depot.mutex);
+	last->next = v_pool_depot.free[class_id];
+	v_pool_depot.free[class_id] = first;
+	v_pool_depot.count[class_id] += i;
+	pthread_mutex_unlock(&v_pool_depot.mutex);
+}
+
+/**
+ * \brief This function is called, when thread is finished. All free blocks
+ * of this thread are returned to the shared depot.
+ */
+static void v_pool_cache_destroy(void *arg)
+{
+	struct VPoolCache *cache = (struct VPoolCache*)arg;
+	uint32 class_id;
+
+	for(class_id = 0; class_id < POOL_CLASS_COUNT; class_id++) {
+		v_pool_flush(cache, class_id, cache->count[class_id]);
+	}
+}
+
+static void v_pool_key_create(void)
+{
+	pthread_key_create(&v_pool_key, v_pool_cache_destroy);
+}
+
+/**
+ * \brief This function registers destructor of cache of current thread
+ */
+static void v_pool_cache_register(struct VPoolCache *cache)
+{
+	pthread_once(&v_pool_once, v_pool_key_create);
+	pthread_setspecific(v_pool_key, cache);
+	cache->registered = 1;
+}
+
+/**
+ * \brief This function adds free blocks to the empty cache of thread. Blocks
+ * are taken from the shared depot first. New slab is allocated only, when
+ * the depot is empty too.
+ * \return This function returns 1 on success and 0, when there is not enough
+ * memory.
+ */
+static int v_pool_refill(struct VPoolCache *cache, uint32 class_id)
+{
+	struct VPoolBlock *first, *last;
+	size_t block_size = (class_id + 1) * POOL_CLASS_SIZE;
+	uint8 *slab;
+	uint32 count;
+
+	if(cache->registered == 0) {
+		v_pool_cache_register(cache);
+	}
+
+	pthread_mutex_lock(&v_pool_depot.mutex);
+	first = last = v_pool_depot.free[class_id];
+	count = 0;
+	if(first != NULL) {
+		for(count = 1; count < POOL_BATCH_SIZE && last->next != NULL; count++) {
+			last = last->next;
+		}
+		v_pool_depot.free[class_id] = last->next;
+		v_pool_depot.count[class_id] -= count;
+		last->next = NULL;
+	}
+	pthread_mutex_unlock(&v_pool_depot.mutex);
+
+	if(first == NULL) {
+		/* Allocate new slab and split it to blocks */
+		slab = (uint8*)malloc(POOL_BATCH_SIZE * block_size);
+		if(slab == NULL) {
+			v_print_log(VRS_PRINT_ERROR, "malloc(): no memory allocated\n");
+			return 0;
+		}
+
+		for(count = 0; count < POOL_BATCH_SIZE - 1; count++) {
+			((struct VPoolBlock*)&slab[count * block_size])->next =
+					(struct VPoolBlock*)&slab[(count + 1) * block_size];
+		}
+		first = (struct VPoolBlock*)slab;
+		last = (struct VPoolBlock*)&slab[count * block_size];
+		last->next = NULL;
+		count = POOL_BATCH_SIZE;
+
+		pthread_mutex_lock(&v_pool_depot.mutex);
+		v_pool_depot.slab_count++;
+		pthread_mutex_unlock(&v_pool_depot.mutex);
+	}
+
+	last->next = cache->free[class_id];
+	cache->free[class_id] = first;
+	cache->count[class_id] += count;
+
+	return 1;
+}
+
+/**
+ * \brief This function allocates block of memory with size. Small blocks are
+ * taken from the cache of current thread, bigger blocks are allocated with
+ * malloc(). Block has to be freed with v_pool_free() with the same size.
+ */
+void *v_pool_alloc(size_t size)
+{
+	struct VPoolCache *cache = &v_pool_cache;
+	struct VPoolBlock *block;
+	uint32 class_id;
+
+	cache->alloc_count++;
+
+	if(size > POOL_MAX_SIZE) {
+		return malloc(size);
+	}
+
+	class_id = v_pool_class(size);
+
+	if(cache->free[class_id] == NULL) {
+		if(v_pool_refill(cache, class_id) != 1) {
+			return NULL;
+		}
+	}
+
+	block = cache->free[class_id];
+	cache->free[class_id] = block->next;
+	cache->count[class_id]--;
+
+	return (void*)block;
+}
+
+/**
+ * \brief This function allocates block of memory with size and it sets
+ * the memory to zero.
+ */
+void *v_pool_calloc(size_t size)
+{
+	void *ptr = v_pool_alloc(size);
+
+	if(ptr != NULL) {
+		memset(ptr, 0, size);
+	}
+
+	return ptr;
+}
+
+/**
+ * \brief This function returns block of memory with size to the pool. When
+ * the cache of current thread is full, then part of free blocks is moved
+ * to the shared depot.
+ */
+void v_pool_free(void *ptr, size_t size)
+{
+	struct VPoolCache *cache = &v_pool_cache;
+	struct VPoolBlock *block = (struct VPoolBlock*)ptr;
+	uint32 class_id;
+
+	if(ptr == NULL) {
+		return;
+	}
+
+	if(size > POOL_MAX_SIZE) {
+		free(ptr);
+		return;
+	}
+
+	/* Blocks freed by thread, which never allocated any block, have to be
+	 * returned to the depot, when this thread is finished */
+	if(cache->registered == 0) {
+		v_pool_cache_register(cache);
+	}
+
+	class_id = v_pool_class(size);
+
+	block->next = cache->free[class_id];
+	cache->free[class_id] = block;
+	cache->count[class_id]++;
+
+	if(cache->count[class_id] > POOL_CACHE_SIZE) {
+		v_pool_flush(cache, class_id, POOL_BATCH_SIZE);
+	}
+}
+
+/**
+ * \brief This function returns all items of linked list to the pool
+ */
+void v_pool_list_free(struct VListBase *listbase, size_t item_size)
+{
+	struct VItem *item, *next;
+
+	if(listbase == NULL) {
+		return;
+	}
+
+	item = listbase->first;
+	while(item != NULL) {
+		next = item->next;
+		v_pool_free(item, item_size);
+		item = next;
+	}
+
+	listbase->first = NULL;
+	listbase->last = NULL;
+}
+
+/**
+ * \brief This function removes item from linked list and it returns this item
+ * to the pool
+ */
+void v_pool_list_free_item(struct VListBase *listbase, void *item, size_t item_size)
+{
+	if(item == NULL || listbase == NULL) {
+		return;
+	}
+
+	v_list_rem_item(listbase, item);
+	v_pool_free(item, item_size);
+}
+
+/**
+ * \brief This function returns number of slabs allocated by pool
+ */
+uint32 v_pool_slab_count(void)
+{
+	uint32 count;
+
+	pthread_mutex_lock(&v_pool_depot.mutex);
+	count = v_pool_depot.slab_count;
+	pthread_mutex_unlock(&v_pool_depot.mutex);
+
+	return count;
+}
+
+/**
+ * \brief This function returns number of blocks allocated from pool by
+ * current thread
+ */
+uint64 v_pool_thread_alloc_count(void)
+{
+	return v_pool_cache.alloc_count;
+}
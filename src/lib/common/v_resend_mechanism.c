@@ -35,6 +35,7 @@
 
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
 
 #include "v_network.h"
 #include "v_connection.h"
@@ -43,10 +44,79 @@
 #include "v_fake_commands.h"
 #include "v_out_queue.h"
 #include "v_history.h"
+#include "v_congestion.h"
+#include "v_pmtud.h"
 #include "v_cmd_queue.h"
+#include "v_pool.h"
 
 #include "v_resend_mechanism.h"
 
+/**
+ * \brief This function updates SRTT, RTTVAR and RTO with new RTT sample as
+ * described in RFC 6298
+ */
+void v_rto_update(struct VDgramConn *vconn, unsigned long int rtt)
+{
+	unsigned long int delta, rto;
+
+	if(vconn->srtt == 0) {
+		/* The first RTT measurement */
+		vconn->srtt = rtt;
+		vconn->rttvar = rtt/2;
+	} else {
+		/* RTTVAR = 3/4*RTTVAR + 1/4*|SRTT - R'|, SRTT = 7/8*SRTT + 1/8*R' */
+		delta = (vconn->srtt > rtt) ? (vconn->srtt - rtt) : (rtt - vconn->srtt);
+		vconn->rttvar = (3*vconn->rttvar + delta)/4;
+		vconn->srtt = (7*vconn->srtt + rtt)/8;
+	}
+
+	/* RTO = SRTT + max(G, 4*RTTVAR) */
+	rto = vconn->srtt + ((4*vconn->rttvar > RTO_CLOCK_GRANULARITY) ?
+			4*vconn->rttvar : RTO_CLOCK_GRANULARITY);
+
+	if(rto < RTO_MIN) {
+		rto = RTO_MIN;
+	} else if(rto > RTO_MAX) {
+		rto = RTO_MAX;
+	}
+
+	vconn->rto = rto;
+	vconn->rto_backoff = 0;
+}
+
+/**
+ * \brief This function backs off retransmission timer after its expiration
+ * (RFC 6298, 5.5). Packets sent before the first expiration are not used for
+ * RTT samples until new RTT sample is taken.
+ */
+void v_rto_timeout(struct VDgramConn *vconn)
+{
+	vconn->rto = (vconn->rto < RTO_MAX/2) ? vconn->rto*2 : RTO_MAX;
+	/* Karn's rule: RTT of packets sent before this probe could include time
+	 * of loss recovery */
+	if(vconn->rto_backoff == 0) {
+		vconn->karn_id = vconn->host_id + vconn->count_s_pay;
+	}
+	vconn->rto_backoff++;
+}
+
+/**
+ * \brief This function checks, if acknowledged packet could be used for RTT
+ * sample according Karn's rule.
+ * \return This function returns 1, when RTT of packet could be used for
+ * update of RTO, otherwise it returns 0.
+ */
+int v_rto_sample_valid(const struct VDgramConn *vconn, uint32 pay_id)
+{
+	/* Packets sent before expiration of retransmission timer could be
+	 * acknowledged after retransmission */
+	if(vconn->rto_backoff > 0 && (int)(pay_id - vconn->karn_id) < 0) {
+		return 0;
+	}
+
+	return 1;
+}
+
 /**
  * \brief This function check if it is necessary to send payload packet
  */
@@ -57,23 +127,41 @@ static int check_pay_flag(struct vContext *C)
 	struct timeval tv;
 	int ret = 0;
 
-	/* When there are no payload data to send, then there is possibly need
-	 * for sending keep alive packet. */
-	if(v_out_queue_get_count(vsession->out_queue) > 0) {
-		ret = 1;
+	/* Get current time */
+	gettimeofday(&tv, NULL);
+
+	/* When there are no payload data to send, congestion window is full or
+	 * pacer holds next packet, then there is possibly need for sending keep
+	 * alive packet. */
+	if(v_out_queue_get_count(vsession->out_queue) > 0 &&
+			v_cc_can_send(vconn) == 1 &&
+			v_cc_pacing_delay(vconn, &tv) == 0) {
+		/* Probe of PMTU discovery is sent only, when following packets
+		 * will trigger NAK command, when the probe is lost */
+		if(v_pmtud_probe_size(vconn, &tv) > 0) {
+			ret = 3;
+		} else {
+			ret = 1;
+		}
 	} else {
 		long int d_timeout, d_sec_timeout, d_usec_timeout;
 
-		/* Get current time */
-		gettimeofday(&tv, NULL);
-
 		/* When was sent last payload packet? */
 		d_sec_timeout = tv.tv_sec - vconn->tv_pay_send.tv_sec;
 		d_usec_timeout = tv.tv_usec - vconn->tv_pay_send.tv_usec;
 		d_timeout = 1000000*d_sec_timeout + d_usec_timeout;
 
+		/* When some sent payload packets were not acknowledged in RTO, then
+		 * the last packets or their ACK were probably lost. Peer can not
+		 * detect such loss, so keep alive packet is sent to trigger NAK
+		 * commands. The timer is backed off (RFC 6298, 5.5) */
+		if(vconn->packet_history.count > 0 && d_timeout > (long int)vconn->rto) {
+			v_print_log(VRS_PRINT_DEBUG_MSG, "Retransmission timeout: %u [us]\n", vconn->rto);
+			v_rto_timeout(vconn);
+			v_cc_timeout(vconn, &tv);
+			ret = 2;
 		/* Is it necessary to send keep alive packet? */
-		if(d_timeout > RESEND_TIMEOUT) {
+		} else if(d_timeout > RESEND_TIMEOUT) {
 			ret = 2;
 		}
 	}
@@ -116,24 +204,16 @@ static int check_ack_nak_flag(struct vContext *C)
 }
 
 /**
- * \brief This function set size of congestion window (congestion control)
+ * \brief This function set size of congestion window (congestion control).
+ * The window is updated by Congestion Control selected by negotiated method,
+ * when packets are acknowledged or lost.
  */
 static void set_host_cwin(struct vContext *C)
 {
 	struct VDgramConn *dgram_conn = CTX_current_dgram_conn(C);
 
-	switch(dgram_conn->cc_meth) {
-	case CC_NONE:
-		dgram_conn->cwin = 0xFFFF;
-		break;
-	case CC_TCP_LIKE:
-		/* TODO: implement real TCP like congestion control */
-		dgram_conn->cwin = 0xFFFF;
-		break;
-	case CC_RESERVED:
-		v_print_log(VRS_PRINT_WARNING, "CC_RESERVED should never be used\n");
-		dgram_conn->cwin = 0xFFFF;
-		break;
+	if(dgram_conn->cc.ops == NULL) {
+		v_cc_init(dgram_conn);
 	}
 }
 
@@ -170,9 +250,34 @@ static void set_host_rwin(struct vContext *C)
 	}
 }
 
+/**
+ * \brief This function adds command packed to the packet to the history of
+ * sent packet
+ */
+static void add_cmd_to_history(struct VDgramConn *vconn,
+		struct VSent_Packet *sent_packet,
+		struct Generic_Cmd *cmd,
+		uint8 prio)
+{
+	int ret;
+
+	/* Print command */
+	v_cmd_print(VRS_PRINT_DEBUG_MSG, cmd);
+
+	/* TODO: remove command alias here (layer value set/unset) */
+
+	/* Add command to the packet history */
+	ret = v_packet_history_add_cmd(&vconn->packet_history, sent_packet, cmd, prio);
+	assert(ret == 1);
+	(void)ret;
+}
+
 /**
  * \brief This function packs and compress command to the packet from one
- * priority queue.
+ * priority queue. Groups of commands with the same ID are prepared by the
+ * outgoing queue, thus the first command of the group is packed with the
+ * header of compressed commands and the following commands of the group are
+ * only appended to the buffer.
  *
  * \param[in]	*C	The verse context
  * \param[in]	*sent_packet	The pointer at structure with send packet
@@ -192,10 +297,8 @@ static int pack_prio_queue(struct vContext *C,
 	struct VDgramConn *vconn = CTX_current_dgram_conn(C);
 	struct IO_CTX *io_ctx = CTX_io_ctx(C);
 	struct Generic_Cmd *cmd;
-	int ret, last_cmd_count = 0;
 	uint16 cmd_count, cmd_len, cmd_size, sum_len=0;
 	int8 cmd_share;
-	uint8  last_cmd_id = CMD_RESERVED_ID;
 
 	while( (v_out_queue_get_count_prio(vsession->out_queue, prio) > 0) &&
 			(sum_len < prio_win) &&
@@ -204,14 +307,16 @@ static int pack_prio_queue(struct vContext *C,
 		cmd_count = 0;
 		cmd_share = 0;
 
-		/* Compute how many commands could be compressed to the packet
-		 * and compute right length of compressed commands. */
+		/* Maximal length of commands, that could be added to the packet */
 		cmd_len = ((prio_win - sum_len)<(vconn->io_ctx.mtu - buffer_pos)) ?
 				(prio_win - sum_len) :
 				(vconn->io_ctx.mtu - buffer_pos);
 
-		/* Remove command from queue */
-		cmd = v_out_queue_pop(vsession->out_queue, prio, &cmd_count, &cmd_share, &cmd_len);
+		/* Remove command from queue. When compression is not allowed, then
+		 * commands are not popped in groups. */
+		cmd = v_out_queue_pop(vsession->out_queue, prio,
+				(vconn->host_cmd_cmpr == CMPR_NONE) ? NULL : &cmd_count,
+				&cmd_share, &cmd_len);
 
 		/* When it is not possible to pop more commands from queue, then break
 		 * while loop */
@@ -235,70 +340,36 @@ static int pack_prio_queue(struct vContext *C,
 				vsession->fps_host = fps_cmd->fps;
 			}
 			v_cmd_destroy(&cmd);
-		} else {
-
-			/* What was size of command in queue */
-			cmd_size = v_cmd_size(cmd);
-
-			if(!(buffer_pos < (vconn->io_ctx.mtu - cmd_size))) {
-				/* When there is not enough space for other command,
-				 * then push command back to the beginning of queue. */
-				v_out_queue_push_head(vsession->out_queue, prio, cmd);
-				break;
-			} else {
-
-				/* Update total size of commands that were poped from queue */
-				*tot_cmd_size += cmd_size;
-
-				/* When compression is not allowed, then add this command as is */
-				if( vconn->host_cmd_cmpr == CMPR_NONE) {
-					cmd_count = 0;
-					cmd_len = cmd_size;
-					/* Debug print */
-					v_print_log(VRS_PRINT_DEBUG_MSG, "Cmd: %d, count: %d, length: %d\n",
-							cmd->id, cmd_count, cmd_len);
-					/* Add command to the buffer */
-					buffer_pos += v_cmd_pack(&io_ctx->buf[buffer_pos], cmd, cmd_len, 0);
-				} else {
-					/* When command compression is allowed and was ID of command changed? */
-					if( (cmd->id != last_cmd_id) || (last_cmd_count <= 0) )	{
-						/* When this command is alone, then use default command size */
-						if(cmd_count == 0) {
-							cmd_len = cmd_size;
-						} else {
-							/* FIXME: do not recompute command length here, but do it right,
-							 * when command is added to the queue */
-							cmd_len = v_cmds_len(cmd, cmd_count, cmd_share, cmd_len);
-						}
-						/* Debug print */
-						v_print_log(VRS_PRINT_DEBUG_MSG, "Cmd: %d, count: %d, length: %d\n",
-								cmd->id, cmd_count, cmd_len);
-						/* Add command to the buffer */
-						buffer_pos += v_cmd_pack(&io_ctx->buf[buffer_pos], cmd, cmd_len, cmd_share);
-						/* Set up current count of commands in the line */
-						last_cmd_count = cmd_count;
-						/* Update summary of commands length */
-						sum_len += cmd_len;
-					} else {
-						buffer_pos += v_cmd_pack(&io_ctx->buf[buffer_pos], cmd, 0, cmd_share);
-					}
-				}
-
-				/* Print command */
-				v_cmd_print(VRS_PRINT_DEBUG_MSG, cmd);
+			continue;
+		}
 
-				/* TODO: remove command alias here (layer value set/unset) */
+		/* What was size of command in queue */
+		cmd_size = v_cmd_size(cmd);
 
-				/* Add command to the packet history */
-				ret = v_packet_history_add_cmd(&vconn->packet_history, sent_packet, cmd, prio);
-				assert(ret == 1);
-				(void)ret;
+		if(cmd_count == 0) {
+			/* Alone command is added as is */
+			cmd_len = cmd_size;
+		}
 
-				/* Update last command id */
-				last_cmd_id = cmd->id;
-				/* Decrement counter of commands in queue */
-				last_cmd_count--;
-			}
+		/* Debug print */
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Cmd: %d, count: %d, length: %d\n",
+				cmd->id, cmd_count, cmd_len);
+
+		/* Add the first command with header to the buffer */
+		buffer_pos += v_cmd_pack(&io_ctx->buf[buffer_pos], cmd, cmd_len, cmd_share);
+		*tot_cmd_size += cmd_size;
+		sum_len += cmd_len;
+		add_cmd_to_history(vconn, sent_packet, cmd, prio);
+
+		/* Add following commands of the group, they are counted in the
+		 * length of compressed commands */
+		while(cmd_count > 1) {
+			cmd = v_out_queue_pop(vsession->out_queue, prio, NULL, NULL, NULL);
+			assert(cmd != NULL);
+			buffer_pos += v_cmd_pack(&io_ctx->buf[buffer_pos], cmd, 0, cmd_share);
+			*tot_cmd_size += v_cmd_size(cmd);
+			add_cmd_to_history(vconn, sent_packet, cmd, prio);
+			cmd_count--;
 		}
 	}
 
@@ -319,7 +390,7 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 	struct timeval tv;
 	int ret, keep_alive_packet = -1, full_packet = 0;
 	int error_num;
-	uint16 swin, prio_win, sent_size = 0;
+	uint16 swin, prio_win, sent_size = 0, probe_size = 0;
 	uint32 rwin;
 	int cmd_rank = 0;
 
@@ -329,12 +400,22 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 	/* Clear header flags */
 	s_packet->header.flags = 0;
 
+	/* Compute current window of congestion control */
+	set_host_cwin(C);
+
 	/* Check if it is necessary to send payload packet */
 	ret = check_pay_flag(C);
 	if(ret != 0) {
 		s_packet->header.flags |= PAY_FLAG;
 		if(ret == 2) {
 			keep_alive_packet = 1;
+		} else if(ret == 3) {
+			/* Probe is keep alive packet padded to the probed size. Data
+			 * waiting in the queue are sent in following packets. */
+			keep_alive_packet = 1;
+			full_packet = 1;
+			gettimeofday(&tv, NULL);
+			probe_size = v_pmtud_probe_size(vconn, &tv);
 		}
 	}
 
@@ -352,17 +433,11 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 		/* Update last acknowledged Payload packet */
 		vconn->last_acked_pay = vconn->last_r_pay;
 
-		/* Add ACK and NAK commands from the list of ACK and NAK commands to the
-		 * packet (only max count of ACK and NAK commands could be added to
-		 * the packet) */
-		for(cmd_rank = 0;
-				cmd_rank < vconn->ack_nak.count &&
-				cmd_rank < MAX_SYSTEM_COMMAND_COUNT;
-				cmd_rank++)
-		{
-			s_packet->sys_cmd[cmd_rank].ack_cmd.id = vconn->ack_nak.cmds[cmd_rank].id;
-			s_packet->sys_cmd[cmd_rank].ack_cmd.pay_id = vconn->ack_nak.cmds[cmd_rank].pay_id;
-		}
+		/* Add ACK and NAK commands from the history of received packets to
+		 * the packet (only max count of ACK and NAK commands could be added
+		 * to the packet and one slot is left for negotiate command) */
+		cmd_rank = v_ack_nak_history_pack_cmds(&vconn->ack_nak,
+				s_packet->sys_cmd, MAX_SYSTEM_COMMAND_COUNT - 1);
 		s_packet->sys_cmd[cmd_rank].cmd.id = CMD_RESERVED_ID;
 
 	}
@@ -375,9 +450,8 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 	s_packet->header.flags |= ANK_FLAG;
 	s_packet->header.ank_id = vconn->ank_id;
 
-	/* Compute current windows for flow control and congestion control */
+	/* Compute current window for flow control */
 	set_host_rwin(C);
-	set_host_cwin(C);
 
 	/* Set window of flow control that will sent to receiver */
 	rwin = vconn->rwin_host >> vconn->rwin_host_scale;
@@ -387,8 +461,9 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 	/* Compute how many data could be sent to not congest receiver */
 	rwin = vconn->rwin_peer - vconn->sent_size;
 
-	/* Select smallest window for sending (congestion control window or flow control window)*/
-	swin = (vconn->cwin < rwin) ? vconn->cwin : rwin;
+	/* Congestion window limits sending of whole packets (check_pay_flag), so
+	 * only flow control window limits size of commands in this packet */
+	swin = (rwin < 0xFFFF) ? rwin : 0xFFFF;
 
 	/* Set up Payload ID, when there is need to send payload packet */
 	if(s_packet->header.flags & PAY_FLAG)
@@ -430,58 +505,56 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 		assert(sent_packet != NULL);
 
 		if(keep_alive_packet != 1) {
-			real32 prio_sum_high, prio_sum_low, r_prio;
-			uint32 prio_count;
-			int16 prio, max_prio, min_prio;
-			uint16 tot_cmd_size;
+			uint32 prio_count, deficit;
+			uint16 tot_cmd_size, last_pos;
+			uint8 prio;
 
 			/* Print outgoing command with green color */
 			if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
 				printf("%c[%d;%dm", 27, 1, 32);
 			}
 
-			max_prio = v_out_queue_get_max_prio(vsession->out_queue);
-			min_prio = v_out_queue_get_min_prio(vsession->out_queue);
-
-			prio_sum_high = v_out_queue_get_prio_sum_high(vsession->out_queue);
-			prio_sum_low = v_out_queue_get_prio_sum_low(vsession->out_queue);
-
 			v_print_log(VRS_PRINT_DEBUG_MSG, "Packing prio queues, cmd count: %d\n", v_out_queue_get_count(vsession->out_queue));
 
-			/* Go through all priorities and pick commands from priority queues */
-			for(prio = max_prio; prio >= min_prio; prio--)
+			/* Pick commands from not empty priority queues in order given
+			 * by deficit round robin scheduler */
+			while(buffer_pos < vconn->io_ctx.mtu && buffer_pos < swin &&
+					v_out_queue_drr_next(vsession->out_queue, &prio, &deficit) == 1)
 			{
-				/* TODO: Add better check here */
-				if(prio <= VRS_DEFAULT_PRIORITY && buffer_pos >= vconn->io_ctx.mtu) {
-					full_packet = 1;
-					break;
-				}
-
 				prio_count = v_out_queue_get_count_prio(vsession->out_queue, prio);
 
-				if(prio_count > 0) {
-					r_prio = v_out_queue_get_prio(vsession->out_queue, prio);
+				/* Size of buffer that could be occupied by commands from this
+				 * queue is limited by its deficit and by flow control */
+				prio_win = (deficit < (uint32)(swin - buffer_pos)) ? (uint16)deficit : (uint16)(swin - buffer_pos);
 
-					/* Compute size of buffer that could be occupied by
-					 * commands from this queue */
-					if(prio >= VRS_DEFAULT_PRIORITY) {
-						prio_win = ((swin - buffer_pos)*r_prio)/prio_sum_high;
-					} else {
-						prio_win = ((swin - buffer_pos)*r_prio)/prio_sum_low;
-					}
+				/* Debug print */
+				v_print_log(VRS_PRINT_DEBUG_MSG, "Queue: %d, count: %d, deficit: %d, prio_win: %d\n",
+						prio, prio_count, deficit, prio_win);
+
+				/* Get total size of commands that were stored in queue (sent_size) */
+				tot_cmd_size = 0;
+				last_pos = buffer_pos;
+				/* Pack commands from this queue to the buffer */
+				buffer_pos = pack_prio_queue(C, sent_packet, buffer_pos, prio, prio_win, &tot_cmd_size);
+				sent_size += tot_cmd_size;
 
-					/* Debug print */
-					v_print_log(VRS_PRINT_DEBUG_MSG, "Queue: %d, count: %d, r_prio: %6.3f, prio_win: %d\n",
-							prio, prio_count, r_prio, prio_win);
+				v_out_queue_drr_charge(vsession->out_queue, prio, buffer_pos - last_pos);
 
-					/* Get total size of commands that were stored in queue (sent_size) */
-					tot_cmd_size = 0;
-					/* Pack commands from queues with high priority to the buffer */
-					buffer_pos = pack_prio_queue(C, sent_packet, buffer_pos, prio, prio_win, &tot_cmd_size);
-					sent_size += tot_cmd_size;
+				/* When no command could be popped from the queue, then the
+				 * first command does not fit to the rest of packet */
+				if(v_out_queue_get_count_prio(vsession->out_queue, prio) == prio_count) {
+					if(vconn->io_ctx.mtu - buffer_pos < prio_win) {
+						full_packet = 1;
+					}
+					break;
 				}
 			}
 
+			/* Some commands did not fit to this packet */
+			if(buffer_pos >= vconn->io_ctx.mtu && v_out_queue_get_count(vsession->out_queue) > 0) {
+				full_packet = 1;
+			}
+
 			/* Use default color for output */
 			if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
 				printf("%c[%dm", 27, 0);
@@ -492,6 +565,14 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 				v_print_log(VRS_PRINT_DEBUG_MSG, "Keep alive packet\n");
 				printf("%c[%dm", 27, 0);
 			}
+			/* Receiver stops unpacking of commands at reserved command ID,
+			 * thus probe is padded with zeros. Probes are sent only, when
+			 * peer confirmed FTR_PMTU_PROBE. */
+			if(probe_size > buffer_pos) {
+				v_print_log(VRS_PRINT_DEBUG_MSG, "PMTU probe: %d\n", probe_size);
+				memset(&io_ctx->buf[buffer_pos], 0, probe_size - buffer_pos);
+				buffer_pos = probe_size;
+			}
 		}
 	}
 
@@ -515,6 +596,11 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 			if(sent_packet != NULL) {
 				sent_packet->tv.tv_sec = tv.tv_sec;
 				sent_packet->tv.tv_usec = tv.tv_usec;
+				/* Packet is in flight until it is acknowledged or lost */
+				v_cc_packet_sent(vconn, sent_packet, io_ctx->buf_size, &tv);
+				if(probe_size > 0) {
+					v_pmtud_probe_sent(vconn, sent_packet->id, probe_size);
+				}
 			}
 		}
 
@@ -538,6 +624,13 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 		if(sent_packet != NULL) {
 			v_packet_history_rem_packet(C, s_packet->header.payload_id);
 		}
+		/* Probe bigger then MTU of local interface is not error of
+		 * connection */
+		if(probe_size > 0 && error_num == EMSGSIZE) {
+			gettimeofday(&tv, NULL);
+			v_pmtud_probe_failed(vconn, probe_size, &tv);
+			ret = SEND_PACKET_CANCELED;
+		}
 	}
 
 	/*v_print_packet_history(&vconn->packet_history);*/
@@ -545,6 +638,37 @@ int send_packet_in_OPEN_CLOSEREQ_state(struct vContext *C)
 	return ret;
 }
 
+/**
+ * \brief This function returns time in microseconds, when pacer allows
+ * sending of next payload packet. Loops of client and server use it to wake
+ * up before next tick of FPS timer.
+ *
+ * \return This function returns -1, when no payload packet is held by pacer.
+ */
+long int pacing_delay_in_OPEN_CLOSEREQ_state(struct vContext *C)
+{
+	struct VDgramConn *vconn = CTX_current_dgram_conn(C);
+	struct VSession *vsession = CTX_current_session(C);
+	struct timeval tv;
+	uint32 delay;
+
+	if(vconn->cc.pacing == 0 ||
+			v_out_queue_get_count(vsession->out_queue) == 0 ||
+			v_cc_can_send(vconn) == 0) {
+		return -1;
+	}
+
+	gettimeofday(&tv, NULL);
+
+	/* When pacer does not hold any packet, then all packets allowed by
+	 * windows were already sent */
+	if((delay = v_cc_pacing_delay(vconn, &tv)) == 0) {
+		return -1;
+	}
+
+	return (long int)delay;
+}
+
 /**
  * \brief This function returns RTT of received packet in microseconds.
  */
@@ -560,6 +684,25 @@ static unsigned long int packet_rtt(struct VSent_Packet *sent_packet,
 	return rtt;
 }
 
+/**
+ * \brief This function removes acknowledged packet from history of sent
+ * packets and it notifies congestion control about delivered packet.
+ */
+static void ack_packet(struct vContext *C,
+		uint32 id,
+		struct timeval *tv)
+{
+	struct VDgramConn *vconn = CTX_current_dgram_conn(C);
+	struct VSent_Packet *sent_packet;
+
+	sent_packet = v_packet_history_find_packet(&vconn->packet_history, id);
+	if(sent_packet != NULL) {
+		v_pmtud_packet_acked(vconn, sent_packet, tv);
+		v_cc_packet_acked(vconn, sent_packet, tv);
+		v_packet_history_rem_packet(C, id);
+	}
+}
+
 /**
  * \brief This function is called, when acknowledgment packet was received.
  *
@@ -581,22 +724,29 @@ static int handle_ack_nak_commands(struct vContext *C)
 	struct VDgramConn *vconn = CTX_current_dgram_conn(C);
 	struct VPacket *r_packet = CTX_r_packet(C);
 	struct VSent_Packet *sent_packet;
-	struct VSent_Command *sent_cmd, *sent_cmd_prev;
+	struct VSent_Command *sent_cmd;
 	unsigned long int rtt = ULONG_MAX;
 	struct timeval tv;
 	uint32 ack_id, nak_id;
+	uint16 j;
 	int i, ret=-1;
 
 	gettimeofday(&tv, NULL);
 
 	/* Compute SRTT */
-	if(r_packet->sys_cmd[0].cmd.id==CMD_ACK_ID) {
+	if(r_packet->sys_cmd[0].cmd.id==CMD_ACK_ID ||
+			r_packet->sys_cmd[0].cmd.id==CMD_NAK_ID) {
 		unsigned long int tmp;
 		int i=0;
 
 		/* Try to find the smallest RTT from acknowledged packets */
 		for(i=0; r_packet->sys_cmd[i].cmd.id!=CMD_RESERVED_ID; i++) {
 			if(r_packet->sys_cmd[i].cmd.id==CMD_ACK_ID) {
+				/* Karn's rule: packets sent before expiration of
+				 * retransmission timer are not used for RTT samples */
+				if(v_rto_sample_valid(vconn, r_packet->sys_cmd[i].ack_cmd.pay_id) == 0) {
+					continue;
+				}
 				sent_packet = v_packet_history_find_packet(&vconn->packet_history,
 					r_packet->sys_cmd[i].ack_cmd.pay_id);
 				if(sent_packet!=NULL) {
@@ -607,14 +757,12 @@ static int handle_ack_nak_commands(struct vContext *C)
 		}
 
 		if(rtt<ULONG_MAX) {
-			/* Computation of SRTT as described in RFC */
-			if(vconn->srtt==0) {
-				vconn->srtt = rtt;
-			} else {
-				vconn->srtt = RTT_ALPHA*vconn->srtt + (1-RTT_ALPHA)*rtt;
-			}
-			v_print_log(VRS_PRINT_DEBUG_MSG, "RTT: %d [us]\n", rtt);
-			v_print_log(VRS_PRINT_DEBUG_MSG, "SRTT: %d [us]\n", vconn->srtt);
+			/* Computation of SRTT, RTTVAR and RTO as described in RFC */
+			v_rto_update(vconn, rtt);
+			v_cc_rtt_sample(vconn, rtt, &tv);
+			v_print_log(VRS_PRINT_DEBUG_MSG, "RTT: %lu [us]\n", rtt);
+			v_print_log(VRS_PRINT_DEBUG_MSG, "SRTT: %u, RTTVAR: %u, RTO: %u [us]\n",
+					vconn->srtt, vconn->rttvar, vconn->rto);
 		}
 	}
 
@@ -647,12 +795,12 @@ static int handle_ack_nak_commands(struct vContext *C)
 						ack_id < r_packet->sys_cmd[i+1].nak_cmd.pay_id;
 						ack_id++)
 				{
-					v_packet_history_rem_packet(C, ack_id);
+					ack_packet(C, ack_id, &tv);
 				}
 			} else {
 				/* Remove this acknowledged payload packets from the history
 				 * of sent payload packets */
-				v_packet_history_rem_packet(C, r_packet->sys_cmd[i].ack_cmd.pay_id);
+				ack_packet(C, r_packet->sys_cmd[i].ack_cmd.pay_id, &tv);
 				/* This is the last ACK command in the sequence of ACK/NAK
 				 * commands. Update ANK ID. */
 				vconn->ank_id = r_packet->sys_cmd[i].ack_cmd.pay_id;
@@ -675,12 +823,16 @@ static int handle_ack_nak_commands(struct vContext *C)
 				sent_packet = v_packet_history_find_packet(&vconn->packet_history, nak_id);
 				if(sent_packet != NULL) {
 					v_print_log(VRS_PRINT_DEBUG_MSG, "Try to re-send packet: %d\n", nak_id);
-					sent_cmd = sent_packet->cmds.last;
-
-					/* Go through all commands in command list and add not
-					 * obsolete commands to the outgoing queue */
-					while(sent_cmd != NULL) {
-						sent_cmd_prev = sent_cmd->prev;
+					/* Lost packet is signal of congestion, but lost probe
+					 * of PMTU discovery is not */
+					if(v_pmtud_packet_lost(vconn, sent_packet, &tv) == 0) {
+						v_cc_packet_lost(vconn, sent_packet, &tv);
+					}
+					/* Go through all commands in command array from the last
+					 * one and add not obsolete commands to the head of
+					 * outgoing queue */
+					for(j = sent_packet->cmd_count; j > 0; j--) {
+						sent_cmd = sent_packet->cmds[j - 1];
 						if(sent_cmd->vbucket != NULL && sent_cmd->vbucket->data != NULL) {
 
 							/* Try to add command back to the outgoing command queue */
@@ -689,15 +841,13 @@ static int handle_ack_nak_commands(struct vContext *C)
 									(struct Generic_Cmd*)sent_cmd->vbucket->data) == 1)
 							{
 								/* Remove bucket from the history of sent commands too */
-								v_hash_array_remove_item(&vconn->packet_history.cmd_hist[sent_cmd->id]->cmds, sent_cmd->vbucket->data);
+								v_hash_array_remove_bucket(&vconn->packet_history.cmd_hist[sent_cmd->id]->cmds, sent_cmd->vbucket);
 
 								/* When command was added back to the queue,
-								 * then delete only sent command */
-								v_list_free_item(&sent_packet->cmds, sent_cmd);
-
+								 * then forget only sent command */
+								sent_cmd->vbucket = NULL;
 							}
 						}
-						sent_cmd = sent_cmd_prev;
 					}
 
 					/* When all not obsolete commands are added to outgoing
@@ -728,19 +878,14 @@ static int handle_node_commands(struct vContext *C)
 	struct VSession *vsession = CTX_current_session(C);
 	struct VDgramConn *vconn = CTX_current_dgram_conn(C);
 	struct VPacket *r_packet = CTX_r_packet(C);
-	struct Ack_Nak_Cmd ack_nak_cmd;
 
-	/* Note: when ACK and NAK command are add to the AckNak history,
-	 * then this vector of commands is automatically compressed. */
+	/* Note: lost packets are not added to the AckNak history. NAK commands
+	 * are generated from gaps between ranges of received packets. */
 
 	/* Was any packet lost since last receiving of packet? */
 	if(r_packet->header.payload_id > vconn->last_r_pay+1) {
 		v_print_log(VRS_PRINT_DEBUG_MSG, "Packet(s) lost: %d - %d\n",
 				vconn->last_r_pay+1, r_packet->header.payload_id-1);
-		/* Add NAK command to the list of ACK NAK commands */
-		ack_nak_cmd.id = CMD_NAK_ID;
-		ack_nak_cmd.pay_id = vconn->last_r_pay+1;
-		v_ack_nak_history_add_cmd(&vconn->ack_nak, &ack_nak_cmd);
 	/* Was some delayed packet received? */
 	} else if(r_packet->header.payload_id < vconn->last_r_pay+1) {
 		if(is_log_level(VRS_PRINT_WARNING))
@@ -749,10 +894,8 @@ static int handle_node_commands(struct vContext *C)
 		return RECEIVE_PACKET_UNORDERED;
 	}
 
-	/* ADD ACK command to the list of ACK NAK commands */
-	ack_nak_cmd.id = CMD_ACK_ID;
-	ack_nak_cmd.pay_id = r_packet->header.payload_id;
-	v_ack_nak_history_add_cmd(&vconn->ack_nak, &ack_nak_cmd);
+	/* Add ID of received packet to the history of ACK NAK commands */
+	v_ack_nak_history_add_id(&vconn->ack_nak, r_packet->header.payload_id);
 
 	/* Check if there are really node commands */
 	if(r_packet->data!=NULL) {
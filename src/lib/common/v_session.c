@@ -36,6 +36,79 @@
 #include <stdlib.h>
 
 #include "v_session.h"
+#include "v_atomic.h"
+
+/**
+ * \brief This function initializes empty list of ready sessions
+ */
+void v_session_ready_init(struct VSessionReadyList *ready_list)
+{
+	ready_list->first = NULL;
+}
+
+/**
+ * \brief This function adds session to the list of sessions with received
+ * commands. It could be called by several threads at once. Session is
+ * added only once, until consumer of the list calls v_session_ready_done().
+ *
+ * \return This function returns 1, when session was added to the list and
+ * consumer should be notified. It returns 0, when session is already in
+ * the list.
+ */
+int v_session_ready_push(struct VSessionReadyList *ready_list,
+		struct VSession *vsession)
+{
+	struct VSession *first;
+
+	if(V_ATOMIC_CAS(&vsession->ready, 0, 1) == 0) {
+		return 0;
+	}
+
+	do {
+		first = ready_list->first;
+		vsession->ready_next = first;
+	} while(V_ATOMIC_CAS_PTR(&ready_list->first, first, vsession) == 0);
+
+	return 1;
+}
+
+/**
+ * \brief This function takes all sessions from the list of ready sessions.
+ * Sessions are returned in order, in which they were added to the list
+ * and they are linked with ready_next pointer.
+ */
+struct VSession *v_session_ready_pop_all(struct VSessionReadyList *ready_list)
+{
+	struct VSession *first, *next, *prev = NULL;
+
+	do {
+		first = ready_list->first;
+		if(first == NULL) {
+			return NULL;
+		}
+	} while(V_ATOMIC_CAS_PTR(&ready_list->first, first, NULL) == 0);
+
+	/* Reverse list to get sessions in FIFO order */
+	while(first != NULL) {
+		next = first->ready_next;
+		first->ready_next = prev;
+		prev = first;
+		first = next;
+	}
+
+	return prev;
+}
+
+/**
+ * \brief This function has to be called by consumer of the list, before it
+ * starts handling of commands received by session. Session could be added
+ * to the list again, when new command is received.
+ */
+void v_session_ready_done(struct VSession *vsession)
+{
+	vsession->ready = 0;
+	V_BARRIER();
+}
 
 void v_init_session(struct VSession *vsession)
 {
@@ -48,6 +121,8 @@ void v_init_session(struct VSession *vsession)
 	vsession->tcp_thread = 0;
 	vsession->udp_thread = 0;
 #endif
+	vsession->io_handle = NULL;
+	vsession->stream_handle = NULL;
 	vsession->peer_hostname = NULL;
 	vsession->service = NULL;
 	vsession->session_id = 0;
@@ -72,6 +147,9 @@ void v_init_session(struct VSession *vsession)
 	vsession->tmp_flags = 0;
 	vsession->client_name = NULL;
 	vsession->client_version = NULL;
+	vsession->ready_next = NULL;
+	vsession->ready = 0;
+	vsession->data_cmds = 0;
 }
 
 void v_destroy_session(struct VSession *vsession)
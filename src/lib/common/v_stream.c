@@ -132,11 +132,10 @@ int v_STREAM_pack_message(struct vContext *C)
 	struct IO_CTX *io_ctx = CTX_io_ctx(C);
 	struct VMessage *s_message = CTX_s_message(C);
 	struct Generic_Cmd *cmd;
-	int ret = -1, queue_size = 0, buffer_pos = 0, prio_cmd_count, cmd_rank=0;
-	int8 cmd_share;
-	int16 prio, max_prio, min_prio;
-	uint16 cmd_count, cmd_len, prio_win, swin, sent_size, tot_cmd_size;
-	real32 prio_sum_high, prio_sum_low, r_prio;
+	int ret = -1, queue_size = 0, buffer_pos = 0, prio_cmd_count, popped, cmd_rank=0;
+	uint8 prio;
+	uint16 cmd_len, prio_win, swin, sent_size, tot_cmd_size;
+	uint32 deficit;
 
 	/* Is here something to send? */
 	if((v_out_queue_get_count(vsession->out_queue) > 0) ||
@@ -174,73 +173,68 @@ int v_STREAM_pack_message(struct vContext *C)
 
 		buffer_pos += v_pack_stream_system_commands(s_message, &io_ctx->buf[buffer_pos]);
 
-		max_prio = v_out_queue_get_max_prio(vsession->out_queue);
-		min_prio = v_out_queue_get_min_prio(vsession->out_queue);
-
-		prio_sum_high = v_out_queue_get_prio_sum_high(vsession->out_queue);
-		prio_sum_low = v_out_queue_get_prio_sum_low(vsession->out_queue);
-
 		v_print_log(VRS_PRINT_DEBUG_MSG, "Packing prio queues, cmd count: %d\n",
 				v_out_queue_get_count(vsession->out_queue));
 
-		/* Go through all priorities and pick commands from priority queues */
-		for(prio = max_prio; prio >= min_prio; prio--)
+		/* Pick commands from not empty priority queues in order given by
+		 * deficit round robin scheduler */
+		while(swin > buffer_pos &&
+				v_out_queue_drr_next(vsession->out_queue, &prio, &deficit) == 1)
 		{
 			prio_cmd_count = v_out_queue_get_count_prio(vsession->out_queue, prio);
 
-			if(prio_cmd_count > 0) {
-
-				r_prio = v_out_queue_get_prio(vsession->out_queue, prio);
+			/* Size of buffer that could be occupied by commands from this
+			 * queue is limited by its deficit and by free space in TCP buffer */
+			prio_win = (deficit < (uint32)(swin - buffer_pos)) ? (uint16)deficit : (uint16)(swin - buffer_pos);
+
+			/* Debug print */
+			v_print_log(VRS_PRINT_DEBUG_MSG, "Queue: %d, count: %d, deficit: %d, prio_win: %d\n",
+					prio, prio_cmd_count, deficit, prio_win);
+
+			/* Get total size of commands that were stored in queue (sent_size) */
+			sent_size = 0;
+			tot_cmd_size = 0;
+			popped = 0;
+
+			while(prio_cmd_count > 0 && sent_size < prio_win) {
+				cmd_len = prio_win - sent_size;
+
+				/* Pack commands from queues with high priority to the buffer.
+				 * Commands are not compressed, when TCP is used. */
+				cmd = v_out_queue_pop(vsession->out_queue, prio, NULL, NULL, &cmd_len);
+				if(cmd != NULL) {
+
+					/* Is this command fake command? */
+					if(cmd->id < MIN_CMD_ID) {
+						if(cmd->id == FAKE_CMD_CONNECT_TERMINATE) {
+							/* TODO */
+						} else if(cmd->id == FAKE_CMD_FPS) {
+							struct Fps_Cmd *fps_cmd = (struct Fps_Cmd*)cmd;
+							/* Change value of FPS. It will be sent in negotiate command
+							 * until it is confirmed be the peer (server) */
+							vsession->fps_host = fps_cmd->fps;
+						}
+					} else {
+						buffer_pos += tot_cmd_size = v_cmd_pack(&io_ctx->buf[buffer_pos], cmd, v_cmd_size(cmd), 0);
+						v_cmd_print(VRS_PRINT_DEBUG_MSG, cmd);
+						sent_size += tot_cmd_size;
+					}
 
-				/* Compute size of buffer that could be occupied by
-				 * commands from this queue */
-				if(prio >= VRS_DEFAULT_PRIORITY) {
-					prio_win = ((swin - buffer_pos)*r_prio)/prio_sum_high;
+					/* It is not neccessary to put cmd to history of sent commands,
+					 * when TCP is used. */
+					v_cmd_destroy(&cmd);
+					prio_cmd_count--;
+					popped++;
 				} else {
-					prio_win = ((swin - buffer_pos)*r_prio)/prio_sum_low;
+					break;
 				}
+			}
 
-				/* Debug print */
-				v_print_log(VRS_PRINT_DEBUG_MSG, "Queue: %d, count: %d, r_prio: %6.3f, prio_win: %d\n",
-						prio, prio_cmd_count, r_prio, prio_win);
-
-				/* Get total size of commands that were stored in queue (sent_size) */
-				sent_size = 0;
-				tot_cmd_size = 0;
-
-				while(prio_cmd_count > 0) {
-					cmd_share = 0;
-					cmd_count = 0;
-					cmd_len = prio_win - sent_size;
-
-					/* Pack commands from queues with high priority to the buffer */
-					cmd = v_out_queue_pop(vsession->out_queue, prio, &cmd_count, &cmd_share, &cmd_len);
-					if(cmd != NULL) {
-
-						/* Is this command fake command? */
-						if(cmd->id < MIN_CMD_ID) {
-							if(cmd->id == FAKE_CMD_CONNECT_TERMINATE) {
-								/* TODO */
-							} else if(cmd->id == FAKE_CMD_FPS) {
-								struct Fps_Cmd *fps_cmd = (struct Fps_Cmd*)cmd;
-								/* Change value of FPS. It will be sent in negotiate command
-								 * until it is confirmed be the peer (server) */
-								vsession->fps_host = fps_cmd->fps;
-							}
-						} else {
-							buffer_pos += tot_cmd_size = v_cmd_pack(&io_ctx->buf[buffer_pos], cmd, v_cmd_size(cmd), 0);
-							v_cmd_print(VRS_PRINT_DEBUG_MSG, cmd);
-							sent_size += tot_cmd_size;
-						}
+			v_out_queue_drr_charge(vsession->out_queue, prio, sent_size);
 
-						/* It is not neccessary to put cmd to history of sent commands,
-						 * when TCP is used. */
-						v_cmd_destroy(&cmd);
-						prio_cmd_count--;
-					} else {
-						break;
-					}
-				}
+			/* The first command of this queue does not fit to the buffer */
+			if(popped == 0) {
+				break;
 			}
 		}
 
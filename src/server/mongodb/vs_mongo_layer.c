@@ -45,8 +45,8 @@ static void vs_mongo_layer_save_version(struct VSLayer *layer,
 		uint32 version)
 {
 	bson bson_version;
-	VSLayerValue *layer_value;
-	VBucket *bucket;
+	uint32 slot, item_id;
+	void *value;
 	char str_num[15];
 	int data_id;
 
@@ -55,34 +55,33 @@ static void vs_mongo_layer_save_version(struct VSLayer *layer,
 	bson_append_int(&bson_version, "crc32", layer->crc32);
 
 	bson_append_start_object(&bson_version, "values");
-	bucket = layer->values.lb.first;
-	while(bucket != NULL) {
-		layer_value = (struct VSLayerValue*)bucket->data;
-		sprintf(str_num, "%d", layer_value->id);
+	slot = 0;
+	while(vs_layer_values_next(&layer->values, &slot, &item_id, &value) == 1) {
+		sprintf(str_num, "%u", item_id);
 		bson_append_start_array(&bson_version, str_num);
 		switch(layer->data_type) {
 		case VRS_VALUE_TYPE_UINT8:
 			for(data_id = 0; data_id < layer->num_vec_comp; data_id++) {
 				sprintf(str_num, "%d", data_id);
-				bson_append_int(&bson_version, str_num, ((uint8*)layer_value->value)[data_id]);
+				bson_append_int(&bson_version, str_num, ((uint8*)value)[data_id]);
 			}
 			break;
 		case VRS_VALUE_TYPE_UINT16:
 			for(data_id = 0; data_id < layer->num_vec_comp; data_id++) {
 				sprintf(str_num, "%d", data_id);
-				bson_append_int(&bson_version, str_num, ((uint16*)layer_value->value)[data_id]);
+				bson_append_int(&bson_version, str_num, ((uint16*)value)[data_id]);
 			}
 			break;
 		case VRS_VALUE_TYPE_UINT32:
 			for(data_id = 0; data_id < layer->num_vec_comp; data_id++) {
 				sprintf(str_num, "%d", data_id);
-				bson_append_int(&bson_version, str_num, ((uint32*)layer_value->value)[data_id]);
+				bson_append_int(&bson_version, str_num, ((uint32*)value)[data_id]);
 			}
 			break;
 		case VRS_VALUE_TYPE_UINT64:
 			for(data_id = 0; data_id < layer->num_vec_comp; data_id++) {
 				sprintf(str_num, "%d", data_id);
-				bson_append_int(&bson_version, str_num, ((uint64*)layer_value->value)[data_id]);
+				bson_append_int(&bson_version, str_num, ((uint64*)value)[data_id]);
 			}
 			break;
 		case VRS_VALUE_TYPE_REAL16:
@@ -91,19 +90,17 @@ static void vs_mongo_layer_save_version(struct VSLayer *layer,
 		case VRS_VALUE_TYPE_REAL32:
 			for(data_id = 0; data_id < layer->num_vec_comp; data_id++) {
 				sprintf(str_num, "%d", data_id);
-				bson_append_double(&bson_version, str_num, ((float*)layer_value->value)[data_id]);
+				bson_append_double(&bson_version, str_num, ((float*)value)[data_id]);
 			}
 			break;
 		case VRS_VALUE_TYPE_REAL64:
 			for(data_id = 0; data_id < layer->num_vec_comp; data_id++) {
 				sprintf(str_num, "%d", data_id);
-				bson_append_double(&bson_version, str_num, ((double*)layer_value->value)[data_id]);
+				bson_append_double(&bson_version, str_num, ((double*)value)[data_id]);
 			}
 			break;
 		}
 		bson_append_finish_array(&bson_version);
-
-		bucket = bucket->next;
 	}
 	bson_append_finish_object(&bson_version);
 
@@ -261,7 +258,7 @@ static void vs_mongo_layer_load_data(struct VSNode *node,
 
 	/* Try to get values of layer */
 	if( bson_find(&version_data_iter, bson_version, "values") == BSON_OBJECT ) {
-		struct VSLayerValue *item;
+		uint8 *item_value;
 		bson_iterator items_iter, values_iter;
 		const char *key;
 		uint8 val_uint8;
@@ -282,9 +279,7 @@ static void vs_mongo_layer_load_data(struct VSNode *node,
 
 			bson_iterator_subiterator(&items_iter, &values_iter);
 
-			item = (struct VSLayerValue*)calloc(1, sizeof(struct VSLayerValue));
-			item->id = item_id;
-			item->value = (void*)calloc(layer->num_vec_comp, item_data_size);
+			item_value = (uint8*)calloc(layer->num_vec_comp, item_data_size);
 
 			value_id = 0;
 
@@ -294,27 +289,27 @@ static void vs_mongo_layer_load_data(struct VSNode *node,
 				switch(layer->data_type) {
 				case VRS_VALUE_TYPE_UINT8:
 					val_uint8 = (uint8)bson_iterator_int(&values_iter);
-					((uint8*)item->value)[value_id] = val_uint8;
+					((uint8*)item_value)[value_id] = val_uint8;
 					break;
 				case VRS_VALUE_TYPE_UINT16:
 					val_uint16 = (uint16)bson_iterator_int(&values_iter);
-					((uint16*)item->value)[value_id] = val_uint16;
+					((uint16*)item_value)[value_id] = val_uint16;
 					break;
 				case VRS_VALUE_TYPE_UINT32:
 					val_uint32 = (uint32)bson_iterator_int(&values_iter);
-					((uint32*)item->value)[value_id] = val_uint32;
+					((uint32*)item_value)[value_id] = val_uint32;
 					break;
 				case VRS_VALUE_TYPE_UINT64:
 					val_uint64 = (uint64)bson_iterator_long(&values_iter);
-					((uint64*)item->value)[value_id] = val_uint64;
+					((uint64*)item_value)[value_id] = val_uint64;
 					break;
 				case VRS_VALUE_TYPE_REAL32:
 					val_real32 = (real32)bson_iterator_double(&values_iter);
-					((real32*)item->value)[value_id] = val_real32;
+					((real32*)item_value)[value_id] = val_real32;
 					break;
 				case VRS_VALUE_TYPE_REAL64:
 					val_real64 = (real64)bson_iterator_double(&values_iter);
-					((real64*)item->value)[value_id] = val_real64;
+					((real64*)item_value)[value_id] = val_real64;
 					break;
 				default:
 					break;
@@ -322,7 +317,8 @@ static void vs_mongo_layer_load_data(struct VSNode *node,
 				value_id++;
 			}
 
-			v_hash_array_add_item(&layer->values, item, sizeof(struct VSLayerValue));
+			vs_layer_values_set(&layer->values, item_id, item_value);
+			free(item_value);
 		}
 	}
 }
@@ -29,6 +29,7 @@
 #include <stdint.h>
 
 #include "vs_main.h"
+#include "vs_reactor.h"
 #include "v_common.h"
 
 /**
@@ -49,6 +50,7 @@ void vs_read_config_file(struct VS_CTX *vs_ctx, const char *ini_file_name)
 		char *ca_certificate_file_name;
 		char *private_key;
 		char *fc_type;
+		char *cc_type;
 #ifdef WITH_MONGODB
 		char *mongodb_server_hostname;
 		int mongodb_server_port;
@@ -58,12 +60,20 @@ void vs_read_config_file(struct VS_CTX *vs_ctx, const char *ini_file_name)
 #endif
 		int fc_win_scale;
 		int in_queue_max_size;
+		int in_queue_cmd_views;
 		int out_queue_max_size;
 		int tcp_port_number;
 		int ws_port_number;
 		int udp_low_port_number;
 		int udp_high_port_number;
 		int max_session_count;
+		int data_thread_count;
+		int reactor;
+		int io_thread_count;
+		int shared_port;
+		int dgram_batch;
+		int dgram_offload;
+		int cc_pacing;
 
 		v_print_log(VRS_PRINT_DEBUG_MSG, "Reading config file: %s\n",
 				ini_file_name);
@@ -129,6 +139,69 @@ void vs_read_config_file(struct VS_CTX *vs_ctx, const char *ini_file_name)
 			vs_ctx->max_sessions = max_session_count;
 		}
 
+		/* Number of threads handling received node commands */
+		data_thread_count = iniparser_getint(ini_dict, "Global:DataThreads", -1);
+		if(data_thread_count != -1) {
+			if(data_thread_count >= 0 && data_thread_count <= MAX_DATA_WORKERS) {
+				v_print_log(VRS_PRINT_DEBUG_MSG,
+						"data worker threads: %d\n", data_thread_count);
+				vs_ctx->data.worker_count = data_thread_count;
+			} else {
+				v_print_log(VRS_PRINT_WARNING, "DataThreads: %d out of range: 0-%d\n",
+						data_thread_count, MAX_DATA_WORKERS);
+			}
+		}
+
+		/* Stream and datagram connections could be handled by pool of I/O threads */
+		reactor = iniparser_getint(ini_dict, "Global:Reactor", -1);
+		if(reactor == 0 || reactor == 1) {
+			v_print_log(VRS_PRINT_DEBUG_MSG, "reactor: %d\n", reactor);
+			vs_ctx->reactor = reactor;
+		}
+
+		io_thread_count = iniparser_getint(ini_dict, "Global:IOThreads", -1);
+		if(io_thread_count != -1) {
+			if(io_thread_count >= 0 && io_thread_count <= MAX_IO_THREADS) {
+				v_print_log(VRS_PRINT_DEBUG_MSG,
+						"I/O threads: %d\n", io_thread_count);
+				vs_ctx->io_thread_count = io_thread_count;
+			} else {
+				v_print_log(VRS_PRINT_WARNING, "IOThreads: %d out of range: 0-%d\n",
+						io_thread_count, MAX_IO_THREADS);
+			}
+		}
+
+		/* All unsecured datagram connections could use one UDP port */
+		shared_port = iniparser_getint(ini_dict, "Global:SharedUDPPort", -1);
+		if(shared_port != -1) {
+			if(shared_port >= 1024 && shared_port <= 65535) {
+				v_print_log(VRS_PRINT_DEBUG_MSG, "shared UDP port: %d\n", shared_port);
+				vs_ctx->shared_port = shared_port;
+			} else {
+				v_print_log(VRS_PRINT_WARNING, "SharedUDPPort: %d out of range: 1024-65535\n",
+						shared_port);
+			}
+		}
+
+		/* Number of packets sent or received with one system call */
+		dgram_batch = iniparser_getint(ini_dict, "Global:DgramBatch", -1);
+		if(dgram_batch != -1) {
+			if(dgram_batch >= 1 && dgram_batch <= MAX_DGRAM_BATCH) {
+				v_print_log(VRS_PRINT_DEBUG_MSG, "datagram batch: %d\n", dgram_batch);
+				vs_ctx->dgram_batch = dgram_batch;
+			} else {
+				v_print_log(VRS_PRINT_WARNING, "DgramBatch: %d out of range: 1-%d\n",
+						dgram_batch, MAX_DGRAM_BATCH);
+			}
+		}
+
+		/* Send packets of batch in super-buffers segmented by kernel */
+		dgram_offload = iniparser_getint(ini_dict, "Global:DgramOffload", -1);
+		if(dgram_offload == 0 || dgram_offload == 1) {
+			v_print_log(VRS_PRINT_DEBUG_MSG, "datagram offload: %d\n", dgram_offload);
+			vs_ctx->dgram_offload = dgram_offload;
+		}
+
 		/* Try to load section [Users] */
 		user_auth_method = iniparser_getstring(ini_dict, "Users:Method", NULL);
 		if(user_auth_method != NULL &&
@@ -196,6 +269,33 @@ void vs_read_config_file(struct VS_CTX *vs_ctx, const char *ini_file_name)
 			}
 		}
 
+		/* Allowed type of Congestion Control. Clients without Congestion
+		 * Control are accepted always. */
+		cc_type = iniparser_getstring(ini_dict, "CongestionControl:Type", NULL);
+		if(cc_type != NULL) {
+			if(strcmp(cc_type, "any")==0) {
+				vs_ctx->cc_meth = CC_MASK(CC_NONE) | CC_MASK(CC_TCP_LIKE) |
+						CC_MASK(CC_CUBIC) | CC_MASK(CC_BBR);
+			} else if(strcmp(cc_type, "cubic")==0) {
+				vs_ctx->cc_meth = CC_MASK(CC_NONE) | CC_MASK(CC_TCP_LIKE) |
+						CC_MASK(CC_CUBIC);
+			} else if(strcmp(cc_type, "bbr")==0) {
+				vs_ctx->cc_meth = CC_MASK(CC_NONE) | CC_MASK(CC_BBR);
+			} else if(strcmp(cc_type, "none")==0) {
+				vs_ctx->cc_meth = CC_MASK(CC_NONE);
+			}
+			v_print_log(VRS_PRINT_DEBUG_MSG,
+					"congestion_control type: %s\n", cc_type);
+		}
+
+		/* Pacing of payload packets */
+		cc_pacing = iniparser_getint(ini_dict, "CongestionControl:Pacing", -1);
+		if(cc_pacing == 0 || cc_pacing == 1) {
+			v_print_log(VRS_PRINT_DEBUG_MSG,
+					"congestion_control pacing: %d\n", cc_pacing);
+			vs_ctx->dgram_pacing = cc_pacing;
+		}
+
 		/* Scale of Flow Control window */
 		fc_win_scale = iniparser_getint(ini_dict, "FlowControl:WinScale", -1);
 		if(fc_win_scale != -1) {
@@ -216,6 +316,14 @@ void vs_read_config_file(struct VS_CTX *vs_ctx, const char *ini_file_name)
 			}
 		}
 
+		/* Received commands stored as views of received buffer */
+		in_queue_cmd_views = iniparser_getint(ini_dict, "InQueue:CmdViews", -1);
+		if(in_queue_cmd_views == 0 || in_queue_cmd_views == 1) {
+			v_print_log(VRS_PRINT_DEBUG_MSG,
+					"in_queue cmd views: %d\n", in_queue_cmd_views);
+			vs_ctx->in_queue_cmd_views = in_queue_cmd_views;
+		}
+
 		/* Maximal size of outgoing queue */
 		out_queue_max_size = iniparser_getint(ini_dict, "OutQueue:MaxSize", -1);
 		if(out_queue_max_size != -1) {
@@ -22,6 +22,8 @@
  *
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <time.h>
@@ -45,6 +47,7 @@
 #include "v_context.h"
 #include "v_list.h"
 #include "v_fake_commands.h"
+#include "v_pool.h"
 
 /**
  * \brief This function handle all received node commands
@@ -56,7 +59,6 @@ static void vs_handle_node_cmd(struct VS_CTX *vs_ctx,
 		struct VSession *vsession,
 		struct Generic_Cmd *cmd)
 {
-	pthread_mutex_lock(&vs_ctx->data.mutex);
 	switch(cmd->id) {
 		case CMD_NODE_CREATE:
 			vs_handle_node_create(vs_ctx, vsession, cmd);
@@ -272,7 +274,392 @@ static void vs_handle_node_cmd(struct VS_CTX *vs_ctx,
 			v_print_log(VRS_PRINT_WARNING, "Yet unimplemented command id: %d\n", cmd->id);
 			break;
 	}
-	pthread_mutex_unlock(&vs_ctx->data.mutex);
+}
+
+/**
+ * \brief This function returns 1, when session is in OPEN state and data
+ * thread can handle commands received from this session.
+ */
+static int vs_data_session_is_open(struct VSession *vsession)
+{
+	return (vsession->dgram_conn->host_state == UDP_SERVER_STATE_OPEN ||
+			vsession->stream_conn->host_state == TCP_SERVER_STATE_STREAM_OPEN);
+}
+
+/**
+ * \brief This function gets ID of node, when the command changes only data
+ * of this node (tag groups, tags and layers) and it could be handled by data
+ * worker thread concurrently with commands of other nodes.
+ *
+ * \param[in]	*cmd		The pointer at received command
+ * \param[out]	*node_id	The ID of node changed by command
+ *
+ * \return This function returns 1, when command changes only one node.
+ * Commands changing node tree, subscription, permissions, etc. returns 0.
+ */
+static int vs_data_cmd_node_id(const struct Generic_Cmd *cmd, uint32 *node_id)
+{
+	switch(cmd->id) {
+		case FAKE_CMD_TAGGROUP_CREATE_ACK:
+		case FAKE_CMD_TAGGROUP_DESTROY_ACK:
+			*node_id = ((struct TagGroup_Create_Ack_Cmd*)cmd)->node_id;
+			return 1;
+		case FAKE_CMD_TAG_CREATE_ACK:
+		case FAKE_CMD_TAG_DESTROY_ACK:
+			*node_id = ((struct Tag_Create_Ack_Cmd*)cmd)->node_id;
+			return 1;
+		case FAKE_CMD_LAYER_CREATE_ACK:
+		case FAKE_CMD_LAYER_DESTROY_ACK:
+			*node_id = ((struct Layer_Create_Ack_Cmd*)cmd)->node_id;
+			return 1;
+		default:
+			/* All tag group, tag and layer commands has ID of node as
+			 * first item */
+			if(cmd->id >= CMD_TAGGROUP_CREATE && cmd->id <= CMD_LAYER_SET_VEC4_REAL64) {
+				*node_id = UINT32(cmd->data[0]);
+				return 1;
+			}
+			break;
+	}
+
+	return 0;
+}
+
+/**
+ * \brief This function is called, when commands of the session dispatched to
+ * data workers were handled or dropped. It wakes up threads waiting for idle
+ * workers or for commands of this session.
+ */
+static void vs_data_cmds_done(struct VS_CTX *vs_ctx,
+		struct VSession *vsession,
+		uint32 count)
+{
+	pthread_mutex_lock(&vs_ctx->data.workers_mutex);
+	vs_ctx->data.pending_cmds -= count;
+	vsession->data_cmds -= count;
+	if(vs_ctx->data.pending_cmds == 0 || vsession->data_cmds == 0) {
+		pthread_cond_broadcast(&vs_ctx->data.workers_idle);
+	}
+	pthread_mutex_unlock(&vs_ctx->data.workers_mutex);
+}
+
+/**
+ * \brief This function is function of data worker thread. It handles commands
+ * of nodes assigned to this worker. Commands of one node are handled in the
+ * same order as they were received.
+ */
+static void *vs_data_worker_loop(void *arg)
+{
+	struct VSDataWorker *worker = (struct VSDataWorker*)arg;
+	struct VS_CTX *vs_ctx = worker->vs_ctx;
+	struct VSDataCmd *data_cmd, *next;
+	struct VSession *vsession;
+	uint32 count;
+
+	while(1) {
+		/* Take all commands from queue of this worker */
+		pthread_mutex_lock(&worker->mutex);
+		while(worker->first == NULL && worker->stop == 0) {
+			pthread_cond_wait(&worker->cond, &worker->mutex);
+		}
+		data_cmd = worker->first;
+		worker->first = worker->last = NULL;
+		pthread_mutex_unlock(&worker->mutex);
+
+		if(data_cmd == NULL) {
+			break;
+		}
+
+		/* Commands of other nodes could be handled by other workers, but
+		 * node tree can not be changed now */
+		count = 0;
+		vsession = data_cmd->vsession;
+		pthread_rwlock_rdlock(&vs_ctx->data.lock);
+		while(data_cmd != NULL) {
+			next = data_cmd->next;
+			/* Session could be closed, when command was waiting in queue */
+			if(vs_data_session_is_open(data_cmd->vsession)) {
+				vs_handle_node_cmd(vs_ctx, data_cmd->vsession, data_cmd->cmd);
+			}
+			v_cmd_destroy(&data_cmd->cmd);
+			v_pool_free(data_cmd, sizeof(struct VSDataCmd));
+			count++;
+			/* Following commands are mostly from the same session. Closing
+			 * session is notified, when its commands were handled. */
+			if(next == NULL || next->vsession != vsession) {
+				vs_data_cmds_done(vs_ctx, vsession, count);
+				if(next != NULL) {
+					vsession = next->vsession;
+				}
+				count = 0;
+			}
+			data_cmd = next;
+		}
+		pthread_rwlock_unlock(&vs_ctx->data.lock);
+	}
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Exiting data worker thread\n");
+
+	return NULL;
+}
+
+/**
+ * \brief This function waits until all commands dispatched to data workers
+ * are handled.
+ */
+static void vs_data_workers_wait(struct VS_CTX *vs_ctx)
+{
+	pthread_mutex_lock(&vs_ctx->data.workers_mutex);
+	while(vs_ctx->data.pending_cmds > 0) {
+		pthread_cond_wait(&vs_ctx->data.workers_idle, &vs_ctx->data.workers_mutex);
+	}
+	pthread_mutex_unlock(&vs_ctx->data.workers_mutex);
+}
+
+/**
+ * \brief This function is called, when session is closed and it could be
+ * used by other client. Commands of this session waiting in queues of data
+ * workers are dropped and then it waits for commands, that are handled by
+ * workers now. Thus no worker can handle old command with identity of new
+ * client using the same session. It has to be called before avatar of the
+ * session is unsubscribed and data of session are cleared. It can not be
+ * called with locked data.lock.
+ */
+void vs_data_session_close(struct VS_CTX *vs_ctx, struct VSession *vsession)
+{
+	struct VSDataWorker *worker;
+	struct VSDataCmd *data_cmd, *prev, *next;
+	uint32 count = 0;
+	int i;
+
+	if(vs_ctx->data.workers == NULL) {
+		return;
+	}
+
+	for(i = 0; i < vs_ctx->data.worker_count; i++) {
+		worker = &vs_ctx->data.workers[i];
+		pthread_mutex_lock(&worker->mutex);
+		prev = NULL;
+		for(data_cmd = worker->first; data_cmd != NULL; data_cmd = next) {
+			next = data_cmd->next;
+			if(data_cmd->vsession != vsession) {
+				prev = data_cmd;
+				continue;
+			}
+			if(prev != NULL) {
+				prev->next = next;
+			} else {
+				worker->first = next;
+			}
+			if(worker->last == data_cmd) {
+				worker->last = prev;
+			}
+			v_cmd_destroy(&data_cmd->cmd);
+			v_pool_free(data_cmd, sizeof(struct VSDataCmd));
+			count++;
+		}
+		pthread_mutex_unlock(&worker->mutex);
+	}
+
+	pthread_mutex_lock(&vs_ctx->data.workers_mutex);
+	if(count > 0) {
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Dropped %d commands of closed session\n", count);
+
+		vs_ctx->data.pending_cmds -= count;
+		vsession->data_cmds -= count;
+		if(vs_ctx->data.pending_cmds == 0) {
+			pthread_cond_broadcast(&vs_ctx->data.workers_idle);
+		}
+	}
+
+	/* Commands of this session taken by workers before could be still
+	 * handled. Commands of other sessions are not waited for. */
+	while(vsession->data_cmds > 0) {
+		pthread_cond_wait(&vs_ctx->data.workers_idle, &vs_ctx->data.workers_mutex);
+	}
+	pthread_mutex_unlock(&vs_ctx->data.workers_mutex);
+}
+
+/**
+ * \brief This function dispatches received command. Command changing only
+ * one node is added to the queue of worker owning this node. Other commands
+ * are handled by data thread, when all previous commands were handled by
+ * workers and no worker can access node tree.
+ */
+static void vs_data_dispatch_cmd(struct VS_CTX *vs_ctx,
+		struct VSession *vsession,
+		struct Generic_Cmd *cmd)
+{
+	struct VSDataWorker *worker;
+	struct VSDataCmd *data_cmd;
+	uint32 node_id;
+
+	/* Command is handled by data thread too, when it can not be dispatched
+	 * to worker */
+	if(vs_data_cmd_node_id(cmd, &node_id) == 1 &&
+			(data_cmd = (struct VSDataCmd*)v_pool_alloc(sizeof(struct VSDataCmd))) != NULL)
+	{
+		worker = &vs_ctx->data.workers[node_id % vs_ctx->data.worker_count];
+
+		data_cmd->next = NULL;
+		data_cmd->vsession = vsession;
+		data_cmd->cmd = cmd;
+
+		pthread_mutex_lock(&vs_ctx->data.workers_mutex);
+		vs_ctx->data.pending_cmds++;
+		vsession->data_cmds++;
+		pthread_mutex_unlock(&vs_ctx->data.workers_mutex);
+
+		pthread_mutex_lock(&worker->mutex);
+		if(worker->last != NULL) {
+			worker->last->next = data_cmd;
+		} else {
+			worker->first = data_cmd;
+		}
+		worker->last = data_cmd;
+		pthread_cond_signal(&worker->cond);
+		pthread_mutex_unlock(&worker->mutex);
+	} else {
+		vs_data_workers_wait(vs_ctx);
+
+		pthread_rwlock_wrlock(&vs_ctx->data.lock);
+		vs_handle_node_cmd(vs_ctx, vsession, cmd);
+		pthread_rwlock_unlock(&vs_ctx->data.lock);
+
+		v_cmd_destroy(&cmd);
+	}
+}
+
+/**
+ * \brief This function creates data worker threads
+ */
+static int vs_data_workers_create(struct VS_CTX *vs_ctx)
+{
+	struct VSDataWorker *worker;
+	int i;
+
+	if(vs_ctx->data.worker_count == 0) {
+		return 1;
+	}
+
+	pthread_mutex_init(&vs_ctx->data.workers_mutex, NULL);
+	pthread_cond_init(&vs_ctx->data.workers_idle, NULL);
+	vs_ctx->data.pending_cmds = 0;
+
+	vs_ctx->data.workers = (struct VSDataWorker*)calloc(vs_ctx->data.worker_count,
+			sizeof(struct VSDataWorker));
+	if(vs_ctx->data.workers == NULL) {
+		return 0;
+	}
+
+	for(i = 0; i < vs_ctx->data.worker_count; i++) {
+		worker = &vs_ctx->data.workers[i];
+		worker->vs_ctx = vs_ctx;
+		worker->first = worker->last = NULL;
+		worker->stop = 0;
+		pthread_mutex_init(&worker->mutex, NULL);
+		pthread_cond_init(&worker->cond, NULL);
+		if(pthread_create(&worker->thread, NULL, vs_data_worker_loop, (void*)worker) != 0) {
+			v_print_log(VRS_PRINT_ERROR, "pthread_create(): %s\n", strerror(errno));
+			pthread_cond_destroy(&worker->cond);
+			pthread_mutex_destroy(&worker->mutex);
+			/* Use only workers, that were created */
+			vs_ctx->data.worker_count = i;
+			break;
+		}
+	}
+
+	if(vs_ctx->data.worker_count == 0) {
+		free(vs_ctx->data.workers);
+		vs_ctx->data.workers = NULL;
+		return 0;
+	}
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Created %d data worker threads\n",
+			vs_ctx->data.worker_count);
+
+	return 1;
+}
+
+/**
+ * \brief This function stops and destroys data worker threads
+ */
+static void vs_data_workers_destroy(struct VS_CTX *vs_ctx)
+{
+	struct VSDataWorker *worker;
+	int i;
+
+	if(vs_ctx->data.workers == NULL) {
+		return;
+	}
+
+	for(i = 0; i < vs_ctx->data.worker_count; i++) {
+		worker = &vs_ctx->data.workers[i];
+		pthread_mutex_lock(&worker->mutex);
+		worker->stop = 1;
+		pthread_cond_signal(&worker->cond);
+		pthread_mutex_unlock(&worker->mutex);
+	}
+
+	for(i = 0; i < vs_ctx->data.worker_count; i++) {
+		worker = &vs_ctx->data.workers[i];
+		pthread_join(worker->thread, NULL);
+		pthread_cond_destroy(&worker->cond);
+		pthread_mutex_destroy(&worker->mutex);
+	}
+
+	free(vs_ctx->data.workers);
+	vs_ctx->data.workers = NULL;
+
+	pthread_cond_destroy(&vs_ctx->data.workers_idle);
+	pthread_mutex_destroy(&vs_ctx->data.workers_mutex);
+}
+
+/**
+ * \brief This function handles all commands in incoming queue of session
+ */
+static void vs_data_handle_session(struct VS_CTX *vs_ctx,
+		struct VSession *vsession)
+{
+	struct Generic_Cmd *cmd;
+	union VInQueueCmdBuf cmd_buf;
+
+	/* Pop all data of incoming messages from queue */
+	while(v_in_queue_cmd_count(vsession->in_queue) > 0) {
+		if(vs_ctx->data.workers != NULL) {
+			/* Command could wait in queue of worker */
+			cmd = v_in_queue_pop(vsession->in_queue);
+			if(cmd == NULL) {
+				/* Producer did not finish adding of command and it will
+				 * poke data thread again */
+				break;
+			}
+			vs_data_dispatch_cmd(vs_ctx, vsession, cmd);
+			continue;
+		}
+		cmd = v_in_queue_pop_buf(vsession->in_queue, &cmd_buf);
+		if(cmd == NULL) {
+			break;
+		}
+		pthread_rwlock_wrlock(&vs_ctx->data.lock);
+		vs_handle_node_cmd(vs_ctx, vsession, cmd);
+		pthread_rwlock_unlock(&vs_ctx->data.lock);
+		/* Command unpacked from view is not allocated */
+		if(cmd != &cmd_buf.cmd) {
+			v_cmd_destroy(&cmd);
+		}
+	}
+}
+
+/**
+ * \brief This function adds session to the list of sessions with received
+ * commands and it pokes data thread. It is called by connection threads.
+ */
+void vs_data_session_ready(struct VS_CTX *vs_ctx, struct VSession *vsession)
+{
+	if(v_session_ready_push(&vs_ctx->data.ready_sessions, vsession) == 1) {
+		sem_post(vs_ctx->data.sem);
+	}
 }
 
 /**
@@ -282,10 +669,15 @@ static void vs_handle_node_cmd(struct VS_CTX *vs_ctx,
 void *vs_data_loop(void *arg)
 {
 	struct VS_CTX *vs_ctx = (struct VS_CTX*)arg;
-	struct Generic_Cmd *cmd;
+	struct VSession *vsession, *next;
 	struct timespec ts;
 	struct timeval tv;
-	int i, ret = 0;
+	int ret = 0;
+
+	if(vs_data_workers_create(vs_ctx) != 1) {
+		v_print_log(VRS_PRINT_WARNING, "Commands will be handled only by data thread\n");
+		vs_ctx->data.worker_count = 0;
+	}
 
 	gettimeofday(&tv, NULL);
 	ts.tv_sec = tv.tv_sec + 1;
@@ -299,25 +691,37 @@ void *vs_data_loop(void *arg)
         ret = sem_wait(vs_ctx->data.sem);
 #endif
 		if(ret == 0) {
-			for(i=0; i<vs_ctx->max_sessions; i++) {
-				if(vs_ctx->vsessions[i]->dgram_conn->host_state == UDP_SERVER_STATE_OPEN ||
-						vs_ctx->vsessions[i]->stream_conn->host_state == TCP_SERVER_STATE_STREAM_OPEN)
-				{
-					/* Pop all data of incoming messages from queue */
-					while(v_in_queue_cmd_count(vs_ctx->vsessions[i]->in_queue) > 0) {
-						cmd = v_in_queue_pop(vs_ctx->vsessions[i]->in_queue);
-						vs_handle_node_cmd(vs_ctx, vs_ctx->vsessions[i], cmd);
-						v_cmd_destroy(&cmd);
-					}
+			/* Visit only sessions with received commands */
+			vsession = v_session_ready_pop_all(&vs_ctx->data.ready_sessions);
+			if(vsession != NULL) {
+				vs_ctx->data.wakeups++;
+			}
+			while(vsession != NULL) {
+				next = vsession->ready_next;
+				/* Session could be added again, when new command is received */
+				v_session_ready_done(vsession);
+				vs_ctx->data.visited_sessions++;
+				if(vs_data_session_is_open(vsession)) {
+					vs_data_handle_session(vs_ctx, vsession);
 				}
+				vsession = next;
 			}
 		} else {
 			if(errno == ETIMEDOUT) {
-				ts.tv_sec++;
+				/* Wake up once per second to check state of server */
+				gettimeofday(&tv, NULL);
+				ts.tv_sec = tv.tv_sec + 1;
+				ts.tv_nsec = 1000*tv.tv_usec;
 			}
 		}
 	}
 
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Data thread: wakeups: %llu, visited sessions: %llu\n",
+			(unsigned long long)vs_ctx->data.wakeups,
+			(unsigned long long)vs_ctx->data.visited_sessions);
+
+	vs_data_workers_destroy(vs_ctx);
+
 	v_print_log(VRS_PRINT_DEBUG_MSG, "Exiting data thread\n");
 
 	pthread_exit(NULL);
@@ -0,0 +1,67 @@
+/*
+ *
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ *
+ * Contributor(s): Jiri Hnidek <jiri.hnidek@tul.cz>.
+ *
+ */
+
+
+#include "verse_types.h"
+#include "v_list.h"
+#include "v_commands.h"
+#include "v_out_queue.h"
+
+#include "vs_entity.h"
+
+/**
+ * \brief This function adds one command to the outgoing queues of all
+ * subscribers of entity (layer, tag group, etc.). The command is not copied.
+ * All queues share the same command and each queue holds own reference at it.
+ * Reference of the caller is dropped and *cmd is set to NULL.
+ * \param[in]	*subscribers	The list of VSEntitySubscriber
+ * \param[in]	**cmd			The pointer at pointer at command
+ * \return This function returns 1, when command was added to all queues.
+ * Otherwise it returns 0.
+ */
+int vs_entity_send_cmd(struct VListBase *subscribers,
+		struct Generic_Cmd **cmd)
+{
+	struct VSEntitySubscriber *subscriber;
+	struct Generic_Cmd *shared_cmd;
+	int ret = 1;
+
+	for(subscriber = subscribers->first;
+			subscriber != NULL;
+			subscriber = subscriber->next)
+	{
+		shared_cmd = v_cmd_ref(*cmd);
+		if(v_out_queue_push_tail(subscriber->node_sub->session->out_queue,
+				subscriber->node_sub->prio,
+				shared_cmd) != 1)
+		{
+			v_cmd_destroy(&shared_cmd);
+			ret = 0;
+		}
+	}
+
+	v_cmd_destroy(cmd);
+
+	return ret;
+}
@@ -52,6 +52,8 @@
 #include "vs_main.h"
 #include "vs_tcp_connect.h"
 #include "vs_udp_connect.h"
+#include "vs_reactor.h"
+#include "vs_data.h"
 #include "vs_auth_pam.h"
 #include "vs_auth_csv.h"
 #include "vs_node.h"
@@ -98,46 +100,23 @@ int vs_user_auth(struct vContext *C, const char *username, const char *data)
 
 #ifdef WITH_OPENSSL
 /**
- * \brief do TLS negotiation with client application
+ * \brief This function creates SSL of stream connection and it binds it with
+ * socket of connection. It does not change blocking mode of socket.
  * \param[in]	*C	The context of verse server
- * \return This function returns 1, when TLS connection was established and
- * it returns 0, when TLS was not established.
+ * \return This function returns 1, when SSL was created and it returns 0,
+ * when SSL could not be created.
  */
-int vs_TLS_handshake(struct vContext *C)
+int vs_TLS_setup(struct vContext *C)
 {
 	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
 	struct IO_CTX *io_ctx = CTX_io_ctx(C);
 	struct VStreamConn *stream_conn = CTX_current_stream_conn(C);
 
-	int flag, ret;
-
-	/* Make sure socket is blocking */
-#ifdef WIN32
-	long ioctlsocket_ret = 0;
-	if ((ioctlsocket(io_ctx->sockfd, FIONBIO, &ioctlsocket_ret)) == -1) {
-		if (is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "ioctlsocket(): %s\n", strerror(errno));
-		return -1;
-	}
-#else
-	flag = fcntl(stream_conn->io_ctx.sockfd, F_GETFL, 0);
-	if( (fcntl(stream_conn->io_ctx.sockfd, F_SETFL, flag & ~O_NONBLOCK)) == -1) {
-		if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "fcntl(): %s\n", strerror(errno));
-		return 0;
-	}
-#endif
-
 	/* Set up SSL */
 	if( (stream_conn->io_ctx.ssl = SSL_new(vs_ctx->tls_ctx)) == NULL) {
 		v_print_log(VRS_PRINT_ERROR, "Setting up SSL failed.\n");
 		ERR_print_errors_fp(v_log_file());
-		SSL_free(stream_conn->io_ctx.ssl);
-		stream_conn->io_ctx.ssl = NULL;
 		stream_conn->io_ctx.bio = NULL;
-#ifdef WIN32
-		closesocket(io_ctx->sockfd);
-#else
-		close(io_ctx->sockfd);
-#endif
 		return 0;
 	}
 
@@ -148,34 +127,77 @@ int vs_TLS_handshake(struct vContext *C)
 		SSL_free(stream_conn->io_ctx.ssl);
 		stream_conn->io_ctx.ssl = NULL;
 		stream_conn->io_ctx.bio = NULL;
-#ifdef WIN32
-		closesocket(io_ctx->sockfd);
-#else
-		close(io_ctx->sockfd);
-#endif
 		return 0;
 	}
 
 	SSL_set_mode(stream_conn->io_ctx.ssl, SSL_MODE_AUTO_RETRY);
 
-	/* Do TLS handshake and negotiation */
+	return 1;
+}
+
+/**
+ * \brief This function does one step of TLS handshake with client at
+ * non-blocking socket. SSL has to be created with vs_TLS_setup().
+ * \param[in]	*C	The context of verse server
+ * \return This function returns 1, when TLS connection was established, it
+ * returns -1, when handshake has to continue after socket is ready (use
+ * SSL_want_write() to find out the direction) and it returns 0, when TLS was
+ * not established.
+ */
+int vs_TLS_accept(struct vContext *C)
+{
+	struct VStreamConn *stream_conn = CTX_current_stream_conn(C);
+	int ret, err;
+
 	if( (ret = SSL_accept(stream_conn->io_ctx.ssl)) != 1) {
-		int err = SSL_get_error(stream_conn->io_ctx.ssl, ret);
+		err = SSL_get_error(stream_conn->io_ctx.ssl, ret);
+		if(err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+			return -1;
+		}
 		v_print_log(VRS_PRINT_ERROR, "SSL handshake failed: %d -> %d\n", ret, err);
 		ERR_print_errors_fp(v_log_file());
 		SSL_free(stream_conn->io_ctx.ssl);
 		stream_conn->io_ctx.ssl = NULL;
 		stream_conn->io_ctx.bio = NULL;
+		return 0;
+	}
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "SSL handshake succeed.\n");
+	return 1;
+}
+
+/**
+ * \brief do TLS negotiation with client application
+ * \param[in]	*C	The context of verse server
+ * \return This function returns 1, when TLS connection was established and
+ * it returns 0, when TLS was not established.
+ */
+int vs_TLS_handshake(struct vContext *C)
+{
+	struct VStreamConn *stream_conn = CTX_current_stream_conn(C);
+	int flag;
+
+	/* Make sure socket is blocking */
 #ifdef WIN32
-		closesocket(io_ctx->sockfd);
+	long ioctlsocket_ret = 0;
+	if ((ioctlsocket(stream_conn->io_ctx.sockfd, FIONBIO, &ioctlsocket_ret)) == -1) {
+		if (is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "ioctlsocket(): %s\n", strerror(errno));
+		return -1;
+	}
 #else
-		close(io_ctx->sockfd);
+	flag = fcntl(stream_conn->io_ctx.sockfd, F_GETFL, 0);
+	if( (fcntl(stream_conn->io_ctx.sockfd, F_SETFL, flag & ~O_NONBLOCK)) == -1) {
+		if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "fcntl(): %s\n", strerror(errno));
+		return 0;
+	}
 #endif
+
+	if(vs_TLS_setup(C) != 1) {
 		return 0;
 	}
 
-	v_print_log(VRS_PRINT_DEBUG_MSG, "SSL handshake succeed.\n");
-	return 1;
+	/* Do TLS handshake and negotiation (socket is blocking) */
+	return (vs_TLS_accept(C) == 1) ? 1 : 0;
 }
 
 /**
@@ -294,7 +316,7 @@ int vs_STREAM_OPEN_tcp_loop(struct vContext *C)
 			}
 
 			/* When some payload data were received, then poke data thread */
-			sem_post(vs_ctx->data.sem);
+			vs_data_session_ready(vs_ctx, vsession);
 		}
 
 		if( (ret = v_STREAM_pack_message(C)) == 0 ) {
@@ -520,25 +542,34 @@ int vs_NEGOTIATE_token_ded_loop(struct vContext *C)
 		/* Do not confirm proposed URL */
 		v_add_negotiate_cmd(s_message->sys_cmd, cmd_rank++, CMD_CONFIRM_R_ID, FTR_HOST_URL, NULL);
 
-		/* Find first unused port from port range or port with the lowest
-		 * aggregation */
-		for(i=vs_ctx->port_low, j=0; i<vs_ctx->port_high; i++, j++) {
-			if(vs_ctx->port_list[j].aggregation == 0) {
-				vsession->dgram_conn->io_ctx.host_addr.port = vs_ctx->port_list[j].port_number;
-				min_aggregation = 0;
-				vs_ctx->port_list[j].aggregation++;
-				break;
-			} else {
-				if(vs_ctx->port_list[j].aggregation < min_aggregation) {
-					min_aggregation = vs_ctx->port_list[j].aggregation;
-					la_port = vs_ctx->port_list[j].port_number;
+		if(vs_ctx->shared_port != 0 &&
+				url.transport_protocol == VRS_TP_UDP &&
+				!(url.security_protocol & VRS_SEC_DATA_TLS))
+		{
+			/* Unsecured UDP connections are handled by I/O threads at
+			 * shared port */
+			vsession->dgram_conn->io_ctx.host_addr.port = vs_ctx->shared_port;
+		} else {
+			/* Find first unused port from port range or port with the lowest
+			 * aggregation */
+			for(i=vs_ctx->port_low, j=0; i<vs_ctx->port_high; i++, j++) {
+				if(vs_ctx->port_list[j].aggregation == 0) {
+					vsession->dgram_conn->io_ctx.host_addr.port = vs_ctx->port_list[j].port_number;
+					min_aggregation = 0;
+					vs_ctx->port_list[j].aggregation++;
+					break;
+				} else {
+					if(vs_ctx->port_list[j].aggregation < min_aggregation) {
+						min_aggregation = vs_ctx->port_list[j].aggregation;
+						la_port = vs_ctx->port_list[j].port_number;
+					}
 				}
 			}
-		}
 
-		/* When all ports are used, then use port with lowest aggregation */
-		if(min_aggregation != 0) {
-			vsession->dgram_conn->io_ctx.host_addr.port = la_port;
+			/* When all ports are used, then use port with lowest aggregation */
+			if(min_aggregation != 0) {
+				vsession->dgram_conn->io_ctx.host_addr.port = la_port;
+			}
 		}
 
 		/* Do not allow unsecure TCP data connection */
@@ -558,17 +589,24 @@ int vs_NEGOTIATE_token_ded_loop(struct vContext *C)
 			new_C = (struct vContext*)calloc(1, sizeof(struct vContext));
 			memcpy(new_C, C, sizeof(struct vContext));
 
-			/* Try to create new thread */
-			if((ret = pthread_create(&vsession->udp_thread, NULL, vs_main_dgram_loop, (void*)new_C)) != 0) {
-				if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "pthread_create(): %s\n", strerror(errno));
+			/* Try to add datagram connection to I/O thread */
+			ret = vs_reactor_add_dgram_conn(new_C);
+			if(ret == -1) {
 				ret = 0;
 				goto end;
-			}
+			} else if(ret == 0) {
+				/* Try to create new thread */
+				if((ret = pthread_create(&vsession->udp_thread, NULL, vs_main_dgram_loop, (void*)new_C)) != 0) {
+					if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "pthread_create(): %s\n", strerror(errno));
+					ret = 0;
+					goto end;
+				}
 
-			/* Wait for datagram thread to be in LISTEN state */
-			while(vsession->dgram_conn->host_state != UDP_SERVER_STATE_LISTEN) {
-				/* Sleep 1 milisecond */
-				usleep(1000);
+				/* Wait for datagram thread to be in LISTEN state */
+				while(vsession->dgram_conn->host_state != UDP_SERVER_STATE_LISTEN) {
+					/* Sleep 1 milisecond */
+					usleep(1000);
+				}
 			}
 		} else if(vsession->flags & VRS_TP_TCP) {
 			strncpy(trans_proto, "tcp", 3);
@@ -714,9 +752,9 @@ int vs_RESPOND_userauth_loop(struct vContext *C)
 				{
 					long int avatar_id;
 
-					pthread_mutex_lock(&vs_ctx->data.mutex);
+					pthread_rwlock_wrlock(&vs_ctx->data.lock);
 					avatar_id = vs_create_avatar_node(vs_ctx, vsession, user_id);
-					pthread_mutex_unlock(&vs_ctx->data.mutex);
+					pthread_rwlock_unlock(&vs_ctx->data.lock);
 
 					if(avatar_id == -1) {
 						v_print_log(VRS_PRINT_ERROR, "Failed to create avatar node\n");
@@ -989,6 +1027,12 @@ int vs_handle_handshake(struct vContext *C)
 					printf("%c[%dm", 27, 0);
 				}
 
+				/* Connection handled by I/O thread is not blocked, it
+				 * continues with exchanging of data by I/O thread */
+				if(vsession->stream_handle != NULL) {
+					return 0;
+				}
+
 				vs_STREAM_OPEN_tcp_loop(C);
 				return -1;
 			} else if(vsession->flags & VRS_TP_WEBSOCKET) {
@@ -1002,9 +1046,16 @@ int vs_handle_handshake(struct vContext *C)
 			}
 		} else {
 			/* When thread was not confirmed, then try to cancel
-			 * UDP thread*/
-			if(pthread_cancel(vsession->udp_thread) != 0) {
-				v_print_log(VRS_PRINT_DEBUG_MSG, "UDP thread was not canceled\n");
+			 * UDP thread. Connection handled by I/O thread is closed
+			 * after timeout in LISTEN state. */
+#ifdef WIN32
+			if(vsession->udp_thread.p != 0) {
+#else
+			if(vsession->udp_thread != 0) {
+#endif
+				if(pthread_cancel(vsession->udp_thread) != 0) {
+					v_print_log(VRS_PRINT_DEBUG_MSG, "UDP thread was not canceled\n");
+				}
 			}
 			return -1;
 		}
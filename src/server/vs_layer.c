@@ -29,6 +29,7 @@
 
 #include "vs_layer.h"
 #include "vs_node_access.h"
+#include "vs_entity.h"
 
 /**
  * \brief This function increments version of layer
@@ -81,10 +82,8 @@ struct VSLayer *vs_layer_create(struct VSNode *node,
 	layer->parent = parent;
 	layer->num_vec_comp = count;
 
-	v_hash_array_init(&layer->values,
-				HASH_MOD_65536,
-				offsetof(VSLayerValue, id),
-				sizeof(uint32));
+	vs_layer_values_init(&layer->values,
+			layer->num_vec_comp * vs_layer_data_size(layer));
 
 	if(layer_id == VRS_RESERVED_LAYER_ID) {
 		/* Try to find first free id for layer */
@@ -145,19 +144,9 @@ struct VSLayer *vs_layer_create(struct VSNode *node,
 void vs_layer_destroy(struct VSNode *node, struct VSLayer *layer)
 {
 	struct VSLayer *child_layer;
-	struct VSLayerValue *item;
-	struct VBucket *vbucket;
-
-	/* Free values in all items */
-	vbucket = (struct VBucket*)layer->values.lb.first;
-	while(vbucket != NULL) {
-		item = (struct VSLayerValue*)vbucket->data;
-		free(item->value);
-		vbucket = vbucket->next;
-	}
 
-	/* Destroy hashed array with items */
-	v_hash_array_destroy(&layer->values);
+	/* Free values of all items */
+	vs_layer_values_destroy(&layer->values);
 
 	/* Set references to parent layer in all child layers to NULL */
 	child_layer = layer->child_layers.first;
@@ -357,35 +346,19 @@ int vs_layer_send_destroy(struct VSNode *node,
 	return ret;
 }
 
-/**
- * \brief This function send unset layer value to the client
- */
-int vs_layer_send_unset_value(struct VSEntitySubscriber *layer_subscriber,
-		struct VSNode *node,
-		struct VSLayer *layer,
-		struct VSLayerValue *value)
-{
-	struct Generic_Cmd *unset_value_cmd;
-
-	unset_value_cmd = v_layer_unset_value_create(node->id, layer->id, value->id);
-
-	return v_out_queue_push_tail(layer_subscriber->node_sub->session->out_queue,
-			layer_subscriber->node_sub->prio,
-			unset_value_cmd);
-}
-
 /**
  * \brief This function send set layer value to the client
  */
 int vs_layer_send_set_value(struct VSEntitySubscriber *layer_subscriber,
 		struct VSNode *node,
 		struct VSLayer *layer,
-		struct VSLayerValue *value)
+		uint32 item_id,
+		void *value)
 {
 	struct Generic_Cmd *set_value_cmd;
 
-	set_value_cmd = v_layer_set_value_create(node->id, layer->id, value->id,
-			layer->data_type, layer->num_vec_comp, value->value);
+	set_value_cmd = v_layer_set_value_create(node->id, layer->id, item_id,
+			layer->data_type, layer->num_vec_comp, value);
 
 	if(set_value_cmd != NULL) {
 		return v_out_queue_push_tail(layer_subscriber->node_sub->session->out_queue,
@@ -731,8 +704,8 @@ int vs_handle_layer_subscribe(struct VS_CTX *vs_ctx,
 	struct VSLayer *layer;
 	struct VSNodeSubscriber *node_subscriber;
 	struct VSEntitySubscriber *layer_subscriber;
-	struct VBucket *vbucket;
-	struct VSLayerValue *value;
+	uint32 slot, item_id;
+	void *value;
 	uint32 node_id = UINT32(layer_subscribe_cmd->data[0]);
 	uint16 layer_id = UINT16(layer_subscribe_cmd->data[UINT32_SIZE]);
 /*	uint32 version = UINT32(layer_subscribe_cmd->data[UINT32_SIZE+UINT16_SIZE]);
@@ -817,11 +790,9 @@ int vs_handle_layer_subscribe(struct VS_CTX *vs_ctx,
 	 * TODO: do not push all values to outgoing queue at once, when there is lot
 	 * of values in this layer. Implement this, when queue limits will be
 	 * finished. */
-	vbucket = layer->values.lb.first;
-	while(vbucket != NULL) {
-		value = (struct VSLayerValue*)vbucket->data;
-		vs_layer_send_set_value(layer_subscriber, node, layer, value);
-		vbucket = vbucket->next;
+	slot = 0;
+	while(vs_layer_values_next(&layer->values, &slot, &item_id, &value) == 1) {
+		vs_layer_send_set_value(layer_subscriber, node, layer, item_id, value);
 	}
 
 end:
@@ -916,9 +887,8 @@ int vs_handle_layer_set_value(struct VS_CTX *vs_ctx,
 {
 	struct VSNode *node;
 	struct VSLayer *layer;
-	struct VSLayerValue *item, _item;
-	struct VBucket *vbucket;
-	struct VSEntitySubscriber *layer_subscriber;
+	struct Generic_Cmd *set_value_cmd;
+	void *value;
 	int ret = 0;
 	int item_data_size;
 
@@ -970,42 +940,13 @@ int vs_handle_layer_set_value(struct VS_CTX *vs_ctx,
 	}
 
 	/* Set item value */
-
 	item_data_size = vs_layer_data_size(layer);
 	if(item_data_size > 0) {
-		/* Try to find item value first */
-		_item.id = item_id;
-		vbucket = v_hash_array_find_item(&layer->values, &_item);
-		if(vbucket == NULL) {
-			/* When this item doesn't exist yet, then allocate memory for this item
-			 * and add it to the hashed array */
-			item = calloc(1, sizeof(struct VSLayerValue));
-
-			if(item == NULL) {
-				v_print_log(VRS_PRINT_ERROR, "Out of memory\n");
-				goto end;
-			}
-
-			item->id = item_id;
-
-			/* Allocate memory for values and copy data to this memory */
-			item->value = (void*)calloc(layer->num_vec_comp, item_data_size);
-			if(item->value != NULL) {
-				v_hash_array_add_item(&layer->values, item, sizeof(struct VSLayerValue));
-				memcpy(item->value,
-						&layer_set_value_cmd->data[UINT32_SIZE + UINT16_SIZE + UINT32_SIZE],
-						layer->num_vec_comp * item_data_size);
-			} else {
-				free(item);
-				item = NULL;
-				v_print_log(VRS_PRINT_ERROR, "Out of memory\n");
-				goto end;
-			}
-		} else {
-			item = (struct VSLayerValue*)vbucket->data;
-			memcpy(item->value,
-					&layer_set_value_cmd->data[UINT32_SIZE + UINT16_SIZE + UINT32_SIZE],
-					layer->num_vec_comp * item_data_size);
+		value = vs_layer_values_set(&layer->values, item_id,
+				&layer_set_value_cmd->data[UINT32_SIZE + UINT16_SIZE + UINT32_SIZE]);
+		if(value == NULL) {
+			v_print_log(VRS_PRINT_ERROR, "Out of memory\n");
+			goto end;
 		}
 	} else {
 		v_print_log(VRS_PRINT_ERROR, "Unsupported data type: %d\n",
@@ -1017,13 +958,16 @@ int vs_handle_layer_set_value(struct VS_CTX *vs_ctx,
 
 	ret = 1;
 
-	/* Send command layer_set_value to all layer subscribers */
-	layer_subscriber = layer->layer_subs.first;
-	while(layer_subscriber != NULL) {
-		if(vs_layer_send_set_value(layer_subscriber, node, layer, item) != 1) {
+	/* Send command layer_set_value to all layer subscribers. One command is
+	 * shared by outgoing queues of all subscribers. */
+	if(layer->layer_subs.first != NULL) {
+		set_value_cmd = v_layer_set_value_create(node->id, layer->id, item_id,
+				layer->data_type, layer->num_vec_comp, value);
+		if(set_value_cmd == NULL ||
+				vs_entity_send_cmd(&layer->layer_subs, &set_value_cmd) != 1)
+		{
 			ret = 0;
 		}
-		layer_subscriber = layer_subscriber->next;
 	}
 
 end:
@@ -1053,35 +997,22 @@ static int vs_layer_unset_value(struct VSNode *node,
 		uint8 send_command)
 {
 	struct VSLayer *child_layer;
-	struct VSLayerValue *item = NULL, _item;
-	struct VBucket *vbucket;
-	struct VSEntitySubscriber *layer_subscriber;
-
-	/* Try to find item value first */
-	_item.id = item_id;
-	vbucket = v_hash_array_find_item(&layer->values, &_item);
-	if(vbucket != NULL) {
-		item = (struct VSLayerValue*)vbucket->data;
+	struct Generic_Cmd *unset_value_cmd;
 
-		/* Send unset command only for parent layer */
-		if(send_command == 1) {
-			/* Send item value unset to all layer subscribers */
+	/* Try to unset item value */
+	if(vs_layer_values_unset(&layer->values, item_id) != 1) {
+		return 0;
+	}
 
-			layer_subscriber = layer->layer_subs.first;
-			while(layer_subscriber != NULL) {
-				vs_layer_send_unset_value(layer_subscriber, node, layer, item);
-				layer_subscriber = layer_subscriber->next;
+	/* Send unset command only for parent layer */
+	if(send_command == 1) {
+		/* Send item value unset to all layer subscribers */
+		if(layer->layer_subs.first != NULL) {
+			unset_value_cmd = v_layer_unset_value_create(node->id, layer->id, item_id);
+			if(unset_value_cmd != NULL) {
+				vs_entity_send_cmd(&layer->layer_subs, &unset_value_cmd);
 			}
 		}
-
-		/* Free value */
-		free(item->value);
-		/* Remove value from hashed array */
-		v_hash_array_remove_item(&layer->values, item);
-		/* Free item */
-		free(item);
-	} else {
-		return 0;
 	}
 
 	vs_layer_inc_version(layer);
@@ -0,0 +1,439 @@
+/*
+ *
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ *
+ * Contributor(s): Jiri Hnidek <jiri.hnidek@tul.cz>.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "v_common.h"
+
+#include "vs_layer_values.h"
+
+/**
+ * \brief This function returns the lowest power of two, that is not lower
+ * then length and VS_LAYER_VALUES_MIN_LENGTH
+ */
+static uint32 vs_layer_values_pow2(uint64 length)
+{
+	uint64 ret = VS_LAYER_VALUES_MIN_LENGTH;
+
+	while(ret < length) {
+		ret <<= 1;
+	}
+
+	return (ret > 0x80000000) ? 0x80000000 : (uint32)ret;
+}
+
+/**
+ * \brief This function computes hash of item ID used in the index
+ */
+static uint32 vs_layer_values_hash(uint32 item_id)
+{
+	return item_id * 2654435761U;
+}
+
+/**
+ * \brief This function tries to find position of item ID in the index
+ * \return This function returns position in the index or -1, when item ID
+ * is not in the index.
+ */
+static int64 vs_layer_index_find(struct VSLayerValues *values, uint32 item_id)
+{
+	uint32 mask = values->index_length - 1;
+	uint32 pos;
+
+	if(values->index == NULL) {
+		return -1;
+	}
+
+	for(pos = vs_layer_values_hash(item_id) & mask;
+			values->index[pos].slot != VS_LAYER_VALUES_NO_SLOT;
+			pos = (pos + 1) & mask)
+	{
+		if(values->index[pos].id == item_id) {
+			return pos;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * \brief This function adds item ID to the index. The index has to contain
+ * at least one free position.
+ */
+static void vs_layer_index_insert(struct VSLayerValues *values,
+		uint32 item_id,
+		uint32 slot)
+{
+	uint32 mask = values->index_length - 1;
+	uint32 pos;
+
+	for(pos = vs_layer_values_hash(item_id) & mask;
+			values->index[pos].slot != VS_LAYER_VALUES_NO_SLOT;
+			pos = (pos + 1) & mask)
+	{
+	}
+
+	values->index[pos].id = item_id;
+	values->index[pos].slot = slot;
+}
+
+/**
+ * \brief This function removes item from the position in the index. Following
+ * items of the same cluster are shifted back, thus no tombstones are needed.
+ */
+static void vs_layer_index_remove(struct VSLayerValues *values, uint32 pos)
+{
+	uint32 mask = values->index_length - 1;
+	uint32 next, home;
+
+	for(next = (pos + 1) & mask;
+			values->index[next].slot != VS_LAYER_VALUES_NO_SLOT;
+			next = (next + 1) & mask)
+	{
+		home = vs_layer_values_hash(values->index[next].id) & mask;
+		/* Item can be moved, when its home position is not between
+		 * the free position and its current position */
+		if( ((next - home) & mask) >= ((next - pos) & mask) ) {
+			values->index[pos] = values->index[next];
+			pos = next;
+		}
+	}
+
+	values->index[pos].slot = VS_LAYER_VALUES_NO_SLOT;
+}
+
+/**
+ * \brief This function creates new index with index_length positions and
+ * it adds all stored values to this index.
+ */
+static int vs_layer_index_rebuild(struct VSLayerValues *values,
+		uint32 index_length)
+{
+	struct VSLayerIndexSlot *index;
+	uint32 i;
+
+	index = (struct VSLayerIndexSlot*)malloc(index_length * sizeof(struct VSLayerIndexSlot));
+	if(index == NULL) {
+		v_print_log(VRS_PRINT_ERROR, "malloc(): no memory allocated\n");
+		return 0;
+	}
+
+	for(i = 0; i < index_length; i++) {
+		index[i].slot = VS_LAYER_VALUES_NO_SLOT;
+	}
+
+	free(values->index);
+	values->index = index;
+	values->index_length = index_length;
+
+	for(i = 0; i < values->count; i++) {
+		vs_layer_index_insert(values, values->ids[i], i);
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function changes number of allocated slots
+ */
+static int vs_layer_values_resize(struct VSLayerValues *values, uint32 length)
+{
+	uint8 *data;
+
+	data = (uint8*)realloc(values->data, (size_t)length * values->value_size);
+	if(data == NULL) {
+		v_print_log(VRS_PRINT_ERROR, "realloc(): no memory allocated\n");
+		return 0;
+	}
+	values->data = data;
+
+	if(values->mode == VS_LAYER_VALUES_DENSE) {
+		uint32 *bitmap = (uint32*)realloc(values->bitmap,
+				(length / 32) * sizeof(uint32));
+		if(bitmap == NULL) {
+			v_print_log(VRS_PRINT_ERROR, "realloc(): no memory allocated\n");
+			return 0;
+		}
+		memset(&bitmap[values->length / 32], 0,
+				((length - values->length) / 32) * sizeof(uint32));
+		values->bitmap = bitmap;
+	} else {
+		uint32 *ids = (uint32*)realloc(values->ids, length * sizeof(uint32));
+		if(ids == NULL) {
+			v_print_log(VRS_PRINT_ERROR, "realloc(): no memory allocated\n");
+			return 0;
+		}
+		values->ids = ids;
+	}
+
+	values->length = length;
+
+	return 1;
+}
+
+/**
+ * \brief This function switches storage from dense mode to sparse mode. It
+ * is used, when IDs of items are not contiguous.
+ */
+static int vs_layer_values_to_sparse(struct VSLayerValues *values)
+{
+	struct VSLayerValues sparse;
+	uint32 slot = 0, item_id;
+	void *value;
+
+	memset(&sparse, 0, sizeof(struct VSLayerValues));
+	sparse.value_size = values->value_size;
+	sparse.mode = VS_LAYER_VALUES_SPARSE;
+
+	if(vs_layer_values_resize(&sparse, vs_layer_values_pow2((uint64)values->count + 1)) != 1) {
+		vs_layer_values_destroy(&sparse);
+		return 0;
+	}
+
+	/* Pack values */
+	while(vs_layer_values_next(values, &slot, &item_id, &value) == 1) {
+		memcpy(&sparse.data[sparse.count * sparse.value_size], value, sparse.value_size);
+		sparse.ids[sparse.count] = item_id;
+		sparse.count++;
+	}
+
+	if(vs_layer_index_rebuild(&sparse, vs_layer_values_pow2((uint64)sparse.length * 2)) != 1) {
+		vs_layer_values_destroy(&sparse);
+		return 0;
+	}
+
+	vs_layer_values_destroy(values);
+	*values = sparse;
+
+	return 1;
+}
+
+/**
+ * \brief This function tries to find value of item
+ * \return This function returns pointer at value or NULL, when value of
+ * item is not set. The pointer is valid until next change of values.
+ */
+void *vs_layer_values_find(struct VSLayerValues *values, uint32 item_id)
+{
+	int64 pos;
+
+	if(values->mode == VS_LAYER_VALUES_DENSE) {
+		if(item_id < values->length &&
+				(values->bitmap[item_id >> 5] & (1U << (item_id & 31))))
+		{
+			return &values->data[(size_t)item_id * values->value_size];
+		}
+	} else {
+		pos = vs_layer_index_find(values, item_id);
+		if(pos != -1) {
+			return &values->data[(size_t)values->index[pos].slot * values->value_size];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief This function sets value of item. Memory is allocated only, when
+ * there is no free slot for new item.
+ * \return This function returns pointer at stored value or NULL, when there
+ * is not enough memory. The pointer is valid until next change of values.
+ */
+void *vs_layer_values_set(struct VSLayerValues *values,
+		uint32 item_id,
+		const void *value)
+{
+	uint8 *data;
+	uint32 slot;
+
+	/* Update existing value first */
+	data = (uint8*)vs_layer_values_find(values, item_id);
+	if(data != NULL) {
+		memcpy(data, value, values->value_size);
+		return data;
+	}
+
+	if(values->mode == VS_LAYER_VALUES_DENSE) {
+		if(item_id >= values->length) {
+			if(item_id < VS_LAYER_VALUES_DENSE_LIMIT ||
+					(uint64)item_id < (uint64)(values->count + 1) * VS_LAYER_VALUES_DENSE_RATIO)
+			{
+				if(vs_layer_values_resize(values, vs_layer_values_pow2((uint64)item_id + 1)) != 1) {
+					return NULL;
+				}
+			} else if(vs_layer_values_to_sparse(values) != 1) {
+				return NULL;
+			}
+		}
+	}
+
+	if(values->mode == VS_LAYER_VALUES_DENSE) {
+		slot = item_id;
+		values->bitmap[slot >> 5] |= 1U << (slot & 31);
+	} else {
+		if(values->count == values->length) {
+			if(vs_layer_values_resize(values, vs_layer_values_pow2((uint64)values->length * 2)) != 1) {
+				return NULL;
+			}
+		}
+		if((uint64)(values->count + 1) * 4 > (uint64)values->index_length * 3) {
+			if(vs_layer_index_rebuild(values, vs_layer_values_pow2((uint64)values->index_length * 2)) != 1) {
+				return NULL;
+			}
+		}
+		slot = values->count;
+		values->ids[slot] = item_id;
+		vs_layer_index_insert(values, item_id, slot);
+	}
+
+	data = &values->data[(size_t)slot * values->value_size];
+	memcpy(data, value, values->value_size);
+	values->count++;
+
+	return data;
+}
+
+/**
+ * \brief This function unsets value of item. The last value is moved to the
+ * free slot in sparse mode, thus values are still packed.
+ * \return This function returns 1, when value was unset and it returns 0,
+ * when value of item was not set.
+ */
+int vs_layer_values_unset(struct VSLayerValues *values, uint32 item_id)
+{
+	uint32 slot, last;
+	int64 pos;
+
+	if(values->mode == VS_LAYER_VALUES_DENSE) {
+		if(item_id < values->length &&
+				(values->bitmap[item_id >> 5] & (1U << (item_id & 31))))
+		{
+			values->bitmap[item_id >> 5] &= ~(1U << (item_id & 31));
+			values->count--;
+			return 1;
+		}
+		return 0;
+	}
+
+	pos = vs_layer_index_find(values, item_id);
+	if(pos == -1) {
+		return 0;
+	}
+
+	slot = values->index[pos].slot;
+	vs_layer_index_remove(values, (uint32)pos);
+
+	last = values->count - 1;
+	if(slot != last) {
+		memcpy(&values->data[(size_t)slot * values->value_size],
+				&values->data[(size_t)last * values->value_size],
+				values->value_size);
+		values->ids[slot] = values->ids[last];
+		pos = vs_layer_index_find(values, values->ids[slot]);
+		assert(pos != -1);
+		values->index[pos].slot = slot;
+	}
+
+	values->count--;
+
+	return 1;
+}
+
+/**
+ * \brief This function is used for iterating over all values. The slot has
+ * to be set to zero before first call of this function.
+ * \return This function returns 1, when next value was found and it returns
+ * 0, when there is no other value.
+ */
+int vs_layer_values_next(struct VSLayerValues *values,
+		uint32 *slot,
+		uint32 *item_id,
+		void **value)
+{
+	uint32 i = *slot, word;
+
+	if(values->mode == VS_LAYER_VALUES_DENSE) {
+		while(i < values->length) {
+			word = values->bitmap[i >> 5] >> (i & 31);
+			if(word == 0) {
+				/* Skip rest of the word */
+				i = (i | 31) + 1;
+				continue;
+			}
+			while((word & 1) == 0) {
+				word >>= 1;
+				i++;
+			}
+			*item_id = i;
+			*value = &values->data[(size_t)i * values->value_size];
+			*slot = i + 1;
+			return 1;
+		}
+	} else if(i < values->count) {
+		*item_id = values->ids[i];
+		*value = &values->data[(size_t)i * values->value_size];
+		*slot = i + 1;
+		return 1;
+	}
+
+	*slot = i;
+
+	return 0;
+}
+
+/**
+ * \brief This function frees all values
+ */
+void vs_layer_values_destroy(struct VSLayerValues *values)
+{
+	free(values->data);
+	free(values->bitmap);
+	free(values->ids);
+	free(values->index);
+
+	values->data = NULL;
+	values->bitmap = NULL;
+	values->ids = NULL;
+	values->index = NULL;
+	values->length = 0;
+	values->index_length = 0;
+	values->count = 0;
+	values->mode = VS_LAYER_VALUES_DENSE;
+}
+
+/**
+ * \brief This function initializes storage of values. No memory is allocated
+ * until first value is set.
+ * \param[out]	*values		The pointer at storage of values
+ * \param[in]	value_size	The size of one value (all vector components)
+ */
+void vs_layer_values_init(struct VSLayerValues *values, uint16 value_size)
+{
+	memset(values, 0, sizeof(struct VSLayerValues));
+	values->value_size = value_size;
+	values->mode = VS_LAYER_VALUES_DENSE;
+}
@@ -47,6 +47,7 @@ extern int sem_close_win(sem_t *sem);
 #include "vs_main.h"
 #include "vs_tcp_connect.h"
 #include "vs_udp_connect.h"
+#include "vs_reactor.h"
 #include "vs_auth_csv.h"
 #include "vs_data.h"
 #include "vs_node.h"
@@ -159,8 +160,19 @@ static void vs_init(struct VS_CTX *vs_ctx)
 
 	vs_ctx->max_connection_attempts = 10;
 	vs_ctx->vsessions = NULL;
-	vs_ctx->max_sessions = 10;
+	/* Sockets of all sessions have to be lower than FD_SETSIZE, because
+	 * WebSocket and DTLS connections are still handled with select() */
+	vs_ctx->max_sessions = 256;
 	vs_ctx->max_sockets = vs_ctx->max_sessions;
+#ifdef __linux__
+	vs_ctx->reactor = 1;
+#else
+	vs_ctx->reactor = 0;
+#endif
+	vs_ctx->io_thread_count = 0;
+	vs_ctx->reactors = NULL;
+	vs_ctx->shared_port = 0;
+	vs_ctx->pending_conns = NULL;
 	vs_ctx->flag = SERVER_DEBUG_MODE;		/* SERVER_MULTI_SOCKET_MODE | SERVER_REQUIRE_SECURE_CONNECTION */
 	vs_ctx->stream_protocol = TCP;			/* For new connection attempts is used TCP protocol */
 	vs_ctx->dgram_protocol = VRS_TP_UDP;	/* For data exchange UDP protocol could be used */
@@ -219,7 +231,8 @@ static void vs_init(struct VS_CTX *vs_ctx)
 
 	vs_ctx->default_perm = VRS_PERM_NODE_READ;
 
-	vs_ctx->cc_meth = CC_NONE;		/* "List" of allowed methods of Congestion Control */
+	/* Set of allowed methods of Congestion Control */
+	vs_ctx->cc_meth = CC_MASK(CC_NONE) | CC_MASK(CC_TCP_LIKE) | CC_MASK(CC_CUBIC) | CC_MASK(CC_BBR);
 	vs_ctx->fc_meth = FC_TCP_LIKE;	/* "List" of allowed methods of Flow Control */
 
 	vs_ctx->cmd_cmpr = CMPR_ADDR_SHARE;
@@ -227,7 +240,11 @@ static void vs_init(struct VS_CTX *vs_ctx)
 	vs_ctx->rwin_scale = 0;			/*  Default scale of Flow Control Window */
 
 	vs_ctx->in_queue_max_size = 1048576;	/* 1MB */
+	vs_ctx->in_queue_cmd_views = 0;
 	vs_ctx->out_queue_max_size = 1048576;	/* 1MB */
+	vs_ctx->dgram_batch = 16;
+	vs_ctx->dgram_offload = 0;
+	vs_ctx->dgram_pacing = 1;
 
 	vs_ctx->tls_ctx = NULL;
 	vs_ctx->dtls_ctx = NULL;
@@ -243,6 +260,13 @@ static void vs_init(struct VS_CTX *vs_ctx)
 	vs_ctx->data.avatar_node = NULL;
 
 	vs_ctx->data.sem = NULL;
+	v_session_ready_init(&vs_ctx->data.ready_sessions);
+	vs_ctx->data.wakeups = 0;
+	vs_ctx->data.visited_sessions = 0;
+
+	vs_ctx->data.worker_count = 0;
+	vs_ctx->data.workers = NULL;
+	vs_ctx->data.pending_cmds = 0;
 
 #if WITH_MONGODB
 	vs_ctx->mongo_conn = NULL;
@@ -586,9 +610,9 @@ int main(int argc, char *argv[])
 			exit(EXIT_FAILURE);
 	}
 
-	/* Initialize data mutex */
-	if( pthread_mutex_init(&vs_ctx.data.mutex, NULL) != 0) {
-		v_print_log(VRS_PRINT_ERROR, "pthread_mutex_init(): failed\n");
+	/* Initialize data lock */
+	if( pthread_rwlock_init(&vs_ctx.data.lock, NULL) != 0) {
+		v_print_log(VRS_PRINT_ERROR, "pthread_rwlock_init(): failed\n");
 		vs_destroy_ctx(&vs_ctx);
 		exit(EXIT_FAILURE);
 	}
@@ -676,6 +700,13 @@ int main(int argc, char *argv[])
 		exit(EXIT_FAILURE);
 	}
 
+	/* Try to create I/O threads for datagram connections */
+	if(vs_ctx.reactor == 1 || vs_ctx.shared_port != 0) {
+		if(vs_reactor_init(&vs_ctx) != 1) {
+			v_print_log(VRS_PRINT_WARNING, "Datagram connections will be handled by threads of sessions\n");
+		}
+	}
+
 	/* Try to create cli thread */
 	if(pthread_create(&vs_ctx.cli_thread, NULL, vs_server_cli, (void*)&vs_ctx) != 0) {
 		v_print_log(VRS_PRINT_ERROR, "pthread_create(): %s\n", strerror(errno));
@@ -709,6 +740,9 @@ int main(int argc, char *argv[])
 		exit(EXIT_FAILURE);
 	}
 
+	/* Join I/O threads */
+	vs_reactor_destroy(&vs_ctx);
+
 #ifdef WITH_MONGODB
 	/* Try to save data and disconnect from MongoDB server */
 	if(vs_ctx.mongo_conn != NULL) {
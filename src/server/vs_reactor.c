@@ -0,0 +1,1566 @@
+/*
+ *
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ *
+ * Contributor(s): Jiri Hnidek <jiri.hnidek@tul.cz>.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#ifdef WITH_OPENSSL
+#include <openssl/ssl.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <netinet/in.h>
+#endif
+
+#include "verse_types.h"
+
+#include "vs_main.h"
+#include "vs_reactor.h"
+#include "vs_udp_connect.h"
+#include "vs_tcp_connect.h"
+#include "vs_handshake.h"
+#include "vs_data.h"
+
+#include "v_common.h"
+#include "v_context.h"
+#include "v_session.h"
+#include "v_network.h"
+#include "v_connection.h"
+#include "v_stream.h"
+#include "v_sys_commands.h"
+#include "v_commands.h"
+
+#ifdef __linux__
+
+/* Types of file descriptors registered in epoll */
+#define REACTOR_HANDLE_SOCKET	1
+#define REACTOR_HANDLE_TIMER	2
+#define REACTOR_HANDLE_SHARED	3
+#define REACTOR_HANDLE_EVENT	4
+#define REACTOR_HANDLE_STREAM	5
+#define REACTOR_HANDLE_STREAM_TIMER	6
+
+/**
+ * Address and port of client used as key of connections at shared port
+ */
+typedef struct VSReactorPeer {
+	uint8					addr[16];	/* IPv4 or IPv6 address */
+	uint16					port;		/* Port in network byte order */
+	uint8					ip_ver;		/* Version of IP */
+	uint8					reserved;
+} VSReactorPeer;
+
+/**
+ * Datagram connection handled by I/O thread
+ */
+typedef struct VSReactorConn {
+	struct VSReactorPeer	peer;		/* Key of hashed connections (it has to be first) */
+	struct VSReactorConn	*prev, *next;	/* List of connections of I/O thread */
+	struct VSReactorHandle	sock;		/* Handle of socket */
+	struct VSReactorHandle	timer;		/* Handle of timer */
+	struct vContext			*C;			/* Verse context of datagram connection */
+	struct VSReactor		*reactor;	/* I/O thread handling this connection */
+	int						timer_fd;	/* Timer used for sending packets with FPS */
+	float					fps;		/* FPS used for timer */
+	uint8					shared;		/* Connection uses shared socket of I/O thread */
+	uint8					pending;	/* Connection at shared port has not received first packet yet */
+	uint8					closed;		/* Connection was closed during handling of events */
+	struct VSReactorConn	*prev_pending, *next_pending;
+	struct VSReactorConn	*next_closed;
+} VSReactorConn;
+
+/**
+ * Stream connection handled by I/O thread
+ */
+typedef struct VSReactorStream {
+	struct VSReactorStream	*prev, *next;	/* List of stream connections of I/O thread */
+	struct VSReactorHandle	sock;		/* Handle of socket */
+	struct VSReactorHandle	timer;		/* Handle of timer */
+	struct vContext			*C;			/* Verse context of stream connection */
+	struct VSReactor		*reactor;	/* I/O thread handling this connection */
+	int						timer_fd;	/* Timer of handshake timeout or sending messages with FPS */
+	uint32					events;		/* Events of socket watched by epoll */
+	float					fps;		/* FPS used for timer (0 = timeout of verse handshake) */
+	uint8					tls;		/* TLS handshake has not finished yet */
+	uint8					waiting;	/* Closed connection waits for closing of datagram connection */
+	uint8					join_dgram;	/* UDP thread of session has to be joined before freeing */
+	uint8					closed;		/* Connection was closed during handling of events */
+	struct VSReactorStream	*next_closed;
+} VSReactorStream;
+
+/**
+ * Packet received at shared socket of other I/O thread
+ */
+typedef struct VSReactorPacket {
+	struct VSReactorPacket	*next;
+	struct VSReactorConn	*conn;		/* Connection of this packet */
+	struct VNetworkAddress	peer_addr;	/* Address of client */
+	ssize_t					size;		/* Size of packet */
+	char					buf[1];		/* Received data */
+} VSReactorPacket;
+
+/**
+ * \brief This function creates key of hashed connections from the address
+ * and port of client.
+ */
+static void vs_reactor_peer_key(const struct VNetworkAddress *addr,
+		struct VSReactorPeer *peer)
+{
+	memset(peer, 0, sizeof(struct VSReactorPeer));
+	peer->ip_ver = addr->ip_ver;
+	if(addr->ip_ver == IPV4) {
+		memcpy(peer->addr, &addr->addr.ipv4.sin_addr, sizeof(addr->addr.ipv4.sin_addr));
+		peer->port = addr->addr.ipv4.sin_port;
+	} else if(addr->ip_ver == IPV6) {
+		memcpy(peer->addr, &addr->addr.ipv6.sin6_addr, sizeof(addr->addr.ipv6.sin6_addr));
+		peer->port = addr->addr.ipv6.sin6_port;
+	}
+}
+
+/**
+ * \brief This function sets period of timer according FPS negotiated with
+ * client.
+ */
+static int vs_reactor_conn_set_timer(struct VSReactorConn *conn)
+{
+	struct VSession *vsession = CTX_current_session(conn->C);
+	struct itimerspec its;
+	long int period;
+
+	conn->fps = vsession->fps_host;
+	period = (long int)(1000000000.0/conn->fps);
+
+	its.it_interval.tv_sec = period / 1000000000;
+	its.it_interval.tv_nsec = period % 1000000000;
+	its.it_value = its.it_interval;
+
+	if(timerfd_settime(conn->timer_fd, 0, &its, NULL) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "timerfd_settime(): %s\n", strerror(errno));
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function shortens current period of timer, when pacer holds
+ * next payload packet. Following periods of timer are not changed.
+ */
+static int vs_reactor_conn_set_pacing_timer(struct VSReactorConn *conn,
+		long int delay)
+{
+	struct itimerspec its;
+	long int period;
+
+	period = (long int)(1000000000.0/conn->fps);
+
+	its.it_interval.tv_sec = period / 1000000000;
+	its.it_interval.tv_nsec = period % 1000000000;
+	/* Zero value would disarm the timer */
+	its.it_value.tv_sec = delay / 1000000;
+	its.it_value.tv_nsec = (delay > 0) ? (delay % 1000000)*1000 : 1000;
+
+	if(timerfd_settime(conn->timer_fd, 0, &its, NULL) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "timerfd_settime(): %s\n", strerror(errno));
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function adds connection to the list of closed connections,
+ * that are freed, when all events of I/O thread were handled.
+ */
+static void vs_reactor_conn_set_closed(struct VSReactorConn *conn,
+		struct VSReactorConn **closed)
+{
+	if(conn->closed == 0) {
+		conn->closed = 1;
+		conn->next_closed = *closed;
+		*closed = conn;
+	}
+}
+
+/**
+ * \brief This function is function of thread freeing closed stream
+ * connection. It waits for end of UDP thread of session, when DTLS
+ * connection was not handled by I/O threads. Releasing of session waits for
+ * commands of session handled by data workers, thus I/O thread must not do
+ * it.
+ */
+static void *vs_reactor_stream_free_loop(void *arg)
+{
+	struct VSReactorStream *stream = (struct VSReactorStream*)arg;
+	struct VS_CTX *vs_ctx = stream->reactor->vs_ctx;
+
+	if(stream->join_dgram == 1) {
+		vs_tcp_conn_join_dgram(stream->C);
+	}
+
+	vs_tcp_conn_free(stream->C);
+	free(stream);
+
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	vs_ctx->stream_frees--;
+	pthread_cond_broadcast(&vs_ctx->reactor_cond);
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	return NULL;
+}
+
+/**
+ * \brief This function frees closed stream connection and it releases the
+ * session for new client in new thread. Datagram connection of session has
+ * to be closed or it has to be handled by UDP thread, that is joined before.
+ */
+static void vs_reactor_stream_free(struct VSReactorStream *stream,
+		uint8 join_dgram)
+{
+	struct VS_CTX *vs_ctx = stream->reactor->vs_ctx;
+	pthread_t thread;
+
+	stream->join_dgram = join_dgram;
+
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	vs_ctx->stream_frees++;
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	if(pthread_create(&thread, NULL, vs_reactor_stream_free_loop, (void*)stream) == 0) {
+		pthread_detach(thread);
+		return;
+	}
+
+	v_print_log(VRS_PRINT_ERROR, "pthread_create(): %s\n", strerror(errno));
+	vs_reactor_stream_free_loop((void*)stream);
+}
+
+/**
+ * \brief This function removes connection from I/O thread, frees datagram
+ * connection and notifies TCP thread waiting for end of connection. Closed
+ * stream connection handled by I/O thread waiting for end of datagram
+ * connection is freed too.
+ */
+static void vs_reactor_conn_close(struct VSReactorConn *conn)
+{
+	struct VSReactor *reactor = conn->reactor;
+	struct VS_CTX *vs_ctx = reactor->vs_ctx;
+	struct VSession *vsession = CTX_current_session(conn->C);
+	struct VSReactorPacket *packet, **packet_p;
+	struct VSReactorStream *stream;
+
+	if(conn->shared == 1) {
+		/* No other I/O thread could find this connection since now */
+		pthread_rwlock_wrlock(&vs_ctx->peers_lock);
+		if(conn->pending == 1) {
+			if(conn->prev_pending != NULL) {
+				conn->prev_pending->next_pending = conn->next_pending;
+			} else {
+				vs_ctx->pending_conns = conn->next_pending;
+			}
+			if(conn->next_pending != NULL) {
+				conn->next_pending->prev_pending = conn->prev_pending;
+			}
+		} else {
+			v_hash_array_remove_item(&vs_ctx->peers, conn);
+		}
+		pthread_rwlock_unlock(&vs_ctx->peers_lock);
+
+		/* Drop packets forwarded to this connection */
+		pthread_mutex_lock(&reactor->inbox_mutex);
+		reactor->inbox_last = NULL;
+		packet_p = &reactor->inbox_first;
+		while(*packet_p != NULL) {
+			packet = *packet_p;
+			if(packet->conn == conn) {
+				*packet_p = packet->next;
+				free(packet);
+			} else {
+				reactor->inbox_last = packet;
+				packet_p = &packet->next;
+			}
+		}
+		pthread_mutex_unlock(&reactor->inbox_mutex);
+	} else {
+		epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, vsession->dgram_conn->io_ctx.sockfd, NULL);
+	}
+
+	epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, conn->timer_fd, NULL);
+	close(conn->timer_fd);
+
+	vs_dgram_conn_free(conn->C);
+
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	if(conn->prev != NULL) {
+		conn->prev->next = conn->next;
+	} else {
+		reactor->conns = conn->next;
+	}
+	if(conn->next != NULL) {
+		conn->next->prev = conn->prev;
+	}
+	reactor->conn_count--;
+	vsession->io_handle = NULL;
+	stream = (struct VSReactorStream*)vsession->stream_handle;
+	if(stream != NULL && stream->waiting == 1) {
+		vsession->stream_handle = NULL;
+	} else {
+		stream = NULL;
+	}
+	pthread_cond_broadcast(&vs_ctx->reactor_cond);
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	free(conn);
+
+	if(stream != NULL) {
+		vs_reactor_stream_free(stream, 0);
+	}
+}
+
+/**
+ * \brief This function does periodic work of connection after received
+ * packet or timer expiration.
+ * \return This function returns 0, when connection should be closed.
+ */
+static int vs_reactor_conn_update(struct VSReactorConn *conn)
+{
+	struct VS_CTX *vs_ctx = conn->reactor->vs_ctx;
+	struct VSession *vsession = CTX_current_session(conn->C);
+	long int pacing_delay;
+
+	if(vs_dgram_conn_update(conn->C) == 0) {
+		return 0;
+	}
+
+	/* When client finished first phase of handshake, then packets of
+	 * this connection could be found according address of client */
+	if(conn->pending == 1 &&
+			vsession->dgram_conn->host_state != UDP_SERVER_STATE_LISTEN)
+	{
+		pthread_rwlock_wrlock(&vs_ctx->peers_lock);
+		if(conn->prev_pending != NULL) {
+			conn->prev_pending->next_pending = conn->next_pending;
+		} else {
+			vs_ctx->pending_conns = conn->next_pending;
+		}
+		if(conn->next_pending != NULL) {
+			conn->next_pending->prev_pending = conn->prev_pending;
+		}
+		conn->pending = 0;
+		vs_reactor_peer_key(&vsession->dgram_conn->peer_address, &conn->peer);
+		v_hash_array_add_item(&vs_ctx->peers, conn, sizeof(struct VSReactorConn));
+		pthread_rwlock_unlock(&vs_ctx->peers_lock);
+	}
+
+	/* FPS could be negotiated again */
+	if(vsession->fps_host != conn->fps) {
+		if(vs_reactor_conn_set_timer(conn) == 0) {
+			return 0;
+		}
+	}
+
+	/* Timer expires earlier, when pacer holds next payload packet */
+	pacing_delay = vs_dgram_conn_pacing_delay(conn->C);
+	if(pacing_delay >= 0 && pacing_delay < (long int)(1000000.0/conn->fps)) {
+		return vs_reactor_conn_set_pacing_timer(conn, pacing_delay);
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function passes received packet to the connection. When swap
+ * is not zero, then buffers are only swapped.
+ * \return This function returns 0, when connection should be closed.
+ */
+static int vs_reactor_conn_deliver(struct VSReactorConn *conn,
+		const struct VNetworkAddress *peer_addr,
+		char **buf,
+		ssize_t size,
+		int swap)
+{
+	struct VSession *vsession = CTX_current_session(conn->C);
+	struct IO_CTX *io_ctx = &vsession->dgram_conn->io_ctx;
+	char *tmp;
+
+	if(swap != 0) {
+		tmp = io_ctx->buf;
+		io_ctx->buf = *buf;
+		*buf = tmp;
+	} else {
+		memcpy(io_ctx->buf, *buf, size);
+	}
+	io_ctx->buf_size = size;
+	memcpy(&io_ctx->peer_addr, peer_addr, sizeof(struct VNetworkAddress));
+
+	if(size > 0) {
+		vs_dgram_conn_handle(conn->C);
+	}
+
+	return vs_reactor_conn_update(conn);
+}
+
+/**
+ * \brief This function handles one event of connection with own socket.
+ * All packets waiting in the socket are received with one system call.
+ * \return This function returns 0, when connection should be closed.
+ */
+static int vs_reactor_conn_handle(struct VSReactorHandle *handle)
+{
+	struct VSReactorConn *conn = handle->conn;
+	struct VSReactor *reactor = conn->reactor;
+	struct VDgramBatch *batch = reactor->recv_batch;
+	struct VSession *vsession = CTX_current_session(conn->C);
+	uint64 expirations;
+	int i, count, error_num;
+
+	if(handle->type == REACTOR_HANDLE_TIMER) {
+		if(read(conn->timer_fd, &expirations, sizeof(expirations)) == -1 &&
+				errno != EAGAIN)
+		{
+			v_print_log(VRS_PRINT_ERROR, "read(): %s\n", strerror(errno));
+			return 0;
+		}
+		return vs_reactor_conn_update(conn);
+	}
+
+	/* DTLS connections are not handled by I/O threads, thus new DTLS
+	 * hello is never expected */
+	count = v_dgram_batch_receive(batch, vsession->dgram_conn->io_ctx.sockfd,
+			vsession->dgram_conn->io_ctx.host_addr.ip_ver, &error_num);
+	if(count == -1) {
+		if(error_num == ECONNREFUSED) {
+			v_print_log(VRS_PRINT_WARNING, "Closing connection ...\n");
+			return 0;
+		}
+		return vs_reactor_conn_update(conn);
+	}
+
+	for(i = 0; i < count; i++) {
+		if(vs_reactor_conn_deliver(conn, &batch->addrs[i], &batch->bufs[i], batch->sizes[i], 1) == 0) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function tries to find connection waiting for first packet
+ * from client. The packet has to include token negotiated during
+ * authentication. It has to be called, when peers_lock is locked.
+ */
+static struct VSReactorConn *vs_reactor_find_pending(struct VSReactor *reactor,
+		const char *buf,
+		ssize_t size,
+		const struct VNetworkAddress *peer_addr)
+{
+	struct VPacket *packet = reactor->peek_packet;
+	struct VSReactorConn *conn;
+	struct VSession *vsession;
+	struct Negotiate_Cmd *negotiate_cmd;
+	int i;
+
+	if(reactor->vs_ctx->pending_conns == NULL ||
+			size < VERSE_PACKET_HEADER_SIZE || size > USHRT_MAX) {
+		return NULL;
+	}
+
+	v_unpack_packet_header(buf, (unsigned short)size, packet);
+	if(packet->header.flags != (PAY_FLAG|SYN_FLAG)) {
+		return NULL;
+	}
+
+	v_unpack_packet_system_commands(buf, (unsigned short)size, packet);
+
+	for(i = 0; i < MAX_SYSTEM_COMMAND_COUNT && packet->sys_cmd[i].cmd.id != CMD_RESERVED_ID; i++) {
+		negotiate_cmd = &packet->sys_cmd[i].negotiate_cmd;
+		if(negotiate_cmd->id != CMD_CHANGE_L_ID ||
+				negotiate_cmd->feature != FTR_TOKEN ||
+				negotiate_cmd->count == 0) {
+			continue;
+		}
+		for(conn = reactor->vs_ctx->pending_conns; conn != NULL; conn = conn->next_pending) {
+			vsession = CTX_current_session(conn->C);
+			if(vsession->peer_token.str != NULL &&
+					v_compare_addr(&vsession->peer_address, peer_addr) == 1 &&
+					strcmp((char*)negotiate_cmd->value[0].string8.str, vsession->peer_token.str) == 0)
+			{
+				return conn;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief This function receives packets from the shared socket of I/O
+ * thread. Packets of connections handled by other I/O threads are
+ * forwarded to these threads.
+ */
+static void vs_reactor_shared_receive(struct VSReactor *reactor,
+		struct VSReactorConn **closed)
+{
+	struct VS_CTX *vs_ctx = reactor->vs_ctx;
+	struct VDgramBatch *batch = reactor->recv_batch;
+	struct VNetworkAddress *peer_addr;
+	struct VSReactorPeer key;
+	struct VSReactorConn *conn;
+	struct VSReactorPacket *packet;
+	struct VBucket *vbucket;
+	ssize_t size;
+	uint64 one = 1;
+	int i, count, error_num;
+
+	count = v_dgram_batch_receive(batch, reactor->shared_fd,
+			vs_ctx->tcp_io_ctx.host_addr.ip_ver, &error_num);
+
+	for(i = 0; i < count; i++) {
+		peer_addr = &batch->addrs[i];
+		size = batch->sizes[i];
+		if(size == 0) {
+			continue;
+		}
+
+		vs_reactor_peer_key(peer_addr, &key);
+
+		pthread_rwlock_rdlock(&vs_ctx->peers_lock);
+		vbucket = v_hash_array_find_item(&vs_ctx->peers, &key);
+		if(vbucket != NULL) {
+			conn = (struct VSReactorConn*)vbucket->data;
+		} else {
+			conn = vs_reactor_find_pending(reactor, batch->bufs[i], size, peer_addr);
+		}
+
+		if(conn == NULL) {
+			pthread_rwlock_unlock(&vs_ctx->peers_lock);
+			if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
+				v_print_log(VRS_PRINT_DEBUG_MSG, "Packet from unknown client: ");
+				v_print_addr_port(VRS_PRINT_DEBUG_MSG, peer_addr);
+				v_print_log_simple(VRS_PRINT_DEBUG_MSG, "\n");
+			}
+			continue;
+		}
+
+		if(conn->reactor != reactor) {
+			/* Connection can not be freed, until peers_lock is unlocked */
+			packet = (struct VSReactorPacket*)malloc(offsetof(struct VSReactorPacket, buf) + size);
+			if(packet != NULL) {
+				packet->next = NULL;
+				packet->conn = conn;
+				packet->size = size;
+				memcpy(&packet->peer_addr, peer_addr, sizeof(struct VNetworkAddress));
+				memcpy(packet->buf, batch->bufs[i], size);
+				pthread_mutex_lock(&conn->reactor->inbox_mutex);
+				if(conn->reactor->inbox_last != NULL) {
+					conn->reactor->inbox_last->next = packet;
+				} else {
+					conn->reactor->inbox_first = packet;
+				}
+				conn->reactor->inbox_last = packet;
+				pthread_mutex_unlock(&conn->reactor->inbox_mutex);
+				if(write(conn->reactor->event_fd, &one, sizeof(one)) == -1) {
+					v_print_log(VRS_PRINT_ERROR, "write(): %s\n", strerror(errno));
+				}
+			}
+			pthread_rwlock_unlock(&vs_ctx->peers_lock);
+			continue;
+		}
+
+		/* Only this thread could free own connection */
+		pthread_rwlock_unlock(&vs_ctx->peers_lock);
+
+		if(conn->closed == 0 &&
+				vs_reactor_conn_deliver(conn, peer_addr, &batch->bufs[i], size, 1) == 0)
+		{
+			vs_reactor_conn_set_closed(conn, closed);
+		}
+	}
+}
+
+/**
+ * \brief This function handles packets forwarded from other I/O threads.
+ */
+static void vs_reactor_inbox_receive(struct VSReactor *reactor,
+		struct VSReactorConn **closed)
+{
+	struct VSReactorPacket *packet, *packets;
+	uint64 count;
+	char *buf;
+
+	if(read(reactor->event_fd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+		v_print_log(VRS_PRINT_ERROR, "read(): %s\n", strerror(errno));
+	}
+
+	pthread_mutex_lock(&reactor->inbox_mutex);
+	packets = reactor->inbox_first;
+	reactor->inbox_first = NULL;
+	reactor->inbox_last = NULL;
+	pthread_mutex_unlock(&reactor->inbox_mutex);
+
+	while(packets != NULL) {
+		packet = packets;
+		packets = packets->next;
+		buf = packet->buf;
+		if(packet->conn->closed == 0 &&
+				vs_reactor_conn_deliver(packet->conn, &packet->peer_addr, &buf, packet->size, 0) == 0)
+		{
+			vs_reactor_conn_set_closed(packet->conn, closed);
+		}
+		free(packet);
+	}
+}
+
+/**
+ * \brief This function adds stream connection to the list of closed
+ * connections, that are freed, when all events of I/O thread were handled.
+ */
+static void vs_reactor_stream_set_closed(struct VSReactorStream *stream,
+		struct VSReactorStream **closed)
+{
+	if(stream->closed == 0) {
+		stream->closed = 1;
+		stream->next_closed = *closed;
+		*closed = stream;
+	}
+}
+
+/**
+ * \brief This function sets timer of stream connection. Timer expires once
+ * after VRS_TIMEOUT seconds during verse handshake and it expires with
+ * negotiated FPS, when stream connection is used for data exchange.
+ */
+static int vs_reactor_stream_set_timer(struct VSReactorStream *stream)
+{
+	struct VSession *vsession = CTX_current_session(stream->C);
+	struct itimerspec its;
+	long int period;
+
+	if(vsession->stream_conn->host_state == TCP_SERVER_STATE_STREAM_OPEN) {
+		stream->fps = vsession->fps_host;
+		period = (long int)(1000000000.0/stream->fps);
+		its.it_interval.tv_sec = period / 1000000000;
+		its.it_interval.tv_nsec = period % 1000000000;
+		its.it_value = its.it_interval;
+	} else {
+		/* Client has to send something in VRS_TIMEOUT seconds */
+		stream->fps = 0;
+		its.it_interval.tv_sec = 0;
+		its.it_interval.tv_nsec = 0;
+		its.it_value.tv_sec = VRS_TIMEOUT;
+		its.it_value.tv_nsec = 0;
+	}
+
+	if(timerfd_settime(stream->timer_fd, 0, &its, NULL) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "timerfd_settime(): %s\n", strerror(errno));
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function changes events of socket watched by epoll. Socket
+ * has to be writable, when TLS handshake needs to send data.
+ */
+static int vs_reactor_stream_watch(struct VSReactorStream *stream,
+		uint32 events)
+{
+	struct VSession *vsession = CTX_current_session(stream->C);
+	struct epoll_event event;
+
+	if(stream->events == events) {
+		return 1;
+	}
+
+	stream->events = events;
+	event.events = events;
+	event.data.ptr = &stream->sock;
+	if(epoll_ctl(stream->reactor->epoll_fd, EPOLL_CTL_MOD,
+			vsession->stream_conn->io_ctx.sockfd, &event) == -1)
+	{
+		v_print_log(VRS_PRINT_ERROR, "epoll_ctl(): %s\n", strerror(errno));
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function returns 1, when error of reading from non-blocking
+ * stream connection means, that no complete message was received yet.
+ */
+static int vs_reactor_stream_would_block(int error)
+{
+#ifdef WITH_OPENSSL
+	return (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) ? 1 : 0;
+#else
+	return (error == EAGAIN || error == EWOULDBLOCK) ? 1 : 0;
+#endif
+}
+
+/**
+ * \brief This function returns 1, when some received data were already read
+ * from socket, but they were not processed yet (epoll does not report them).
+ */
+static int vs_reactor_stream_pending(struct IO_CTX *io_ctx)
+{
+#ifdef WITH_OPENSSL
+	return (io_ctx->ssl != NULL && SSL_pending(io_ctx->ssl) > 0) ? 1 : 0;
+#else
+	(void)io_ctx;
+	return 0;
+#endif
+}
+
+/**
+ * \brief This function sends commands from outgoing queue of session to the
+ * client, when stream connection is used for data exchange.
+ * \return This function returns 0, when connection should be closed.
+ */
+static int vs_reactor_stream_send(struct VSReactorStream *stream)
+{
+	struct vContext *C = stream->C;
+	struct IO_CTX *io_ctx = CTX_io_ctx(C);
+	int ret, error;
+
+	if( (ret = v_STREAM_pack_message(C)) == 0 ) {
+		return 0;
+	}
+
+	/* Send command to the client */
+	if(ret == 1 && v_tcp_write(io_ctx, &error) <= 0) {
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function receives messages of stream connection. Received
+ * messages are handled as verse handshake or as data exchange, when TCP is
+ * used for data exchange.
+ * \return This function returns 0, when connection should be closed.
+ */
+static int vs_reactor_stream_receive(struct VSReactorStream *stream)
+{
+	struct vContext *C = stream->C;
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
+	struct VSession *vsession = CTX_current_session(C);
+	struct VStreamConn *stream_conn = CTX_current_stream_conn(C);
+	struct IO_CTX *io_ctx = CTX_io_ctx(C);
+	int ret, error;
+
+	do {
+		/* Try to receive data through TCP connection */
+		error = 0;
+		if( v_tcp_read(io_ctx, &error) <= 0 ) {
+			return vs_reactor_stream_would_block(error);
+		}
+
+		if(stream_conn->host_state == TCP_SERVER_STATE_STREAM_OPEN) {
+			if(v_STREAM_handle_messages(C) == 0) {
+				return 0;
+			}
+
+			/* When some payload data were received, then poke data thread */
+			vs_data_session_ready(vs_ctx, vsession);
+
+			if(vs_reactor_stream_send(stream) == 0) {
+				return 0;
+			}
+		} else {
+			/* Handle verse handshake at TCP connection */
+			if( (ret = vs_handle_handshake(C)) == -1) {
+				return 0;
+			}
+
+			/* When there is something to send, then send it to peer */
+			if( ret == 1 && v_tcp_write(io_ctx, &error) <= 0) {
+				return 0;
+			}
+
+			/* Restart timeout or start sending data with FPS */
+			if(vs_reactor_stream_set_timer(stream) == 0) {
+				return 0;
+			}
+		}
+	} while(vs_reactor_stream_pending(io_ctx) == 1);
+
+	/* FPS could be negotiated again */
+	if(stream_conn->host_state == TCP_SERVER_STATE_STREAM_OPEN &&
+			vsession->fps_host != stream->fps)
+	{
+		return vs_reactor_stream_set_timer(stream);
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function prints debug message about start of verse handshake
+ * at stream connection.
+ */
+static void vs_reactor_stream_print_state(void)
+{
+	if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
+		printf("%c[%d;%dm", 27, 1, 31);
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Server TCP state: RESPOND_methods\n");
+		printf("%c[%dm", 27, 0);
+	}
+}
+
+/**
+ * \brief This function handles one event of stream connection.
+ * \return This function returns 0, when connection should be closed.
+ */
+static int vs_reactor_stream_handle(struct VSReactorHandle *handle)
+{
+	struct VSReactorStream *stream = handle->stream;
+	uint64 expirations;
+#ifdef WITH_OPENSSL
+	struct IO_CTX *io_ctx = CTX_io_ctx(stream->C);
+	int ret;
+#endif
+
+	if(handle->type == REACTOR_HANDLE_STREAM_TIMER) {
+		if(read(stream->timer_fd, &expirations, sizeof(expirations)) == -1 &&
+				errno != EAGAIN)
+		{
+			v_print_log(VRS_PRINT_ERROR, "read(): %s\n", strerror(errno));
+			return 0;
+		}
+		if(stream->fps != 0) {
+			return vs_reactor_stream_send(stream);
+		}
+		v_print_log(VRS_PRINT_ERROR, "No response in %d seconds\n", VRS_TIMEOUT);
+		return 0;
+	}
+
+#ifdef WITH_OPENSSL
+	/* Try to continue in TLS handshake with client */
+	if(stream->tls == 1) {
+		if( (ret = vs_TLS_accept(stream->C)) == 0) {
+			return 0;
+		} else if(ret == -1) {
+			return vs_reactor_stream_watch(stream,
+					SSL_want_write(io_ctx->ssl) ? EPOLLOUT : EPOLLIN);
+		}
+
+		stream->tls = 0;
+		vs_reactor_stream_print_state();
+
+		if(vs_reactor_stream_watch(stream, EPOLLIN) == 0) {
+			return 0;
+		}
+		if(vs_reactor_stream_pending(io_ctx) == 0) {
+			return 1;
+		}
+	}
+#endif
+
+	return vs_reactor_stream_receive(stream);
+}
+
+/**
+ * \brief This function removes stream connection from I/O thread and closes
+ * it. Session is released immediately, when datagram connection of session
+ * was closed. Otherwise it is released after closing datagram connection.
+ */
+static void vs_reactor_stream_close(struct VSReactorStream *stream)
+{
+	struct VSReactor *reactor = stream->reactor;
+	struct VS_CTX *vs_ctx = reactor->vs_ctx;
+	struct VSession *vsession = CTX_current_session(stream->C);
+
+	epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, vsession->stream_conn->io_ctx.sockfd, NULL);
+	epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, stream->timer_fd, NULL);
+	close(stream->timer_fd);
+
+	/* Close socket and free messages */
+	vs_tcp_conn_closing(stream->C);
+
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	if(stream->prev != NULL) {
+		stream->prev->next = stream->next;
+	} else {
+		reactor->streams = stream->next;
+	}
+	if(stream->next != NULL) {
+		stream->next->prev = stream->prev;
+	}
+	reactor->stream_count--;
+	if(vsession->udp_thread == 0 && vsession->io_handle != NULL) {
+		/* I/O thread closing datagram connection will free this connection */
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Waiting for closing connection by I/O thread ...\n");
+		stream->waiting = 1;
+		pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+		return;
+	}
+	vsession->stream_handle = NULL;
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	/* DTLS connections are not handled by I/O threads */
+	vs_reactor_stream_free(stream, (vsession->udp_thread != 0) ? 1 : 0);
+}
+
+/**
+ * \brief This function is function of I/O thread. It waits for packets
+ * received by datagram connections and for timers of these connections.
+ */
+static void *vs_reactor_loop(void *arg)
+{
+	struct VSReactor *reactor = (struct VSReactor*)arg;
+	struct VS_CTX *vs_ctx = reactor->vs_ctx;
+	struct epoll_event events[IO_THREAD_MAX_EVENTS];
+	struct VSReactorHandle *handle;
+	struct VSReactorConn *closed, *conn;
+	struct VSReactorStream *closed_streams, *stream;
+	int i, count;
+
+	while(vs_ctx->state != SERVER_STATE_CLOSED) {
+		count = epoll_wait(reactor->epoll_fd, events, IO_THREAD_MAX_EVENTS, 1000);
+		if(count == -1) {
+			if(errno == EINTR) {
+				continue;
+			}
+			v_print_log(VRS_PRINT_ERROR, "epoll_wait(): %s\n", strerror(errno));
+			break;
+		}
+
+		/* Connections are freed, when all events were handled, because
+		 * some other event of closed connection could be in the array */
+		closed = NULL;
+		closed_streams = NULL;
+		for(i = 0; i < count; i++) {
+			handle = (struct VSReactorHandle*)events[i].data.ptr;
+			switch(handle->type) {
+			case REACTOR_HANDLE_SHARED:
+				vs_reactor_shared_receive(reactor, &closed);
+				break;
+			case REACTOR_HANDLE_EVENT:
+				vs_reactor_inbox_receive(reactor, &closed);
+				break;
+			case REACTOR_HANDLE_STREAM:
+			case REACTOR_HANDLE_STREAM_TIMER:
+				stream = handle->stream;
+				if(stream->closed == 0 && vs_reactor_stream_handle(handle) == 0) {
+					vs_reactor_stream_set_closed(stream, &closed_streams);
+				}
+				break;
+			default:
+				conn = handle->conn;
+				if(conn->closed == 0 && vs_reactor_conn_handle(handle) == 0) {
+					vs_reactor_conn_set_closed(conn, &closed);
+				}
+				break;
+			}
+		}
+
+		while(closed_streams != NULL) {
+			stream = closed_streams;
+			closed_streams = closed_streams->next_closed;
+			vs_reactor_stream_close(stream);
+		}
+
+		while(closed != NULL) {
+			conn = closed;
+			closed = closed->next_closed;
+			vs_reactor_conn_close(conn);
+		}
+	}
+
+	/* Close all remaining connections */
+	while(reactor->streams != NULL) {
+		vs_reactor_stream_close(reactor->streams);
+	}
+	while(reactor->conns != NULL) {
+		vs_reactor_conn_close(reactor->conns);
+	}
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Exiting I/O thread\n");
+
+	return NULL;
+}
+
+/**
+ * \brief This function adds new datagram connection of session to the I/O
+ * thread with the smallest number of connections.
+ * \param[in]	*C	The copy of verse context used by datagram connection
+ * \return This function returns 1, when connection is handled by I/O thread,
+ * it returns 0, when connection has to be handled by its own thread and it
+ * returns -1, when connection could not be initialized (C is freed).
+ */
+int vs_reactor_add_dgram_conn(struct vContext *C)
+{
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
+	struct VSession *vsession = CTX_current_session(C);
+	struct VSReactor *reactor;
+	struct VSReactorConn *conn;
+	struct epoll_event event;
+	int i;
+
+	if(vs_ctx->reactors == NULL) {
+		return 0;
+	}
+
+	/* DTLS handshake is blocking operation */
+	if(vsession->flags & VRS_SEC_DATA_TLS) {
+		return 0;
+	}
+
+	conn = (struct VSReactorConn*)calloc(1, sizeof(struct VSReactorConn));
+	if(conn == NULL) {
+		goto error;
+	}
+
+	if((conn->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK)) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "timerfd_create(): %s\n", strerror(errno));
+		free(conn);
+		conn = NULL;
+		goto error;
+	}
+
+	/* Choose I/O thread with the smallest number of connections */
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	reactor = &vs_ctx->reactors[0];
+	for(i = 1; i < vs_ctx->io_thread_count; i++) {
+		if(vs_ctx->reactors[i].conn_count < reactor->conn_count) {
+			reactor = &vs_ctx->reactors[i];
+		}
+	}
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	/* Client was told to use shared port during authentication */
+	if(vs_ctx->shared_port != 0) {
+		conn->shared = 1;
+		vsession->dgram_conn->io_ctx.sockfd = reactor->shared_fd;
+		vsession->dgram_conn->io_ctx.flags = SOCKET_SHARED;
+	}
+
+	if(vs_dgram_conn_init(C) != 1) {
+		close(conn->timer_fd);
+		free(conn);
+		vs_dgram_conn_free(C);
+		return -1;
+	}
+
+	conn->C = C;
+	conn->sock.type = REACTOR_HANDLE_SOCKET;
+	conn->sock.conn = conn;
+	conn->timer.type = REACTOR_HANDLE_TIMER;
+	conn->timer.conn = conn;
+	vs_reactor_conn_set_timer(conn);
+
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	conn->reactor = reactor;
+	conn->next = reactor->conns;
+	if(reactor->conns != NULL) {
+		reactor->conns->prev = conn;
+	}
+	reactor->conns = conn;
+	reactor->conn_count++;
+	vsession->io_handle = conn;
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	/* I/O thread could start handling connection now */
+	event.events = EPOLLIN;
+	event.data.ptr = &conn->timer;
+	epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, conn->timer_fd, &event);
+
+	if(conn->shared == 1) {
+		/* Wait for first packet with negotiated token */
+		pthread_rwlock_wrlock(&vs_ctx->peers_lock);
+		conn->pending = 1;
+		conn->next_pending = vs_ctx->pending_conns;
+		if(vs_ctx->pending_conns != NULL) {
+			vs_ctx->pending_conns->prev_pending = conn;
+		}
+		vs_ctx->pending_conns = conn;
+		pthread_rwlock_unlock(&vs_ctx->peers_lock);
+	} else {
+		event.events = EPOLLIN;
+		event.data.ptr = &conn->sock;
+		epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, vsession->dgram_conn->io_ctx.sockfd, &event);
+	}
+
+	return 1;
+
+error:
+	/* Connection could not be handled by own thread, when client uses
+	 * shared port */
+	if(vs_ctx->shared_port != 0) {
+		free(C);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * \brief This function waits until datagram connection of session handled by
+ * I/O thread is closed.
+ */
+void vs_reactor_wait_dgram_conn(struct VS_CTX *vs_ctx, struct VSession *vsession)
+{
+	if(vs_ctx->reactors == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	while(vsession->io_handle != NULL) {
+		pthread_cond_wait(&vs_ctx->reactor_cond, &vs_ctx->reactor_mutex);
+	}
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+}
+
+/**
+ * \brief This function adds new stream connection of session to the I/O
+ * thread with the smallest number of connections. TLS and verse handshake
+ * are done by I/O thread and TCP could be used for data exchange too.
+ * \param[in]	*C	The copy of verse context used by stream connection
+ * \return This function returns 1, when connection is handled by I/O thread,
+ * it returns 0, when connection has to be handled by its own thread and it
+ * returns -1, when connection could not be initialized (connection is closed
+ * and C is freed).
+ */
+int vs_reactor_add_stream_conn(struct vContext *C)
+{
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
+	struct VSession *vsession = CTX_current_session(C);
+	struct IO_CTX *io_ctx = CTX_io_ctx(C);
+	struct VSReactor *reactor;
+	struct VSReactorStream *stream;
+	struct epoll_event event;
+	int i, flag;
+
+	if(vs_ctx->reactors == NULL) {
+		return 0;
+	}
+
+	stream = (struct VSReactorStream*)calloc(1, sizeof(struct VSReactorStream));
+	if(stream == NULL) {
+		return 0;
+	}
+
+	if((stream->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK)) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "timerfd_create(): %s\n", strerror(errno));
+		free(stream);
+		return 0;
+	}
+
+	stream->C = C;
+	stream->sock.type = REACTOR_HANDLE_STREAM;
+	stream->sock.stream = stream;
+	stream->timer.type = REACTOR_HANDLE_STREAM_TIMER;
+	stream->timer.stream = stream;
+
+	/* I/O thread must not be blocked by socket */
+	flag = fcntl(io_ctx->sockfd, F_GETFL, 0);
+	if(fcntl(io_ctx->sockfd, F_SETFL, flag | O_NONBLOCK) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "fcntl(): %s\n", strerror(errno));
+		goto error;
+	}
+
+	if(vs_tcp_conn_init(C) != 1) {
+		goto error;
+	}
+
+#ifdef WITH_OPENSSL
+	/* TLS handshake is done, when client sends data */
+	if(vs_TLS_setup(C) != 1) {
+		goto error;
+	}
+	stream->tls = 1;
+#else
+	vs_reactor_stream_print_state();
+#endif
+
+	if(vs_reactor_stream_set_timer(stream) != 1) {
+		goto error;
+	}
+
+	/* Choose I/O thread with the smallest number of connections */
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	reactor = &vs_ctx->reactors[0];
+	for(i = 1; i < vs_ctx->io_thread_count; i++) {
+		if(vs_ctx->reactors[i].conn_count + vs_ctx->reactors[i].stream_count <
+				reactor->conn_count + reactor->stream_count) {
+			reactor = &vs_ctx->reactors[i];
+		}
+	}
+	stream->reactor = reactor;
+	stream->next = reactor->streams;
+	if(reactor->streams != NULL) {
+		reactor->streams->prev = stream;
+	}
+	reactor->streams = stream;
+	reactor->stream_count++;
+	vsession->stream_handle = stream;
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	/* I/O thread could start handling connection now */
+	event.events = EPOLLIN;
+	event.data.ptr = &stream->timer;
+	epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, stream->timer_fd, &event);
+
+	stream->events = EPOLLIN;
+	event.events = EPOLLIN;
+	event.data.ptr = &stream->sock;
+	epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, io_ctx->sockfd, &event);
+
+	return 1;
+
+error:
+	close(stream->timer_fd);
+	free(stream);
+	/* Session could be used for other client */
+	vs_tcp_conn_closing(C);
+	vs_tcp_conn_free(C);
+	return -1;
+}
+
+/**
+ * \brief This function creates socket bound to the shared port. Each I/O
+ * thread has own socket and kernel distributes packets of clients between
+ * these sockets.
+ * \return This function returns descriptor of socket or -1 on error.
+ */
+static int vs_reactor_shared_socket(struct VS_CTX *vs_ctx)
+{
+	struct sockaddr_in addr4;
+	struct sockaddr_in6 addr6;
+	int sockfd, flag;
+
+	if(vs_ctx->tcp_io_ctx.host_addr.ip_ver == IPV4) {
+		sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	} else {
+		sockfd = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	}
+	if(sockfd == -1) {
+		v_print_log(VRS_PRINT_ERROR, "socket(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	flag = fcntl(sockfd, F_GETFL, 0);
+	if(fcntl(sockfd, F_SETFL, flag | O_NONBLOCK) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "fcntl(): %s\n", strerror(errno));
+		goto error;
+	}
+
+	flag = 1;
+	if(setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, (const void*)&flag, sizeof(flag)) != 0) {
+		v_print_log(VRS_PRINT_ERROR, "setsockopt(): %s\n", strerror(errno));
+		goto error;
+	}
+
+#ifdef SO_REUSEPORT
+	if(vs_ctx->io_thread_count > 1 &&
+			setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, (const void*)&flag, sizeof(flag)) != 0) {
+		v_print_log(VRS_PRINT_ERROR, "setsockopt(): %s\n", strerror(errno));
+		goto error;
+	}
+#endif
+
+	if(vs_ctx->tcp_io_ctx.host_addr.ip_ver == IPV4) {
+		memset(&addr4, 0, sizeof(addr4));
+		addr4.sin_family = AF_INET;
+		addr4.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr4.sin_port = htons(vs_ctx->shared_port);
+		if(bind(sockfd, (struct sockaddr*)&addr4, sizeof(addr4)) == -1) {
+			v_print_log(VRS_PRINT_ERROR, "bind(): %s\n", strerror(errno));
+			goto error;
+		}
+	} else {
+		memset(&addr6, 0, sizeof(addr6));
+		addr6.sin6_family = AF_INET6;
+		addr6.sin6_addr = in6addr_any;
+		addr6.sin6_port = htons(vs_ctx->shared_port);
+		if(bind(sockfd, (struct sockaddr*)&addr6, sizeof(addr6)) == -1) {
+			v_print_log(VRS_PRINT_ERROR, "bind(): %s\n", strerror(errno));
+			goto error;
+		}
+	}
+
+	return sockfd;
+
+error:
+	close(sockfd);
+	return -1;
+}
+
+/**
+ * \brief This function creates shared socket, buffer and event descriptor
+ * of I/O thread and it registers them in epoll.
+ */
+static int vs_reactor_shared_init(struct VSReactor *reactor)
+{
+	struct epoll_event event;
+
+	if((reactor->shared_fd = vs_reactor_shared_socket(reactor->vs_ctx)) == -1) {
+		return 0;
+	}
+
+	if((reactor->event_fd = eventfd(0, EFD_NONBLOCK)) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "eventfd(): %s\n", strerror(errno));
+		return 0;
+	}
+
+	reactor->peek_packet = (struct VPacket*)malloc(sizeof(struct VPacket));
+	if(reactor->peek_packet == NULL) {
+		return 0;
+	}
+
+	reactor->shared.type = REACTOR_HANDLE_SHARED;
+	reactor->shared.conn = NULL;
+	event.events = EPOLLIN;
+	event.data.ptr = &reactor->shared;
+	if(epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->shared_fd, &event) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "epoll_ctl(): %s\n", strerror(errno));
+		return 0;
+	}
+
+	reactor->event.type = REACTOR_HANDLE_EVENT;
+	reactor->event.conn = NULL;
+	event.events = EPOLLIN;
+	event.data.ptr = &reactor->event;
+	if(epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->event_fd, &event) == -1) {
+		v_print_log(VRS_PRINT_ERROR, "epoll_ctl(): %s\n", strerror(errno));
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function frees resources of one I/O thread
+ */
+static void vs_reactor_free(struct VSReactor *reactor)
+{
+	struct VSReactorPacket *packet;
+
+	while(reactor->inbox_first != NULL) {
+		packet = reactor->inbox_first;
+		reactor->inbox_first = packet->next;
+		free(packet);
+	}
+	pthread_mutex_destroy(&reactor->inbox_mutex);
+
+	if(reactor->shared_fd != -1) {
+		close(reactor->shared_fd);
+	}
+	if(reactor->event_fd != -1) {
+		close(reactor->event_fd);
+	}
+	if(reactor->recv_batch != NULL) {
+		v_dgram_batch_destroy(reactor->recv_batch);
+	}
+	if(reactor->peek_packet != NULL) {
+		free(reactor->peek_packet);
+	}
+	close(reactor->epoll_fd);
+}
+
+/**
+ * \brief This function creates I/O threads. The number of threads is equal
+ * to the number of processors, when it is not configured. When shared port
+ * is configured, then each I/O thread has own socket bound to this port.
+ * \return This function returns 1, when I/O threads were created.
+ */
+int vs_reactor_init(struct VS_CTX *vs_ctx)
+{
+	struct VSReactor *reactor;
+	int i, j, count, initialized;
+
+	if(vs_ctx->io_thread_count == 0) {
+		long int cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+		vs_ctx->io_thread_count = (cpu_count > 0) ?
+				((cpu_count < MAX_IO_THREADS) ? cpu_count : MAX_IO_THREADS) : 1;
+	}
+
+	pthread_mutex_init(&vs_ctx->reactor_mutex, NULL);
+	pthread_cond_init(&vs_ctx->reactor_cond, NULL);
+	vs_ctx->stream_frees = 0;
+	pthread_rwlock_init(&vs_ctx->peers_lock, NULL);
+	v_hash_array_init(&vs_ctx->peers,
+			HASH_MOD_65536,
+			offsetof(VSReactorConn, peer),
+			sizeof(struct VSReactorPeer));
+	vs_ctx->pending_conns = NULL;
+
+	vs_ctx->reactors = (struct VSReactor*)calloc(vs_ctx->io_thread_count,
+			sizeof(struct VSReactor));
+	if(vs_ctx->reactors == NULL) {
+		vs_ctx->shared_port = 0;
+		return 0;
+	}
+
+	for(i = 0; i < vs_ctx->io_thread_count; i++) {
+		reactor = &vs_ctx->reactors[i];
+		reactor->vs_ctx = vs_ctx;
+		reactor->conns = NULL;
+		reactor->conn_count = 0;
+		reactor->streams = NULL;
+		reactor->stream_count = 0;
+		reactor->shared_fd = -1;
+		reactor->event_fd = -1;
+		pthread_mutex_init(&reactor->inbox_mutex, NULL);
+		if((reactor->epoll_fd = epoll_create1(0)) == -1) {
+			v_print_log(VRS_PRINT_ERROR, "epoll_create1(): %s\n", strerror(errno));
+			pthread_mutex_destroy(&reactor->inbox_mutex);
+			break;
+		}
+		reactor->recv_batch = v_dgram_batch_create(vs_ctx->dgram_batch, MAX_PACKET_SIZE);
+		if(reactor->recv_batch == NULL) {
+			vs_reactor_free(reactor);
+			break;
+		}
+		if(vs_ctx->shared_port != 0 && vs_reactor_shared_init(reactor) != 1) {
+			vs_reactor_free(reactor);
+			break;
+		}
+	}
+
+	initialized = count = i;
+
+	/* All I/O threads have to be able to receive packets at shared port */
+	if(count < vs_ctx->io_thread_count && vs_ctx->shared_port != 0) {
+		v_print_log(VRS_PRINT_ERROR, "Could not use shared UDP port: %d\n",
+				vs_ctx->shared_port);
+		count = 0;
+	}
+
+	for(j = 0; j < count; j++) {
+		reactor = &vs_ctx->reactors[j];
+		if(pthread_create(&reactor->thread, NULL, vs_reactor_loop, (void*)reactor) != 0) {
+			v_print_log(VRS_PRINT_ERROR, "pthread_create(): %s\n", strerror(errno));
+			break;
+		}
+	}
+
+	/* Use only I/O threads, that were created */
+	for(i = j; i < initialized; i++) {
+		vs_reactor_free(&vs_ctx->reactors[i]);
+	}
+	vs_ctx->io_thread_count = j;
+	if(vs_ctx->io_thread_count == 0) {
+		free(vs_ctx->reactors);
+		vs_ctx->reactors = NULL;
+		vs_ctx->shared_port = 0;
+		return 0;
+	}
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Created %d I/O threads\n",
+			vs_ctx->io_thread_count);
+	if(vs_ctx->shared_port != 0) {
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Datagram connections use shared UDP port: %d\n",
+				vs_ctx->shared_port);
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function joins I/O threads. It has to be called, when server
+ * is in CLOSED state.
+ */
+void vs_reactor_destroy(struct VS_CTX *vs_ctx)
+{
+	int i;
+
+	if(vs_ctx->reactors == NULL) {
+		return;
+	}
+
+	for(i = 0; i < vs_ctx->io_thread_count; i++) {
+		pthread_join(vs_ctx->reactors[i].thread, NULL);
+	}
+
+	/* Wait for threads freeing closed stream connections */
+	pthread_mutex_lock(&vs_ctx->reactor_mutex);
+	while(vs_ctx->stream_frees > 0) {
+		pthread_cond_wait(&vs_ctx->reactor_cond, &vs_ctx->reactor_mutex);
+	}
+	pthread_mutex_unlock(&vs_ctx->reactor_mutex);
+
+	for(i = 0; i < vs_ctx->io_thread_count; i++) {
+		vs_reactor_free(&vs_ctx->reactors[i]);
+	}
+
+	free(vs_ctx->reactors);
+	vs_ctx->reactors = NULL;
+
+	v_hash_array_destroy(&vs_ctx->peers);
+	pthread_rwlock_destroy(&vs_ctx->peers_lock);
+	pthread_cond_destroy(&vs_ctx->reactor_cond);
+	pthread_mutex_destroy(&vs_ctx->reactor_mutex);
+}
+
+#else
+
+/* Other platforms use only threads of sessions */
+
+int vs_reactor_init(struct VS_CTX *vs_ctx)
+{
+	v_print_log(VRS_PRINT_WARNING, "I/O threads are supported only at Linux\n");
+	vs_ctx->reactors = NULL;
+	vs_ctx->shared_port = 0;
+	return 0;
+}
+
+void vs_reactor_destroy(struct VS_CTX *vs_ctx)
+{
+	(void)vs_ctx;
+}
+
+int vs_reactor_add_dgram_conn(struct vContext *C)
+{
+	(void)C;
+	return 0;
+}
+
+void vs_reactor_wait_dgram_conn(struct VS_CTX *vs_ctx, struct VSession *vsession)
+{
+	(void)vs_ctx;
+	(void)vsession;
+}
+
+int vs_reactor_add_stream_conn(struct vContext *C)
+{
+	(void)C;
+	return 0;
+}
+
+#endif
@@ -34,6 +34,7 @@
 #include "vs_node.h"
 #include "vs_node_access.h"
 #include "vs_taggroup.h"
+#include "vs_entity.h"
 
 /**
  * \brief This function add any TagSet command to the queue of outgoing commands
@@ -695,7 +696,7 @@ int vs_handle_tag_set(struct VS_CTX *vs_ctx,
 	struct VSNode				*node;
 	struct VSTagGroup			*tg;
 	struct VSTag				*tag;
-	struct VSEntitySubscriber	*tg_subscriber;
+	struct Generic_Cmd			*tag_set_cmd;
 	uint32 						node_id;
 	uint16 						taggroup_id;
 	uint16						tag_id;
@@ -812,13 +813,16 @@ int vs_handle_tag_set(struct VS_CTX *vs_ctx,
 
 	vs_taggroup_inc_version(tg);
 
-	/* Send this tag to all client subscribed to the TagGroup */
-	tg_subscriber = tg->tg_subs.first;
-	while(tg_subscriber != NULL) {
-		if(vs_tag_send_set(tg_subscriber->node_sub->session, tg_subscriber->node_sub->prio, node, tg, tag) != 1) {
+	/* Send this tag to all client subscribed to the TagGroup. One command is
+	 * shared by outgoing queues of all subscribers. */
+	if(tg->tg_subs.first != NULL) {
+		tag_set_cmd = v_tag_set_create(node->id, tg->id, tag->id,
+				tag->data_type, tag->count, tag->value);
+		if(tag_set_cmd == NULL ||
+				vs_entity_send_cmd(&tg->tg_subs, &tag_set_cmd) != 1)
+		{
 			ret = 0;
 		}
-		tg_subscriber = tg_subscriber->next;
 	}
 
 end:
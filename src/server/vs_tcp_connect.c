@@ -51,11 +51,13 @@
 #include "vs_main.h"
 #include "vs_tcp_connect.h"
 #include "vs_udp_connect.h"
+#include "vs_reactor.h"
 #include "vs_auth_pam.h"
 #include "vs_auth_csv.h"
 #include "vs_node.h"
 #include "vs_handshake.h"
 #include "vs_sys_nodes.h"
+#include "vs_data.h"
 
 #include "v_common.h"
 #include "v_pack.h"
@@ -81,21 +83,15 @@ static void vs_init_stream_conn(struct VStreamConn *stream_conn)
 
 
 /**
- * \brief Main function for new thread. This thread is created for new
- * connection with client. This thread will try to authenticate new user
- * and negotiate new udp port. */
-void *vs_tcp_conn_loop(void *arg)
+ * \brief This function prepares new stream connection for verse handshake.
+ * It gets size of TCP buffer and it allocates messages used by connection.
+ * \return This function returns 1 on success, otherwise it returns 0.
+ */
+int vs_tcp_conn_init(struct vContext *C)
 {
-	struct vContext *C = (struct vContext*)arg;
-	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
-	struct VSession *vsession = CTX_current_session(C);
 	struct IO_CTX *io_ctx = CTX_io_ctx(C);
 	struct VStreamConn *stream_conn = CTX_current_stream_conn(C);
-	struct VMessage *r_message=NULL, *s_message=NULL;
-	struct timeval tv;
-	fd_set set;
-	int error, ret;
-	void *udp_thread_result;
+	struct VMessage *r_message, *s_message;
 	unsigned int int_size;
 
 	/* Try to get size of TCP buffer */
@@ -104,76 +100,33 @@ void *vs_tcp_conn_loop(void *arg)
 			(void *)&stream_conn->socket_buffer_size, &int_size) != 0 )
 	{
 		v_print_log(VRS_PRINT_ERROR, "getsockopt(): %s\n", strerror(errno));
-		goto end;
+		return 0;
 	}
 
-#ifdef WITH_OPENSSL
-	/* Try to do TLS handshake with client */
-	if(vs_TLS_handshake(C) != 1) {
-		goto end;
-	}
-#endif
-
 	r_message = (struct VMessage*)calloc(1, sizeof(struct VMessage));
 	s_message = (struct VMessage*)calloc(1, sizeof(struct VMessage));
 
 	if(r_message == NULL || s_message == NULL) {
 		v_print_log(VRS_PRINT_ERROR, "Out of memory\n");
-		goto end;
+		if(r_message != NULL) free(r_message);
+		if(s_message != NULL) free(s_message);
+		return 0;
 	}
 
 	CTX_r_message_set(C, r_message);
 	CTX_s_message_set(C, s_message);
 
-	stream_conn->host_state = TCP_SERVER_STATE_RESPOND_METHODS;
-
-	if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
-		printf("%c[%d;%dm", 27, 1, 31);
-		v_print_log(VRS_PRINT_DEBUG_MSG, "Server TCP state: RESPOND_methods\n");
-		printf("%c[%dm", 27, 0);
-	}
-
-	/* "Never ending" loop */
-	while(1)
-	{
-		FD_ZERO(&set);
-		FD_SET(io_ctx->sockfd, &set);
-
-		tv.tv_sec = VRS_TIMEOUT;	/* User have to send something in 30 seconds */
-		tv.tv_usec = 0;
-
-		if( (ret = select(io_ctx->sockfd+1, &set, NULL, NULL, &tv)) == -1) {
-			if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "%s:%s():%d select(): %s\n",
-					__FILE__, __FUNCTION__,  __LINE__, strerror(errno));
-			goto end;
-			/* Was event on the listen socket */
-		} else if(ret>0 && FD_ISSET(io_ctx->sockfd, &set)) {
-
-			/* Try to receive data through TCP connection */
-			if( v_tcp_read(io_ctx, &error) <= 0 ) {
-				goto end;
-			}
-
-			/* Handle verse handshake at TCP connection */
-			if( (ret = vs_handle_handshake(C)) == -1) {
-				goto end;
-			}
-
-			/* When there is something to send, then send it to peer */
-			if( ret == 1 ) {
-				/* Send response message to the client */
-				if( (ret = v_tcp_write(io_ctx, &error)) <= 0) {
-					goto end;
-				}
-			}
+	return 1;
+}
 
-		} else {
-			if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "No response in %d seconds\n", VRS_TIMEOUT);
-			goto end;
-		}
-	}
+/**
+ * \brief This function closes stream connection. The session can not be used
+ * for other client, until vs_tcp_conn_free() is called.
+ */
+void vs_tcp_conn_closing(struct vContext *C)
+{
+	struct VStreamConn *stream_conn = CTX_current_stream_conn(C);
 
-end:
 	if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
 		printf("%c[%d;%dm", 27, 1, 31);
 		v_print_log(VRS_PRINT_DEBUG_MSG, "Server TCP state: CLOSING\n");
@@ -184,14 +137,12 @@ end:
 	vs_CLOSING(C);
 
 	/* Receive and Send messages are not necessary any more */
-	if(r_message != NULL) {
-		free(r_message);
-		r_message = NULL;
+	if(CTX_r_message(C) != NULL) {
+		free(CTX_r_message(C));
 		CTX_r_message_set(C, NULL);
 	}
-	if(s_message != NULL) {
-		free(s_message);
-		s_message = NULL;
+	if(CTX_s_message(C) != NULL) {
+		free(CTX_s_message(C));
 		CTX_s_message_set(C, NULL);
 	}
 
@@ -208,29 +159,27 @@ end:
 		v_print_log(VRS_PRINT_DEBUG_MSG, "Server TCP state: CLOSED\n");
 		printf("%c[%dm", 27, 0);
 	}
+}
 
-	/* Was udp thread created? */
-#ifdef WIN32
-	if(vsession->udp_thread.p != 0 ) {
-#else
-	if(vsession->udp_thread != 0) {
-#endif
-		/* Wait for UDP thread (this is blocking operation) */
-		v_print_log(VRS_PRINT_DEBUG_MSG, "Waiting for join with UDP thread ...\n");
-		if(pthread_join(vsession->udp_thread, &udp_thread_result) != 0) {
-			v_print_log(VRS_PRINT_DEBUG_MSG, "UDP thread was not joined\n");
-		}
-	}
+/**
+ * \brief This function frees data of closed session and it frees the context
+ * of stream connection. It has to be called, when datagram connection of
+ * session is closed. The session could be used for new client since now.
+ */
+void vs_tcp_conn_free(struct vContext *C)
+{
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
+	struct VSession *vsession = CTX_current_session(C);
+
+	/* Commands of this session must not be handled, when session is reused */
+	vs_data_session_close(vs_ctx, vsession);
 
-	pthread_mutex_lock(&vs_ctx->data.mutex);
+	pthread_rwlock_wrlock(&vs_ctx->data.lock);
 	/* Unsubscribe this session (this avatar) from all nodes */
 	vs_node_free_avatar_reference(vs_ctx, vsession);
 	/* Try to destroy avatar node */
 	vs_node_destroy_avatar_node(vs_ctx, vsession);
-	pthread_mutex_unlock(&vs_ctx->data.mutex);
-
-	/* This session could be used again for authentication */
-	stream_conn->host_state = TCP_SERVER_STATE_LISTEN;
+	pthread_rwlock_unlock(&vs_ctx->data.lock);
 
 	/* Clear session flags */
 	vsession->flags = 0;
@@ -252,6 +201,9 @@ end:
 		vsession->client_version = NULL;
 	}
 
+	/* This session could be used again for authentication */
+	vsession->stream_conn->host_state = TCP_SERVER_STATE_LISTEN;
+
 	if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
 		printf("%c[%d;%dm", 27, 1, 31);
 		v_print_log(VRS_PRINT_DEBUG_MSG, "Server TCP state: LISTEN\n");
@@ -259,6 +211,120 @@ end:
 	}
 
 	free(C);
+}
+
+/**
+ * \brief This function waits for end of UDP thread of session (this is
+ * blocking operation).
+ */
+void vs_tcp_conn_join_dgram(struct vContext *C)
+{
+	struct VSession *vsession = CTX_current_session(C);
+	void *udp_thread_result;
+
+	v_print_log(VRS_PRINT_DEBUG_MSG, "Waiting for join with UDP thread ...\n");
+	if(pthread_join(vsession->udp_thread, &udp_thread_result) != 0) {
+		v_print_log(VRS_PRINT_DEBUG_MSG, "UDP thread was not joined\n");
+	}
+#ifdef WIN32
+	vsession->udp_thread.p = NULL;
+	vsession->udp_thread.x = 0;
+#else
+	vsession->udp_thread = 0;
+#endif
+}
+
+/**
+ * \brief Main function for new thread. This thread is created for new
+ * connection with client. This thread will try to authenticate new user
+ * and negotiate new udp port. */
+void *vs_tcp_conn_loop(void *arg)
+{
+	struct vContext *C = (struct vContext*)arg;
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
+	struct VSession *vsession = CTX_current_session(C);
+	struct IO_CTX *io_ctx = CTX_io_ctx(C);
+	struct VStreamConn *stream_conn = CTX_current_stream_conn(C);
+	struct timeval tv;
+	fd_set set;
+	int error, ret;
+
+	if(vs_tcp_conn_init(C) != 1) {
+		goto end;
+	}
+
+#ifdef WITH_OPENSSL
+	/* Try to do TLS handshake with client */
+	if(vs_TLS_handshake(C) != 1) {
+		goto end;
+	}
+#endif
+
+	stream_conn->host_state = TCP_SERVER_STATE_RESPOND_METHODS;
+
+	if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
+		printf("%c[%d;%dm", 27, 1, 31);
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Server TCP state: RESPOND_methods\n");
+		printf("%c[%dm", 27, 0);
+	}
+
+	/* "Never ending" loop */
+	while(1)
+	{
+		FD_ZERO(&set);
+		FD_SET(io_ctx->sockfd, &set);
+
+		tv.tv_sec = VRS_TIMEOUT;	/* User have to send something in 30 seconds */
+		tv.tv_usec = 0;
+
+		if( (ret = select(io_ctx->sockfd+1, &set, NULL, NULL, &tv)) == -1) {
+			if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "%s:%s():%d select(): %s\n",
+					__FILE__, __FUNCTION__,  __LINE__, strerror(errno));
+			goto end;
+			/* Was event on the listen socket */
+		} else if(ret>0 && FD_ISSET(io_ctx->sockfd, &set)) {
+
+			/* Try to receive data through TCP connection */
+			if( v_tcp_read(io_ctx, &error) <= 0 ) {
+				goto end;
+			}
+
+			/* Handle verse handshake at TCP connection */
+			if( (ret = vs_handle_handshake(C)) == -1) {
+				goto end;
+			}
+
+			/* When there is something to send, then send it to peer */
+			if( ret == 1 ) {
+				/* Send response message to the client */
+				if( (ret = v_tcp_write(io_ctx, &error)) <= 0) {
+					goto end;
+				}
+			}
+
+		} else {
+			if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "No response in %d seconds\n", VRS_TIMEOUT);
+			goto end;
+		}
+	}
+
+end:
+	vs_tcp_conn_closing(C);
+
+	/* Was udp thread created? */
+#ifdef WIN32
+	if(vsession->udp_thread.p != 0 ) {
+#else
+	if(vsession->udp_thread != 0) {
+#endif
+		vs_tcp_conn_join_dgram(C);
+	} else if(vsession->io_handle != NULL) {
+		/* Wait for I/O thread closing datagram connection */
+		v_print_log(VRS_PRINT_DEBUG_MSG, "Waiting for closing connection by I/O thread ...\n");
+		vs_reactor_wait_dgram_conn(vs_ctx, vsession);
+	}
+
+	vs_tcp_conn_free(C);
 	C = NULL;
 
 	pthread_exit(NULL);
@@ -347,6 +413,23 @@ static int vs_new_stream_conn(struct vContext *C, void *(*conn_loop)(void*))
 			v_print_log_simple(VRS_PRINT_DEBUG_MSG, "\n");
 		}
 
+		/* Plain TCP connection could be handled by I/O thread. WebSocket
+		 * connections are still handled by own threads. */
+		if(conn_loop == vs_tcp_conn_loop) {
+			new_C = (struct vContext*)calloc(1, sizeof(struct vContext));
+			if(new_C == NULL) {
+				return 0;
+			}
+			memcpy(new_C, C, sizeof(struct vContext));
+
+			if((ret = vs_reactor_add_stream_conn(new_C)) != 0) {
+				return (ret == 1) ? 1 : 0;
+			}
+
+			free(new_C);
+			new_C = NULL;
+		}
+
 		/* Try to initialize thread attributes */
 		if( (ret = pthread_attr_init(&current_session->tcp_thread_attr)) !=0 ) {
 			v_print_log(VRS_PRINT_ERROR, "pthread_attr_init(): %s\n", strerror(errno));
@@ -863,6 +946,9 @@ static int vs_init_sessions(VS_CTX *vs_ctx)
 		/* Set up input and output queues */
 		vs_ctx->vsessions[i]->in_queue = (struct VInQueue*)calloc(1, sizeof(VInQueue));
 		v_in_queue_init(vs_ctx->vsessions[i]->in_queue, vs_ctx->in_queue_max_size);
+		if(vs_ctx->in_queue_cmd_views == 1) {
+			vs_ctx->vsessions[i]->in_queue->flags |= IN_QUEUE_CMD_VIEWS;
+		}
 		vs_ctx->vsessions[i]->out_queue = (struct VOutQueue*)calloc(1, sizeof(VOutQueue));
 		v_out_queue_init(vs_ctx->vsessions[i]->out_queue, vs_ctx->out_queue_max_size);
 		/* Allocate memory for TCP connection */
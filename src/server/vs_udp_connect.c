@@ -53,6 +53,7 @@ typedef USHORT in_port_t;
 
 #include "vs_main.h"
 #include "vs_udp_connect.h"
+#include "vs_data.h"
 
 #include "v_context.h"
 #include "v_network.h"
@@ -207,6 +208,22 @@ int vs_send_packet(struct vContext *C)
 
 /************************************** LISTEN state **************************************/
 
+/**
+ * \brief This function returns 1, when method of Congestion Control is
+ * implemented and it is allowed in configuration of server.
+ */
+static int vs_cc_meth_allowed(struct VS_CTX *vs_ctx, uint8 cc_meth)
+{
+	if(cc_meth < 8 &&
+			(vs_ctx->cc_meth & CC_MASK(cc_meth)) &&
+			v_cc_get_ops(cc_meth) != NULL)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
 /**
  * \brief This function checks received Change_L system commands, when system
  * command is wrong, then this function returns 0 value; otherwise it returns 1.
@@ -240,8 +257,8 @@ static int vs_LISTEN_CHANGE_L_cb(struct vContext *C, struct Generic_Cmd *cmd)
 			/* This could not be never send */
 			if(change_l_cmd->value[value_rank].uint8 == CC_RESERVED) {
 				break;
-			/* TODO: better implementation: server could have list of supported CC methods */
-			} else if(change_l_cmd->value[value_rank].uint8 == vs_ctx->cc_meth) {
+			/* Use the first method proposed by client, that is allowed at server */
+			} else if(vs_cc_meth_allowed(vs_ctx, change_l_cmd->value[value_rank].uint8) == 1) {
 				/* It will try to use first found supported method, but ... */
 				if(dgram_conn->cc_meth == CC_RESERVED) {
 					/* Congestion Control has not been proposed yet */
@@ -299,6 +316,20 @@ static int vs_LISTEN_CHANGE_L_cb(struct vContext *C, struct Generic_Cmd *cmd)
 		}
 	}
 
+	/* Client wants to send padded PMTU probes */
+	if(change_l_cmd->feature == FTR_PMTU_PROBE) {
+		for(value_rank=0; value_rank<change_l_cmd->count; value_rank++) {
+			if(change_l_cmd->value[value_rank].uint8 == PMTU_PROBE_NONE ||
+					change_l_cmd->value[value_rank].uint8 == PMTU_PROBE_PADDED)
+			{
+				dgram_conn->peer_pmtu_probe = change_l_cmd->value[value_rank].uint8;
+				break;
+			}
+		}
+		/* Unsupported probes are not confirmed and client will not send them */
+		return 1;
+	}
+
 	/* Received command is unknown. Ignore it. */
 	return 1;
 }
@@ -321,7 +352,7 @@ static int	vs_LISTEN_CHANGE_R_cb(struct vContext *C, struct Generic_Cmd *cmd)
 			/* This could not be never send */
 			if(change_r_cmd->value[value_rank].uint8 == CC_RESERVED) {
 				break;
-			} else if(change_r_cmd->value[value_rank].uint8 == vs_ctx->cc_meth) { /* TODO: better implementation */
+			} else if(vs_cc_meth_allowed(vs_ctx, change_r_cmd->value[value_rank].uint8) == 1) {
 				/* It will try to use first found supported method, but ... */
 				if(dgram_conn->cc_meth == CC_RESERVED) {
 					/* Congestion Control has not been proposed yet */
@@ -369,6 +400,19 @@ static int	vs_LISTEN_CHANGE_R_cb(struct vContext *C, struct Generic_Cmd *cmd)
 		}
 	}
 
+	/* Client is able to receive padded PMTU probes */
+	if(change_r_cmd->feature == FTR_PMTU_PROBE) {
+		for(value_rank=0; value_rank<change_r_cmd->count; value_rank++) {
+			if(change_r_cmd->value[value_rank].uint8 == PMTU_PROBE_NONE ||
+					change_r_cmd->value[value_rank].uint8 == PMTU_PROBE_PADDED)
+			{
+				dgram_conn->host_pmtu_probe = change_r_cmd->value[value_rank].uint8;
+				break;
+			}
+		}
+		return 1;
+	}
+
 	return 1;
 }
 
@@ -510,6 +554,17 @@ static void vs_LISTEN_init_send_packet(struct vContext *C)
 		}
 	}
 
+	/* Send confirmation of PMTU probes. Clients, that did not propose them,
+	 * would not understand padding of probes, thus server never proposes
+	 * them itself. */
+	if(dgram_conn->host_pmtu_probe != PMTU_PROBE_RESERVED) {
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CONFIRM_R_ID, FTR_PMTU_PROBE, &dgram_conn->host_pmtu_probe, NULL);
+	}
+	if(dgram_conn->peer_pmtu_probe != PMTU_PROBE_RESERVED) {
+		cmd_rank += v_add_negotiate_cmd(s_packet->sys_cmd, cmd_rank,
+				CMD_CONFIRM_L_ID, FTR_PMTU_PROBE, &dgram_conn->peer_pmtu_probe, NULL);
+	}
 }
 
 /* Handle received packet, when server is in LISTEN state */
@@ -704,8 +759,10 @@ static void vs_RESPOND_init(struct vContext *C)
 	dgram_conn->peer_id = r_packet->header.payload_id;
 
 	/* When unsecured connection is used, then "connect" server to the client
-	 * after first phase of handshake */
-	if(!(dgram_conn->flags & SOCKET_SECURED)) {
+	 * after first phase of handshake. Shared socket receives packets of
+	 * many clients and it could not be connected. */
+	if(!(dgram_conn->flags & SOCKET_SECURED) &&
+			!(io_ctx->flags & SOCKET_SHARED)) {
 		/* When handshake is finished, then do connect */
 		if(io_ctx->peer_addr.ip_ver == IPV4) {
 			ret = connect(io_ctx->sockfd, (struct sockaddr*)&io_ctx->peer_addr.addr.ipv4, sizeof(io_ctx->peer_addr.addr.ipv4));
@@ -828,9 +885,9 @@ static int vs_RESPOND_handle_packet(struct vContext *C)
 
 static void vs_OPEN_init(struct vContext *C)
 {
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
 	struct VDgramConn *dgram_conn = CTX_current_dgram_conn(C);
 	struct VPacket *r_packet = CTX_r_packet(C);
-	struct Ack_Nak_Cmd ack_cmd;
 	struct timeval tv;
 	int ret;
 
@@ -842,6 +899,9 @@ static void vs_OPEN_init(struct vContext *C)
 	dgram_conn->state[UDP_SERVER_STATE_OPEN].tv_state_began.tv_sec = tv.tv_sec;
 	dgram_conn->state[UDP_SERVER_STATE_OPEN].tv_state_began.tv_usec = tv.tv_usec;
 
+	/* Payload packets are paced or sent at tick of FPS */
+	dgram_conn->cc.pacing = vs_ctx->dgram_pacing;
+
 #ifdef WITH_OPENSSL
 	/* Try to get MTU from the bio */
 	ret = BIO_ctrl(dgram_conn->io_ctx.bio, BIO_CTRL_DGRAM_QUERY_MTU, 0, NULL);
@@ -857,10 +917,14 @@ static void vs_OPEN_init(struct vContext *C)
 	dgram_conn->io_ctx.mtu = DEFAULT_MTU;
 #endif
 
-	/* Add ACK command to the list of ACK NAK commands to be send to the peer */
-	ack_cmd.id = CMD_ACK_ID;
-	ack_cmd.pay_id = r_packet->header.payload_id;
-	v_ack_nak_history_add_cmd(&dgram_conn->ack_nak, &ack_cmd);
+	/* Search for bigger MTU, when path allows it and client confirmed, that
+	 * it is able to receive padded probes */
+	v_pmtud_init(dgram_conn, (dgram_conn->host_pmtu_probe == PMTU_PROBE_PADDED) ?
+			v_dgram_pmtud_enable(&dgram_conn->io_ctx) : 0);
+
+	/* Add ID of received packet to the list of ACK NAK commands to be send
+	 * to the peer */
+	v_ack_nak_history_add_id(&dgram_conn->ack_nak, r_packet->header.payload_id);
 
 	if(is_log_level(VRS_PRINT_DEBUG_MSG)) {
 		printf("%c[%d;%dm", 27, 1, 31);
@@ -871,12 +935,32 @@ static void vs_OPEN_init(struct vContext *C)
 
 static int vs_OPEN_CLOSEREQ_send_packet(struct vContext *C)
 {
-	int ret;
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
+	struct VDgramConn *dgram_conn = CTX_current_dgram_conn(C);
+	struct IO_CTX *io_ctx = CTX_io_ctx(C);
+	int ret, error_num;
+
+	/* DTLS packets could not be sent in batch. Slots of batch are big
+	 * enough for packets of MTU found by PMTU discovery. */
+	if(io_ctx->batch == NULL &&
+			vs_ctx->dgram_batch > 1 &&
+			!(io_ctx->flags & SOCKET_SECURED))
+	{
+		io_ctx->batch = v_dgram_batch_create(vs_ctx->dgram_batch,
+				(dgram_conn->pmtud.state != PMTUD_DISABLED) ? dgram_conn->pmtud.max_mtu : io_ctx->mtu);
+		if(io_ctx->batch != NULL && vs_ctx->dgram_offload == 1) {
+			io_ctx->batch->gso = v_dgram_gso_enable(io_ctx->sockfd);
+		}
+	}
 
-	/* Send as much packets as needed or possible */
+	/* Send as much packets as needed or possible. All full packets allowed
+	 * by windows are sent with one system call. */
+	v_dgram_batch_begin(io_ctx);
 	do {
 		ret = send_packet_in_OPEN_CLOSEREQ_state(C);
 	} while (!(ret == SEND_PACKET_CANCELED || ret == SEND_PACKET_SUCCESS));
+	v_dgram_batch_end(io_ctx, &error_num);
+
 	return ret;
 }
 
@@ -947,7 +1031,7 @@ static int vs_OPEN_CLOSEREQ_handle_packet(struct vContext *C)
 
 		/* When some payload data were received, then poke data thread */
 		if( (vs_ctx != NULL) && (r_packet->data != NULL)) {
-			sem_post(vs_ctx->data.sem);
+			vs_data_session_ready(vs_ctx, CTX_current_session(C));
 		}
 
 		/* Call callback functions for system commands */
@@ -1395,30 +1479,33 @@ static int vs_init_dgram_ctx(struct vContext *C)
 /************************************** MAIN loop **************************************/
 
 /**
- * \brief Main UDP thread. This thread waits for connection from client. It
- * expects connection from certain IP address and client has to send negotiated
- * token in its REQUEST state.
- * \param[in]	*arg	The void pointer is pointer at copy of Verse context.
- * \return		This thread does not return any usefull information now.
+ * \brief This function initializes datagram connection of session. It creates
+ * socket of connection and switches connection to LISTEN state.
+ * \param[in]	*C	The verse context of new datagram connection
+ * \return This function returns 1, when connection was initialized and it
+ * returns 0 otherwise.
  */
-void *vs_main_dgram_loop(void *arg)
+int vs_dgram_conn_init(struct vContext *C)
 {
-	struct vContext *C = (struct vContext*)arg;
 	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
 	struct VSession *vsession = CTX_current_session(C);
-	struct VDgramConn *dgram_conn=vsession->dgram_conn;
-	struct VPacket *r_packet=NULL, *s_packet=NULL;
-	struct timeval tv;
-	fd_set set;
-	int i, j, ret, error_num;
+	struct VDgramConn *dgram_conn = vsession->dgram_conn;
+	struct VPacket *r_packet, *s_packet;
+
+	/* Copy of verse context could include packets of stream connection */
+	CTX_r_packet_set(C, NULL);
+	CTX_s_packet_set(C, NULL);
 
 	/* Set up datagram connection */
 	CTX_current_dgram_conn_set(C, dgram_conn);
 
 	/* Copy version of IP from Verse server context */
 	dgram_conn->io_ctx.host_addr.ip_ver = vs_ctx->tcp_io_ctx.host_addr.ip_ver;
-	if (vs_init_dgram_ctx(C) != 1) {
-		goto end;
+	if(dgram_conn->io_ctx.flags & SOCKET_SHARED) {
+		/* Shared socket was already created by I/O thread */
+		dgram_conn->io_ctx.host_addr.protocol = UDP;
+	} else if (vs_init_dgram_ctx(C) != 1) {
+		return 0;
 	}
 
 	/* Set up IO CTX */
@@ -1427,7 +1514,7 @@ void *vs_main_dgram_loop(void *arg)
 #if (defined WITH_OPENSSL) && OPENSSL_VERSION_NUMBER>=0x10000000
 	if(vsession->flags & VRS_SEC_DATA_TLS) {
 		if( vs_init_dtls_connection(C) == 0) {
-			goto end;
+			return 0;
 		}
 		/*dgram_conn->io_ctx.mtu -= 100;*/
 		dgram_conn->flags |= SOCKET_SECURED;
@@ -1451,6 +1538,250 @@ void *vs_main_dgram_loop(void *arg)
 
 	vs_LISTEN_init(C);
 
+	return 1;
+}
+
+/**
+ * \brief This function handles packet stored in the buffer of IO_CTX of
+ * datagram connection according state of connection.
+ * \param[in]	*C	The verse context of datagram connection
+ * \return This function returns 1, when connection should continue and it
+ * returns 2, when client exceeded number of attempts and new DTLS hello is
+ * expected.
+ */
+int vs_dgram_conn_handle(struct vContext *C)
+{
+	struct VSession *vsession = CTX_current_session(C);
+	struct VDgramConn *dgram_conn = vsession->dgram_conn;
+	struct VPacket *r_packet = CTX_r_packet(C);
+	struct timeval tv;
+	int ret = RECEIVE_PACKET_ERROR;
+
+	/* Check if the packet is from the authenticated client */
+	if((dgram_conn->io_ctx.flags & SOCKET_CONNECTED) ||
+			v_compare_addr(&vsession->peer_address, &dgram_conn->io_ctx.peer_addr)==1) {
+
+		/* Get time of receiving packet */
+		gettimeofday(&tv, NULL);
+
+		/* Handle packet according state of connection */
+		switch(dgram_conn->host_state) {
+		case UDP_SERVER_STATE_LISTEN:
+			ret = vs_handle_packet(C, vs_LISTEN_handle_packet);
+			break;
+		case UDP_SERVER_STATE_RESPOND:
+			ret = vs_handle_packet(C, vs_RESPOND_handle_packet);
+			break;
+		case UDP_SERVER_STATE_OPEN:
+			ret = vs_handle_packet(C, vs_OPEN_CLOSEREQ_handle_packet);
+			break;
+		case UDP_SERVER_STATE_CLOSEREQ:
+			ret = vs_handle_packet(C, vs_OPEN_CLOSEREQ_handle_packet);
+			break;
+		case UDP_SERVER_STATE_CLOSED:
+			ret = vs_handle_packet(C, vs_CLOSED_handle_packet);
+			break;
+		default:
+			break;
+		}
+
+		/* Update time of last receiving payload packet for
+		 * current connection */
+		if(r_packet->header.flags & PAY_FLAG) {
+			dgram_conn->tv_pay_recv.tv_sec = tv.tv_sec;
+			dgram_conn->tv_pay_recv.tv_usec = tv.tv_usec;
+		}
+
+		/* Handle returned values */
+		switch(ret) {
+		case RECEIVE_PACKET_ATTEMPTS_EXCEED:
+			return 2;
+		case RECEIVE_PACKET_CORRUPTED:
+			if(dgram_conn->host_state == UDP_SERVER_STATE_LISTEN)
+				vs_LISTEN_init(C);
+			break;
+		default:
+			break;
+		}
+	} else {
+		if(is_log_level(VRS_PRINT_WARNING)) {
+			v_print_log(VRS_PRINT_WARNING, "Client sent packet from wrong address: ");
+			v_print_addr(VRS_PRINT_WARNING, &dgram_conn->io_ctx.peer_addr);
+			v_print_log_simple(VRS_PRINT_WARNING, " != ");
+			v_print_addr(VRS_PRINT_WARNING, &vsession->peer_address);
+			v_print_log_simple(VRS_PRINT_WARNING, "\n");
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function receives one packet from the socket of datagram
+ * connection and it handles the packet according state of connection.
+ * \param[in]	*C	The verse context of datagram connection
+ * \return This function returns 1, when connection should continue, it
+ * returns 0, when connection should be closed and it returns 2, when
+ * client exceeded number of attempts and new DTLS hello is expected.
+ */
+int vs_dgram_conn_receive(struct vContext *C)
+{
+	struct VSession *vsession = CTX_current_session(C);
+	struct VDgramConn *dgram_conn = vsession->dgram_conn;
+	int ret, error_num;
+
+	/* Try to receive packet */
+	ret = v_receive_packet(&dgram_conn->io_ctx, &error_num);
+
+	/* If receiving of packet was successful, then process the packet */
+	if((ret==1) && (dgram_conn->io_ctx.buf_size > 0)) {
+		return vs_dgram_conn_handle(C);
+	} else {
+		if(error_num == ECONNREFUSED) {
+			v_print_log(VRS_PRINT_WARNING, "Closing connection ...\n");
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function does periodic work of datagram connection. It sends
+ * payload packets with negotiated FPS and it checks timeouts of connection.
+ * It is called after each received packet and each timeout.
+ * \param[in]	*C	The verse context of datagram connection
+ * \return This function returns 1, when connection should continue and it
+ * returns 0, when connection should be closed.
+ */
+int vs_dgram_conn_update(struct vContext *C)
+{
+	struct VSession *vsession = CTX_current_session(C);
+	struct VDgramConn *dgram_conn = vsession->dgram_conn;
+	struct timeval tv;
+
+#if (defined WITH_OPENSSL) && OPENSSL_VERSION_NUMBER>=0x10000000
+	/* Did client close DTLS connection? */
+	if(vsession->flags & VRS_SEC_DATA_TLS) {
+		if((SSL_get_shutdown(dgram_conn->io_ctx.ssl) & SSL_RECEIVED_SHUTDOWN)) {
+			vs_destroy_dtls_connection(C);
+			return 0;
+		}
+	}
+#endif
+
+	gettimeofday(&tv, NULL);
+
+	/* Check if token is still fresh */
+	if(dgram_conn->host_state == UDP_SERVER_STATE_LISTEN &&
+			(tv.tv_sec - vsession->peer_token.tv.tv_sec) > VRS_TIMEOUT) {
+		v_print_log(VRS_PRINT_ERROR, "Token timed out\n");
+		return 0;
+	}
+
+	if(dgram_conn->host_state != UDP_SERVER_STATE_LISTEN) {
+
+		/* Verse server has to try to send payload packets with negotiated FPSs */
+		if(dgram_conn->host_state == UDP_SERVER_STATE_OPEN) {
+			vs_OPEN_CLOSEREQ_send_packet(C);
+		} else {
+			/* When client is too long in the handshake or teardown
+			 * state, then terminate connection. */
+			if((tv.tv_sec - dgram_conn->state[dgram_conn->host_state].tv_state_began.tv_sec) >= VRS_TIMEOUT) {
+				v_print_log(VRS_PRINT_DEBUG_MSG, "Connection timed out\n");
+				return 0;
+			}
+		}
+
+		/* When no valid packet received from client for defined time, then consider this
+		 * connection as dead and free it */
+		if((tv.tv_sec - dgram_conn->tv_pay_recv.tv_sec) >= VRS_TIMEOUT) {
+			v_print_log(VRS_PRINT_DEBUG_MSG, "Connection timed out\n");
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * \brief This function returns time in microseconds, when pacer of datagram
+ * connection allows sending of next payload packet.
+ * \param[in]	*C	The verse context of datagram connection
+ * \return This function returns -1, when no payload packet is held by pacer.
+ */
+long int vs_dgram_conn_pacing_delay(struct vContext *C)
+{
+	struct VSession *vsession = CTX_current_session(C);
+
+	if(vsession->dgram_conn->host_state != UDP_SERVER_STATE_OPEN) {
+		return -1;
+	}
+
+	return pacing_delay_in_OPEN_CLOSEREQ_state(C);
+}
+
+/**
+ * \brief This function frees datagram connection of session, port used by
+ * this connection and the verse context of connection.
+ * \param[in]	*C	The verse context of datagram connection
+ */
+void vs_dgram_conn_free(struct vContext *C)
+{
+	struct VS_CTX *vs_ctx = CTX_server_ctx(C);
+	struct VSession *vsession = CTX_current_session(C);
+	struct VDgramConn *dgram_conn = vsession->dgram_conn;
+	int i, j;
+
+	if(dgram_conn->io_ctx.flags & SOCKET_SHARED) {
+		/* Shared socket is closed by I/O thread */
+		dgram_conn->io_ctx.sockfd = -1;
+		dgram_conn->io_ctx.flags = 0;
+	} else {
+		/* Free port used by datagram connection */
+		for(i=vs_ctx->port_low, j=0; i<vs_ctx->port_high; i++, j++) {
+			if(dgram_conn->io_ctx.host_addr.port == vs_ctx->port_list[j].port_number) {
+				v_print_log(VRS_PRINT_DEBUG_MSG, "Free port: %d\n", vs_ctx->port_list[j].port_number);
+				vs_ctx->port_list[j].aggregation--;
+				break;
+			}
+		}
+	}
+
+	/* Clear this datagram connection for other session */
+	vs_clear_vconn(dgram_conn);
+
+	if(CTX_r_packet(C) != NULL) {
+		free(CTX_r_packet(C));
+	}
+	if(CTX_s_packet(C) != NULL) {
+		free(CTX_s_packet(C));
+	}
+
+	free(C);
+}
+
+/**
+ * \brief Main UDP thread. This thread waits for connection from client. It
+ * expects connection from certain IP address and client has to send negotiated
+ * token in its REQUEST state.
+ * \param[in]	*arg	The void pointer is pointer at copy of Verse context.
+ * \return		This thread does not return any usefull information now.
+ */
+void *vs_main_dgram_loop(void *arg)
+{
+	struct vContext *C = (struct vContext*)arg;
+	struct VSession *vsession = CTX_current_session(C);
+	struct VDgramConn *dgram_conn=vsession->dgram_conn;
+	struct timeval tv;
+	fd_set set;
+	long int pacing_delay;
+	int ret;
+
+	if(vs_dgram_conn_init(C) != 1) {
+		goto end;
+	}
+
 hello:
 #if (defined WITH_OPENSSL) && OPENSSL_VERSION_NUMBER>=0x10000000
 	/* Wait for DTLS Hello Command from client */
@@ -1557,15 +1888,6 @@ again:
 
 	/* "Never ending" listen loop */
 	while(1) {
-		gettimeofday(&tv, NULL);
-
-		/* Check if token is still fresh */
-		if(dgram_conn->host_state == UDP_SERVER_STATE_LISTEN &&
-				(tv.tv_sec - vsession->peer_token.tv.tv_sec) > VRS_TIMEOUT) {
-			v_print_log(VRS_PRINT_ERROR, "Token timed out\n");
-			goto end;
-		}
-
 		/* Initialize set */
 		FD_ZERO(&set);
 		FD_SET(dgram_conn->io_ctx.sockfd, &set);
@@ -1574,6 +1896,13 @@ again:
 		tv.tv_sec = 1/vsession->fps_host;			/* Seconds */
 		tv.tv_usec = 1000000/vsession->fps_host;	/* Microseconds */
 
+		/* Wake up earlier, when pacer holds next payload packet */
+		pacing_delay = vs_dgram_conn_pacing_delay(C);
+		if(pacing_delay >= 0 && pacing_delay < 1000000*tv.tv_sec + tv.tv_usec) {
+			tv.tv_sec = pacing_delay / 1000000;
+			tv.tv_usec = pacing_delay % 1000000;
+		}
+
 		/* Wait for event on socket sockfd */
 		if( (ret = select(dgram_conn->io_ctx.sockfd+1, &set, NULL, NULL, &tv)) == -1 ) {
 			if(is_log_level(VRS_PRINT_ERROR)) v_print_log(VRS_PRINT_ERROR, "%s:%s():%d select(): %s\n",  __FILE__, __FUNCTION__,  __LINE__, strerror(errno));
@@ -1581,130 +1910,21 @@ again:
 		}
 		/* Check if the event occurred on sockfd */
 		else if(ret>0 && FD_ISSET(dgram_conn->io_ctx.sockfd, &set)) {
-
-			/* Try to receive packet */
-			ret = v_receive_packet(&dgram_conn->io_ctx, &error_num);
-
-			/* If receiving of packet was successful, then process the packet */
-			if((ret==1) && (dgram_conn->io_ctx.buf_size > 0)) {
-
-				/* Check if the packet is from the authenticated client */
-				if((dgram_conn->io_ctx.flags & SOCKET_CONNECTED) ||
-						v_compare_addr(&vsession->peer_address, &dgram_conn->io_ctx.peer_addr)==1) {
-
-					/* Get time of receiving packet */
-					gettimeofday(&tv, NULL);
-
-					/* Handle packet according state of connection */
-					switch(dgram_conn->host_state) {
-					case UDP_SERVER_STATE_LISTEN:
-						ret = vs_handle_packet(C, vs_LISTEN_handle_packet);
-						break;
-					case UDP_SERVER_STATE_RESPOND:
-						ret = vs_handle_packet(C, vs_RESPOND_handle_packet);
-						break;
-					case UDP_SERVER_STATE_OPEN:
-						ret = vs_handle_packet(C, vs_OPEN_CLOSEREQ_handle_packet);
-						break;
-					case UDP_SERVER_STATE_CLOSEREQ:
-						ret = vs_handle_packet(C, vs_OPEN_CLOSEREQ_handle_packet);
-						break;
-					case UDP_SERVER_STATE_CLOSED:
-						ret = vs_handle_packet(C, vs_CLOSED_handle_packet);
-						break;
-					default:
-						break;
-					}
-
-					/* Update time of last receiving payload packet for
-					 * current connection */
-					if(r_packet->header.flags & PAY_FLAG) {
-						dgram_conn->tv_pay_recv.tv_sec = tv.tv_sec;
-						dgram_conn->tv_pay_recv.tv_usec = tv.tv_usec;
-					}
-
-					/* Handle returned values */
-					switch(ret) {
-					case RECEIVE_PACKET_ATTEMPTS_EXCEED:
-						goto hello;
-						break;
-					case RECEIVE_PACKET_CORRUPTED:
-						if(dgram_conn->host_state == UDP_SERVER_STATE_LISTEN)
-							vs_LISTEN_init(C);
-						break;
-					default:
-						break;
-					}
-				} else {
-					if(is_log_level(VRS_PRINT_WARNING)) {
-						v_print_log(VRS_PRINT_WARNING, "Client sent packet from wrong address: ");
-						v_print_addr(VRS_PRINT_WARNING, &dgram_conn->io_ctx.peer_addr);
-						v_print_log_simple(VRS_PRINT_WARNING, " != ");
-						v_print_addr(VRS_PRINT_WARNING, &vsession->peer_address);
-						v_print_log_simple(VRS_PRINT_WARNING, "\n");
-					}
-				}
-			} else {
-				if(error_num == ECONNREFUSED) {
-					v_print_log(VRS_PRINT_WARNING, "Closing connection ...\n");
-					break;
-				}
-			}
-		}
-
-#if (defined WITH_OPENSSL) && OPENSSL_VERSION_NUMBER>=0x10000000
-		/* Did client close DTLS connection? */
-		if(vsession->flags & VRS_SEC_DATA_TLS) {
-			if((SSL_get_shutdown(dgram_conn->io_ctx.ssl) & SSL_RECEIVED_SHUTDOWN)) {
-				vs_destroy_dtls_connection(C);
+			ret = vs_dgram_conn_receive(C);
+			if(ret == 0) {
 				break;
+			} else if(ret == 2) {
+				goto hello;
 			}
 		}
-#endif
-
-		gettimeofday(&tv, NULL);
-		if(dgram_conn->host_state != UDP_SERVER_STATE_LISTEN) {
-
-			/* Verse server has to try to send payload packets with negotiated FPSs */
-			if(dgram_conn->host_state == UDP_SERVER_STATE_OPEN) {
-				vs_OPEN_CLOSEREQ_send_packet(C);
-			} else {
-				/* When client is too long in the handshake or teardown
-				 * state, then terminate connection. */
-				if((tv.tv_sec - dgram_conn->state[dgram_conn->host_state].tv_state_began.tv_sec) >= VRS_TIMEOUT) {
-					v_print_log(VRS_PRINT_DEBUG_MSG, "Connection timed out\n");
-					break;
-				}
-			}
 
-			/* When no valid packet received from client for defined time, then consider this
-			 * connection as dead and free it */
-			if((tv.tv_sec - dgram_conn->tv_pay_recv.tv_sec) >= VRS_TIMEOUT) {
-				v_print_log(VRS_PRINT_DEBUG_MSG, "Connection timed out\n");
-				break;
-			}
-
-		}
-	}
-
-end:
-
-	/* Free port used by datagram connection */
-	for(i=vs_ctx->port_low, j=0; i<vs_ctx->port_high; i++, j++) {
-		if(dgram_conn->io_ctx.host_addr.port == vs_ctx->port_list[j].port_number) {
-			v_print_log(VRS_PRINT_DEBUG_MSG, "Free port: %d\n", vs_ctx->port_list[j].port_number);
-			vs_ctx->port_list[j].aggregation--;
+		if(vs_dgram_conn_update(C) == 0) {
 			break;
 		}
 	}
 
-	/* Clear this datagram connection for other session */
-	vs_clear_vconn(dgram_conn);
-
-	free(r_packet);
-	free(s_packet);
-
-	free(C);
+end:
+	vs_dgram_conn_free(C);
 
 	pthread_exit(NULL);
 
@@ -41,6 +41,7 @@
 #include "vs_main.h"
 #include "vs_websocket.h"
 #include "vs_handshake.h"
+#include "vs_data.h"
 #include "vs_sys_nodes.h"
 
 #include "v_stream.h"
@@ -455,6 +456,8 @@ void vs_ws_recv_msg_callback(wslay_event_context_ptr wslay_ctx,
 							13);	/* The length of close message */
 					return;
 				}
+				/* Poke data thread, when some commands were received */
+				vs_data_session_ready(CTX_server_ctx(C), session);
 			} else {
 				if( vs_handle_handshake(C) == -1 ) {
 					/* End connection */
@@ -741,12 +744,15 @@ end:
 	}
 
 
-	pthread_mutex_lock(&vs_ctx->data.mutex);
+	/* Commands of this session must not be handled, when session is reused */
+	vs_data_session_close(vs_ctx, vsession);
+
+	pthread_rwlock_wrlock(&vs_ctx->data.lock);
 	/* Unsubscribe this session (this avatar) from all nodes */
 	vs_node_free_avatar_reference(vs_ctx, vsession);
 	/* Try to destroy avatar node */
 	vs_node_destroy_avatar_node(vs_ctx, vsession);
-	pthread_mutex_unlock(&vs_ctx->data.mutex);
+	pthread_rwlock_unlock(&vs_ctx->data.lock);
 
 	/* This session could be used again for authentication */
 	stream_conn->host_state=TCP_SERVER_STATE_LISTEN;
@@ -0,0 +1,178 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <string.h>
+#include <check.h>
+
+#include "v_network.h"
+#include "v_sys_commands.h"
+#include "v_history.h"
+
+/**
+ * \brief This function checks, that system commands are equal to the
+ * expected sequence of ACK (positive ID) and NAK (negative ID) commands
+ */
+static int check_cmds(VSystemCommands *sys_cmds, int count,
+		const int *expected, int expected_count)
+{
+	int i;
+
+	if(count != expected_count) {
+		return 0;
+	}
+
+	for(i = 0; i < count; i++) {
+		if(expected[i] > 0) {
+			if(sys_cmds[i].ack_cmd.id != CMD_ACK_ID ||
+					sys_cmds[i].ack_cmd.pay_id != (uint32)expected[i])
+				return 0;
+		} else {
+			if(sys_cmds[i].nak_cmd.id != CMD_NAK_ID ||
+					sys_cmds[i].nak_cmd.pay_id != (uint32)-expected[i])
+				return 0;
+		}
+	}
+
+	return 1;
+}
+
+START_TEST ( test_Ack_Nak_ranges )
+{
+	struct AckNakHistory history;
+	VSystemCommands sys_cmds[MAX_SYSTEM_COMMAND_COUNT + 1];
+	const int all[] = {1, -6, 9, -11, 12};
+	const int anked[] = {-6, 9, -11, 12};
+	const int gap[] = {-11, 12};
+	const int last[] = {-11, 12, 14};
+	const int cut[] = {1, -6, 9};
+	uint32 pay_id;
+	int count;
+
+	memset(&history, 0, sizeof(history));
+	v_ack_nak_history_init(&history);
+
+	/* Packets 6, 7, 8 and 11 are lost */
+	for(pay_id = 1; pay_id <= 12; pay_id++) {
+		if((pay_id >= 6 && pay_id <= 8) || pay_id == 11)
+			continue;
+		v_ack_nak_history_add_id(&history, pay_id);
+	}
+
+	count = v_ack_nak_history_pack_cmds(&history, sys_cmds, MAX_SYSTEM_COMMAND_COUNT);
+	fail_unless( check_cmds(sys_cmds, count, all, 5) == 1,
+			"Wrong ACK and NAK commands of received packets");
+
+	/* Sequence has to end with ACK command, when there is not enough space */
+	count = v_ack_nak_history_pack_cmds(&history, sys_cmds, 3);
+	fail_unless( check_cmds(sys_cmds, count, cut, 3) == 1,
+			"Wrong ACK and NAK commands, when count is limited");
+
+	/* Peer confirmed commands up to packet 5 */
+	v_ack_nak_history_remove_cmds(&history, 5);
+	count = v_ack_nak_history_pack_cmds(&history, sys_cmds, MAX_SYSTEM_COMMAND_COUNT);
+	fail_unless( check_cmds(sys_cmds, count, anked, 4) == 1,
+			"Lost packets after ANK ID are not in NAK command");
+
+	/* Peer confirmed commands up to packet 10 */
+	v_ack_nak_history_remove_cmds(&history, 10);
+	count = v_ack_nak_history_pack_cmds(&history, sys_cmds, MAX_SYSTEM_COMMAND_COUNT);
+	fail_unless( check_cmds(sys_cmds, count, gap, 2) == 1,
+			"Wrong ACK and NAK commands after removing of range");
+
+	v_ack_nak_history_add_id(&history, 13);
+	v_ack_nak_history_add_id(&history, 14);
+	count = v_ack_nak_history_pack_cmds(&history, sys_cmds, MAX_SYSTEM_COMMAND_COUNT);
+	fail_unless( check_cmds(sys_cmds, count, last, 3) == 1,
+			"Last range was not extended");
+
+	v_ack_nak_history_remove_cmds(&history, 14);
+	fail_unless( history.count == 0, "History is not empty: %d", history.count);
+	fail_unless( v_ack_nak_history_pack_cmds(&history, sys_cmds, MAX_SYSTEM_COMMAND_COUNT) == 0,
+			"Empty history produced commands");
+
+	v_ack_nak_history_clear(&history);
+}
+END_TEST
+
+START_TEST ( test_Ack_Nak_grow )
+{
+	struct AckNakHistory history;
+	VSystemCommands sys_cmds[MAX_SYSTEM_COMMAND_COUNT + 1];
+	uint32 pay_id;
+	int count;
+
+	memset(&history, 0, sizeof(history));
+	v_ack_nak_history_init(&history);
+
+	/* Every other packet is lost, ring of ranges has to grow */
+	for(pay_id = 1; pay_id <= 1000; pay_id += 2) {
+		v_ack_nak_history_add_id(&history, pay_id);
+	}
+	fail_unless( history.count == 500, "Wrong count of ranges: %d", history.count);
+
+	count = v_ack_nak_history_pack_cmds(&history, sys_cmds, MAX_SYSTEM_COMMAND_COUNT - 1);
+	fail_unless( count <= MAX_SYSTEM_COMMAND_COUNT - 1 &&
+			sys_cmds[count - 1].ack_cmd.id == CMD_ACK_ID,
+			"Sequence of commands does not end with ACK command");
+
+	/* Remove ranges in the middle of the ring */
+	v_ack_nak_history_remove_cmds(&history, 501);
+	fail_unless( history.count == 249, "Wrong count of ranges: %d", history.count);
+
+	count = v_ack_nak_history_pack_cmds(&history, sys_cmds, MAX_SYSTEM_COMMAND_COUNT - 1);
+	fail_unless( sys_cmds[0].nak_cmd.id == CMD_NAK_ID && sys_cmds[0].nak_cmd.pay_id == 502 &&
+			sys_cmds[1].ack_cmd.id == CMD_ACK_ID && sys_cmds[1].ack_cmd.pay_id == 503,
+			"Wrong first commands after removing");
+
+	v_ack_nak_history_clear(&history);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for history of ACK and NAK commands
+ */
+struct Suite *ack_nak_suite(void)
+{
+	struct Suite *suite = suite_create("Ack_Nak");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Ack_Nak_ranges);
+	tcase_add_test(tc_core, test_Ack_Nak_grow);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -0,0 +1,294 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "v_commands.h"
+#include "v_cmd_codec.h"
+#include "v_in_queue.h"
+
+#define PACK_BUFFER_SIZE	256
+
+/* Number of commands compressed to one command with shared address */
+#define VIEW_CMD_COUNT		4
+
+extern const struct Cmd_Struct cmd_struct[];
+
+/**
+ * \brief This function creates command with id and it fills its data with
+ * some pattern
+ */
+static struct Generic_Cmd *test_cmd_create(uint8 id)
+{
+	struct Generic_Cmd *cmd = v_cmd_alloc(id);
+	size_t i;
+
+	for(i=0; i < cmd_struct[id].size; i++) {
+		cmd->data[i] = (uint8)(id + i*7);
+	}
+
+	return cmd;
+}
+
+/**
+ * \brief This function packs command directly and it packs the same command
+ * again, when it is shared by more sessions.
+ * \return This function returns 1, when both results are the same.
+ */
+static int test_cmd_pack_shared(uint8 id, uint16 length, uint8 share)
+{
+	struct Generic_Cmd *cmd = test_cmd_create(id), *ref;
+	char direct[PACK_BUFFER_SIZE], shared[PACK_BUFFER_SIZE];
+	int direct_len, shared_len;
+
+	direct_len = v_cmd_pack(direct, cmd, length, share);
+
+	ref = v_cmd_ref(cmd);
+	shared_len = v_cmd_pack(shared, cmd, length, share);
+
+	v_cmd_destroy(&ref);
+	v_cmd_destroy(&cmd);
+
+	return direct_len == shared_len && memcmp(direct, shared, direct_len) == 0;
+}
+
+/**
+ * \brief Encoded items of shared commands have to be the same as items packed
+ * directly for all fixed length node commands and all sizes of shared address.
+ */
+START_TEST ( test_Cmd_Pack_shared )
+{
+	int id, i;
+	uint8 share;
+
+	for(id=MIN_CMD_ID; id <= MAX_CMD_ID; id++) {
+		if( !(cmd_struct[id].flag & NODE_CMD) || (cmd_struct[id].flag & VAR_LEN) ) {
+			continue;
+		}
+
+		fail_unless( test_cmd_pack_shared(id, cmd_struct[id].cmd_size, 0) == 1,
+				"Command %d packed differently", id);
+
+		if( !(cmd_struct[id].flag & SHARE_ADDR) ) {
+			continue;
+		}
+
+		/* Commands piggy-packed with shared address */
+		for(i=0, share=0; i <= cmd_struct[id].key_count; i++) {
+			fail_unless( test_cmd_pack_shared(id, 0, share) == 1,
+					"Command %d with shared address %d packed differently", id, share);
+			if(i < cmd_struct[id].key_count) {
+				share += cmd_struct[id].items[i].size;
+			}
+		}
+	}
+}
+END_TEST
+
+/**
+ * \brief Generated functions have to pack and unpack items of commands in the
+ * same way as interpreted functions.
+ */
+START_TEST ( test_Cmd_Pack_codec )
+{
+	struct Generic_Cmd *cmd, *unpacked;
+	char interp[PACK_BUFFER_SIZE], codec[PACK_BUFFER_SIZE];
+	int id, i, interp_len, codec_len;
+
+	for(id=MIN_CMD_ID; id <= MAX_CMD_ID; id++) {
+		if( !(cmd_struct[id].flag & NODE_CMD) || (cmd_struct[id].flag & VAR_LEN) ) {
+			continue;
+		}
+
+		cmd = test_cmd_create(id);
+
+		for(i=0; i <= cmd_struct[id].key_count; i++) {
+			interp_len = v_cmd_pack_items(interp, cmd, i);
+			codec_len = v_cmd_codec_pack(codec, cmd, i);
+			fail_unless( interp_len == codec_len && memcmp(interp, codec, codec_len) == 0,
+					"Command %d with %d skipped items packed differently", id, i);
+		}
+
+		unpacked = v_cmd_alloc(id);
+		interp_len = v_cmd_pack_items(interp, cmd, 0);
+		fail_unless( v_cmd_codec_unpack(interp, unpacked, 0) == interp_len,
+				"Command %d unpacked with wrong length", id);
+		fail_unless( memcmp(cmd->data, unpacked->data, cmd_struct[id].size) == 0,
+				"Command %d unpacked differently", id);
+
+		v_cmd_destroy(&unpacked);
+		v_cmd_destroy(&cmd);
+	}
+}
+END_TEST
+
+/**
+ * \brief Commands popped from incoming queue have to be the same, when they
+ * are unpacked during receiving and when they are stored as views of received
+ * buffer.
+ */
+START_TEST ( test_Cmd_Unpack_views )
+{
+	struct VInQueue *in_queue;
+	struct Generic_Cmd *cmds[VIEW_CMD_COUNT], *cmd;
+	union VInQueueCmdBuf cmd_buf;
+	char buffer[PACK_BUFFER_SIZE];
+	uint16 length, buffer_pos = 0;
+	uint8 id = CMD_LAYER_SET_VEC3_REAL32, share = UINT32_SIZE + UINT16_SIZE;
+	int i, views;
+
+	/* Commands with the same Node_ID and Layer_ID, but different items */
+	for(i=0; i < VIEW_CMD_COUNT; i++) {
+		cmds[i] = test_cmd_create(id);
+		cmds[i]->data[share] += i;
+	}
+
+	length = 3 + share + VIEW_CMD_COUNT*(cmd_struct[id].size - share);
+	buffer_pos += v_cmd_pack(&buffer[buffer_pos], cmds[0], length, share);
+	for(i=1; i < VIEW_CMD_COUNT; i++) {
+		buffer_pos += v_cmd_pack(&buffer[buffer_pos], cmds[i], 0, share);
+	}
+	fail_unless( buffer_pos == length, "Wrong length of packed commands");
+
+	for(views=0; views <= 1; views++) {
+		in_queue = v_in_queue_create();
+		if(views == 1) {
+			in_queue->flags |= IN_QUEUE_CMD_VIEWS;
+		}
+
+		v_cmd_unpack(buffer, buffer_pos, in_queue);
+		fail_unless( v_in_queue_cmd_count(in_queue) == VIEW_CMD_COUNT,
+				"Wrong count of unpacked commands");
+
+		for(i=0; i < VIEW_CMD_COUNT; i++) {
+			cmd = v_in_queue_pop_buf(in_queue, &cmd_buf);
+			fail_unless( cmd != NULL && cmd->id == id &&
+					memcmp(cmd->data, cmds[i]->data, cmd_struct[id].size) == 0,
+					"Command %d unpacked differently (views: %d)", i, views);
+			fail_unless( (cmd == &cmd_buf.cmd) == views,
+					"Command %d unpacked to wrong buffer (views: %d)", i, views);
+			if(cmd != &cmd_buf.cmd) {
+				v_cmd_destroy(&cmd);
+			}
+		}
+
+		v_in_queue_destroy(&in_queue);
+	}
+
+	for(i=0; i < VIEW_CMD_COUNT; i++) {
+		v_cmd_destroy(&cmds[i]);
+	}
+}
+END_TEST
+
+/**
+ * \brief Received commands with the same address have to replace older
+ * commands waiting in incoming queue, when they are stored as views too.
+ */
+START_TEST ( test_Cmd_Unpack_views_dups )
+{
+	struct VInQueue *in_queue;
+	struct Generic_Cmd *cmds[2], *cmd;
+	union VInQueueCmdBuf cmd_buf;
+	char buffer[PACK_BUFFER_SIZE];
+	uint16 length, buffer_pos = 0;
+	uint8 id = CMD_TAG_SET_UINT8, share = cmd_struct[id].key_size;
+	int i, views;
+
+	/* Commands with the same address, but different values */
+	for(i=0; i < 2; i++) {
+		cmds[i] = test_cmd_create(id);
+		cmds[i]->data[share] += i;
+	}
+
+	length = 3 + share + 2*(cmd_struct[id].size - share);
+	buffer_pos += v_cmd_pack(&buffer[buffer_pos], cmds[0], length, share);
+	buffer_pos += v_cmd_pack(&buffer[buffer_pos], cmds[1], 0, share);
+	fail_unless( buffer_pos == length, "Wrong length of packed commands");
+
+	for(views=0; views <= 1; views++) {
+		in_queue = v_in_queue_create();
+		if(views == 1) {
+			in_queue->flags |= IN_QUEUE_CMD_VIEWS;
+			/* View has to replace also unpacked command */
+			v_in_queue_push(in_queue, test_cmd_create(id));
+		}
+
+		v_cmd_unpack(buffer, buffer_pos, in_queue);
+		fail_unless( v_in_queue_cmd_count(in_queue) == 1,
+				"Wrong count of unpacked commands: %d (views: %d)",
+				v_in_queue_cmd_count(in_queue), views);
+
+		cmd = v_in_queue_pop_buf(in_queue, &cmd_buf);
+		fail_unless( cmd != NULL &&
+				memcmp(cmd->data, cmds[1]->data, cmd_struct[id].size) == 0,
+				"Command was not replaced (views: %d)", views);
+		fail_unless( (cmd == &cmd_buf.cmd) == views,
+				"Command unpacked to wrong buffer (views: %d)", views);
+		if(cmd != &cmd_buf.cmd) {
+			v_cmd_destroy(&cmd);
+		}
+
+		fail_unless( v_in_queue_pop_buf(in_queue, &cmd_buf) == NULL,
+				"Queue is not empty (views: %d)", views);
+
+		v_in_queue_destroy(&in_queue);
+	}
+
+	for(i=0; i < 2; i++) {
+		v_cmd_destroy(&cmds[i]);
+	}
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for packing of commands
+ */
+struct Suite *cmd_pack_suite(void)
+{
+	struct Suite *suite = suite_create("Cmd_Pack");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Cmd_Pack_shared);
+	tcase_add_test(tc_core, test_Cmd_Pack_codec);
+	tcase_add_test(tc_core, test_Cmd_Unpack_views);
+	tcase_add_test(tc_core, test_Cmd_Unpack_views_dups);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
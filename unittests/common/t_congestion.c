@@ -0,0 +1,282 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <string.h>
+#include <check.h>
+
+#include "v_network.h"
+#include "v_sys_commands.h"
+#include "v_history.h"
+#include "v_connection.h"
+#include "v_congestion.h"
+
+#define TEST_MSS	1000
+
+static struct VDgramConn vconn;
+
+/**
+ * \brief This function initializes connection with negotiated method of
+ * Congestion Control
+ */
+static void init_conn(uint8 cc_meth)
+{
+	memset(&vconn, 0, sizeof(struct VDgramConn));
+	vconn.cc_meth = cc_meth;
+	vconn.io_ctx.mtu = TEST_MSS;
+	vconn.host_id = 1;
+	v_cc_init(&vconn);
+}
+
+/**
+ * \brief This function sends packet with next payload ID at time us
+ */
+static void send_packet(struct VSent_Packet *sent_packet, uint64 us)
+{
+	struct timeval tv;
+
+	tv.tv_sec = us / 1000000;
+	tv.tv_usec = us % 1000000;
+	memset(sent_packet, 0, sizeof(struct VSent_Packet));
+	sent_packet->id = vconn.host_id + vconn.count_s_pay;
+	sent_packet->tv = tv;
+	v_cc_packet_sent(&vconn, sent_packet, TEST_MSS, &tv);
+	vconn.count_s_pay++;
+}
+
+/**
+ * \brief This function acknowledges (or loses) sent packet at time us
+ */
+static void recv_ack(struct VSent_Packet *sent_packet, uint64 us, int lost)
+{
+	struct timeval tv;
+
+	tv.tv_sec = us / 1000000;
+	tv.tv_usec = us % 1000000;
+	if(lost == 0) {
+		v_cc_rtt_sample(&vconn,
+				(uint32)(us - ((uint64)sent_packet->tv.tv_sec*1000000 + sent_packet->tv.tv_usec)),
+				&tv);
+		v_cc_packet_acked(&vconn, sent_packet, &tv);
+	} else {
+		v_cc_packet_lost(&vconn, sent_packet, &tv);
+	}
+	/* Packet is removed from history of sent packets */
+	vconn.cc.in_flight -= sent_packet->size;
+}
+
+START_TEST ( test_Congestion_methods )
+{
+	fail_unless( v_cc_get_ops(CC_RESERVED) == NULL,
+			"CC_RESERVED has implementation");
+	fail_unless( v_cc_get_ops(CC_NONE) != NULL &&
+			v_cc_get_ops(CC_CUBIC) != NULL &&
+			v_cc_get_ops(CC_BBR) != NULL,
+			"Congestion Control method is not implemented");
+
+	init_conn(CC_NONE);
+	fail_unless( vconn.cwin == 0xFFFFFFFF && v_cc_pacing_rate(&vconn) == 0,
+			"Connection without Congestion Control is limited");
+
+	/* Unsupported method is replaced with CC_NONE */
+	init_conn(CC_RESERVED);
+	fail_unless( vconn.cc.ops == v_cc_get_ops(CC_NONE),
+			"Unsupported method was not replaced");
+}
+END_TEST
+
+START_TEST ( test_Congestion_cubic )
+{
+	struct VSent_Packet packets[32];
+	uint32 cwin;
+	int i;
+
+	init_conn(CC_CUBIC);
+	fail_unless( vconn.cwin == CC_INIT_CWIN_PACKETS*TEST_MSS,
+			"Wrong initial window: %u", vconn.cwin);
+
+	/* Window is full after sending of initial window */
+	for(i = 0; i < CC_INIT_CWIN_PACKETS; i++) {
+		send_packet(&packets[i], 0);
+	}
+	fail_unless( v_cc_can_send(&vconn) == 0, "Window is not full");
+
+	/* Slow start doubles window in one RTT */
+	for(i = 0; i < CC_INIT_CWIN_PACKETS; i++) {
+		recv_ack(&packets[i], 50000, 0);
+	}
+	fail_unless( vconn.cwin == 2*CC_INIT_CWIN_PACKETS*TEST_MSS,
+			"Wrong window after slow start: %u", vconn.cwin);
+	fail_unless( v_cc_can_send(&vconn) == 1, "Window is full");
+
+	for(i = 0; i < 20; i++) {
+		send_packet(&packets[i], 50000);
+	}
+
+	/* Multiplicative decrease */
+	cwin = vconn.cwin;
+	recv_ack(&packets[0], 100000, 1);
+	fail_unless( vconn.cwin == (uint32)(cwin*CUBIC_BETA) &&
+			vconn.cc.ssthresh == vconn.cwin,
+			"Wrong window after loss: %u", vconn.cwin);
+
+	/* Losses in the same window are one congestion event */
+	cwin = vconn.cwin;
+	recv_ack(&packets[1], 100000, 1);
+	fail_unless( vconn.cwin == cwin, "Second loss decreased window");
+
+	/* Window does not grow in recovery */
+	recv_ack(&packets[2], 100000, 0);
+	fail_unless( vconn.cwin == cwin, "Window grew in recovery");
+
+	/* Packet sent after congestion event finishes recovery */
+	send_packet(&packets[20], 100000);
+	for(i = 3; i < 20; i++) {
+		recv_ack(&packets[i], 100000, 0);
+	}
+	recv_ack(&packets[20], 150000, 0);
+	fail_unless( vconn.cc.in_recovery == 0, "Recovery was not finished");
+
+	/* Expiration of retransmission timer */
+	v_cc_timeout(&vconn, &packets[20].tv);
+	fail_unless( vconn.cwin == TEST_MSS, "Wrong window after timeout: %u", vconn.cwin);
+}
+END_TEST
+
+START_TEST ( test_Congestion_bbr )
+{
+	static struct VSent_Packet packets[64];
+	uint64 us;
+	uint32 rate;
+	int i;
+
+	init_conn(CC_BBR);
+
+	/* Sender sends one packet per millisecond and RTT is 50 ms */
+	for(i = 0; i < 4000; i++) {
+		us = (uint64)i*1000;
+		if(i >= 50) {
+			recv_ack(&packets[(i - 50) % 64], us, 0);
+		}
+		send_packet(&packets[i % 64], us);
+	}
+
+	fail_unless( vconn.cc.alg.bbr.min_rtt == 50000,
+			"Wrong min_rtt: %u", vconn.cc.alg.bbr.min_rtt);
+	fail_unless( vconn.cc.alg.bbr.btl_bw >= 900*TEST_MSS &&
+			vconn.cc.alg.bbr.btl_bw <= 1100*TEST_MSS,
+			"Wrong bottleneck bandwidth: %u", vconn.cc.alg.bbr.btl_bw);
+	fail_unless( vconn.cc.alg.bbr.filled_pipe == 1 &&
+			vconn.cc.alg.bbr.mode == BBR_PROBE_BW,
+			"Wrong mode: %d", vconn.cc.alg.bbr.mode);
+
+	/* Window is 2*BDP and pacing rate oscillates around bandwidth */
+	fail_unless( vconn.cwin >= 100*TEST_MSS && vconn.cwin <= 110*TEST_MSS,
+			"Wrong window: %u", vconn.cwin);
+	rate = v_cc_pacing_rate(&vconn);
+	fail_unless( rate >= 650*TEST_MSS && rate <= 1400*TEST_MSS,
+			"Wrong pacing rate: %u", rate);
+
+	/* Random loss does not decrease window */
+	i = vconn.cwin;
+	send_packet(&packets[0], us);
+	recv_ack(&packets[0], us, 1);
+	fail_unless( vconn.cwin == (uint32)i, "Loss decreased window");
+}
+END_TEST
+
+START_TEST ( test_Congestion_pacing )
+{
+	struct VSent_Packet packets[8];
+	struct timeval tv;
+	uint32 delay;
+	int i;
+
+	/* Pacing rate of slow start is 2*cwin/srtt: 2.5 ms per packet */
+	init_conn(CC_CUBIC);
+	vconn.srtt = 50000;
+	vconn.cc.pacing = 1;
+	fail_unless( v_cc_pacing_rate(&vconn) == 400*TEST_MSS,
+			"Wrong pacing rate: %u", v_cc_pacing_rate(&vconn));
+
+	/* Only burst of packets leaves pacer at once */
+	tv.tv_sec = 0;
+	tv.tv_usec = 0;
+	for(i = 0; i < CC_PACING_BURST_PACKETS; i++) {
+		fail_unless( v_cc_pacing_delay(&vconn, &tv) == 0,
+				"Pacer held packet %d of burst", i);
+		send_packet(&packets[i], 0);
+	}
+	delay = v_cc_pacing_delay(&vconn, &tv);
+	fail_unless( delay == 2500, "Wrong pacing delay: %u", delay);
+
+	tv.tv_usec = delay;
+	fail_unless( v_cc_pacing_delay(&vconn, &tv) == 0,
+			"Pacer held packet after delay");
+
+	/* Idle period does not allow bigger burst */
+	for(i = 0; i < CC_PACING_BURST_PACKETS; i++) {
+		send_packet(&packets[i], 1000000);
+	}
+	tv.tv_sec = 1;
+	tv.tv_usec = 0;
+	fail_unless( v_cc_pacing_delay(&vconn, &tv) == 2500,
+			"Idle period increased burst");
+
+	/* Legacy sending at tick of FPS */
+	vconn.cc.pacing = 0;
+	fail_unless( v_cc_pacing_delay(&vconn, &tv) == 0,
+			"Disabled pacer held packet");
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for Congestion Control
+ */
+struct Suite *congestion_suite(void)
+{
+	struct Suite *suite = suite_create("Congestion");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Congestion_methods);
+	tcase_add_test(tc_core, test_Congestion_cubic);
+	tcase_add_test(tc_core, test_Congestion_bbr);
+	tcase_add_test(tc_core, test_Congestion_pacing);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -0,0 +1,181 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <check.h>
+
+#include "v_list.h"
+
+#define ITEM_COUNT 100000
+
+/* Item with the same key as VSNode has */
+typedef struct HA_Item {
+	uint32	id;
+	uint32	value;
+} HA_Item;
+
+START_TEST ( test_Hash_Array_add_find_remove )
+{
+	struct VHashArrayBase hash_array;
+	struct HA_Item *items, find_item;
+	struct VBucket *vbucket;
+	int i;
+
+	items = (struct HA_Item*)malloc(ITEM_COUNT * sizeof(struct HA_Item));
+
+	v_hash_array_init(&hash_array, HASH_MOD_256,
+			offsetof(HA_Item, id), sizeof(uint32));
+
+	/* Array of slots has to grow several times */
+	for(i=0; i < ITEM_COUNT; i++) {
+		items[i].id = i * 65537;
+		items[i].value = i;
+		vbucket = v_hash_array_add_item(&hash_array, &items[i], sizeof(struct HA_Item));
+		fail_unless( vbucket != NULL && vbucket->data == &items[i],
+				"Item %d not added", i);
+	}
+
+	fail_unless( v_hash_array_count_items(&hash_array) == ITEM_COUNT,
+			"Count of items: %d != %d",
+			v_hash_array_count_items(&hash_array), ITEM_COUNT);
+
+	for(i=0; i < ITEM_COUNT; i++) {
+		find_item.id = i * 65537;
+		vbucket = v_hash_array_find_item(&hash_array, &find_item);
+		fail_unless( vbucket != NULL && vbucket->data == &items[i],
+				"Item %d not found", i);
+	}
+
+	find_item.id = 1;
+	fail_unless( v_hash_array_find_item(&hash_array, &find_item) == NULL,
+			"Not added item found");
+
+	/* Remove every second item */
+	for(i=0; i < ITEM_COUNT; i+=2) {
+		fail_unless( v_hash_array_remove_item(&hash_array, &items[i]) == 1,
+				"Item %d not removed", i);
+	}
+
+	for(i=0; i < ITEM_COUNT; i++) {
+		find_item.id = i * 65537;
+		vbucket = v_hash_array_find_item(&hash_array, &find_item);
+		if(i % 2 == 0) {
+			fail_unless( vbucket == NULL, "Removed item %d found", i);
+		} else {
+			fail_unless( vbucket != NULL && vbucket->data == &items[i],
+					"Item %d not found after removing", i);
+		}
+	}
+
+	fail_unless( v_hash_array_count_items(&hash_array) == ITEM_COUNT/2,
+			"Count of items: %d != %d",
+			v_hash_array_count_items(&hash_array), ITEM_COUNT/2);
+
+	v_hash_array_destroy(&hash_array);
+
+	free(items);
+}
+END_TEST
+
+START_TEST ( test_Hash_Array_duplicities )
+{
+	struct VHashArrayBase hash_array;
+	struct HA_Item items[3];
+	struct VBucket *vbucket;
+	int i;
+
+	v_hash_array_init(&hash_array, HASH_MOD_256,
+			offsetof(HA_Item, id), sizeof(uint32));
+
+	for(i=0; i < 3; i++) {
+		items[i].id = 10000;
+		items[i].value = i;
+		v_hash_array_add_item(&hash_array, &items[i], sizeof(struct HA_Item));
+	}
+
+	/* The oldest item is found first */
+	vbucket = v_hash_array_find_item(&hash_array, &items[2]);
+	fail_unless( vbucket != NULL && vbucket->data == &items[0],
+			"The oldest item with the same key was not found");
+
+	/* The bucket pointing at removed item is removed */
+	fail_unless( v_hash_array_remove_item(&hash_array, &items[1]) == 1,
+			"Item with duplicate key not removed");
+
+	for(vbucket = hash_array.lb.first; vbucket != NULL; vbucket = vbucket->next) {
+		fail_unless( vbucket->data != &items[1],
+				"Wrong bucket removed");
+	}
+
+	fail_unless( v_hash_array_count_items(&hash_array) == 2,
+			"Count of items: %d != 2",
+			v_hash_array_count_items(&hash_array));
+
+	/* Removing of the oldest bucket makes next bucket the oldest one */
+	vbucket = v_hash_array_find_item(&hash_array, &items[0]);
+	fail_unless( v_hash_array_remove_bucket(&hash_array, vbucket) == 1,
+			"Oldest bucket with duplicate key not removed");
+
+	vbucket = v_hash_array_find_item(&hash_array, &items[0]);
+	fail_unless( vbucket != NULL && vbucket->data == &items[2],
+			"The next item with the same key was not found");
+
+	fail_unless( v_hash_array_remove_bucket(&hash_array, vbucket) == 1,
+			"Last bucket with duplicate key not removed");
+
+	fail_unless( v_hash_array_find_item(&hash_array, &items[0]) == NULL,
+			"Item found after removing all items with the same key");
+
+	v_hash_array_destroy(&hash_array);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for hashed linked list
+ */
+struct Suite *hash_array_suite(void)
+{
+	struct Suite *suite = suite_create("Hash_Array");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Hash_Array_add_find_remove);
+	tcase_add_test(tc_core, test_Hash_Array_duplicities);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -0,0 +1,277 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "v_history.h"
+#include "v_cmd_queue.h"
+#include "v_connection.h"
+#include "v_context.h"
+#include "v_commands.h"
+#include "v_node_commands.h"
+
+/**
+ * \brief This function adds packet with one Node_Subscribe command of node
+ * node_id to the history of sent packets
+ */
+static struct VSent_Packet *add_packet(struct VPacket_History *history,
+		uint32 id,
+		uint32 node_id)
+{
+	struct VSent_Packet *sent_packet;
+
+	sent_packet = v_packet_history_add_packet(history, id);
+	fail_unless( sent_packet != NULL, "Packet %u was not added", id);
+	fail_unless( v_packet_history_add_cmd(history, sent_packet,
+			v_node_subscribe_create(node_id, 1, 0), VRS_DEFAULT_PRIORITY) == 1,
+			"Command of packet %u was not added", id);
+
+	return sent_packet;
+}
+
+/**
+ * \brief This function checks, that packet with id is in the history and
+ * its command is still linked in hashed linked list of sent commands
+ */
+static void check_packet(struct VPacket_History *history,
+		uint32 id,
+		uint32 node_id)
+{
+	struct VSent_Packet *sent_packet;
+	struct VSent_Command *sent_cmd;
+	struct Generic_Cmd *cmd;
+	uint32 cmd_node_id;
+
+	sent_packet = v_packet_history_find_packet(history, id);
+	fail_unless( sent_packet != NULL && sent_packet->id == id,
+			"Packet %u was not found", id);
+	fail_unless( sent_packet->cmd_count == 1,
+			"Wrong count of commands in packet %u: %d", id, sent_packet->cmd_count);
+
+	sent_cmd = sent_packet->cmds[0];
+	fail_unless( sent_cmd->vbucket == &sent_cmd->bucket &&
+			sent_cmd->bucket.ptr == (void*)sent_cmd,
+			"Sent command of packet %u is not linked to its bucket", id);
+
+	cmd = (struct Generic_Cmd*)sent_cmd->vbucket->data;
+	memcpy(&cmd_node_id, &cmd->data[0], UINT32_SIZE);
+	fail_unless( cmd_node_id == node_id,
+			"Wrong command in packet %u: node %u", id, cmd_node_id);
+	fail_unless( v_hash_array_find_item(&history->cmd_hist[CMD_NODE_SUBSCRIBE]->cmds,
+			cmd) == sent_cmd->vbucket,
+			"Command of packet %u is not in command history", id);
+}
+
+/**
+ * \brief This function initializes context with datagram connection, that
+ * is needed for removing packets from the history
+ */
+static void init_context(struct vContext *C, struct VDgramConn *dgram_conn)
+{
+	memset(C, 0, sizeof(struct vContext));
+	memset(dgram_conn, 0, sizeof(struct VDgramConn));
+	v_packet_history_init(&dgram_conn->packet_history);
+	CTX_current_dgram_conn_set(C, dgram_conn);
+}
+
+START_TEST ( test_History_wrap )
+{
+	struct vContext C;
+	struct VDgramConn dgram_conn;
+	struct VPacket_History *history = &dgram_conn.packet_history;
+	uint32 id, first_id = 0xFFFFFFFE;
+
+	init_context(&C, &dgram_conn);
+
+	/* IDs of packets overflow during sending */
+	for(id = first_id; id != 3; id++) {
+		add_packet(history, id, id + 10);
+	}
+
+	fail_unless( history->count == 5, "Wrong count of packets: %d", history->count);
+	fail_unless( history->first_id == first_id && history->last_id == 2,
+			"Wrong range of IDs: %u - %u", history->first_id, history->last_id);
+
+	for(id = first_id; id != 3; id++) {
+		check_packet(history, id, id + 10);
+	}
+
+	/* Packet sent before overflow is removed */
+	fail_unless( v_packet_history_rem_packet(&C, first_id) == 1,
+			"Packet %u was not removed", first_id);
+	fail_unless( history->first_id == 0xFFFFFFFF,
+			"Wrong first ID: %u", history->first_id);
+	fail_unless( v_packet_history_rem_packet(&C, 0xFFFFFFFF) == 1,
+			"Packet %u was not removed", 0xFFFFFFFF);
+	fail_unless( history->first_id == 0, "Wrong first ID: %u", history->first_id);
+	check_packet(history, 0, 10);
+
+	v_packet_history_destroy(history);
+}
+END_TEST
+
+START_TEST ( test_History_resize )
+{
+	struct vContext C;
+	struct VDgramConn dgram_conn;
+	struct VPacket_History *history = &dgram_conn.packet_history;
+	uint32 id, first_id = 0xFFFFFFF0, count = 3 * INIT_PACKET_HISTORY_SIZE;
+
+	init_context(&C, &dgram_conn);
+
+	/* Some slots contain arrays of removed packets */
+	for(id = first_id; id != first_id + 8; id++) {
+		add_packet(history, id, id);
+	}
+	for(id = first_id; id != first_id + 4; id++) {
+		v_packet_history_rem_packet(&C, id);
+	}
+
+	/* Ring is resized, while packets are not acknowledged */
+	for(id = first_id + 8; id != first_id + count; id++) {
+		add_packet(history, id, id);
+	}
+
+	fail_unless( history->size >= count - 4, "Ring was not resized: %d", history->size);
+	fail_unless( history->count == count - 4, "Wrong count of packets: %d", history->count);
+
+	/* Sent commands were not moved */
+	for(id = first_id + 4; id != first_id + count; id++) {
+		check_packet(history, id, id);
+	}
+
+	for(id = first_id + 4; id != first_id + count; id++) {
+		fail_unless( v_packet_history_rem_packet(&C, id) == 1,
+				"Packet %u was not removed", id);
+	}
+	fail_unless( history->count == 0, "History is not empty: %d", history->count);
+	fail_unless( v_hash_array_count_items(&history->cmd_hist[CMD_NODE_SUBSCRIBE]->cmds) == 0,
+			"Command history is not empty");
+
+	v_packet_history_destroy(history);
+}
+END_TEST
+
+START_TEST ( test_History_first_id )
+{
+	struct vContext C;
+	struct VDgramConn dgram_conn;
+	struct VPacket_History *history = &dgram_conn.packet_history;
+	uint32 id;
+
+	init_context(&C, &dgram_conn);
+
+	for(id = 100; id < 110; id++) {
+		add_packet(history, id, id);
+	}
+
+	/* Packets in the middle are acknowledged first */
+	v_packet_history_rem_packet(&C, 101);
+	v_packet_history_rem_packet(&C, 102);
+	v_packet_history_rem_packet(&C, 104);
+	fail_unless( history->first_id == 100, "First ID moved: %u", history->first_id);
+
+	/* The oldest packet skips removed packets */
+	v_packet_history_rem_packet(&C, 100);
+	fail_unless( history->first_id == 103, "Wrong first ID: %u", history->first_id);
+
+	v_packet_history_rem_packet(&C, 103);
+	fail_unless( history->first_id == 105, "Wrong first ID: %u", history->first_id);
+	fail_unless( history->last_id == 109, "Wrong last ID: %u", history->last_id);
+	fail_unless( history->count == 5, "Wrong count of packets: %d", history->count);
+
+	/* Unknown packets are not removed */
+	fail_unless( v_packet_history_rem_packet(&C, 103) == 0, "Packet removed twice");
+	fail_unless( v_packet_history_rem_packet(&C, 110) == 0, "Not sent packet removed");
+
+	v_packet_history_destroy(history);
+}
+END_TEST
+
+START_TEST ( test_History_stale )
+{
+	struct vContext C;
+	struct VDgramConn dgram_conn;
+	struct VPacket_History *history = &dgram_conn.packet_history;
+	uint32 size, stale_id = 11;
+
+	init_context(&C, &dgram_conn);
+	size = history->size;
+
+	add_packet(history, 10, 10);
+	add_packet(history, stale_id, stale_id);
+	add_packet(history, 12, 12);
+
+	/* Removed packet stays in its slot, but it is not found */
+	v_packet_history_rem_packet(&C, stale_id);
+	fail_unless( v_packet_history_find_packet(history, stale_id) == NULL,
+			"Removed packet was found");
+
+	/* Slot of removed packet is reused by newer packet */
+	v_packet_history_rem_packet(&C, 10);
+	add_packet(history, stale_id + size, stale_id + size);
+	fail_unless( history->size == size, "Ring was resized: %d", history->size);
+
+	fail_unless( v_packet_history_find_packet(history, stale_id) == NULL,
+			"Packet with ID of other packet in the slot was found");
+	fail_unless( v_packet_history_find_packet(history, 10) == NULL,
+			"Packet older then first ID was found");
+	fail_unless( v_packet_history_find_packet(history, 12 + size) == NULL,
+			"Packet newer then last ID was found");
+	check_packet(history, stale_id + size, stale_id + size);
+
+	v_packet_history_destroy(history);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for history of sent packets
+ */
+struct Suite *history_suite(void)
+{
+	struct Suite *suite = suite_create("History");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_History_wrap);
+	tcase_add_test(tc_core, test_History_resize);
+	tcase_add_test(tc_core, test_History_first_id);
+	tcase_add_test(tc_core, test_History_stale);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
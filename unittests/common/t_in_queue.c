@@ -0,0 +1,127 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "t_queue_common.h"
+
+#include "v_commands.h"
+#include "v_node_commands.h"
+#include "v_in_queue.h"
+
+/**
+ * \brief This function pushes command to the queue for incoming commands
+ */
+static int push_cmd(void *queue, struct Generic_Cmd *cmd)
+{
+	return v_in_queue_push((struct VInQueue*)queue, cmd);
+}
+
+/**
+ * \brief This function pops command from the queue for incoming commands
+ */
+static struct Generic_Cmd *pop_cmd(void *queue)
+{
+	return v_in_queue_pop((struct VInQueue*)queue);
+}
+
+START_TEST ( test_In_Queue_replace )
+{
+	struct VInQueue *in_queue = v_in_queue_create();
+	struct Generic_Cmd *cmd;
+
+	v_in_queue_push(in_queue, v_node_subscribe_create(1, 1, 0));
+	v_in_queue_push(in_queue, v_node_subscribe_create(2, 1, 0));
+	v_in_queue_push(in_queue, v_node_subscribe_create(1, 2, 0));
+
+	/* Newer command replaced older command with the same address */
+	fail_unless( v_in_queue_cmd_count(in_queue) == 2,
+			"Wrong count of commands: %d", v_in_queue_cmd_count(in_queue));
+
+	cmd = v_in_queue_pop(in_queue);
+	fail_unless( cmd != NULL && t_cmd_get_node_id(cmd) == 1 && t_cmd_get_version(cmd) == 2,
+			"Command was not replaced");
+	v_cmd_destroy(&cmd);
+
+	/* Command with address of popped command is added to the tail */
+	v_in_queue_push(in_queue, v_node_subscribe_create(1, 3, 0));
+
+	cmd = v_in_queue_pop(in_queue);
+	fail_unless( cmd != NULL && t_cmd_get_node_id(cmd) == 2, "Wrong order of commands");
+	v_cmd_destroy(&cmd);
+
+	cmd = v_in_queue_pop(in_queue);
+	fail_unless( cmd != NULL && t_cmd_get_node_id(cmd) == 1 && t_cmd_get_version(cmd) == 3,
+			"Command was not added again");
+	v_cmd_destroy(&cmd);
+
+	fail_unless( v_in_queue_pop(in_queue) == NULL, "Queue is not empty");
+	fail_unless( v_in_queue_size(in_queue) == 0, "Size of empty queue is not zero");
+
+	v_in_queue_destroy(&in_queue);
+}
+END_TEST
+
+START_TEST ( test_In_Queue_producers )
+{
+	struct VInQueue *in_queue = v_in_queue_create();
+
+	t_queue_producers(in_queue, push_cmd, pop_cmd);
+
+	fail_unless( v_in_queue_cmd_count(in_queue) == 0,
+			"Count of commands is not zero: %d", v_in_queue_cmd_count(in_queue));
+
+	v_in_queue_destroy(&in_queue);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for queue of incoming commands
+ */
+struct Suite *in_queue_suite(void)
+{
+	struct Suite *suite = suite_create("In_Queue");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_In_Queue_replace);
+	tcase_add_test(tc_core, test_In_Queue_producers);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
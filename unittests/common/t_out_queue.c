@@ -0,0 +1,284 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "t_queue_common.h"
+
+#include "v_commands.h"
+#include "v_node_commands.h"
+#include "v_layer_commands.h"
+#include "v_in_queue.h"
+#include "v_out_queue.h"
+
+#define DRR_CMDS			10000
+
+#define RUN_CMDS			300
+#define RUN_BUFFER_SIZE		2048
+
+/**
+ * \brief This function pops one command from the default priority queue
+ */
+static struct Generic_Cmd *pop_cmd(struct VOutQueue *out_queue)
+{
+	uint16 count, len = 0xFFFF;
+	int8 share;
+
+	return v_out_queue_pop(out_queue, VRS_DEFAULT_PRIORITY, &count, &share, &len);
+}
+
+START_TEST ( test_Out_Queue_staged )
+{
+	struct VOutQueue *out_queue = v_out_queue_create();
+	struct Generic_Cmd *cmd;
+
+	v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, v_node_subscribe_create(1, 1, 0));
+	v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, v_node_subscribe_create(2, 1, 0));
+	v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, v_node_subscribe_create(1, 2, 0));
+
+	/* Staged commands are merged in order and duplicities are removed */
+	fail_unless( v_out_queue_get_count(out_queue) == 2,
+			"Wrong count of commands: %d", v_out_queue_get_count(out_queue));
+
+	cmd = pop_cmd(out_queue);
+	fail_unless( cmd != NULL && t_cmd_get_node_id(cmd) == 1 && t_cmd_get_version(cmd) == 2,
+			"Command was not replaced");
+	v_cmd_destroy(&cmd);
+
+	/* Resent command is not added, when newer command is staged */
+	v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, v_node_subscribe_create(2, 3, 0));
+	cmd = v_node_subscribe_create(2, 2, 0);
+	fail_unless( v_out_queue_push_head(out_queue, VRS_DEFAULT_PRIORITY, cmd) == 0,
+			"Obsolete command was added to the head of queue");
+	v_cmd_destroy(&cmd);
+
+	cmd = pop_cmd(out_queue);
+	fail_unless( cmd != NULL && t_cmd_get_node_id(cmd) == 2 && t_cmd_get_version(cmd) == 3,
+			"Staged command was not merged");
+	v_cmd_destroy(&cmd);
+
+	fail_unless( pop_cmd(out_queue) == NULL, "Queue is not empty");
+
+	/* Staged commands are destroyed with the queue */
+	v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, v_node_subscribe_create(3, 1, 0));
+
+	v_out_queue_destroy(&out_queue);
+}
+END_TEST
+
+/**
+ * \brief This function pushes command to the tail of default priority queue
+ */
+static int push_producer_cmd(void *queue, struct Generic_Cmd *cmd)
+{
+	return v_out_queue_push_tail((struct VOutQueue*)queue, VRS_DEFAULT_PRIORITY, cmd);
+}
+
+/**
+ * \brief This function pops command from the default priority queue
+ */
+static struct Generic_Cmd *pop_producer_cmd(void *queue)
+{
+	return pop_cmd((struct VOutQueue*)queue);
+}
+
+START_TEST ( test_Out_Queue_producers )
+{
+	struct VOutQueue *out_queue = v_out_queue_create();
+
+	/* Sender pops commands, while producers push them */
+	t_queue_producers(out_queue, push_producer_cmd, pop_producer_cmd);
+
+	fail_unless( v_out_queue_get_count(out_queue) == 0,
+			"Count of commands is not zero: %d", v_out_queue_get_count(out_queue));
+	fail_unless( v_out_queue_get_size(out_queue) == 0,
+			"Size of commands is not zero: %d", v_out_queue_get_size(out_queue));
+
+	v_out_queue_destroy(&out_queue);
+}
+END_TEST
+
+START_TEST ( test_Out_Queue_drr )
+{
+	struct VOutQueue *out_queue = v_out_queue_create();
+	struct Generic_Cmd *cmd;
+	uint32 i, deficit, sent_high = 0, sent_low = 0;
+	uint8 prio, low_prio = VRS_DEFAULT_PRIORITY - 10;
+
+	/* Bitmap of used priorities */
+	v_out_queue_push_tail(out_queue, 10, v_node_subscribe_create(1, 1, 0));
+	v_out_queue_push_tail(out_queue, 200, v_node_subscribe_create(2, 1, 0));
+	v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, v_node_subscribe_create(3, 1, 0));
+
+	fail_unless( v_out_queue_get_max_prio(out_queue) == 200 &&
+			v_out_queue_get_min_prio(out_queue) == 10,
+			"Wrong max or min priority: %d, %d",
+			v_out_queue_get_max_prio(out_queue), v_out_queue_get_min_prio(out_queue));
+
+	/* Priority of command is changed, when newer command is pushed */
+	v_out_queue_push_tail(out_queue, 20, v_node_subscribe_create(1, 2, 0));
+	fail_unless( v_out_queue_get_min_prio(out_queue) == 20,
+			"Wrong min priority: %d", v_out_queue_get_min_prio(out_queue));
+
+	cmd = v_out_queue_pop(out_queue, 200, NULL, NULL, NULL);
+	v_cmd_destroy(&cmd);
+	fail_unless( v_out_queue_get_max_prio(out_queue) == VRS_DEFAULT_PRIORITY,
+			"Wrong max priority: %d", v_out_queue_get_max_prio(out_queue));
+
+	cmd = v_out_queue_pop(out_queue, 20, NULL, NULL, NULL);
+	v_cmd_destroy(&cmd);
+
+	/* The only used queue is not limited by deficit */
+	fail_unless( v_out_queue_drr_next(out_queue, &prio, &deficit) == 1 &&
+			prio == VRS_DEFAULT_PRIORITY && deficit == 0xFFFFFFFF,
+			"Wrong only queue: %d, deficit: %u", prio, deficit);
+
+	cmd = v_out_queue_pop(out_queue, VRS_DEFAULT_PRIORITY, NULL, NULL, NULL);
+	v_cmd_destroy(&cmd);
+
+	fail_unless( v_out_queue_drr_next(out_queue, &prio, &deficit) == 0,
+			"Empty queue was scheduled");
+
+	/* Two queues share bandwidth according their quantum */
+	for(i = 0; i < DRR_CMDS; i++) {
+		v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY, v_node_subscribe_create(i, 1, 0));
+		v_out_queue_push_tail(out_queue, low_prio, v_node_subscribe_create(DRR_CMDS + i, 1, 0));
+	}
+
+	while(v_out_queue_get_count_prio(out_queue, VRS_DEFAULT_PRIORITY) > 0 &&
+			v_out_queue_get_count_prio(out_queue, low_prio) > 0)
+	{
+		fail_unless( v_out_queue_drr_next(out_queue, &prio, &deficit) == 1,
+				"No queue was scheduled");
+		cmd = v_out_queue_pop(out_queue, prio, NULL, NULL, NULL);
+		fail_unless( cmd != NULL && (uint32)v_cmd_size(cmd) <= deficit,
+				"Command bigger then deficit was scheduled");
+		if(prio == VRS_DEFAULT_PRIORITY) {
+			sent_high += v_cmd_size(cmd);
+		} else {
+			sent_low += v_cmd_size(cmd);
+		}
+		v_out_queue_drr_charge(out_queue, prio, v_cmd_size(cmd));
+		v_cmd_destroy(&cmd);
+	}
+
+	fail_unless( sent_low > 0, "Low priority queue was starving");
+	i = (sent_high * v_out_queue_get_quantum(out_queue, low_prio)) / sent_low;
+	fail_unless( i >= v_out_queue_get_quantum(out_queue, VRS_DEFAULT_PRIORITY) * 9 / 10 &&
+			i <= v_out_queue_get_quantum(out_queue, VRS_DEFAULT_PRIORITY) * 11 / 10,
+			"Unfair sharing: %u / %u", sent_high, sent_low);
+
+	v_out_queue_destroy(&out_queue);
+}
+END_TEST
+
+/**
+ * \brief Groups of commands with the same ID are popped with length, that
+ * is the same as length of packed commands and that fits to the limit
+ */
+START_TEST ( test_Out_Queue_runs )
+{
+	struct VOutQueue *out_queue = v_out_queue_create();
+	struct VInQueue *in_queue;
+	struct Generic_Cmd *cmd;
+	char buffer[RUN_BUFFER_SIZE];
+	real32 vec[3] = {1.0f, 2.0f, 3.0f};
+	uint16 count, len, limit, buffer_pos;
+	uint32 i, popped = 0;
+	int8 share;
+
+	for(i = 0; i < RUN_CMDS; i++) {
+		v_out_queue_push_tail(out_queue, VRS_DEFAULT_PRIORITY,
+				v_layer_set_value_create(1, 1, i, VRS_VALUE_TYPE_REAL32, 3, vec));
+	}
+
+	/* Groups are popped with growing limit of length */
+	for(limit = 100; v_out_queue_get_count(out_queue) > 0; limit += 150) {
+		count = 0;
+		share = 0;
+		len = limit;
+		cmd = v_out_queue_pop(out_queue, VRS_DEFAULT_PRIORITY, &count, &share, &len);
+		fail_unless( cmd != NULL && count > 0 && len <= limit,
+				"Wrong group: count: %d, length: %d, limit: %d", count, len, limit);
+
+		buffer_pos = v_cmd_pack(buffer, cmd, len, share);
+		v_cmd_destroy(&cmd);
+
+		for(i = 1; i < count; i++) {
+			cmd = v_out_queue_pop(out_queue, VRS_DEFAULT_PRIORITY, NULL, NULL, NULL);
+			fail_unless( cmd != NULL, "Command of group is missing");
+			buffer_pos += v_cmd_pack(&buffer[buffer_pos], cmd, 0, share);
+			v_cmd_destroy(&cmd);
+		}
+
+		fail_unless( buffer_pos == len,
+				"Wrong length of group: %d != %d", buffer_pos, len);
+
+		in_queue = v_in_queue_create();
+		v_cmd_unpack(buffer, buffer_pos, in_queue);
+		fail_unless( v_in_queue_cmd_count(in_queue) == count,
+				"Wrong count of unpacked commands: %d != %d",
+				v_in_queue_cmd_count(in_queue), count);
+		v_in_queue_destroy(&in_queue);
+
+		popped += count;
+	}
+
+	fail_unless( popped == RUN_CMDS, "Wrong count of popped commands: %d", popped);
+
+	v_out_queue_destroy(&out_queue);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for queue of outgoing commands
+ */
+struct Suite *out_queue_suite(void)
+{
+	struct Suite *suite = suite_create("Out_Queue");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Out_Queue_staged);
+	tcase_add_test(tc_core, test_Out_Queue_producers);
+	tcase_add_test(tc_core, test_Out_Queue_drr);
+	tcase_add_test(tc_core, test_Out_Queue_runs);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -0,0 +1,179 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+#include <string.h>
+#include <check.h>
+
+#include "v_network.h"
+#include "v_history.h"
+#include "v_connection.h"
+#include "v_pmtud.h"
+
+/* Path MTU of Ethernet with IPv4 */
+#define TEST_PATH_MTU	(1500 - 20 - 8)
+
+static struct VDgramConn vconn;
+
+/**
+ * \brief This function sends probe, when PMTU discovery wants it, and it
+ * delivers probe, when it is not bigger then path_mtu.
+ * \return This function returns size of sent probe or zero.
+ */
+static uint16 send_probe(uint32 id, uint16 path_mtu, struct timeval *tv)
+{
+	struct VSent_Packet sent_packet;
+	uint16 size;
+
+	size = v_pmtud_probe_size(&vconn, tv);
+	if(size == 0) {
+		return 0;
+	}
+
+	memset(&sent_packet, 0, sizeof(struct VSent_Packet));
+	sent_packet.id = id;
+	sent_packet.size = size;
+	v_pmtud_probe_sent(&vconn, id, size);
+
+	if(size <= path_mtu) {
+		v_pmtud_packet_acked(&vconn, &sent_packet, tv);
+	} else {
+		fail_unless( v_pmtud_packet_lost(&vconn, &sent_packet, tv) == 1,
+				"Lost probe was considered as congestion");
+	}
+
+	return size;
+}
+
+START_TEST ( test_Pmtud_search )
+{
+	struct timeval tv;
+	uint32 id;
+
+	memset(&vconn, 0, sizeof(struct VDgramConn));
+	vconn.io_ctx.mtu = DEFAULT_MTU;
+	tv.tv_sec = 1000;
+	tv.tv_usec = 0;
+
+	/* Disabled PMTU discovery never sends probe */
+	v_pmtud_init(&vconn, 0);
+	fail_unless( v_pmtud_probe_size(&vconn, &tv) == 0,
+			"Disabled PMTU discovery sent probe");
+
+	/* MTU of local interface limits MTU of connection at once */
+	v_pmtud_init(&vconn, 1400);
+	fail_unless( vconn.io_ctx.mtu == 1400 && vconn.pmtud.state == PMTUD_SEARCH_COMPLETE,
+			"Wrong MTU: %d limited by interface", vconn.io_ctx.mtu);
+
+	/* Binary search between DEFAULT_MTU and jumbo frame */
+	vconn.io_ctx.mtu = DEFAULT_MTU;
+	v_pmtud_init(&vconn, 0xFFFF);
+	for(id = 1; id < 100 && send_probe(id, TEST_PATH_MTU, &tv) > 0; id++);
+
+	fail_unless( vconn.pmtud.state == PMTUD_SEARCH_COMPLETE,
+			"Search was not completed after %d probes", id);
+	fail_unless( vconn.io_ctx.mtu <= TEST_PATH_MTU &&
+			vconn.io_ctx.mtu > TEST_PATH_MTU - PMTUD_SEARCH_STEP,
+			"Wrong MTU: %d", vconn.io_ctx.mtu);
+	fail_unless( vconn.cc.mss == vconn.io_ctx.mtu,
+			"MSS of Congestion Control was not updated");
+
+	/* Search is started again after raise timer */
+	tv.tv_sec += PMTUD_RAISE_TIMER - 1;
+	fail_unless( v_pmtud_probe_size(&vconn, &tv) == 0,
+			"Probe was sent before raise timer");
+	tv.tv_sec += 1;
+	fail_unless( v_pmtud_probe_size(&vconn, &tv) > TEST_PATH_MTU,
+			"Probe was not sent after raise timer");
+
+	/* Probe, that could not be sent through interface, lowers limit */
+	v_pmtud_probe_failed(&vconn, v_pmtud_probe_size(&vconn, &tv), &tv);
+	fail_unless( vconn.pmtud.max_mtu < PMTUD_MAX_MTU,
+			"Limit of interface was not lowered");
+}
+END_TEST
+
+START_TEST ( test_Pmtud_black_hole )
+{
+	struct VSent_Packet sent_packet;
+	struct timeval tv;
+	int i;
+
+	memset(&vconn, 0, sizeof(struct VDgramConn));
+	vconn.io_ctx.mtu = DEFAULT_MTU;
+	tv.tv_sec = 1000;
+	tv.tv_usec = 0;
+	v_pmtud_init(&vconn, 0xFFFF);
+
+	memset(&sent_packet, 0, sizeof(struct VSent_Packet));
+	sent_packet.size = DEFAULT_MTU;
+
+	/* Delivered big packet resets counter of lost packets */
+	for(i = 0; i < PMTUD_BLACK_HOLE_LOSSES - 1; i++) {
+		sent_packet.id = i + 1;
+		fail_unless( v_pmtud_packet_lost(&vconn, &sent_packet, &tv) == 0,
+				"Lost packet was considered as probe");
+	}
+	v_pmtud_packet_acked(&vconn, &sent_packet, &tv);
+	sent_packet.id++;
+	v_pmtud_packet_lost(&vconn, &sent_packet, &tv);
+	fail_unless( vconn.io_ctx.mtu == DEFAULT_MTU,
+			"Black hole detected after delivered packet");
+
+	/* Path drops all big packets */
+	for(i = 0; i < PMTUD_BLACK_HOLE_LOSSES; i++) {
+		sent_packet.id++;
+		v_pmtud_packet_lost(&vconn, &sent_packet, &tv);
+	}
+	fail_unless( vconn.io_ctx.mtu == PMTUD_BASE_MTU &&
+			vconn.pmtud.state == PMTUD_SEARCHING,
+			"Black hole was not detected, MTU: %d", vconn.io_ctx.mtu);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for PMTU discovery
+ */
+struct Suite *pmtud_suite(void)
+{
+	struct Suite *suite = suite_create("PMTU Discovery");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Pmtud_search);
+	tcase_add_test(tc_core, test_Pmtud_black_hole);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
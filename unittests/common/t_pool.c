@@ -0,0 +1,107 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "v_pool.h"
+
+#define BLOCK_COUNT 1000
+
+/**
+ * \brief This function allocates blocks of size, frees them and allocates
+ * them again. Blocks of the second round has to be reused and no new slab
+ * can be allocated.
+ */
+static void test_pool_reuse(size_t size)
+{
+	void *blocks[BLOCK_COUNT];
+	uint32 slab_count;
+	int i;
+
+	for(i=0; i < BLOCK_COUNT; i++) {
+		blocks[i] = v_pool_alloc(size);
+		fail_unless( blocks[i] != NULL, "Block %d not allocated", i);
+		memset(blocks[i], 0xFF, size);
+	}
+
+	for(i=0; i < BLOCK_COUNT; i++) {
+		v_pool_free(blocks[i], size);
+	}
+
+	slab_count = v_pool_slab_count();
+
+	for(i=0; i < BLOCK_COUNT; i++) {
+		blocks[i] = v_pool_calloc(size);
+		fail_unless( blocks[i] != NULL, "Block %d not allocated", i);
+		fail_unless( ((uint8*)blocks[i])[size-1] == 0, "Block %d not cleared", i);
+	}
+
+	fail_unless( v_pool_slab_count() == slab_count,
+			"New slabs allocated: %u != %u", v_pool_slab_count(), slab_count);
+
+	for(i=0; i < BLOCK_COUNT; i++) {
+		v_pool_free(blocks[i], size);
+	}
+}
+
+START_TEST ( test_Pool_small_blocks )
+{
+	test_pool_reuse(sizeof(struct VListBase));
+}
+END_TEST
+
+START_TEST ( test_Pool_big_blocks )
+{
+	test_pool_reuse(POOL_MAX_SIZE + 1);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for pool of memory blocks
+ */
+struct Suite *pool_suite(void)
+{
+	struct Suite *suite = suite_create("Pool");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Pool_small_blocks);
+	tcase_add_test(tc_core, test_Pool_big_blocks);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -0,0 +1,160 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <check.h>
+
+#include "t_queue_common.h"
+
+#include "v_node_commands.h"
+#include "v_atomic.h"
+
+/**
+ * Data of one producer thread
+ */
+typedef struct Producer {
+	pthread_t			thread;
+	void				*queue;
+	TQueuePushFunc		push;
+	uint32				first_node_id;
+	volatile uint32		*finished;
+} Producer;
+
+/**
+ * \brief This function returns version stored in Node_Subscribe command
+ */
+uint32 t_cmd_get_version(struct Generic_Cmd *cmd)
+{
+	uint32 version;
+
+	memcpy(&version, &cmd->data[UINT32_SIZE], UINT32_SIZE);
+
+	return version;
+}
+
+/**
+ * \brief This function returns node ID stored in node command
+ */
+uint32 t_cmd_get_node_id(struct Generic_Cmd *cmd)
+{
+	uint32 node_id;
+
+	memcpy(&node_id, &cmd->data[0], UINT32_SIZE);
+
+	return node_id;
+}
+
+/**
+ * \brief This function checks, that popped command is newer then previously
+ * popped command with the same address and it destroys it
+ */
+static void check_popped_cmd(struct Generic_Cmd *cmd, uint32 *last_version)
+{
+	uint32 node_id = t_cmd_get_node_id(cmd), version = t_cmd_get_version(cmd);
+
+	fail_unless( version > last_version[node_id],
+			"Older version %d of node %d popped after version %d",
+			version, node_id, last_version[node_id]);
+	last_version[node_id] = version;
+	v_cmd_destroy(&cmd);
+}
+
+/**
+ * \brief This function pushes commands with the same addresses and with
+ * increasing versions to the queue
+ */
+static void *producer_thread(void *arg)
+{
+	struct Producer *producer = (struct Producer*)arg;
+	uint32 i;
+
+	for(i = 1; i <= PRODUCER_CMDS; i++) {
+		producer->push(producer->queue,
+				v_node_subscribe_create(producer->first_node_id + (i % PRODUCER_NODES), i, 0));
+	}
+
+	V_ATOMIC_INC(producer->finished);
+
+	return NULL;
+}
+
+/**
+ * \brief This function runs PRODUCER_COUNT threads pushing Node_Subscribe
+ * commands to the queue, while this thread pops them. It checks, that
+ * commands with the same address are popped in order and that the latest
+ * version of each address is popped. The queue is empty, when this function
+ * returns.
+ */
+void t_queue_producers(void *queue, TQueuePushFunc push, TQueuePopFunc pop)
+{
+	struct Producer producers[PRODUCER_COUNT];
+	uint32 last_version[PRODUCER_COUNT * PRODUCER_NODES];
+	volatile uint32 finished = 0;
+	struct Generic_Cmd *cmd;
+	uint32 i;
+
+	memset(last_version, 0, sizeof(last_version));
+
+	for(i = 0; i < PRODUCER_COUNT; i++) {
+		producers[i].queue = queue;
+		producers[i].push = push;
+		producers[i].first_node_id = i * PRODUCER_NODES;
+		producers[i].finished = &finished;
+		pthread_create(&producers[i].thread, NULL, producer_thread, &producers[i]);
+	}
+
+	/* Consumer pops commands, while producers push them */
+	while(finished < PRODUCER_COUNT) {
+		if( (cmd = pop(queue)) != NULL ) {
+			check_popped_cmd(cmd, last_version);
+		}
+	}
+
+	for(i = 0; i < PRODUCER_COUNT; i++) {
+		pthread_join(producers[i].thread, NULL);
+	}
+
+	while( (cmd = pop(queue)) != NULL ) {
+		check_popped_cmd(cmd, last_version);
+	}
+
+	/* The latest version of each address has to be popped */
+	for(i = 0; i < PRODUCER_COUNT * PRODUCER_NODES; i++) {
+		fail_unless( last_version[i] > PRODUCER_CMDS - PRODUCER_NODES,
+				"The latest version of node %d was not popped: %d", i, last_version[i]);
+	}
+}
@@ -0,0 +1,195 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+#include <string.h>
+#include <check.h>
+
+#include "v_network.h"
+#include "v_history.h"
+#include "v_connection.h"
+#include "v_resend_mechanism.h"
+
+static struct VDgramConn vconn;
+
+/**
+ * \brief This function initializes connection, that has not taken any RTT
+ * sample yet
+ */
+static void init_conn(void)
+{
+	memset(&vconn, 0, sizeof(struct VDgramConn));
+	vconn.rto = RTO_INITIAL;
+	vconn.host_id = 1;
+}
+
+/**
+ * \brief SRTT, RTTVAR and RTO have to be computed as described in RFC 6298
+ */
+START_TEST ( test_Rto_update )
+{
+	init_conn();
+
+	/* The first sample: SRTT = R, RTTVAR = R/2, RTO = SRTT + 4*RTTVAR */
+	v_rto_update(&vconn, 300000);
+	fail_unless( vconn.srtt == 300000 && vconn.rttvar == 150000,
+			"Wrong SRTT: %u, RTTVAR: %u after first sample", vconn.srtt, vconn.rttvar);
+	fail_unless( vconn.rto == 900000,
+			"Wrong RTO: %u after first sample", vconn.rto);
+
+	/* RTTVAR = 3/4*RTTVAR + 1/4*|SRTT - R|, SRTT = 7/8*SRTT + 1/8*R */
+	v_rto_update(&vconn, 100000);
+	fail_unless( vconn.srtt == 275000 && vconn.rttvar == 162500,
+			"Wrong SRTT: %u, RTTVAR: %u after second sample", vconn.srtt, vconn.rttvar);
+	fail_unless( vconn.rto == 925000,
+			"Wrong RTO: %u after second sample", vconn.rto);
+}
+END_TEST
+
+/**
+ * \brief RTO has to be clamped to RTO_MIN and RTO_MAX and variance has to be
+ * at least clock granularity
+ */
+START_TEST ( test_Rto_clamp )
+{
+	int i;
+
+	init_conn();
+	v_rto_update(&vconn, 1000);
+	fail_unless( vconn.rto == RTO_MIN, "RTO: %u is not RTO_MIN", vconn.rto);
+
+	init_conn();
+	v_rto_update(&vconn, 30000000);
+	fail_unless( vconn.rto == RTO_MAX, "RTO: %u is not RTO_MAX", vconn.rto);
+
+	/* Variance of stable RTT drops to zero */
+	init_conn();
+	for(i = 0; i < 100; i++) {
+		v_rto_update(&vconn, 300000);
+	}
+	fail_unless( vconn.rttvar == 0, "RTTVAR: %u of stable RTT", vconn.rttvar);
+	fail_unless( vconn.rto == 300000 + RTO_CLOCK_GRANULARITY,
+			"RTO: %u does not include clock granularity", vconn.rto);
+}
+END_TEST
+
+/**
+ * \brief RTO has to be doubled after expiration of retransmission timer and
+ * new RTT sample has to reset the back off
+ */
+START_TEST ( test_Rto_timeout )
+{
+	init_conn();
+	v_rto_update(&vconn, 300000);
+	vconn.count_s_pay = 10;
+
+	v_rto_timeout(&vconn);
+	fail_unless( vconn.rto == 1800000 && vconn.rto_backoff == 1,
+			"Wrong RTO: %u after timeout", vconn.rto);
+	fail_unless( vconn.karn_id == 11, "Wrong ID: %u of first probe", vconn.karn_id);
+
+	/* The first packet sent after first expiration is still the border */
+	vconn.count_s_pay = 12;
+	v_rto_timeout(&vconn);
+	fail_unless( vconn.rto == 3600000 && vconn.rto_backoff == 2,
+			"Wrong RTO: %u after second timeout", vconn.rto);
+	fail_unless( vconn.karn_id == 11, "ID of first probe was changed");
+
+	/* Backed off RTO is not bigger then RTO_MAX */
+	vconn.rto = RTO_MAX/2 + 1;
+	v_rto_timeout(&vconn);
+	fail_unless( vconn.rto == RTO_MAX, "RTO: %u is not RTO_MAX", vconn.rto);
+	v_rto_timeout(&vconn);
+	fail_unless( vconn.rto == RTO_MAX, "RTO: %u is bigger then RTO_MAX", vconn.rto);
+
+	/* New sample computes RTO from SRTT again */
+	v_rto_update(&vconn, 300000);
+	fail_unless( vconn.rto_backoff == 0 && vconn.rto < RTO_MAX,
+			"RTO: %u was not reset by new sample", vconn.rto);
+}
+END_TEST
+
+/**
+ * \brief Packets sent before expiration of retransmission timer must not be
+ * used for RTT samples, until new sample is taken (Karn's rule)
+ */
+START_TEST ( test_Rto_karn )
+{
+	init_conn();
+	v_rto_update(&vconn, 300000);
+	vconn.count_s_pay = 10;
+
+	fail_unless( v_rto_sample_valid(&vconn, 5) == 1,
+			"Sample ignored without back off");
+
+	v_rto_timeout(&vconn);
+	fail_unless( v_rto_sample_valid(&vconn, 10) == 0,
+			"Sample of packet sent before timeout was not ignored");
+	fail_unless( v_rto_sample_valid(&vconn, 11) == 1 &&
+			v_rto_sample_valid(&vconn, 12) == 1,
+			"Sample of packet sent after timeout was ignored");
+
+	v_rto_update(&vconn, 300000);
+	fail_unless( v_rto_sample_valid(&vconn, 10) == 1,
+			"Sample ignored after new RTT sample");
+
+	/* ID of payload packets could wrap around */
+	init_conn();
+	vconn.host_id = 0xFFFFFFF0;
+	vconn.count_s_pay = 0x20;
+	v_rto_timeout(&vconn);
+	fail_unless( v_rto_sample_valid(&vconn, 0xFFFFFFFF) == 0,
+			"Sample of packet sent before wrapped ID was not ignored");
+	fail_unless( v_rto_sample_valid(&vconn, 0x10) == 1,
+			"Sample of packet with wrapped ID was ignored");
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for retransmission timer
+ */
+struct Suite *rto_suite(void)
+{
+	struct Suite *suite = suite_create("RTO");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Rto_update);
+	tcase_add_test(tc_core, test_Rto_clamp);
+	tcase_add_test(tc_core, test_Rto_timeout);
+	tcase_add_test(tc_core, test_Rto_karn);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -0,0 +1,95 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "v_session.h"
+
+#define SESSION_COUNT 3
+
+START_TEST ( test_Session_Ready_order )
+{
+	struct VSessionReadyList ready_list;
+	struct VSession vsessions[SESSION_COUNT], *vsession;
+	int i;
+
+	v_session_ready_init(&ready_list);
+	for(i = 0; i < SESSION_COUNT; i++) {
+		memset(&vsessions[i], 0, sizeof(struct VSession));
+		fail_unless( v_session_ready_push(&ready_list, &vsessions[i]) == 1,
+				"Session %d not added", i);
+	}
+
+	/* Session could be added only once */
+	fail_unless( v_session_ready_push(&ready_list, &vsessions[1]) == 0,
+			"Session added twice");
+
+	/* Sessions are returned in FIFO order */
+	vsession = v_session_ready_pop_all(&ready_list);
+	for(i = 0; i < SESSION_COUNT; i++) {
+		fail_unless( vsession == &vsessions[i], "Wrong session at position %d", i);
+		vsession = vsession->ready_next;
+	}
+	fail_unless( vsession == NULL, "List is not terminated");
+	fail_unless( v_session_ready_pop_all(&ready_list) == NULL, "List is not empty");
+
+	/* Session could be added again, when it was handled */
+	fail_unless( v_session_ready_push(&ready_list, &vsessions[0]) == 0,
+			"Session added before it was handled");
+	v_session_ready_done(&vsessions[0]);
+	fail_unless( v_session_ready_push(&ready_list, &vsessions[0]) == 1,
+			"Handled session not added");
+	fail_unless( v_session_ready_pop_all(&ready_list) == &vsessions[0],
+			"Wrong session in list");
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for list of ready sessions
+ */
+struct Suite *session_ready_suite(void)
+{
+	struct Suite *suite = suite_create("Session_Ready");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Session_Ready_order);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -41,5 +41,17 @@
 struct Suite *node_create_suite(void);
 struct Suite *node_destroy_suite(void);
 struct Suite *taggroup_create_suite(void);
+struct Suite *hash_array_suite(void);
+struct Suite *pool_suite(void);
+struct Suite *cmd_pack_suite(void);
+struct Suite *session_ready_suite(void);
+struct Suite *ack_nak_suite(void);
+struct Suite *in_queue_suite(void);
+struct Suite *out_queue_suite(void);
+struct Suite *history_suite(void);
+struct Suite *congestion_suite(void);
+struct Suite *pmtud_suite(void);
+struct Suite *rto_suite(void);
+struct Suite *layer_values_suite(void);
 
 #endif /* T_NODE_CREATE_H_ */
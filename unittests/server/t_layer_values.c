@@ -0,0 +1,143 @@
+/*
+ *
+ * ***** BEGIN BSD LICENSE BLOCK *****
+ *
+ * Copyright (c) 2009-2013, Jiri Hnidek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END BSD LICENSE BLOCK *****
+ *
+ * Authors: Jiri Hnidek <jiri.hnidek@tul.cz>
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <check.h>
+
+#include "vs_layer_values.h"
+
+#define VALUE_COUNT 10000
+
+/* Value of layer with three real32 components */
+typedef struct LV_Value {
+	real32	vec[3];
+} LV_Value;
+
+/**
+ * \brief This function sets, finds and unsets values with item IDs generated
+ * by function id_func
+ */
+static void test_layer_values(uint32 (*id_func)(uint32), uint8 mode)
+{
+	struct VSLayerValues values;
+	struct LV_Value value, *found;
+	uint32 i, slot, item_id, count;
+	void *ptr;
+
+	vs_layer_values_init(&values, sizeof(struct LV_Value));
+
+	for(i=0; i < VALUE_COUNT; i++) {
+		value.vec[0] = value.vec[1] = value.vec[2] = (real32)i;
+		fail_unless( vs_layer_values_set(&values, id_func(i), &value) != NULL,
+				"Value %u not set", i);
+	}
+
+	fail_unless( values.mode == mode, "Wrong mode: %d != %d", values.mode, mode);
+	fail_unless( values.count == VALUE_COUNT,
+			"Count of values: %u != %d", values.count, VALUE_COUNT);
+
+	/* Unset every second value */
+	for(i=0; i < VALUE_COUNT; i+=2) {
+		fail_unless( vs_layer_values_unset(&values, id_func(i)) == 1,
+				"Value %u not unset", i);
+	}
+
+	fail_unless( vs_layer_values_unset(&values, id_func(0)) == 0,
+			"Value unset twice");
+
+	for(i=0; i < VALUE_COUNT; i++) {
+		found = (struct LV_Value*)vs_layer_values_find(&values, id_func(i));
+		if(i % 2 == 0) {
+			fail_unless( found == NULL, "Unset value %u found", i);
+		} else {
+			fail_unless( found != NULL && found->vec[2] == (real32)i,
+					"Value %u not found", i);
+		}
+	}
+
+	/* Iterate over all values */
+	count = 0;
+	slot = 0;
+	while(vs_layer_values_next(&values, &slot, &item_id, &ptr) == 1) {
+		found = (struct LV_Value*)vs_layer_values_find(&values, item_id);
+		fail_unless( found == ptr, "Wrong value of item %u", item_id);
+		count++;
+	}
+
+	fail_unless( count == VALUE_COUNT/2,
+			"Count of iterated values: %u != %d", count, VALUE_COUNT/2);
+
+	vs_layer_values_destroy(&values);
+}
+
+static uint32 dense_id(uint32 i)
+{
+	return i;
+}
+
+static uint32 sparse_id(uint32 i)
+{
+	return i * 2654435761U;
+}
+
+START_TEST ( test_Layer_Values_dense )
+{
+	test_layer_values(dense_id, VS_LAYER_VALUES_DENSE);
+}
+END_TEST
+
+START_TEST ( test_Layer_Values_sparse )
+{
+	test_layer_values(sparse_id, VS_LAYER_VALUES_SPARSE);
+}
+END_TEST
+
+/**
+ * \brief This function creates test suite for storage of layer values
+ */
+struct Suite *layer_values_suite(void)
+{
+	struct Suite *suite = suite_create("Layer_Values");
+	struct TCase *tc_core = tcase_create("Core");
+
+	tcase_add_test(tc_core, test_Layer_Values_dense);
+	tcase_add_test(tc_core, test_Layer_Values_sparse);
+
+	suite_add_tcase(suite, tc_core);
+
+	return suite;
+}
@@ -104,6 +104,18 @@ int main(int argc, char *argv[])
 	srunner_add_suite(master_sr, node_create_suite());
 	srunner_add_suite(master_sr, node_destroy_suite());
 	srunner_add_suite(master_sr, taggroup_create_suite());
+	srunner_add_suite(master_sr, hash_array_suite());
+	srunner_add_suite(master_sr, pool_suite());
+	srunner_add_suite(master_sr, cmd_pack_suite());
+	srunner_add_suite(master_sr, session_ready_suite());
+	srunner_add_suite(master_sr, in_queue_suite());
+	srunner_add_suite(master_sr, out_queue_suite());
+	srunner_add_suite(master_sr, history_suite());
+	srunner_add_suite(master_sr, ack_nak_suite());
+	srunner_add_suite(master_sr, congestion_suite());
+	srunner_add_suite(master_sr, pmtud_suite());
+	srunner_add_suite(master_sr, rto_suite());
+	srunner_add_suite(master_sr, layer_values_suite());
 
 	/* When client was started with some arguments */
 	if(argc>1) {